@@ -0,0 +1,314 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "capture.h"
+
+
+/**
+ * @brief   Store a little-endian integer.
+ *
+ * @param[out]  p_buffer    Pointer to the destination buffer
+ * @param[in]   value       Value to store
+ * @param[in]   size        Integer size in bytes
+ **/
+
+static void capture_put_le(uint8_t *p_buffer, uint64_t value, int size)
+{
+    int i;
+
+    for (i=0; i<size; i++)
+    {
+        p_buffer[i] = (uint8_t)(value >> (8*i));
+    }
+}
+
+
+/**
+ * @brief   Load a little-endian integer.
+ *
+ * @param[in]   p_buffer    Pointer to the source buffer
+ * @param[in]   size        Integer size in bytes
+ * @return  Loaded value.
+ **/
+
+static uint64_t capture_get_le(const uint8_t *p_buffer, int size)
+{
+    uint64_t value = 0;
+    int i;
+
+    for (i=size-1; i>=0; i--)
+    {
+        value = (value << 8) | p_buffer[i];
+    }
+
+    return value;
+}
+
+
+/**
+ * @brief   Create a capture file.
+ *
+ * @param[out]  p_writer    Pointer to a `capture_writer_t` structure
+ * @param[in]   psz_path    Capture file path, overwritten if it exists
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      File could not be created.
+ **/
+
+whad_result_t capture_create(capture_writer_t *p_writer, const char *psz_path)
+{
+    uint8_t header[CAPTURE_HEADER_SIZE];
+
+    /* Sanity check. */
+    if ((p_writer == NULL) || (psz_path == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    memset(p_writer, 0, sizeof(capture_writer_t));
+    p_writer->p_file = fopen(psz_path, "wb");
+    if (p_writer->p_file == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    capture_put_le(&header[8], CAPTURE_VERSION, 4);
+    if (fwrite(header, sizeof(header), 1, p_writer->p_file) != 1)
+    {
+        fclose(p_writer->p_file);
+        p_writer->p_file = NULL;
+        return WHAD_ERROR;
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Append received bytes to a capture file.
+ *
+ * @param[in]   p_writer    Pointer to a `capture_writer_t` structure
+ * @param[in]   time_ns     Receive time in ns, from any monotonic clock
+ * @param[in]   p_data      Pointer to the received bytes
+ * @param[in]   size        Number of received bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid parameters or write error.
+ **/
+
+whad_result_t capture_write(capture_writer_t *p_writer, uint64_t time_ns, const uint8_t *p_data, int size)
+{
+    uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+
+    /* Sanity check. */
+    if ((p_writer == NULL) || (p_writer->p_file == NULL) || (p_data == NULL) || (size < 0))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Nothing to record. */
+    if (size == 0)
+    {
+        return WHAD_SUCCESS;
+    }
+
+    /* Times are stored relative to the first record. */
+    if (!p_writer->started)
+    {
+        p_writer->origin_ns = time_ns;
+        p_writer->started = true;
+    }
+
+    capture_put_le(&header[0], time_ns - p_writer->origin_ns, 8);
+    capture_put_le(&header[8], (uint32_t)size, 4);
+    if ((fwrite(header, sizeof(header), 1, p_writer->p_file) != 1) ||
+        (fwrite(p_data, size, 1, p_writer->p_file) != 1))
+    {
+        return WHAD_ERROR;
+    }
+
+    p_writer->records++;
+    p_writer->bytes += size;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Close a capture file.
+ *
+ * @param[in]   p_writer    Pointer to a `capture_writer_t` structure
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Capture file is not open or could not be flushed.
+ **/
+
+whad_result_t capture_close(capture_writer_t *p_writer)
+{
+    int result;
+
+    /* Sanity check. */
+    if ((p_writer == NULL) || (p_writer->p_file == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    result = fclose(p_writer->p_file);
+    p_writer->p_file = NULL;
+
+    return (result == 0) ? WHAD_SUCCESS : WHAD_ERROR;
+}
+
+
+/**
+ * @brief   Map a capture file for reading.
+ *
+ * @param[out]  p_reader    Pointer to a `capture_reader_t` structure
+ * @param[in]   psz_path    Capture file path
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      File could not be mapped or is not a capture file.
+ **/
+
+whad_result_t capture_open(capture_reader_t *p_reader, const char *psz_path)
+{
+    struct stat st;
+    void *p_map;
+    int fd;
+
+    /* Sanity check. */
+    if ((p_reader == NULL) || (psz_path == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    memset(p_reader, 0, sizeof(capture_reader_t));
+    fd = open(psz_path, O_RDONLY);
+    if (fd < 0)
+    {
+        return WHAD_ERROR;
+    }
+
+    if ((fstat(fd, &st) != 0) || (st.st_size < CAPTURE_HEADER_SIZE))
+    {
+        close(fd);
+        return WHAD_ERROR;
+    }
+
+    /* The mapping remains valid once the descriptor is closed. */
+    p_map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_map == MAP_FAILED)
+    {
+        return WHAD_ERROR;
+    }
+
+    p_reader->p_map = (uint8_t *)p_map;
+    p_reader->size = (size_t)st.st_size;
+
+    /* Check header. */
+    if ((memcmp(p_reader->p_map, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) ||
+        (capture_get_le(&p_reader->p_map[8], 4) != CAPTURE_VERSION))
+    {
+        capture_release(p_reader);
+        return WHAD_ERROR;
+    }
+
+    madvise(p_reader->p_map, p_reader->size, MADV_SEQUENTIAL);
+    p_reader->offset = CAPTURE_HEADER_SIZE;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Read the next record of a capture file.
+ *
+ * @param[in]   p_reader    Pointer to a `capture_reader_t` structure
+ * @param[out]  p_time_ns   Receive time in ns, relative to the first record
+ * @param[out]  pp_data     Pointer set to the received bytes, inside the mapping
+ * @param[out]  p_size      Number of received bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_NONE       End of capture.
+ * @retval  WHAD_ERROR      Invalid parameters or truncated record.
+ **/
+
+whad_result_t capture_next(capture_reader_t *p_reader, uint64_t *p_time_ns, const uint8_t **pp_data, int *p_size)
+{
+    const uint8_t *p_record;
+    uint64_t size;
+
+    /* Sanity check. */
+    if ((p_reader == NULL) || (p_reader->p_map == NULL) || (p_time_ns == NULL) || (pp_data == NULL) ||
+        (p_size == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* End of capture. */
+    if (p_reader->offset == p_reader->size)
+    {
+        return WHAD_NONE;
+    }
+
+    if ((p_reader->size - p_reader->offset) < CAPTURE_RECORD_HEADER_SIZE)
+    {
+        return WHAD_ERROR;
+    }
+
+    p_record = &p_reader->p_map[p_reader->offset];
+    size = capture_get_le(&p_record[8], 4);
+    if ((size > INT32_MAX) || (size > (p_reader->size - p_reader->offset - CAPTURE_RECORD_HEADER_SIZE)))
+    {
+        return WHAD_ERROR;
+    }
+
+    *p_time_ns = capture_get_le(p_record, 8);
+    *pp_data = &p_record[CAPTURE_RECORD_HEADER_SIZE];
+    *p_size = (int)size;
+    p_reader->offset += CAPTURE_RECORD_HEADER_SIZE + (size_t)size;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Go back to the first record of a capture file.
+ *
+ * @param[in]   p_reader    Pointer to a `capture_reader_t` structure
+ **/
+
+void capture_rewind(capture_reader_t *p_reader)
+{
+    if ((p_reader != NULL) && (p_reader->p_map != NULL))
+    {
+        p_reader->offset = CAPTURE_HEADER_SIZE;
+    }
+}
+
+
+/**
+ * @brief   Unmap a capture file.
+ *
+ * @param[in]   p_reader    Pointer to a `capture_reader_t` structure
+ **/
+
+void capture_release(capture_reader_t *p_reader)
+{
+    if ((p_reader != NULL) && (p_reader->p_map != NULL))
+    {
+        munmap(p_reader->p_map, p_reader->size);
+        p_reader->p_map = NULL;
+        p_reader->size = 0;
+        p_reader->offset = 0;
+    }
+}
@@ -0,0 +1,54 @@
+/** \file capture.h
+ * Capture files of raw transport streams (host only).
+ *
+ * A capture file stores the bytes received on a WHAD link, framing included,
+ * along with their receive time, so that a session can be replayed through the
+ * transport layer without the device (see whad_replay.c).
+ *
+ * File format (all integers little-endian):
+ * - header: "WHADCAP" magic (8 bytes, NUL-terminated), version (32 bits),
+ *   reserved (32 bits, zero),
+ * - records: receive time in ns relative to the first record (64 bits),
+ *   number of bytes (32 bits), bytes.
+ *
+ * Captures are written with buffered stdio and read back through a read-only
+ * memory mapping.
+ */
+
+#ifndef __INC_WHAD_CAPTURE_H
+#define __INC_WHAD_CAPTURE_H
+
+#include <stdio.h>
+#include "whad.h"
+
+#define CAPTURE_MAGIC               "WHADCAP"
+#define CAPTURE_VERSION             (1)
+#define CAPTURE_HEADER_SIZE         (16)
+#define CAPTURE_RECORD_HEADER_SIZE  (12)
+
+/* Capture writer. */
+typedef struct {
+    FILE *p_file;               /*!< Capture file */
+    bool started;               /*!< At least one record has been written */
+    uint64_t origin_ns;         /*!< Time of the first record */
+    uint64_t records;           /*!< Records written */
+    uint64_t bytes;             /*!< Stream bytes written */
+} capture_writer_t;
+
+/* Capture reader. */
+typedef struct {
+    uint8_t *p_map;             /*!< Mapped capture file */
+    size_t size;                /*!< Capture file size */
+    size_t offset;              /*!< Offset of the next record */
+} capture_reader_t;
+
+whad_result_t capture_create(capture_writer_t *p_writer, const char *psz_path);
+whad_result_t capture_write(capture_writer_t *p_writer, uint64_t time_ns, const uint8_t *p_data, int size);
+whad_result_t capture_close(capture_writer_t *p_writer);
+
+whad_result_t capture_open(capture_reader_t *p_reader, const char *psz_path);
+whad_result_t capture_next(capture_reader_t *p_reader, uint64_t *p_time_ns, const uint8_t **pp_data, int *p_size);
+void capture_rewind(capture_reader_t *p_reader);
+void capture_release(capture_reader_t *p_reader);
+
+#endif /* __INC_WHAD_CAPTURE_H */
@@ -0,0 +1,381 @@
+#include "uart_sim.h"
+
+/* No pending event. */
+#define UART_SIM_NEVER      (UINT64_MAX)
+
+/* Size of the receiver hardware buffer (FIFO or DMA buffer). */
+#define UART_SIM_RX_BUF_SIZE    (4096)
+
+/* Configuration, statistics and virtual time. */
+static uart_sim_cfg_t g_config;
+static uart_sim_stats_t g_stats;
+static uint64_t g_now;
+
+/* Driver TX buffer, handed to the hardware by chunks. */
+static uint8_t g_tx_data[WHAD_RINGBUF_MAX_SIZE];
+static int g_tx_size;
+static int g_tx_offset;
+static bool g_tx_busy;
+
+/* Ongoing hardware transfer. */
+static bool g_hw_active;
+static uint64_t g_hw_start;
+static int g_hw_offset;
+static int g_hw_length;
+static int g_hw_sent;
+
+/* Bytes received by the hardware and not yet handled by the RX interrupt. */
+static uint8_t g_rx_data[UART_SIM_RX_BUF_SIZE];
+static int g_rx_count;
+
+/* Pending events. */
+static uint64_t g_tx_irq;
+static uint64_t g_rx_irq;
+static uint64_t g_rx_deadline;
+
+
+/**
+ * @brief   Compute the time required to transmit a number of bytes.
+ *
+ * @param[in]   count   Number of bytes
+ * @return  Transmission time in ns.
+ **/
+
+static uint64_t uart_sim_bytes_time(int count)
+{
+    return ((uint64_t)count * g_config.bits_per_byte * 1000000000ULL) / g_config.baudrate;
+}
+
+
+/**
+ * @brief   Hand the next chunk of the driver TX buffer to the hardware.
+ **/
+
+static void uart_sim_start_transfer(void)
+{
+    int length = g_tx_size - g_tx_offset;
+
+    /* Cap transfer to the driver chunk size. */
+    if ((g_config.tx_chunk_size > 0) && (length > g_config.tx_chunk_size))
+    {
+        length = g_config.tx_chunk_size;
+    }
+
+    g_hw_active = true;
+    g_hw_start = g_now;
+    g_hw_offset = g_tx_offset;
+    g_hw_length = length;
+    g_hw_sent = 0;
+
+    g_tx_offset += length;
+    g_stats.tx_transfers++;
+}
+
+
+/**
+ * @brief   Receive a byte from the wire.
+ *
+ * @param[in]   data    Received byte
+ **/
+
+static void uart_sim_receive_byte(uint8_t data)
+{
+    if (g_rx_count < UART_SIM_RX_BUF_SIZE)
+    {
+        g_rx_data[g_rx_count++] = data;
+    }
+    else
+    {
+        /* Hardware overrun. */
+        g_stats.rx_overruns++;
+    }
+
+    /* Raise an RX interrupt when the threshold is reached, or on idle line. */
+    if (g_rx_irq == UART_SIM_NEVER)
+    {
+        if (g_rx_count >= g_config.rx_chunk_size)
+        {
+            g_rx_irq = g_now + g_config.isr_latency_ns;
+            g_rx_deadline = UART_SIM_NEVER;
+        }
+        else if (g_config.rx_timeout > 0)
+        {
+            g_rx_deadline = g_now + uart_sim_bytes_time(g_config.rx_timeout);
+        }
+    }
+}
+
+
+/**
+ * @brief   Handle the end of transmission of the current byte.
+ **/
+
+static void uart_sim_byte_sent(void)
+{
+    /* Loop the byte back to our receiver. */
+    uart_sim_receive_byte(g_tx_data[g_hw_offset + g_hw_sent]);
+    g_hw_sent++;
+    g_stats.tx_bytes++;
+
+    /* End of transfer raises a TX interrupt. */
+    if (g_hw_sent == g_hw_length)
+    {
+        g_hw_active = false;
+        g_stats.busy_ns += uart_sim_bytes_time(g_hw_length);
+        g_tx_irq = g_now + g_config.isr_latency_ns;
+    }
+}
+
+
+/**
+ * @brief   TX interrupt handler.
+ **/
+
+static void uart_sim_tx_irq(void)
+{
+    g_tx_irq = UART_SIM_NEVER;
+    g_stats.tx_irqs++;
+
+    if (g_tx_offset < g_tx_size)
+    {
+        /* Send next chunk. */
+        uart_sim_start_transfer();
+    }
+    else
+    {
+        /* Buffer sent, notify WHAD. */
+        g_tx_busy = false;
+        whad_transport_data_sent();
+
+        if (g_config.tx_chain)
+        {
+            whad_transport_send_pending();
+        }
+    }
+}
+
+
+/**
+ * @brief   RX interrupt handler.
+ **/
+
+static void uart_sim_rx_irq(void)
+{
+    int queued;
+
+    g_rx_irq = UART_SIM_NEVER;
+    g_rx_deadline = UART_SIM_NEVER;
+    g_stats.rx_irqs++;
+
+    if (g_config.pfn_rx_tap != NULL)
+    {
+        g_config.pfn_rx_tap(g_now, g_rx_data, g_rx_count);
+    }
+
+    /* Forward received bytes to WHAD, counting the ones that do not fit. */
+    queued = whad_transport_get_rxbuf_size();
+    whad_transport_data_received(g_rx_data, g_rx_count);
+    queued = whad_transport_get_rxbuf_size() - queued;
+    g_stats.rx_overruns += (g_rx_count - queued);
+
+    g_rx_count = 0;
+}
+
+
+/**
+ * @brief   Fill a simulator configuration with default values.
+ *
+ * @param[out]  p_config    Pointer to a `uart_sim_cfg_t` structure
+ **/
+
+void uart_sim_default_config(uart_sim_cfg_t *p_config)
+{
+    p_config->baudrate = UART_SIM_DEFAULT_BAUDRATE;
+    p_config->bits_per_byte = UART_SIM_DEFAULT_BITS;
+    p_config->isr_latency_ns = UART_SIM_DEFAULT_ISR_LATENCY;
+    p_config->tx_chunk_size = UART_SIM_DEFAULT_TX_CHUNK;
+    p_config->rx_chunk_size = UART_SIM_DEFAULT_RX_CHUNK;
+    p_config->rx_timeout = UART_SIM_DEFAULT_RX_TIMEOUT;
+    p_config->tx_chain = false;
+    p_config->pfn_rx_tap = NULL;
+}
+
+
+/**
+ * @brief   Initialize the simulator and reset its virtual time.
+ *
+ * @param[in]   p_config    Pointer to a `uart_sim_cfg_t` structure
+ **/
+
+void uart_sim_init(uart_sim_cfg_t *p_config)
+{
+    g_config = *p_config;
+    if (g_config.rx_chunk_size < 1)
+    {
+        g_config.rx_chunk_size = 1;
+    }
+    else if (g_config.rx_chunk_size > UART_SIM_RX_BUF_SIZE)
+    {
+        g_config.rx_chunk_size = UART_SIM_RX_BUF_SIZE;
+    }
+
+    memset(&g_stats, 0, sizeof(uart_sim_stats_t));
+    g_now = 0;
+
+    g_tx_size = 0;
+    g_tx_offset = 0;
+    g_tx_busy = false;
+    g_hw_active = false;
+    g_rx_count = 0;
+
+    g_tx_irq = UART_SIM_NEVER;
+    g_rx_irq = UART_SIM_NEVER;
+    g_rx_deadline = UART_SIM_NEVER;
+}
+
+
+/**
+ * @brief   Send a buffer, to be used as `pfn_data_send_buffer`.
+ *
+ * The buffer is copied into the driver TX buffer and its transmission starts
+ * at the current virtual time.
+ *
+ * @param[in]   p_buffer    Pointer to the bytes to send
+ * @param[in]   size        Number of bytes to send
+ **/
+
+void uart_sim_send_buffer(uint8_t *p_buffer, int size)
+{
+    /* Transport layer does not send while a transmission is ongoing. */
+    if (g_tx_busy || (size <= 0))
+    {
+        return;
+    }
+
+    if (size > WHAD_RINGBUF_MAX_SIZE)
+    {
+        size = WHAD_RINGBUF_MAX_SIZE;
+    }
+
+    memcpy(g_tx_data, p_buffer, size);
+    g_tx_size = size;
+    g_tx_offset = 0;
+    g_tx_busy = true;
+
+    uart_sim_start_transfer();
+}
+
+
+/**
+ * @brief   Advance the virtual time, processing every event up to it.
+ *
+ * Simultaneous events are processed in the following order: byte sent,
+ * idle line timeout, TX interrupt and RX interrupt.
+ *
+ * @param[in]   time_ns     Virtual time to reach, in ns
+ **/
+
+void uart_sim_run_until(uint64_t time_ns)
+{
+    uint64_t byte_time;
+    uint64_t next;
+
+    for (;;)
+    {
+        byte_time = UART_SIM_NEVER;
+        if (g_hw_active)
+        {
+            byte_time = g_hw_start + uart_sim_bytes_time(g_hw_sent + 1);
+        }
+
+        next = byte_time;
+        if (g_rx_deadline < next)
+            next = g_rx_deadline;
+        if (g_tx_irq < next)
+            next = g_tx_irq;
+        if (g_rx_irq < next)
+            next = g_rx_irq;
+
+        if ((next == UART_SIM_NEVER) || (next > time_ns))
+        {
+            break;
+        }
+        g_now = next;
+
+        if (next == byte_time)
+        {
+            uart_sim_byte_sent();
+        }
+        else if (next == g_rx_deadline)
+        {
+            g_rx_deadline = UART_SIM_NEVER;
+            if ((g_rx_count > 0) && (g_rx_irq == UART_SIM_NEVER))
+            {
+                g_rx_irq = g_now + g_config.isr_latency_ns;
+            }
+        }
+        else if (next == g_tx_irq)
+        {
+            uart_sim_tx_irq();
+        }
+        else
+        {
+            uart_sim_rx_irq();
+        }
+    }
+
+    if (time_ns > g_now)
+    {
+        g_now = time_ns;
+    }
+}
+
+
+/**
+ * @brief   Get the current virtual time.
+ *
+ * @return  Virtual time in ns.
+ **/
+
+uint64_t uart_sim_get_time(void)
+{
+    return g_now;
+}
+
+
+/**
+ * @brief   Get the time required to transmit a single byte.
+ *
+ * @return  Byte time in ns.
+ **/
+
+uint64_t uart_sim_get_byte_time(void)
+{
+    return uart_sim_bytes_time(1);
+}
+
+
+/**
+ * @brief   Determine if the simulated UART has nothing left to do.
+ *
+ * @retval  true    No transmission, received byte or interrupt pending.
+ * @retval  false   Simulator has pending events.
+ **/
+
+bool uart_sim_is_idle(void)
+{
+    return (!g_tx_busy && (g_rx_count == 0) &&
+            (g_tx_irq == UART_SIM_NEVER) && (g_rx_irq == UART_SIM_NEVER));
+}
+
+
+/**
+ * @brief   Get the simulator statistics.
+ *
+ * @param[out]  p_stats     Pointer to a `uart_sim_stats_t` structure
+ **/
+
+void uart_sim_get_stats(uart_sim_stats_t *p_stats)
+{
+    *p_stats = g_stats;
+}
@@ -0,0 +1,64 @@
+/** \file uart_sim.h
+ * Deterministic UART simulator (host only).
+ *
+ * Stands for the firmware UART driver of the WHAD transport layer: its
+ * `uart_sim_send_buffer()` function is used as `pfn_data_send_buffer`, it calls
+ * `whad_transport_data_sent()` from its simulated TX interrupt and feeds every
+ * transmitted byte back to `whad_transport_data_received()` from its simulated
+ * RX interrupt. Time is virtual and only advances through `uart_sim_run_until()`,
+ * so that a given configuration always produces the same figures.
+ *
+ * The simulator models the byte time for the configured baudrate and frame
+ * format, the latency between a hardware event and its interrupt handler, the
+ * maximum size of a driver transfer (DMA) and the RX interrupt threshold (FIFO
+ * or DMA half-transfer) along with its idle line timeout.
+ */
+
+#ifndef __INC_WHAD_UART_SIM_H
+#define __INC_WHAD_UART_SIM_H
+
+#include "whad.h"
+
+/* Default simulator configuration: 115200 bauds 8N1, 2us ISR latency. */
+#define UART_SIM_DEFAULT_BAUDRATE       (115200)
+#define UART_SIM_DEFAULT_BITS           (10)
+#define UART_SIM_DEFAULT_ISR_LATENCY    (2000)
+#define UART_SIM_DEFAULT_TX_CHUNK       (0)
+#define UART_SIM_DEFAULT_RX_CHUNK       (1)
+#define UART_SIM_DEFAULT_RX_TIMEOUT     (2)
+
+/* Callback receiving the bytes handed to each RX interrupt, with the current time. */
+typedef void (*uart_sim_rx_tap_cb_t)(uint64_t time_ns, uint8_t *p_data, int size);
+
+/* Simulator configuration. */
+typedef struct {
+    uint32_t baudrate;          /*!< Line speed in bits per second */
+    int bits_per_byte;          /*!< Bits per byte on the wire, start and stop bits included */
+    uint32_t isr_latency_ns;    /*!< Delay between a hardware event and its interrupt handler */
+    int tx_chunk_size;          /*!< Maximum size of a driver transfer, 0 if unlimited */
+    int rx_chunk_size;          /*!< Number of received bytes raising an RX interrupt */
+    int rx_timeout;             /*!< Idle line timeout flushing a partial RX chunk, in byte times */
+    bool tx_chain;              /*!< TX interrupt handler sends pending bytes itself */
+    uart_sim_rx_tap_cb_t pfn_rx_tap;    /*!< Receives a copy of the received bytes, may be NULL */
+} uart_sim_cfg_t;
+
+/* Simulator statistics. */
+typedef struct {
+    uint64_t tx_bytes;          /*!< Bytes transmitted on the wire */
+    uint64_t tx_transfers;      /*!< Driver transfers */
+    uint64_t tx_irqs;           /*!< TX interrupts */
+    uint64_t rx_irqs;           /*!< RX interrupts */
+    uint64_t rx_overruns;       /*!< Received bytes dropped, RX ring buffer full */
+    uint64_t busy_ns;           /*!< Time spent transmitting bytes */
+} uart_sim_stats_t;
+
+void uart_sim_init(uart_sim_cfg_t *p_config);
+void uart_sim_default_config(uart_sim_cfg_t *p_config);
+void uart_sim_send_buffer(uint8_t *p_buffer, int size);
+void uart_sim_run_until(uint64_t time_ns);
+uint64_t uart_sim_get_time(void);
+uint64_t uart_sim_get_byte_time(void);
+bool uart_sim_is_idle(void);
+void uart_sim_get_stats(uart_sim_stats_t *p_stats);
+
+#endif /* __INC_WHAD_UART_SIM_H */
@@ -0,0 +1,643 @@
+#include <string.h>
+#include "vdev.h"
+
+/* Device identity. */
+#define VDEV_PROTO_MIN_VERSION      (1)
+#define VDEV_MAX_SPEED              (BAUDRATE_MAX)
+#define VDEV_FW_VERSION_MAJOR       (1)
+#define VDEV_FW_VERSION_MINOR       (0)
+#define VDEV_FW_VERSION_REV         (0)
+
+/* Traffic falling behind by more than this is skipped rather than caught up. */
+#define VDEV_MAX_LATE_NS            (100000000ULL)
+
+/* BLE connection: access address, hop increment and PDUs per connection event. */
+#define VDEV_BLE_ACCESS_ADDRESS     (0x50654c2a)
+#define VDEV_BLE_HOP_INCREMENT      (7)
+#define VDEV_BLE_PDUS_PER_EVENT     (4)
+
+/* Default channels and PHY band. */
+#define VDEV_DOT15D4_DEFAULT_CHANNEL    (11)
+#define VDEV_ESB_DEFAULT_CHANNEL        (8)
+#define VDEV_PHY_BASE_FREQUENCY         (2402000000UL)
+#define VDEV_PHY_CHANNEL_SPACING        (2000000UL)
+#define VDEV_PHY_CHANNELS               (40)
+#define VDEV_PHY_DATARATE               (1000000)
+#define VDEV_PHY_DEVIATION              (250000)
+
+/* Emulated domain state. */
+typedef struct {
+    bool started;               /*!< Traffic is generated */
+    uint64_t next_ns;           /*!< Time of the next notification */
+    uint32_t sequence;          /*!< Notifications generated since start */
+    uint32_t channel;           /*!< Current channel */
+    bool energy_detection;      /*!< 802.15.4 only: generate energy detection samples */
+} vdev_domain_state_t;
+
+static const char *g_vdev_domain_names[VDEV_DOMAINS] = {
+    "ble", "dot15d4", "esb", "phy"
+};
+
+/* Capabilities and supported commands. */
+static whad_domain_desc_t g_vdev_capabilities[] = {
+#if WHAD_ENABLE_BLE
+    {DOMAIN_BTLE, CAP_SNIFF, (1ULL << ble_BleCommand_SniffAdv) | (1ULL << ble_BleCommand_SniffConnReq) |
+                             (1ULL << ble_BleCommand_SniffAccessAddress) | (1ULL << ble_BleCommand_SniffActiveConn) |
+                             (1ULL << ble_BleCommand_Start) | (1ULL << ble_BleCommand_Stop)},
+#endif
+#if WHAD_ENABLE_DOT15D4
+    {DOMAIN_DOT15D4, CAP_SNIFF, (1ULL << dot15d4_Dot15d4Command_Sniff) | (1ULL << dot15d4_Dot15d4Command_EnergyDetection) |
+                                (1ULL << dot15d4_Dot15d4Command_Start) | (1ULL << dot15d4_Dot15d4Command_Stop)},
+#endif
+#if WHAD_ENABLE_ESB
+    {DOMAIN_ESB, CAP_SNIFF, (1ULL << esb_ESBCommand_Sniff) | (1ULL << esb_ESBCommand_Start) |
+                            (1ULL << esb_ESBCommand_Stop)},
+#endif
+#if WHAD_ENABLE_PHY
+    {DOMAIN_PHY, CAP_SNIFF, (1ULL << phy_PhyCommand_SetGFSKModulation) | (1ULL << phy_PhyCommand_SetFrequency) |
+                            (1ULL << phy_PhyCommand_SetDataRate) | (1ULL << phy_PhyCommand_SetEndianness) |
+                            (1ULL << phy_PhyCommand_SetPacketSize) | (1ULL << phy_PhyCommand_SetSyncWord) |
+                            (1ULL << phy_PhyCommand_Sniff) | (1ULL << phy_PhyCommand_Start) |
+                            (1ULL << phy_PhyCommand_Stop)},
+#endif
+    {DOMAIN_NONE, CAP_NONE, 0}
+};
+
+static whad_cap_index_t g_vdev_cap_index;
+
+static uint8_t g_vdev_devid[16] = "whad-vdev";
+static char g_vdev_author[] = "whad-lib";
+static char g_vdev_url[] = "https://github.com/whad-team/whad-lib";
+
+/* Configuration, state and statistics. */
+static vdev_cfg_t g_vdev_config;
+static vdev_domain_state_t g_vdev_domains[VDEV_DOMAINS];
+static vdev_stats_t g_vdev_stats;
+static uint64_t g_vdev_origin_ns;
+
+/* Received message, pending reply and notification being generated. */
+static Message g_vdev_rx;
+static Message g_vdev_reply;
+static bool g_vdev_reply_pending = false;
+static Message g_vdev_tx;
+static uint8_t g_vdev_payload[256];
+
+
+/**
+ * @brief   Queue a message if the TX ring buffer has room for it.
+ *
+ * Unlike `whad_send_message()`, never waits for the TX ring buffer to drain.
+ *
+ * @param[in]   p_message   Message to send
+ *
+ * @retval  WHAD_SUCCESS        Message queued.
+ * @retval  WHAD_RINGBUF_FULL   Not enough room in the TX ring buffer.
+ * @retval  WHAD_ERROR          Message could not be encoded.
+ **/
+
+static whad_result_t vdev_queue(Message *p_message)
+{
+    size_t size;
+
+    if (!pb_get_encoded_size(&size, Message_fields, p_message))
+    {
+        return WHAD_ERROR;
+    }
+
+    if ((int)size + 4 + WHAD_TRACE_OVERHEAD > (WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_txbuf_size()))
+    {
+        return WHAD_RINGBUF_FULL;
+    }
+
+    return whad_send_message(p_message);
+}
+
+
+/**
+ * @brief   Start or stop generating traffic for a domain.
+ *
+ * @param[in]   domain      Emulated domain
+ * @param[in]   started     True to start, false to stop
+ * @param[in]   now_ns      Current time
+ **/
+
+static void vdev_set_started(vdev_domain_t domain, bool started, uint64_t now_ns)
+{
+    if (started && !g_vdev_domains[domain].started)
+    {
+        WHAD_LOG(WHAD_LOG_INFO, "domain %u started", domain);
+    }
+    else if (!started && g_vdev_domains[domain].started)
+    {
+        WHAD_LOG(WHAD_LOG_INFO, "domain %u stopped after %u notifications", domain, g_vdev_domains[domain].sequence);
+    }
+
+    g_vdev_domains[domain].started = started;
+    g_vdev_domains[domain].next_ns = now_ns;
+    g_vdev_domains[domain].sequence = 0;
+}
+
+
+/**
+ * @brief   Handle a domain command, updating the emulated domain state.
+ *
+ * @param[in]   p_message   Received domain message
+ * @param[in]   now_ns      Current time
+ * @return  Command result sent back to the host.
+ **/
+
+static whad_result_code_t vdev_domain_command(Message *p_message, uint64_t now_ns)
+{
+    switch (p_message->which_msg)
+    {
+#if WHAD_ENABLE_BLE
+        case Message_ble_tag:
+            switch (whad_ble_get_message_type(p_message))
+            {
+                case WHAD_BLE_START: vdev_set_started(VDEV_BLE, true, now_ns); break;
+                case WHAD_BLE_STOP: vdev_set_started(VDEV_BLE, false, now_ns); break;
+                default: break;
+            }
+            return WHAD_RESULT_SUCCESS;
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+        case Message_dot15d4_tag:
+            switch (whad_dot15d4_get_message_type(p_message))
+            {
+                case WHAD_DOT15D4_SNIFF:
+                    whad_dot15d4_sniff_parse(p_message, &g_vdev_domains[VDEV_DOT15D4].channel);
+                    g_vdev_domains[VDEV_DOT15D4].energy_detection = false;
+                    break;
+                case WHAD_DOT15D4_NRG_DETECTION:
+                    whad_dot15d4_energy_detect_parse(p_message, &g_vdev_domains[VDEV_DOT15D4].channel);
+                    g_vdev_domains[VDEV_DOT15D4].energy_detection = true;
+                    break;
+                case WHAD_DOT15D4_START: vdev_set_started(VDEV_DOT15D4, true, now_ns); break;
+                case WHAD_DOT15D4_STOP: vdev_set_started(VDEV_DOT15D4, false, now_ns); break;
+                default: break;
+            }
+            return WHAD_RESULT_SUCCESS;
+#endif
+
+#if WHAD_ENABLE_ESB
+        case Message_esb_tag:
+            switch (whad_esb_get_message_type(p_message))
+            {
+                case WHAD_ESB_START: vdev_set_started(VDEV_ESB, true, now_ns); break;
+                case WHAD_ESB_STOP: vdev_set_started(VDEV_ESB, false, now_ns); break;
+                default: break;
+            }
+            return WHAD_RESULT_SUCCESS;
+#endif
+
+#if WHAD_ENABLE_PHY
+        case Message_phy_tag:
+            switch (whad_phy_get_message_type(p_message))
+            {
+                case WHAD_PHY_START: vdev_set_started(VDEV_PHY, true, now_ns); break;
+                case WHAD_PHY_STOP: vdev_set_started(VDEV_PHY, false, now_ns); break;
+                default: break;
+            }
+            return WHAD_RESULT_SUCCESS;
+#endif
+
+        default:
+            return WHAD_RESULT_UNSUPPORTED_DOMAIN;
+    }
+}
+
+
+/**
+ * @brief   Prepare a command result carrying the command timing.
+ *
+ * Duration and TX backlog are set when the result is queued.
+ *
+ * @param[in]   result      Command result code
+ * @param[in]   now_ns      Time at which the command was received
+ **/
+
+static void vdev_cmd_result(whad_result_code_t result, uint64_t now_ns)
+{
+    whad_cmd_timing_t timing;
+
+    timing.rx_time = (uint32_t)((now_ns - g_vdev_origin_ns) / 1000);
+    timing.duration = 0;
+    timing.tx_backlog = 0;
+    whad_generic_cmd_result_timed(&g_vdev_reply, result, &timing);
+}
+
+
+/**
+ * @brief   Handle a message received from the host, preparing its reply.
+ *
+ * @param[in]   p_message   Received message
+ * @param[in]   now_ns      Current time
+ **/
+
+static void vdev_handle_message(Message *p_message, uint64_t now_ns)
+{
+    whad_domain_t domain;
+    uint32_t sequence;
+    uint64_t host_time;
+    int i;
+
+    g_vdev_reply_pending = true;
+    switch (whad_get_message_type(p_message))
+    {
+        case WHAD_MSGTYPE_DISCOVERY:
+            switch (whad_discovery_get_message_type(p_message))
+            {
+                case WHAD_DISCOVERY_DEVICE_INFO_QUERY:
+                    whad_discovery_device_info_resp(&g_vdev_reply, discovery_DeviceType_VirtualDevice, g_vdev_devid,
+                                                    VDEV_PROTO_MIN_VERSION, VDEV_MAX_SPEED, g_vdev_author, g_vdev_url,
+                                                    VDEV_FW_VERSION_MAJOR, VDEV_FW_VERSION_MINOR, VDEV_FW_VERSION_REV,
+                                                    g_vdev_capabilities);
+                    if (whad_discovery_device_info_query_is_describe(p_message))
+                    {
+                        whad_discovery_device_info_resp_add_domains(&g_vdev_reply, g_vdev_capabilities);
+                    }
+                    return;
+
+                case WHAD_DISCOVERY_DOMAIN_INFO_QUERY:
+                    whad_discovery_domain_info_query_parse(p_message, &domain);
+                    if (whad_cap_index_is_domain_supported(&g_vdev_cap_index, domain))
+                    {
+                        whad_discovery_domain_info_resp(&g_vdev_reply, domain, g_vdev_capabilities);
+                    }
+                    else
+                    {
+                        vdev_cmd_result(WHAD_RESULT_UNSUPPORTED_DOMAIN, now_ns);
+                    }
+                    return;
+
+                case WHAD_DISCOVERY_DEVICE_RESET:
+                    for (i=0; i<VDEV_DOMAINS; i++)
+                    {
+                        vdev_set_started((vdev_domain_t)i, false, now_ns);
+                    }
+                    whad_discovery_ready_resp(&g_vdev_reply);
+                    return;
+
+                default:
+                    vdev_cmd_result(WHAD_RESULT_SUCCESS, now_ns);
+                    return;
+            }
+
+        case WHAD_MSGTYPE_DOMAIN:
+            vdev_cmd_result(vdev_domain_command(p_message, now_ns), now_ns);
+            return;
+
+        case WHAD_MSGTYPE_GENERIC:
+            if (whad_generic_time_sync_query_parse(p_message, &sequence, &host_time) == WHAD_SUCCESS)
+            {
+                /* Device time of notifications timestamps, transmission time set when queued. */
+                whad_generic_time_sync_reply(&g_vdev_reply, sequence, host_time, (now_ns - g_vdev_origin_ns) / 1000,
+                                             (now_ns - g_vdev_origin_ns) / 1000);
+                return;
+            }
+
+            /* Other generic messages from the host do not expect a reply. */
+            g_vdev_reply_pending = false;
+            return;
+
+        default:
+            g_vdev_reply_pending = false;
+            return;
+    }
+}
+
+
+/**
+ * @brief   Fill the payload of the next notification.
+ *
+ * @param[in]   sequence    Notification sequence number
+ * @param[in]   size        Payload size
+ **/
+
+static void vdev_fill_payload(uint32_t sequence, int size)
+{
+    int i;
+
+    for (i=0; i<size; i++)
+    {
+        g_vdev_payload[i] = (uint8_t)(sequence + i * 31);
+    }
+}
+
+
+/**
+ * @brief   Cap the payload size to the size of a message field.
+ *
+ * @param[in]   max_size    Field size
+ * @return  Payload size.
+ **/
+
+static int vdev_payload_size(int max_size)
+{
+    return (g_vdev_config.payload_size < max_size) ? g_vdev_config.payload_size : max_size;
+}
+
+
+/**
+ * @brief   Build the next notification of a domain.
+ *
+ * @param[in]   domain      Emulated domain
+ * @param[in]   now_ns      Current time
+ * @retval  WHAD_SUCCESS    Notification built into `g_vdev_tx`.
+ * @retval  WHAD_ERROR      Domain is not built in.
+ **/
+
+static whad_result_t vdev_build(vdev_domain_t domain, uint64_t now_ns)
+{
+    vdev_domain_state_t *p_state = &g_vdev_domains[domain];
+    uint32_t timestamp = (uint32_t)((now_ns - g_vdev_origin_ns) / 1000);
+    int size;
+
+    switch (domain)
+    {
+#if WHAD_ENABLE_BLE
+        case VDEV_BLE:
+            /* Hop to the next data channel at each connection event. */
+            if ((p_state->sequence % VDEV_BLE_PDUS_PER_EVENT) == 0)
+            {
+                p_state->channel = (p_state->channel + VDEV_BLE_HOP_INCREMENT) % 37;
+            }
+            size = vdev_payload_size(sizeof(g_vdev_tx.msg.ble.msg.raw_pdu.pdu.bytes));
+            vdev_fill_payload(p_state->sequence, size);
+            return whad_ble_raw_pdu(&g_vdev_tx, p_state->channel, -50 - (int32_t)(p_state->sequence % 40), 0,
+                                    VDEV_BLE_ACCESS_ADDRESS, g_vdev_payload, size, p_state->sequence & 0xffffff, true,
+                                    timestamp, 0, (p_state->sequence & 1) ? BLE_SLAVE_TO_MASTER : BLE_MASTER_TO_SLAVE,
+                                    false, false, true);
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+        case VDEV_DOT15D4:
+        {
+            whad_dot15d4_recvd_packet_t packet;
+
+            if (p_state->energy_detection)
+            {
+                return whad_dot15d4_energy_detect_sample(&g_vdev_tx, timestamp, p_state->sequence % 256);
+            }
+
+            size = vdev_payload_size(sizeof(packet.packet.bytes));
+            vdev_fill_payload(p_state->sequence, size);
+            memset(&packet, 0, sizeof(packet));
+            packet.channel = p_state->channel;
+            packet.has_rssi = true;
+            packet.rssi = -60 - (int32_t)(p_state->sequence % 30);
+            packet.has_timestamp = true;
+            packet.timestamp = timestamp;
+            packet.has_fcs_validity = true;
+            packet.fcs_validity = true;
+            packet.fcs = p_state->sequence & 0xffff;
+            packet.has_lqi = true;
+            packet.lqi = 255 - (p_state->sequence % 64);
+            memcpy(packet.packet.bytes, g_vdev_payload, size);
+            packet.packet.length = size;
+            return whad_dot15d4_raw_pdu_received(&g_vdev_tx, &packet);
+        }
+#endif
+
+#if WHAD_ENABLE_ESB
+        case VDEV_ESB:
+        {
+            whad_esb_recvd_packet_t packet;
+
+            size = vdev_payload_size(sizeof(packet.packet.bytes));
+            vdev_fill_payload(p_state->sequence, size);
+            memset(&packet, 0, sizeof(packet));
+            packet.channel = p_state->channel;
+            packet.has_rssi = true;
+            packet.rssi = -55 - (int32_t)(p_state->sequence % 30);
+            packet.has_timestamp = true;
+            packet.timestamp = timestamp;
+            packet.has_crc_validity = true;
+            packet.crc_validity = true;
+            packet.has_address = true;
+            memset(packet.address.address, 0xe7, ESB_ADDR_MAX_SIZE);
+            packet.address.size = ESB_ADDR_MAX_SIZE;
+            memcpy(packet.packet.bytes, g_vdev_payload, size);
+            packet.packet.length = (uint8_t)size;
+            return whad_esb_raw_pdu_received(&g_vdev_tx, &packet);
+        }
+#endif
+
+#if WHAD_ENABLE_PHY
+        case VDEV_PHY:
+        {
+            uint8_t syncword[] = {0x8e, 0x89, 0xbe, 0xd6};
+
+            p_state->channel = (p_state->channel + 1) % VDEV_PHY_CHANNELS;
+            size = vdev_payload_size(sizeof(g_vdev_tx.msg.phy.msg.packet.packet.bytes));
+            vdev_fill_payload(p_state->sequence, size);
+            return whad_phy_packet_received(&g_vdev_tx,
+                                            VDEV_PHY_BASE_FREQUENCY + p_state->channel * VDEV_PHY_CHANNEL_SPACING,
+                                            -70 + (int32_t)(p_state->sequence % 20), timestamp / 1000000,
+                                            timestamp % 1000000, g_vdev_payload, size, syncword, sizeof(syncword),
+                                            VDEV_PHY_DEVIATION, VDEV_PHY_DATARATE, PHY_LITTLE_ENDIAN, MOD_GFSK);
+        }
+#endif
+
+        default:
+            return WHAD_ERROR;
+    }
+}
+
+
+/**
+ * @brief   Generate the notifications of a domain that are due.
+ *
+ * @param[in]   domain      Emulated domain
+ * @param[in]   now_ns      Current time
+ **/
+
+static void vdev_generate(vdev_domain_t domain, uint64_t now_ns)
+{
+    vdev_domain_state_t *p_state = &g_vdev_domains[domain];
+    uint64_t period = 1000000000ULL / g_vdev_config.rate;
+
+    /* Do not try to catch up after a long stall. */
+    if ((now_ns - p_state->next_ns) > VDEV_MAX_LATE_NS)
+    {
+        g_vdev_stats.dropped[domain] += (now_ns - p_state->next_ns) / period;
+        p_state->next_ns = now_ns;
+    }
+
+    while (p_state->started && (p_state->next_ns <= now_ns))
+    {
+        if (vdev_build(domain, now_ns) != WHAD_SUCCESS)
+        {
+            /* Domain not built in. */
+            p_state->started = false;
+            return;
+        }
+
+        if (vdev_queue(&g_vdev_tx) == WHAD_SUCCESS)
+        {
+            g_vdev_stats.generated[domain]++;
+        }
+        else
+        {
+            g_vdev_stats.dropped[domain]++;
+            WHAD_LOG(WHAD_LOG_DEBUG, "domain %u notification %u dropped, TX ring buffer full", domain,
+                     p_state->sequence);
+        }
+
+        p_state->sequence++;
+        p_state->next_ns += period;
+    }
+}
+
+
+/**
+ * @brief   Initialize the virtual device.
+ *
+ * @param[in]   p_config    Pointer to a `vdev_cfg_t` structure
+ * @param[in]   now_ns      Current time
+ **/
+
+void vdev_init(vdev_cfg_t *p_config, uint64_t now_ns)
+{
+    int i;
+
+    g_vdev_config = *p_config;
+    if (g_vdev_config.rate == 0)
+    {
+        g_vdev_config.rate = VDEV_DEFAULT_RATE;
+    }
+    if ((g_vdev_config.payload_size < 1) || (g_vdev_config.payload_size > (int)sizeof(g_vdev_payload)))
+    {
+        g_vdev_config.payload_size = VDEV_DEFAULT_PAYLOAD_SIZE;
+    }
+
+    memset(&g_vdev_stats, 0, sizeof(g_vdev_stats));
+    memset(g_vdev_domains, 0, sizeof(g_vdev_domains));
+    for (i=0; i<VDEV_DOMAINS; i++)
+    {
+        vdev_set_started((vdev_domain_t)i, false, now_ns);
+    }
+    g_vdev_domains[VDEV_DOT15D4].channel = VDEV_DOT15D4_DEFAULT_CHANNEL;
+    g_vdev_domains[VDEV_ESB].channel = VDEV_ESB_DEFAULT_CHANNEL;
+    g_vdev_reply_pending = false;
+    g_vdev_origin_ns = now_ns;
+    whad_cap_index_build(&g_vdev_cap_index, g_vdev_capabilities);
+}
+
+
+/**
+ * @brief   Run one iteration of the virtual firmware main loop.
+ *
+ * Handles messages received from the host (one at a time, waiting for the
+ * reply to be queued), generates the notifications that are due and sends
+ * pending bytes.
+ *
+ * @param[in]   now_ns      Current time
+ **/
+
+void vdev_process(uint64_t now_ns)
+{
+    whad_result_t result;
+    generic_CmdResult *p_cmd_result;
+    int i;
+
+    for (;;)
+    {
+        /* Replies wait for room in the TX ring buffer, notifications do not. */
+        if (g_vdev_reply_pending)
+        {
+            if ((g_vdev_reply.which_msg == Message_generic_tag) &&
+                (g_vdev_reply.msg.generic.which_msg == generic_Message_time_sync_reply_tag))
+            {
+                g_vdev_reply.msg.generic.msg.time_sync_reply.tx_time = (now_ns - g_vdev_origin_ns) / 1000;
+            }
+            else if ((g_vdev_reply.which_msg == Message_generic_tag) &&
+                     (g_vdev_reply.msg.generic.which_msg == generic_Message_cmd_result_tag) &&
+                     g_vdev_reply.msg.generic.msg.cmd_result.has_rx_time)
+            {
+                p_cmd_result = &g_vdev_reply.msg.generic.msg.cmd_result;
+                p_cmd_result->duration = (uint32_t)((now_ns - g_vdev_origin_ns) / 1000) - p_cmd_result->rx_time;
+                p_cmd_result->tx_backlog = whad_transport_get_txbuf_size();
+            }
+
+            if (vdev_queue(&g_vdev_reply) == WHAD_RINGBUF_FULL)
+            {
+                break;
+            }
+            g_vdev_reply_pending = false;
+        }
+
+        result = whad_get_message(&g_vdev_rx);
+        if (result == WHAD_NONE)
+        {
+            break;
+        }
+
+        g_vdev_stats.commands++;
+        if (result != WHAD_SUCCESS)
+        {
+            g_vdev_stats.errors++;
+            continue;
+        }
+
+        vdev_handle_message(&g_vdev_rx, now_ns);
+        whad_free_message_resources(&g_vdev_rx);
+    }
+
+    for (i=0; i<VDEV_DOMAINS; i++)
+    {
+        if (g_vdev_domains[i].started)
+        {
+            vdev_generate((vdev_domain_t)i, now_ns);
+        }
+    }
+
+    /* Log entries only take the room left by notifications. */
+    whad_log_flush();
+
+    whad_transport_send_pending();
+}
+
+
+/**
+ * @brief   Check if a domain generates traffic.
+ *
+ * @param[in]   domain      Emulated domain
+ * @return  True if the domain has been started.
+ **/
+
+bool vdev_is_started(vdev_domain_t domain)
+{
+    return ((unsigned int)domain < VDEV_DOMAINS) && g_vdev_domains[domain].started;
+}
+
+
+/**
+ * @brief   Get the name of an emulated domain.
+ *
+ * @param[in]   domain      Emulated domain
+ * @return  Domain name, NULL if domain is invalid.
+ **/
+
+const char *vdev_get_domain_name(vdev_domain_t domain)
+{
+    if ((unsigned int)domain >= VDEV_DOMAINS)
+    {
+        return NULL;
+    }
+
+    return g_vdev_domain_names[domain];
+}
+
+
+/**
+ * @brief   Get the virtual device statistics.
+ *
+ * @param[out]  p_stats     Pointer to a `vdev_stats_t` structure
+ **/
+
+void vdev_get_stats(vdev_stats_t *p_stats)
+{
+    *p_stats = g_vdev_stats;
+}
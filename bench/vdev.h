@@ -0,0 +1,60 @@
+/** \file vdev.h
+ * Virtual WHAD device (host only).
+ *
+ * A firmware main loop built on the library, without any radio: it answers
+ * discovery queries with a `VirtualDevice` description, acknowledges domain
+ * commands with a `CmdResult`, answers clock synchronization queries in the
+ * time base of its notifications timestamps and, once a domain has been
+ * started, generates synthetic notifications at a fixed rate:
+ * - BLE: raw PDUs of a connection hopping over the data channels,
+ * - IEEE 802.15.4: raw frames on the sniffed channel, or energy detection
+ *   samples once an energy detection has been requested,
+ * - ESB: raw packets on the sniffed channel,
+ * - PHY: packets hopping over the 2.4 GHz band.
+ *
+ * Notifications that do not fit in the TX ring buffer are dropped, as a
+ * sniffer firmware would do, and counted. Domain starts, stops and dropped
+ * notifications are also reported with binary log entries (see log.h, expanded
+ * by whad-logdecode from the whad-vdev executable). The transport layer must be
+ * initialized (`whad_init()`) before `vdev_init()`.
+ */
+
+#ifndef __INC_WHAD_VDEV_H
+#define __INC_WHAD_VDEV_H
+
+#include "whad.h"
+
+/* Default traffic parameters. */
+#define VDEV_DEFAULT_RATE           (1000)
+#define VDEV_DEFAULT_PAYLOAD_SIZE   (32)
+
+/* Emulated domains. */
+typedef enum {
+    VDEV_BLE = 0,
+    VDEV_DOT15D4,
+    VDEV_ESB,
+    VDEV_PHY,
+    VDEV_DOMAINS
+} vdev_domain_t;
+
+/* Virtual device configuration. */
+typedef struct {
+    uint32_t rate;              /*!< Notifications per second, for each started domain */
+    int payload_size;           /*!< Payload size of generated packets, capped to each domain maximum */
+} vdev_cfg_t;
+
+/* Virtual device statistics. */
+typedef struct {
+    uint64_t commands;                  /*!< Messages received from the host */
+    uint64_t errors;                    /*!< Messages that could not be decoded */
+    uint64_t generated[VDEV_DOMAINS];   /*!< Notifications queued, per domain */
+    uint64_t dropped[VDEV_DOMAINS];     /*!< Notifications dropped (TX ring buffer full), per domain */
+} vdev_stats_t;
+
+void vdev_init(vdev_cfg_t *p_config, uint64_t now_ns);
+void vdev_process(uint64_t now_ns);
+bool vdev_is_started(vdev_domain_t domain);
+const char *vdev_get_domain_name(vdev_domain_t domain);
+void vdev_get_stats(vdev_stats_t *p_stats);
+
+#endif /* __INC_WHAD_VDEV_H */
@@ -0,0 +1,1027 @@
+/** \file whad_bench.c
+ * WHAD library microbenchmark (host only).
+ *
+ * Times every message builder and `_parse()` function of the generic,
+ * discovery and domain APIs, along with `pb_encode()` and arena-backed
+ * `pb_decode()` of the resulting `Message`. For each message it reports the
+ * average time per operation, the serialized size and the number of heap
+ * allocations per build/encode/decode/parse cycle.
+ *
+ * High-rate notifications are then sent through the transport layer along
+ * each available path: `Message` builder and `whad_send_message()`, compact
+ * message and `whad_send_compact_message()`, then notification template.
+ * Sent bytes are dropped by the transport callback.
+ * For each path it reports the average time and CPU cycles per notification,
+ * TX ring buffer included, and the frame size.
+ *
+ * Usage: whad-bench [iterations] [filter]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "whad.h"
+
+/* Default number of iterations per measurement. */
+#define BENCH_DEFAULT_ITERATIONS    (20000)
+
+/* Benchmark case: a message builder and its parser, if any. */
+typedef struct {
+    const char *name;
+    whad_result_t (*build)(Message *p_message);
+    whad_result_t (*parse)(Message *p_message);
+} bench_case_t;
+
+/* Measured figures, in ns per operation. */
+typedef struct {
+    double build;
+    double encode;
+    double decode;
+    double parse;
+    int size;
+    double allocs;
+    bool encoded;
+    bool parsed;
+} bench_result_t;
+
+/* Send path: a notification sent through the transport layer, after an optional setup. */
+typedef struct {
+    const char *name;
+    whad_result_t (*setup)(void);
+    whad_result_t (*send)(void);
+} bench_send_case_t;
+
+/* Send path figures, per notification. */
+typedef struct {
+    double send;
+    double cycles;
+    int size;
+    bool sent;
+} bench_send_result_t;
+
+/* Heap allocations counter, see the `--wrap` linker options in the Makefile. */
+static unsigned long g_allocs = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    g_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    g_allocs++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    g_allocs++;
+    return __real_realloc(ptr, size);
+}
+
+/* Messages and buffers. */
+static Message g_message;
+static Message g_decoded;
+static uint8_t g_buffer[WHAD_MESSAGE_MAX_SIZE];
+static uint64_t g_arena_buf[512];
+static whad_arena_t g_arena;
+static whad_template_t g_template;
+static whad_compact_msg_t g_compact;
+
+/* Bytes dropped by the transport send callback. */
+static uint64_t g_sent_bytes = 0;
+
+/* Builders input data. */
+static uint8_t g_pdu[32] = {
+    0x02, 0x1e, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x02, 0x01, 0x06, 0x11, 0x07, 0x9e, 0xca, 0xdc,
+    0x24, 0x0e, 0xe5, 0xa9, 0xe0, 0x93, 0xf3, 0xa3, 0xb5, 0x01, 0x00, 0x40, 0x6e, 0x00, 0x00, 0x00
+};
+static char g_text[] = "The quick brown fox jumps over the lazy dog";
+static uint32_t g_log_words[] = {
+    0x80030010, 123456789, 1, 2, 3, 0x80000000, 123456790, 0x80220040, 123456800, 0xcafe, 0xbabe
+};
+static whad_log_entries_t g_log_entries = {(uint8_t *)g_log_words, sizeof(g_log_words), NULL, 0};
+static whad_cmd_timing_t g_cmd_timing = {123456789, 250, 1024};
+static char g_author[] = "whad-team";
+static char g_url[] = "https://github.com/whad-team";
+static uint8_t g_devid[16] = "whad-bench";
+static whad_domain_desc_t g_capabilities[] = {
+    {DOMAIN_BTLE, CAP_SCAN | CAP_SNIFF | CAP_INJECT | CAP_JAM | CAP_HIJACK, 0x3ffffff},
+    {DOMAIN_PHY, CAP_SNIFF | CAP_INJECT | CAP_JAM, 0x7ffffff},
+    {DOMAIN_NONE, CAP_NONE, 0}
+};
+#if WHAD_ENABLE_BLE
+static uint8_t g_bdaddr[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+static uint8_t g_channelmap[5] = {0xff, 0xff, 0xff, 0xff, 0x1f};
+static uint8_t g_key[16] = {0};
+static uint8_t g_iv[8] = {0};
+static whad_prepared_packet_t g_prepared[2] = {{{g_pdu}, 32}, {{g_pdu}, 16}};
+#endif
+#if WHAD_ENABLE_ESB
+static whad_esb_address_t g_esb_addr = {{0xca, 0xfe, 0xba, 0xbe, 0x42}, 5};
+static whad_esb_recvd_packet_t g_esb_pkt = {
+    8, true, -40, true, 123456, true, true, true, {{0xca, 0xfe, 0xba, 0xbe, 0x42}, 5}, {{0}, 32}
+};
+#endif
+#if WHAD_ENABLE_UNIFYING
+static whad_unifying_address_t g_unifying_addr = {{0xca, 0xfe, 0xba, 0xbe, 0x42}, 5};
+static whad_unifying_recvd_packet_t g_unifying_pkt = {
+    8, true, -40, true, 123456, true, true, true, {{0xca, 0xfe, 0xba, 0xbe, 0x42}, 5}, {{0}, 32}
+};
+#endif
+#if WHAD_ENABLE_DOT15D4
+static whad_dot15d4_address_t g_dot15d4_addr = {WHAD_DOT15D4_ADDR_EXTENDED, 0x0011223344556677ULL};
+static whad_dot15d4_recvd_packet_t g_dot15d4_pkt;
+#endif
+#if WHAD_ENABLE_PHY
+static whad_phy_frequency_range_t g_range_list[] = {{2400000000, 2500000000}, {868000000, 869000000}};
+static whad_phy_frequency_ranges_t g_ranges = {g_range_list, 2};
+static uint8_t g_syncword[4] = {0x8e, 0x89, 0xbe, 0xd6};
+#endif
+
+
+/*
+ * Builders and parsers wrappers. Parsers outputs are static so that they
+ * are not optimized out.
+ */
+
+#define BENCH_BUILDER(name, ...) \
+    static whad_result_t build_##name(Message *p_message) { return whad_##name(p_message, ##__VA_ARGS__); }
+
+#define BENCH_PARSER(name, type) \
+    static whad_result_t parse_##name(Message *p_message) { static type out; return whad_##name##_parse(p_message, &out); }
+
+#define BENCH(name)             {#name, build_##name, parse_##name}
+#define BENCH_NOPARSE(name)     {#name, build_##name, NULL}
+
+/* Generic. */
+BENCH_BUILDER(generic_cmd_result, WHAD_RESULT_SUCCESS)
+BENCH_PARSER(generic_cmd_result, whad_result_code_t)
+BENCH_BUILDER(generic_cmd_result_timed, WHAD_RESULT_SUCCESS, &g_cmd_timing)
+static whad_result_t parse_generic_cmd_result_timed(Message *p_message)
+{
+    static whad_cmd_timing_t timing;
+    return whad_generic_cmd_result_timing_parse(p_message, &timing);
+}
+BENCH_BUILDER(generic_verbose_message, g_text)
+BENCH_PARSER(generic_verbose_message, char *)
+BENCH_BUILDER(generic_debug_message, 2, g_text)
+static whad_result_t parse_generic_debug_message(Message *p_message)
+{
+    static uint32_t level;
+    static char *psz_message;
+    return whad_generic_debug_message_parse(p_message, &level, &psz_message);
+}
+BENCH_BUILDER(generic_progress_message, 42)
+BENCH_PARSER(generic_progress_message, uint32_t)
+BENCH_BUILDER(generic_time_sync_query, 42, 123456789)
+static whad_result_t parse_generic_time_sync_query(Message *p_message)
+{
+    static uint32_t sequence;
+    static uint64_t host_time;
+    return whad_generic_time_sync_query_parse(p_message, &sequence, &host_time);
+}
+BENCH_BUILDER(generic_time_sync_reply, 42, 123456789, 987654321, 987654330)
+BENCH_PARSER(generic_time_sync_reply, whad_time_sync_reply_params_t)
+BENCH_BUILDER(generic_log_message, 0, &g_log_entries)
+static whad_result_t parse_generic_log_message(Message *p_message)
+{
+    static uint32_t dropped;
+    static uint8_t *p_entries;
+    static int size;
+    return whad_generic_log_message_parse(p_message, &dropped, &p_entries, &size);
+}
+
+/* Discovery. */
+BENCH_BUILDER(discovery_device_info_query, 2)
+BENCH_PARSER(discovery_device_info_query, uint32_t)
+BENCH_BUILDER(discovery_device_describe_query, 2)
+static whad_result_t parse_discovery_device_describe_query(Message *p_message)
+{
+    return whad_discovery_device_info_query_is_describe(p_message) ? WHAD_SUCCESS : WHAD_ERROR;
+}
+BENCH_BUILDER(discovery_domain_info_query, DOMAIN_BTLE)
+BENCH_PARSER(discovery_domain_info_query, whad_domain_t)
+BENCH_BUILDER(discovery_device_info_resp, discovery_DeviceType_Butterfly, g_devid, 2, 115200, g_author, g_url,
+              1, 2, 3, g_capabilities)
+static whad_result_t parse_discovery_device_info_resp(Message *p_message)
+{
+    static uint32_t *p_caps;
+    static int count;
+    return whad_discovery_device_info_resp_capabilities_parse(p_message, &p_caps, &count);
+}
+static whad_result_t build_discovery_device_describe_resp(Message *p_message)
+{
+    build_discovery_device_info_resp(p_message);
+    return whad_discovery_device_info_resp_add_domains(p_message, g_capabilities);
+}
+static whad_result_t parse_discovery_device_describe_resp(Message *p_message)
+{
+    static discovery_DeviceDomainInfoResp *p_domains;
+    static int count;
+    return whad_discovery_device_info_resp_domains_parse(p_message, &p_domains, &count);
+}
+BENCH_BUILDER(discovery_domain_info_resp, DOMAIN_BTLE, g_capabilities)
+static whad_result_t parse_discovery_domain_info_resp(Message *p_message)
+{
+    static whad_domain_t domain;
+    static uint64_t commands;
+    return whad_discovery_domain_info_resp_parse(p_message, &domain, &commands);
+}
+BENCH_BUILDER(discovery_device_reset)
+BENCH_BUILDER(discovery_ready_resp)
+BENCH_BUILDER(discovery_set_speed, 1000000)
+BENCH_PARSER(discovery_set_speed, uint32_t)
+
+#if WHAD_ENABLE_BLE
+/* BLE. */
+BENCH_BUILDER(ble_set_bdaddress, BLE_ADDR_RANDOM, g_bdaddr)
+static whad_result_t parse_ble_set_bdaddress(Message *p_message)
+{
+    static whad_ble_addrtype_t addr_type;
+    static uint8_t bdaddr[6];
+    return whad_ble_set_bdaddress_parse(p_message, &addr_type, bdaddr);
+}
+BENCH_BUILDER(ble_set_adv_data, g_pdu, 31, g_pdu, 31)
+static whad_result_t parse_ble_set_adv_data(Message *p_message)
+{
+    static uint8_t adv_data[31], scanrsp_data[31];
+    static int adv_data_length, scanrsp_data_length;
+    return whad_ble_set_adv_data_parse(p_message, adv_data, &adv_data_length, scanrsp_data, &scanrsp_data_length);
+}
+BENCH_BUILDER(ble_set_encryption, 0, true, g_key, g_iv, g_key, g_iv, g_iv)
+BENCH_PARSER(ble_set_encryption, whad_ble_encryption_params_t)
+BENCH_BUILDER(ble_sniff_adv, false, 37, g_bdaddr)
+BENCH_PARSER(ble_sniff_adv, whad_ble_sniff_adv_params_t)
+BENCH_BUILDER(ble_sniff_conn_req, true, true, 37, g_bdaddr)
+BENCH_PARSER(ble_sniff_conn_req, whad_ble_sniff_connreq_params_t)
+BENCH_BUILDER(ble_sniff_access_address, g_channelmap)
+static whad_result_t parse_ble_sniff_access_address(Message *p_message)
+{
+    static uint8_t channelmap[5];
+    return whad_ble_sniff_access_address_parse(p_message, channelmap);
+}
+BENCH_BUILDER(ble_sniff_active_conn, 0x8e89bed6, 0x555555, 36, 7, g_channelmap, g_channelmap)
+BENCH_PARSER(ble_sniff_active_conn, whad_ble_sniff_conn_params_t)
+BENCH_BUILDER(ble_scan_mode, true)
+BENCH_PARSER(ble_scan_mode, bool)
+BENCH_BUILDER(ble_adv_mode, g_pdu, 31, g_pdu, 31)
+BENCH_PARSER(ble_adv_mode, whad_ble_adv_mode_params_t)
+BENCH_BUILDER(ble_peripheral_mode, g_pdu, 31, g_pdu, 31)
+BENCH_PARSER(ble_peripheral_mode, whad_ble_adv_mode_params_t)
+BENCH_BUILDER(ble_central_mode)
+BENCH_BUILDER(ble_start)
+BENCH_BUILDER(ble_stop)
+BENCH_BUILDER(ble_connect_to, g_bdaddr, BLE_ADDR_PUBLIC, 0x8e89bed6, g_channelmap, 36, 7, 0x555555)
+BENCH_PARSER(ble_connect_to, whad_ble_connect_params_t)
+BENCH_BUILDER(ble_send_raw_pdu, BLE_MASTER_TO_SLAVE, 0, 0x8e89bed6, g_pdu, 32, 0x123456, false)
+BENCH_PARSER(ble_send_raw_pdu, whad_ble_pdu_params_t)
+BENCH_BUILDER(ble_send_pdu, BLE_MASTER_TO_SLAVE, 0, g_pdu, 32, false)
+BENCH_PARSER(ble_send_pdu, whad_ble_pdu_params_t)
+BENCH_BUILDER(ble_disconnect, 0)
+BENCH_PARSER(ble_disconnect, uint32_t)
+BENCH_BUILDER(ble_prepare_sequence_on_recv, g_pdu, g_pdu, 8, 0, 1, BLE_MASTER_TO_SLAVE, g_prepared, 2)
+static whad_result_t parse_ble_prepare_sequence_on_recv(Message *p_message)
+{
+    static whad_ble_trigger_t trigger;
+    return whad_ble_prepare_sequence_get_trigger_type(p_message, &trigger);
+}
+BENCH_BUILDER(ble_prepare_sequence_conn_evt, 42, 1, BLE_MASTER_TO_SLAVE, g_prepared, 2)
+BENCH_PARSER(ble_prepare_sequence_conn_evt, whad_ble_prepseq_params_t)
+BENCH_BUILDER(ble_prepare_sequence_manual, 1, BLE_MASTER_TO_SLAVE, g_prepared, 2)
+BENCH_PARSER(ble_prepare_sequence_manual, whad_ble_prepseq_params_t)
+BENCH_BUILDER(ble_prepare_sequence_trigger, 1)
+BENCH_PARSER(ble_prepare_sequence_trigger, uint32_t)
+BENCH_BUILDER(ble_prepare_sequence_delete, 1)
+BENCH_BUILDER(ble_jam_adv)
+BENCH_BUILDER(ble_jam_adv_channel, 37)
+BENCH_PARSER(ble_jam_adv_channel, uint32_t)
+BENCH_BUILDER(ble_jam_active_conn, 0x8e89bed6)
+BENCH_PARSER(ble_jam_active_conn, uint32_t)
+BENCH_BUILDER(ble_hijack_master, 0x8e89bed6)
+BENCH_PARSER(ble_hijack_master, uint32_t)
+BENCH_BUILDER(ble_hijack_slave, 0x8e89bed6)
+BENCH_PARSER(ble_hijack_slave, uint32_t)
+BENCH_BUILDER(ble_hijack_both, 0x8e89bed6)
+BENCH_PARSER(ble_hijack_both, uint32_t)
+BENCH_BUILDER(ble_reactive_jam, 12, g_pdu, 8, 4)
+BENCH_PARSER(ble_reactive_jam, whad_ble_reactive_jam_params_t)
+BENCH_BUILDER(ble_notify_connected, BLE_ADDR_PUBLIC, g_bdaddr, BLE_ADDR_RANDOM, g_bdaddr, 0)
+BENCH_BUILDER(ble_notify_disconnected, 0, 0x13)
+BENCH_PARSER(ble_notify_disconnected, whad_ble_disconnected_params_t)
+BENCH_BUILDER(ble_raw_pdu, 12, -40, 0, 0x8e89bed6, g_pdu, 32, 0x123456, true, 123456, 1250, BLE_MASTER_TO_SLAVE,
+              false, false, true)
+BENCH_BUILDER(ble_pdu, g_pdu, 32, BLE_MASTER_TO_SLAVE, 0, false, false)
+BENCH_PARSER(ble_pdu, whad_ble_pdu_t)
+BENCH_BUILDER(ble_triggered, 1)
+BENCH_PARSER(ble_triggered, uint32_t)
+BENCH_BUILDER(ble_access_address_discovered, 0x8e89bed6, 123456, -40, true, true)
+BENCH_PARSER(ble_access_address_discovered, whad_ble_aa_disc_params_t)
+BENCH_BUILDER(ble_adv_pdu, BLE_ADV_IND, -40, g_bdaddr, BLE_ADDR_PUBLIC, g_pdu, 31)
+BENCH_PARSER(ble_adv_pdu, whad_ble_adv_pdu_t)
+BENCH_BUILDER(ble_synchronized, 0x8e89bed6, 0x555555, 36, 7, g_channelmap)
+BENCH_PARSER(ble_synchronized, whad_ble_synchro_params_t)
+BENCH_BUILDER(ble_desynchronized, 0x8e89bed6)
+BENCH_PARSER(ble_desynchronized, uint32_t)
+BENCH_BUILDER(ble_hijacked, 0x8e89bed6, true)
+BENCH_PARSER(ble_hijacked, whad_ble_hijacked_params_t)
+BENCH_BUILDER(ble_injected, 0x8e89bed6, 3, true)
+BENCH_PARSER(ble_injected, whad_ble_injected_params_t)
+#endif
+
+#if WHAD_ENABLE_ESB
+/* ESB. */
+BENCH_BUILDER(esb_set_node_address, &g_esb_addr)
+BENCH_PARSER(esb_set_node_address, whad_esb_address_t)
+BENCH_BUILDER(esb_sniff, &g_esb_addr, 8, true)
+BENCH_PARSER(esb_sniff, whad_esb_sniff_params_t)
+BENCH_BUILDER(esb_jam, 8)
+BENCH_PARSER(esb_jam, uint32_t)
+BENCH_BUILDER(esb_send, 8, 3, g_pdu, 32)
+BENCH_PARSER(esb_send, whad_esb_send_params_t)
+BENCH_BUILDER(esb_send_raw, 8, 3, g_pdu, 32)
+BENCH_PARSER(esb_send_raw, whad_esb_send_params_t)
+BENCH_BUILDER(esb_prx, 8)
+BENCH_PARSER(esb_prx, uint32_t)
+BENCH_BUILDER(esb_ptx, 8)
+BENCH_PARSER(esb_ptx, uint32_t)
+BENCH_BUILDER(esb_start)
+BENCH_BUILDER(esb_stop)
+BENCH_BUILDER(esb_jammed, 123456)
+BENCH_PARSER(esb_jammed, uint32_t)
+BENCH_BUILDER(esb_raw_pdu_received, &g_esb_pkt)
+BENCH_PARSER(esb_raw_pdu_received, whad_esb_recvd_packet_t)
+BENCH_BUILDER(esb_pdu_received, &g_esb_pkt)
+BENCH_PARSER(esb_pdu_received, whad_esb_recvd_packet_t)
+#endif
+
+#if WHAD_ENABLE_UNIFYING
+/* Unifying. */
+BENCH_BUILDER(unifying_set_node_address, &g_unifying_addr)
+BENCH_PARSER(unifying_set_node_address, whad_unifying_address_t)
+BENCH_BUILDER(unifying_sniff, &g_unifying_addr, 5, true)
+BENCH_PARSER(unifying_sniff, whad_unifying_sniff_params_t)
+BENCH_BUILDER(unifying_jam, 5)
+BENCH_PARSER(unifying_jam, uint32_t)
+BENCH_BUILDER(unifying_send, 5, 3, g_pdu, 22)
+BENCH_PARSER(unifying_send, whad_unifying_send_params_t)
+BENCH_BUILDER(unifying_send_raw, 5, 3, g_pdu, 22)
+BENCH_PARSER(unifying_send_raw, whad_unifying_send_params_t)
+BENCH_BUILDER(unifying_dongle_mode, 5)
+BENCH_PARSER(unifying_dongle_mode, uint32_t)
+BENCH_BUILDER(unifying_keyboard_mode, 5)
+BENCH_PARSER(unifying_keyboard_mode, uint32_t)
+BENCH_BUILDER(unifying_mouse_mode, 5)
+BENCH_PARSER(unifying_mouse_mode, uint32_t)
+BENCH_BUILDER(unifying_start)
+BENCH_BUILDER(unifying_stop)
+BENCH_BUILDER(unifying_sniff_pairing)
+BENCH_BUILDER(unifying_jammed, 123456)
+BENCH_PARSER(unifying_jammed, uint32_t)
+BENCH_BUILDER(unifying_raw_pdu_received, &g_unifying_pkt)
+BENCH_PARSER(unifying_raw_pdu_received, whad_unifying_recvd_packet_t)
+BENCH_BUILDER(unifying_pdu_received, &g_unifying_pkt)
+BENCH_PARSER(unifying_pdu_received, whad_unifying_recvd_packet_t)
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+/* IEEE 802.15.4. */
+BENCH_BUILDER(dot15d4_set_node_address, &g_dot15d4_addr)
+BENCH_PARSER(dot15d4_set_node_address, whad_dot15d4_address_t)
+BENCH_BUILDER(dot15d4_sniff, 11)
+BENCH_PARSER(dot15d4_sniff, uint32_t)
+BENCH_BUILDER(dot15d4_jam, 11)
+BENCH_PARSER(dot15d4_jam, uint32_t)
+BENCH_BUILDER(dot15d4_energy_detect, 11)
+BENCH_PARSER(dot15d4_energy_detect, uint32_t)
+BENCH_BUILDER(dot15d4_send, 11, g_pdu, 32)
+BENCH_PARSER(dot15d4_send, whad_dot15d4_send_params_t)
+BENCH_BUILDER(dot15d4_send_raw, 11, g_pdu, 32, 0xbeef)
+BENCH_PARSER(dot15d4_send_raw, whad_dot15d4_send_params_t)
+BENCH_BUILDER(dot15d4_end_device_mode, 11)
+BENCH_PARSER(dot15d4_end_device_mode, uint32_t)
+BENCH_BUILDER(dot15d4_router_mode, 11)
+BENCH_PARSER(dot15d4_router_mode, uint32_t)
+BENCH_BUILDER(dot15d4_coord_mode, 11)
+BENCH_PARSER(dot15d4_coord_mode, uint32_t)
+BENCH_BUILDER(dot15d4_mitm_mode, WHAD_DOT15D4_MITM_REACTIVE)
+BENCH_PARSER(dot15d4_mitm_mode, whad_dot15d4_mitm_role_t)
+BENCH_BUILDER(dot15d4_start)
+BENCH_BUILDER(dot15d4_stop)
+BENCH_BUILDER(dot15d4_jammed, 123456)
+BENCH_PARSER(dot15d4_jammed, uint32_t)
+BENCH_BUILDER(dot15d4_energy_detect_sample, 123456, 42)
+BENCH_PARSER(dot15d4_energy_detect_sample, whad_dot15d4_ed_sample_t)
+BENCH_BUILDER(dot15d4_raw_pdu_received, &g_dot15d4_pkt)
+BENCH_PARSER(dot15d4_raw_pdu_received, whad_dot15d4_recvd_packet_t)
+BENCH_BUILDER(dot15d4_pdu_received, &g_dot15d4_pkt)
+BENCH_PARSER(dot15d4_pdu_received, whad_dot15d4_recvd_packet_t)
+#endif
+
+#if WHAD_ENABLE_PHY
+/* PHY. */
+BENCH_BUILDER(phy_set_ask_mod, true)
+BENCH_PARSER(phy_set_ask_mod, bool)
+BENCH_BUILDER(phy_set_fsk_mod, 250000)
+BENCH_PARSER(phy_set_fsk_mod, uint32_t)
+BENCH_BUILDER(phy_set_4fsk_mod, 250000)
+BENCH_PARSER(phy_set_4fsk_mod, uint32_t)
+BENCH_BUILDER(phy_set_gfsk_mod, 250000)
+BENCH_PARSER(phy_set_gfsk_mod, uint32_t)
+BENCH_BUILDER(phy_set_bpsk_mod)
+BENCH_BUILDER(phy_set_qpsk_mod, true)
+BENCH_PARSER(phy_set_qpsk_mod, bool)
+BENCH_BUILDER(phy_set_msk_mod, 250000)
+BENCH_PARSER(phy_set_msk_mod, uint32_t)
+BENCH_BUILDER(phy_set_lora_mod, 125000, PHY_LORA_SF7, PHY_LORA_CR45, 8, true, true, false)
+BENCH_PARSER(phy_set_lora_mod, whad_phy_lora_params_t)
+BENCH_BUILDER(phy_set_freq, 2402000000)
+BENCH_PARSER(phy_set_freq, uint32_t)
+BENCH_BUILDER(phy_set_datarate, 1000000)
+BENCH_PARSER(phy_set_datarate, uint32_t)
+BENCH_BUILDER(phy_set_endianness, PHY_LITTLE_ENDIAN)
+BENCH_PARSER(phy_set_endianness, whad_phy_endian_t)
+BENCH_BUILDER(phy_set_tx_power, PHY_TXPOWER_HIGH)
+BENCH_PARSER(phy_set_tx_power, whad_phy_txpower_t)
+BENCH_BUILDER(phy_set_packet_size, 250)
+BENCH_PARSER(phy_set_packet_size, uint32_t)
+BENCH_BUILDER(phy_set_sync_word, g_syncword, 4)
+BENCH_PARSER(phy_set_sync_word, whad_phy_syncword_t)
+static whad_result_t build_phy_supported_frequencies(Message *p_message) { return whad_phy_supported_frequency_ranges(p_message, &g_ranges); }
+static whad_result_t parse_phy_supported_frequencies(Message *p_message)
+{
+    static whad_phy_frequency_range_t *p_ranges;
+    static int count;
+    return whad_phy_supported_frequencies_parse(p_message, &p_ranges, &count);
+}
+BENCH_BUILDER(phy_sniff_mode, true)
+BENCH_PARSER(phy_sniff_mode, bool)
+BENCH_BUILDER(phy_jam_mode, PHY_JAM_MODE_CONTINUOUS)
+BENCH_PARSER(phy_jam_mode, whad_phy_jam_mode_t)
+BENCH_BUILDER(phy_monitor_mode)
+BENCH_BUILDER(phy_start)
+BENCH_BUILDER(phy_stop)
+BENCH_BUILDER(phy_send, g_pdu, 32)
+BENCH_PARSER(phy_send, whad_phy_packet_t)
+BENCH_BUILDER(phy_send_raw_iq, g_pdu, 32)
+static whad_result_t parse_phy_send_raw_iq(Message *p_message)
+{
+    static int32_t *p_iq;
+    static int count;
+    return whad_phy_send_raw_iq_parse(p_message, &p_iq, &count);
+}
+BENCH_BUILDER(phy_sched_packet, g_pdu, 32, 1, 500)
+BENCH_PARSER(phy_sched_packet, whad_phy_sched_packet_t)
+BENCH_BUILDER(phy_jammed, 1, 500)
+BENCH_PARSER(phy_jammed, whad_phy_timestamp_t)
+BENCH_BUILDER(phy_packet_received, 2402000000, -40, 1, 500, g_pdu, 32, g_syncword, 4, 250000, 1000000,
+              PHY_LITTLE_ENDIAN, MOD_GFSK)
+BENCH_PARSER(phy_packet_received, whad_phy_received_packet_t)
+BENCH_BUILDER(phy_packet_scheduled, 1, false)
+BENCH_PARSER(phy_packet_scheduled, whad_phy_scheduled_packet_t)
+BENCH_BUILDER(phy_sched_packet_sent, 1)
+BENCH_PARSER(phy_sched_packet_sent, uint32_t)
+#endif
+
+
+static const bench_case_t g_cases[] = {
+    /* Generic. */
+    BENCH(generic_cmd_result),
+    BENCH(generic_cmd_result_timed),
+    BENCH(generic_verbose_message),
+    BENCH(generic_debug_message),
+    BENCH(generic_progress_message),
+    BENCH(generic_time_sync_query),
+    BENCH(generic_time_sync_reply),
+    BENCH(generic_log_message),
+
+    /* Discovery. */
+    BENCH(discovery_device_info_query),
+    BENCH(discovery_device_describe_query),
+    BENCH(discovery_domain_info_query),
+    BENCH(discovery_device_info_resp),
+    BENCH(discovery_device_describe_resp),
+    BENCH(discovery_domain_info_resp),
+    BENCH_NOPARSE(discovery_device_reset),
+    BENCH_NOPARSE(discovery_ready_resp),
+    BENCH(discovery_set_speed),
+
+#if WHAD_ENABLE_BLE
+    /* BLE. */
+    BENCH(ble_set_bdaddress),
+    BENCH(ble_set_adv_data),
+    BENCH(ble_set_encryption),
+    BENCH(ble_sniff_adv),
+    BENCH(ble_sniff_conn_req),
+    BENCH(ble_sniff_access_address),
+    BENCH(ble_sniff_active_conn),
+    BENCH(ble_scan_mode),
+    BENCH(ble_adv_mode),
+    BENCH(ble_peripheral_mode),
+    BENCH_NOPARSE(ble_central_mode),
+    BENCH_NOPARSE(ble_start),
+    BENCH_NOPARSE(ble_stop),
+    BENCH(ble_connect_to),
+    BENCH(ble_send_raw_pdu),
+    BENCH(ble_send_pdu),
+    BENCH(ble_disconnect),
+    BENCH(ble_prepare_sequence_on_recv),
+    BENCH(ble_prepare_sequence_conn_evt),
+    BENCH(ble_prepare_sequence_manual),
+    BENCH(ble_prepare_sequence_trigger),
+    BENCH_NOPARSE(ble_prepare_sequence_delete),
+    BENCH_NOPARSE(ble_jam_adv),
+    BENCH(ble_jam_adv_channel),
+    BENCH(ble_jam_active_conn),
+    BENCH(ble_hijack_master),
+    BENCH(ble_hijack_slave),
+    BENCH(ble_hijack_both),
+    BENCH(ble_reactive_jam),
+    BENCH_NOPARSE(ble_notify_connected),
+    BENCH(ble_notify_disconnected),
+    BENCH_NOPARSE(ble_raw_pdu),
+    BENCH(ble_pdu),
+    BENCH(ble_triggered),
+    BENCH(ble_access_address_discovered),
+    BENCH(ble_adv_pdu),
+    BENCH(ble_synchronized),
+    BENCH(ble_desynchronized),
+    BENCH(ble_hijacked),
+    BENCH(ble_injected),
+#endif
+
+#if WHAD_ENABLE_ESB
+    /* ESB. */
+    BENCH(esb_set_node_address),
+    BENCH(esb_sniff),
+    BENCH(esb_jam),
+    BENCH(esb_send),
+    BENCH(esb_send_raw),
+    BENCH(esb_prx),
+    BENCH(esb_ptx),
+    BENCH_NOPARSE(esb_start),
+    BENCH_NOPARSE(esb_stop),
+    BENCH(esb_jammed),
+    BENCH(esb_raw_pdu_received),
+    BENCH(esb_pdu_received),
+#endif
+
+#if WHAD_ENABLE_UNIFYING
+    /* Unifying. */
+    BENCH(unifying_set_node_address),
+    BENCH(unifying_sniff),
+    BENCH(unifying_jam),
+    BENCH(unifying_send),
+    BENCH(unifying_send_raw),
+    BENCH(unifying_dongle_mode),
+    BENCH(unifying_keyboard_mode),
+    BENCH(unifying_mouse_mode),
+    BENCH_NOPARSE(unifying_start),
+    BENCH_NOPARSE(unifying_stop),
+    BENCH_NOPARSE(unifying_sniff_pairing),
+    BENCH(unifying_jammed),
+    BENCH(unifying_raw_pdu_received),
+    BENCH(unifying_pdu_received),
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+    /* IEEE 802.15.4. */
+    BENCH(dot15d4_set_node_address),
+    BENCH(dot15d4_sniff),
+    BENCH(dot15d4_jam),
+    BENCH(dot15d4_energy_detect),
+    BENCH(dot15d4_send),
+    BENCH(dot15d4_send_raw),
+    BENCH(dot15d4_end_device_mode),
+    BENCH(dot15d4_router_mode),
+    BENCH(dot15d4_coord_mode),
+    BENCH(dot15d4_mitm_mode),
+    BENCH_NOPARSE(dot15d4_start),
+    BENCH_NOPARSE(dot15d4_stop),
+    BENCH(dot15d4_jammed),
+    BENCH(dot15d4_energy_detect_sample),
+    BENCH(dot15d4_raw_pdu_received),
+    BENCH(dot15d4_pdu_received),
+#endif
+
+#if WHAD_ENABLE_PHY
+    /* PHY. */
+    BENCH(phy_set_ask_mod),
+    BENCH(phy_set_fsk_mod),
+    BENCH(phy_set_4fsk_mod),
+    BENCH(phy_set_gfsk_mod),
+    BENCH_NOPARSE(phy_set_bpsk_mod),
+    BENCH(phy_set_qpsk_mod),
+    BENCH(phy_set_msk_mod),
+    BENCH(phy_set_lora_mod),
+    BENCH(phy_set_freq),
+    BENCH(phy_set_datarate),
+    BENCH(phy_set_endianness),
+    BENCH(phy_set_tx_power),
+    BENCH(phy_set_packet_size),
+    BENCH(phy_set_sync_word),
+    BENCH(phy_supported_frequencies),
+    BENCH(phy_sniff_mode),
+    BENCH(phy_jam_mode),
+    BENCH_NOPARSE(phy_monitor_mode),
+    BENCH_NOPARSE(phy_start),
+    BENCH_NOPARSE(phy_stop),
+    BENCH(phy_send),
+    BENCH(phy_send_raw_iq),
+    BENCH(phy_sched_packet),
+    BENCH(phy_jammed),
+    BENCH(phy_packet_received),
+    BENCH(phy_packet_scheduled),
+    BENCH(phy_sched_packet_sent),
+#endif
+};
+
+
+/*
+ * Send paths. Message builders are the ones above, compact messages and
+ * templates send the same notifications.
+ */
+
+#define BENCH_SEND_MESSAGE(name) \
+    static whad_result_t send_##name##_message(void) \
+    { \
+        return (build_##name(&g_message) == WHAD_SUCCESS) ? whad_send_message(&g_message) : WHAD_ERROR; \
+    }
+
+#define BENCH_SEND_COMPACT(name, ...) \
+    static whad_result_t send_##name##_compact(void) \
+    { \
+        return (whad_##name##_compact(&g_compact, __VA_ARGS__) == WHAD_SUCCESS) ? \
+            whad_send_compact_message(&g_compact) : WHAD_ERROR; \
+    }
+
+#define BENCH_SEND(name, path, setup)   {#name " (" #path ")", setup, send_##name##_##path}
+
+#if WHAD_ENABLE_BLE
+BENCH_SEND_MESSAGE(ble_adv_pdu)
+BENCH_SEND_COMPACT(ble_adv_pdu, BLE_ADV_IND, -40, g_bdaddr, BLE_ADDR_PUBLIC, g_pdu, 31)
+BENCH_SEND_MESSAGE(ble_raw_pdu)
+BENCH_SEND_COMPACT(ble_raw_pdu, 12, -40, 0, 0x8e89bed6, g_pdu, 32, 0x123456, true, 123456, 1250, BLE_MASTER_TO_SLAVE,
+                   false, false, true)
+static whad_result_t setup_ble_raw_pdu_template(void)
+{
+    return whad_ble_raw_pdu_template(&g_template, 0, 0x8e89bed6, BLE_MASTER_TO_SLAVE, false, false, true);
+}
+static whad_result_t send_ble_raw_pdu_template(void)
+{
+    return whad_ble_raw_pdu_template_send(&g_template, 12, -40, g_pdu, 32, 0x123456, true, 123456, 1250);
+}
+#endif
+
+#if WHAD_ENABLE_ESB
+BENCH_SEND_MESSAGE(esb_raw_pdu_received)
+BENCH_SEND_COMPACT(esb_raw_pdu_received, &g_esb_pkt)
+static whad_result_t setup_esb_raw_pdu_received_template(void)
+{
+    return whad_esb_raw_pdu_template(&g_template, &g_esb_pkt);
+}
+static whad_result_t send_esb_raw_pdu_received_template(void)
+{
+    return whad_esb_raw_pdu_template_send(&g_template, &g_esb_pkt);
+}
+#endif
+
+#if WHAD_ENABLE_UNIFYING
+BENCH_SEND_MESSAGE(unifying_raw_pdu_received)
+static whad_result_t setup_unifying_raw_pdu_received_template(void)
+{
+    return whad_unifying_raw_pdu_template(&g_template, &g_unifying_pkt);
+}
+static whad_result_t send_unifying_raw_pdu_received_template(void)
+{
+    return whad_unifying_raw_pdu_template_send(&g_template, &g_unifying_pkt);
+}
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+BENCH_SEND_MESSAGE(dot15d4_pdu_received)
+BENCH_SEND_COMPACT(dot15d4_pdu_received, &g_dot15d4_pkt)
+BENCH_SEND_MESSAGE(dot15d4_raw_pdu_received)
+static whad_result_t setup_dot15d4_raw_pdu_received_template(void)
+{
+    return whad_dot15d4_raw_pdu_template(&g_template, &g_dot15d4_pkt);
+}
+static whad_result_t send_dot15d4_raw_pdu_received_template(void)
+{
+    return whad_dot15d4_raw_pdu_template_send(&g_template, &g_dot15d4_pkt);
+}
+#endif
+
+#if WHAD_ENABLE_PHY
+BENCH_SEND_MESSAGE(phy_packet_received)
+static whad_result_t setup_phy_packet_received_template(void)
+{
+    return whad_phy_packet_received_template(&g_template, g_syncword, 4, 250000, 1000000, PHY_LITTLE_ENDIAN,
+                                             MOD_GFSK);
+}
+static whad_result_t send_phy_packet_received_template(void)
+{
+    return whad_phy_packet_received_template_send(&g_template, 2402000000, -40, 1, 500, g_pdu, 32);
+}
+#endif
+
+
+static const bench_send_case_t g_send_cases[] = {
+#if WHAD_ENABLE_BLE
+    BENCH_SEND(ble_adv_pdu, message, NULL),
+    BENCH_SEND(ble_adv_pdu, compact, NULL),
+    BENCH_SEND(ble_raw_pdu, message, NULL),
+    BENCH_SEND(ble_raw_pdu, compact, NULL),
+    BENCH_SEND(ble_raw_pdu, template, setup_ble_raw_pdu_template),
+#endif
+#if WHAD_ENABLE_ESB
+    BENCH_SEND(esb_raw_pdu_received, message, NULL),
+    BENCH_SEND(esb_raw_pdu_received, compact, NULL),
+    BENCH_SEND(esb_raw_pdu_received, template, setup_esb_raw_pdu_received_template),
+#endif
+#if WHAD_ENABLE_UNIFYING
+    BENCH_SEND(unifying_raw_pdu_received, message, NULL),
+    BENCH_SEND(unifying_raw_pdu_received, template, setup_unifying_raw_pdu_received_template),
+#endif
+#if WHAD_ENABLE_DOT15D4
+    BENCH_SEND(dot15d4_pdu_received, message, NULL),
+    BENCH_SEND(dot15d4_pdu_received, compact, NULL),
+    BENCH_SEND(dot15d4_raw_pdu_received, message, NULL),
+    BENCH_SEND(dot15d4_raw_pdu_received, template, setup_dot15d4_raw_pdu_received_template),
+#endif
+#if WHAD_ENABLE_PHY
+    BENCH_SEND(phy_packet_received, message, NULL),
+    BENCH_SEND(phy_packet_received, template, setup_phy_packet_received_template),
+#endif
+};
+
+
+/**
+ * @brief   Get a monotonic timestamp.
+ * @return  Timestamp in nanoseconds.
+ **/
+
+static uint64_t bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+/**
+ * @brief   Read the CPU cycles counter.
+ * @return  Number of cycles, 0 if no counter is available.
+ **/
+
+static uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief   Transport send callback, drops sent bytes and completes at once.
+ **/
+
+static void bench_send_buffer(uint8_t *p_buffer, int size)
+{
+    (void)p_buffer;
+    g_sent_bytes += size;
+    whad_transport_data_sent();
+}
+
+
+/**
+ * @brief   Run a benchmark case.
+ *
+ * @param[in]   p_case      Pointer to the benchmark case
+ * @param[in]   iterations  Number of iterations per measurement
+ * @param[out]  p_result    Pointer to the measured figures
+ **/
+
+static void bench_run(const bench_case_t *p_case, int iterations, bench_result_t *p_result)
+{
+    pb_ostream_t ostream;
+    uint64_t start;
+    unsigned long allocs;
+    int i;
+
+    memset(p_result, 0, sizeof(bench_result_t));
+    allocs = g_allocs;
+
+    /* Builder. */
+    start = bench_now();
+    for (i = 0; i < iterations; i++)
+    {
+        p_case->build(&g_message);
+        whad_free_message_resources(&g_message);
+    }
+    p_result->build = (double)(bench_now() - start) / iterations;
+
+    /* Encoding, with a message that stays allocated. */
+    memset(&g_message, 0, sizeof(Message));
+    if (p_case->build(&g_message) == WHAD_SUCCESS)
+    {
+        start = bench_now();
+        for (i = 0; i < iterations; i++)
+        {
+            ostream = pb_ostream_from_buffer(g_buffer, sizeof(g_buffer));
+            if (!pb_encode(&ostream, Message_fields, &g_message))
+            {
+                break;
+            }
+        }
+        p_result->encode = (double)(bench_now() - start) / iterations;
+        p_result->encoded = (i == iterations);
+        p_result->size = (int)ostream.bytes_written;
+    }
+    whad_free_message_resources(&g_message);
+
+    if (p_result->encoded)
+    {
+        /* Decoding, callback fields included. */
+        start = bench_now();
+        for (i = 0; i < iterations; i++)
+        {
+            whad_arena_reset(&g_arena);
+            if (whad_decode_message_arena(g_buffer, p_result->size, &g_decoded, &g_arena) != WHAD_SUCCESS)
+            {
+                break;
+            }
+        }
+        p_result->decode = (double)(bench_now() - start) / iterations;
+        p_result->encoded = (i == iterations);
+
+        /* Parser, on the decoded message. */
+        if (p_result->encoded && (p_case->parse != NULL))
+        {
+            start = bench_now();
+            for (i = 0; i < iterations; i++)
+            {
+                if (p_case->parse(&g_decoded) != WHAD_SUCCESS)
+                {
+                    break;
+                }
+            }
+            p_result->parse = (double)(bench_now() - start) / iterations;
+            p_result->parsed = (i == iterations);
+        }
+    }
+
+    p_result->allocs = (double)(g_allocs - allocs) / iterations;
+}
+
+
+/**
+ * @brief   Run a send path benchmark case.
+ *
+ * @param[in]   p_case      Pointer to the send path case
+ * @param[in]   iterations  Number of notifications to send
+ * @param[out]  p_result    Pointer to the measured figures
+ **/
+
+static void bench_send_run(const bench_send_case_t *p_case, int iterations, bench_send_result_t *p_result)
+{
+    uint64_t start, cycles;
+    int i;
+
+    memset(p_result, 0, sizeof(bench_send_result_t));
+    if ((p_case->setup != NULL) && (p_case->setup() != WHAD_SUCCESS))
+    {
+        return;
+    }
+
+    g_sent_bytes = 0;
+    start = bench_now();
+    cycles = bench_cycles();
+    for (i = 0; i < iterations; i++)
+    {
+        if (p_case->send() != WHAD_SUCCESS)
+        {
+            break;
+        }
+        while (whad_transport_send_pending() == WHAD_SUCCESS);
+    }
+    p_result->cycles = (double)(bench_cycles() - cycles) / iterations;
+    p_result->send = (double)(bench_now() - start) / iterations;
+    p_result->sent = (i == iterations);
+    p_result->size = (int)(g_sent_bytes / iterations);
+}
+
+
+int main(int argc, char **argv)
+{
+    bench_result_t result;
+    bench_send_result_t send_result;
+    whad_transport_cfg_t transport;
+    const char *filter = NULL;
+    int iterations = BENCH_DEFAULT_ITERATIONS;
+    unsigned int i;
+    char parse[16];
+    char cycles[16];
+
+    if (argc > 1)
+    {
+        iterations = atoi(argv[1]);
+        if (iterations <= 0)
+        {
+            fprintf(stderr, "usage: %s [iterations] [filter]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (argc > 2)
+    {
+        filter = argv[2];
+    }
+
+    whad_arena_init(&g_arena, (uint8_t *)g_arena_buf, sizeof(g_arena_buf));
+
+    printf("# %d iterations, sizeof(Message) = %d bytes, times in ns/op\n", iterations, (int)sizeof(Message));
+    printf("%-40s %10s %10s %10s %10s %8s %8s\n", "message", "build", "parse", "encode", "decode",
+           "bytes", "allocs");
+
+    for (i = 0; i < (sizeof(g_cases) / sizeof(bench_case_t)); i++)
+    {
+        if ((filter != NULL) && (strstr(g_cases[i].name, filter) == NULL))
+        {
+            continue;
+        }
+
+        bench_run(&g_cases[i], iterations, &result);
+
+        if (g_cases[i].parse == NULL)
+        {
+            snprintf(parse, sizeof(parse), "-");
+        }
+        else if (!result.parsed)
+        {
+            snprintf(parse, sizeof(parse), "failed");
+        }
+        else
+        {
+            snprintf(parse, sizeof(parse), "%.1f", result.parse);
+        }
+
+        if (result.encoded)
+        {
+            printf("%-40s %10.1f %10s %10.1f %10.1f %8d %8.2f\n", g_cases[i].name, result.build, parse,
+                   result.encode, result.decode, result.size, result.allocs);
+        }
+        else
+        {
+            printf("%-40s %10.1f %10s %10s %10s %8s %8.2f\n", g_cases[i].name, result.build, parse,
+                   "failed", "failed", "-", result.allocs);
+        }
+    }
+
+    /* Send paths, bytes sent being dropped. */
+    transport.max_txbuf_size = WHAD_RINGBUF_MAX_SIZE;
+    transport.pfn_data_send_buffer = bench_send_buffer;
+    whad_init(&transport);
+
+    printf("\n# send paths, times in ns/notification, TX ring buffer included\n");
+    printf("%-40s %10s %10s %8s\n", "notification", "send", "cycles", "bytes");
+
+    for (i = 0; i < (sizeof(g_send_cases) / sizeof(bench_send_case_t)); i++)
+    {
+        if ((filter != NULL) && (strstr(g_send_cases[i].name, filter) == NULL))
+        {
+            continue;
+        }
+
+        bench_send_run(&g_send_cases[i], iterations, &send_result);
+
+        if (!send_result.sent)
+        {
+            printf("%-40s %10s %10s %8s\n", g_send_cases[i].name, "failed", "-", "-");
+            continue;
+        }
+
+        if (send_result.cycles > 0)
+        {
+            snprintf(cycles, sizeof(cycles), "%.0f", send_result.cycles);
+        }
+        else
+        {
+            snprintf(cycles, sizeof(cycles), "-");
+        }
+        printf("%-40s %10.1f %10s %8d\n", g_send_cases[i].name, send_result.send, cycles, send_result.size);
+    }
+
+    return 0;
+}
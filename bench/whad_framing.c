@@ -0,0 +1,479 @@
+/** \file whad_framing.c
+ * WHAD transport framing recovery benchmark and stress harness (host only).
+ *
+ * Generates a stream of transport frames (0xAC 0xBE magic, 16-bit length and
+ * a payload carrying a sequence number followed by pseudo-random bytes),
+ * injects corruption into it and feeds it to `whad_transport_data_received()`
+ * by chunks, as an RX interrupt handler would, calling
+ * `whad_transport_get_message()` after each chunk.
+ *
+ * The following corruption patterns may be combined:
+ * - bit errors, at a given bit error rate,
+ * - truncated frames, with a given probability per frame,
+ * - bogus length fields, with a given probability per frame,
+ * - garbage bytes inserted between frames, with a given probability per frame.
+ *
+ * For each scenario it reports the fraction of frames recovered intact, the
+ * number of corrupted frames delivered, the number of bytes discarded, the CPU
+ * cost of the receive path per recovered frame, the worst-case stall (longest
+ * run of frames lost in a row, and number of bytes received between two
+ * recovered frames) and the longest `whad_transport_get_message()` call.
+ * Streams are generated from a fixed seed, so that scenarios can be compared
+ * between framing implementations.
+ *
+ * Usage: whad-framing [-n frames] [-s max_payload_size] [-c rx_chunk] [-S seed]
+ *                     [-e ber] [-t truncate] [-l length] [-g garbage] [-m min_recovered]
+ *
+ * Without any of the `-e`, `-t`, `-l` and `-g` options, a predefined set of
+ * scenarios is run. With `-m`, the program exits with an error if a scenario
+ * recovers less than the given fraction of frames or if the transport layer
+ * misbehaves, which allows using it as a stress test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "whad.h"
+
+/* Default parameters. */
+#define FRAMING_DEFAULT_FRAMES          (20000)
+#define FRAMING_DEFAULT_MAX_PAYLOAD     (64)
+#define FRAMING_DEFAULT_RX_CHUNK        (64)
+#define FRAMING_DEFAULT_SEED            (0x5eed)
+
+/* Payload carries a 32-bit sequence number. */
+#define FRAMING_MIN_PAYLOAD             (8)
+
+/* Maximum number of garbage bytes inserted between two frames. */
+#define FRAMING_MAX_GARBAGE             (32)
+
+/* Corruption scenario. */
+typedef struct {
+    const char *name;
+    double ber;             /*!< Bit error rate */
+    double truncate;        /*!< Probability of a frame being truncated */
+    double length;          /*!< Probability of a frame having a bogus length field */
+    double garbage;         /*!< Probability of garbage bytes being inserted before a frame */
+} framing_scenario_t;
+
+/* Scenario results. */
+typedef struct {
+    int recovered;          /*!< Frames delivered intact */
+    int corrupted;          /*!< Frames delivered with a wrong content */
+    int violations;         /*!< Transport layer misbehaviours */
+    uint64_t stream_size;   /*!< Bytes fed to the transport layer */
+    uint64_t discarded;     /*!< Bytes not belonging to a recovered frame */
+    uint64_t cpu_ns;        /*!< Time spent in the receive path */
+    uint64_t max_call_ns;   /*!< Longest whad_transport_get_message() call */
+    int max_lost_run;       /*!< Longest run of frames lost in a row */
+    uint64_t max_gap;       /*!< Most bytes received between two recovered frames */
+} framing_result_t;
+
+/* Predefined scenarios. */
+static const framing_scenario_t g_scenarios[] = {
+    {"clean",           0.0,    0.0,    0.0,    0.0},
+    {"ber_1e-6",        1e-6,   0.0,    0.0,    0.0},
+    {"ber_1e-5",        1e-5,   0.0,    0.0,    0.0},
+    {"ber_1e-4",        1e-4,   0.0,    0.0,    0.0},
+    {"ber_1e-3",        1e-3,   0.0,    0.0,    0.0},
+    {"truncate_1%",     0.0,    0.01,   0.0,    0.0},
+    {"truncate_10%",    0.0,    0.10,   0.0,    0.0},
+    {"length_1%",       0.0,    0.0,    0.01,   0.0},
+    {"length_10%",      0.0,    0.0,    0.10,   0.0},
+    {"garbage_1%",      0.0,    0.0,    0.0,    0.01},
+    {"garbage_10%",     0.0,    0.0,    0.0,    0.10},
+    {"mixed",           1e-5,   0.01,   0.01,   0.01},
+};
+
+/* Parameters. */
+static int g_frames = FRAMING_DEFAULT_FRAMES;
+static int g_max_payload = FRAMING_DEFAULT_MAX_PAYLOAD;
+static int g_rx_chunk = FRAMING_DEFAULT_RX_CHUNK;
+static uint64_t g_seed = FRAMING_DEFAULT_SEED;
+
+/* Stream, frames and receive buffer. */
+static uint8_t *g_stream;
+static int *g_sizes;
+static bool *g_delivered;
+static uint8_t g_rx_buffer[WHAD_MESSAGE_MAX_SIZE];
+
+/* Pseudo-random generator state (xorshift64*). */
+static uint64_t g_prng;
+
+
+static uint64_t framing_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint32_t framing_random(uint64_t *p_state)
+{
+    *p_state ^= *p_state >> 12;
+    *p_state ^= *p_state << 25;
+    *p_state ^= *p_state >> 27;
+    return (uint32_t)((*p_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+
+static double framing_random_unit(void)
+{
+    return framing_random(&g_prng) / 4294967296.0;
+}
+
+
+/**
+ * @brief   Write the payload of a frame.
+ *
+ * The payload only depends on the sequence number, so that delivered frames
+ * can be checked against it.
+ *
+ * @param[out]  p_payload   Pointer to the payload buffer
+ * @param[in]   sequence    Frame sequence number
+ * @param[in]   size        Payload size in bytes
+ **/
+
+static void framing_payload(uint8_t *p_payload, uint32_t sequence, int size)
+{
+    uint64_t state = ((uint64_t)sequence << 32) ^ 0x9e3779b97f4a7c15ULL;
+    int i;
+
+    p_payload[0] = (uint8_t)sequence;
+    p_payload[1] = (uint8_t)(sequence >> 8);
+    p_payload[2] = (uint8_t)(sequence >> 16);
+    p_payload[3] = (uint8_t)(sequence >> 24);
+    for (i = 4; i < size; i++)
+    {
+        p_payload[i] = (uint8_t)framing_random(&state);
+    }
+}
+
+
+/**
+ * @brief   Append bytes to the stream, applying bit errors.
+ *
+ * @param[in]       p_scenario  Pointer to the corruption scenario
+ * @param[in,out]   p_offset    Pointer to the stream size
+ * @param[in]       p_data      Pointer to the bytes to append
+ * @param[in]       size        Number of bytes to append
+ **/
+
+static void framing_emit(const framing_scenario_t *p_scenario, uint64_t *p_offset, uint8_t *p_data, int size)
+{
+    double byte_error = 1.0;
+    int i;
+
+    /* Probability of a byte having at least one bit error. */
+    for (i = 0; i < 8; i++)
+    {
+        byte_error *= (1.0 - p_scenario->ber);
+    }
+    byte_error = 1.0 - byte_error;
+
+    for (i = 0; i < size; i++)
+    {
+        g_stream[*p_offset] = p_data[i];
+        if ((byte_error > 0.0) && (framing_random_unit() < byte_error))
+        {
+            g_stream[*p_offset] ^= (uint8_t)(1 << (framing_random(&g_prng) % 8));
+        }
+        (*p_offset)++;
+    }
+}
+
+
+/**
+ * @brief   Generate a corrupted stream of frames.
+ *
+ * @param[in]   p_scenario  Pointer to the corruption scenario
+ * @return  Stream size in bytes.
+ **/
+
+static uint64_t framing_generate(const framing_scenario_t *p_scenario)
+{
+    uint8_t frame[4 + WHAD_MESSAGE_MAX_SIZE];
+    uint8_t garbage[FRAMING_MAX_GARBAGE];
+    uint64_t offset = 0;
+    uint16_t length;
+    int size;
+    int i, j;
+
+    g_prng = g_seed;
+
+    for (i = 0; i < g_frames; i++)
+    {
+        /* Garbage bytes. */
+        if ((p_scenario->garbage > 0.0) && (framing_random_unit() < p_scenario->garbage))
+        {
+            size = 1 + (framing_random(&g_prng) % FRAMING_MAX_GARBAGE);
+            for (j = 0; j < size; j++)
+            {
+                garbage[j] = (uint8_t)framing_random(&g_prng);
+            }
+            framing_emit(p_scenario, &offset, garbage, size);
+        }
+
+        /* Frame header and payload. */
+        g_sizes[i] = FRAMING_MIN_PAYLOAD + (framing_random(&g_prng) % (g_max_payload - FRAMING_MIN_PAYLOAD + 1));
+        length = (uint16_t)g_sizes[i];
+        if ((p_scenario->length > 0.0) && (framing_random_unit() < p_scenario->length))
+        {
+            length = (uint16_t)framing_random(&g_prng);
+        }
+
+        frame[0] = 0xAC;
+        frame[1] = 0xBE;
+        frame[2] = (uint8_t)length;
+        frame[3] = (uint8_t)(length >> 8);
+        framing_payload(&frame[4], i, g_sizes[i]);
+        size = 4 + g_sizes[i];
+
+        /* Truncation. */
+        if ((p_scenario->truncate > 0.0) && (framing_random_unit() < p_scenario->truncate))
+        {
+            size = 1 + (framing_random(&g_prng) % (size - 1));
+        }
+
+        framing_emit(p_scenario, &offset, frame, size);
+    }
+
+    return offset;
+}
+
+
+/**
+ * @brief   Check a delivered frame and update the results.
+ *
+ * @param[in]   size        Delivered frame size in bytes
+ * @param[in]   fed         Number of stream bytes fed so far
+ * @param[in,out] p_result  Pointer to the scenario results
+ * @param[in,out] p_last    Pointer to the sequence number of the last recovered frame
+ * @param[in,out] p_last_fed Pointer to the number of bytes fed when it was recovered
+ **/
+
+static void framing_check(int size, uint64_t fed, framing_result_t *p_result, int *p_last, uint64_t *p_last_fed)
+{
+    uint8_t expected[WHAD_MESSAGE_MAX_SIZE];
+    uint32_t sequence;
+
+    if (size < 4)
+    {
+        p_result->corrupted++;
+        return;
+    }
+
+    sequence = g_rx_buffer[0] | (g_rx_buffer[1] << 8) | (g_rx_buffer[2] << 16) | ((uint32_t)g_rx_buffer[3] << 24);
+    if ((sequence >= (uint32_t)g_frames) || g_delivered[sequence] || (size != g_sizes[sequence]))
+    {
+        p_result->corrupted++;
+        return;
+    }
+
+    framing_payload(expected, sequence, size);
+    if (memcmp(expected, g_rx_buffer, size) != 0)
+    {
+        p_result->corrupted++;
+        return;
+    }
+
+    /* Recovered. */
+    g_delivered[sequence] = true;
+    p_result->recovered++;
+    p_result->discarded -= (4 + size);
+
+    if (((int)sequence - *p_last - 1) > p_result->max_lost_run)
+    {
+        p_result->max_lost_run = (int)sequence - *p_last - 1;
+    }
+    if ((fed - *p_last_fed) > p_result->max_gap)
+    {
+        p_result->max_gap = fed - *p_last_fed;
+    }
+    *p_last = (int)sequence;
+    *p_last_fed = fed;
+}
+
+
+/**
+ * @brief   Run a corruption scenario.
+ *
+ * @param[in]   p_scenario  Pointer to the corruption scenario
+ * @param[out]  p_result    Pointer to the scenario results
+ **/
+
+static void framing_run(const framing_scenario_t *p_scenario, framing_result_t *p_result)
+{
+    whad_transport_cfg_t transport = {0, NULL};
+    whad_result_t result;
+    uint64_t fed = 0;
+    uint64_t last_fed = 0;
+    uint64_t start, call;
+    int last = -1;
+    int chunk;
+    int size;
+
+    memset(p_result, 0, sizeof(framing_result_t));
+    memset(g_delivered, 0, g_frames * sizeof(bool));
+    p_result->stream_size = framing_generate(p_scenario);
+    p_result->discarded = p_result->stream_size;
+
+    whad_transport_init(&transport);
+
+    while (fed < p_result->stream_size)
+    {
+        /* Feed a chunk, as long as the RX ring buffer can hold it. */
+        chunk = WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_rxbuf_size();
+        if (chunk > g_rx_chunk)
+        {
+            chunk = g_rx_chunk;
+        }
+        if ((uint64_t)chunk > (p_result->stream_size - fed))
+        {
+            chunk = (int)(p_result->stream_size - fed);
+        }
+
+        start = framing_now();
+        if ((chunk <= 0) || (whad_transport_data_received(&g_stream[fed], chunk) != WHAD_SUCCESS))
+        {
+            /* The transport layer did not drain its RX buffer. */
+            p_result->violations++;
+            break;
+        }
+        fed += chunk;
+
+        /* Retrieve every available frame. */
+        for (;;)
+        {
+            size = sizeof(g_rx_buffer);
+            call = framing_now();
+            result = whad_transport_get_message(g_rx_buffer, &size);
+            call = framing_now() - call;
+            if (call > p_result->max_call_ns)
+            {
+                p_result->max_call_ns = call;
+            }
+
+            if (result == WHAD_SUCCESS)
+            {
+                if (size == 0)
+                {
+                    break;
+                }
+                if (size > (int)sizeof(g_rx_buffer))
+                {
+                    p_result->violations++;
+                    break;
+                }
+                framing_check(size, fed, p_result, &last, &last_fed);
+            }
+            else if (size <= (int)sizeof(g_rx_buffer))
+            {
+                /* Errors are only expected for frames larger than our buffer. */
+                p_result->violations++;
+                break;
+            }
+        }
+        p_result->cpu_ns += framing_now() - start;
+    }
+
+    /* Frames lost at the end of the stream. */
+    if ((g_frames - last - 1) > p_result->max_lost_run)
+    {
+        p_result->max_lost_run = g_frames - last - 1;
+    }
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-n frames] [-s max_payload_size] [-c rx_chunk] [-S seed]\n"
+                    "       [-e ber] [-t truncate] [-l length] [-g garbage] [-m min_recovered]\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    framing_scenario_t custom = {"custom", 0.0, 0.0, 0.0, 0.0};
+    const framing_scenario_t *p_scenarios = g_scenarios;
+    int count = sizeof(g_scenarios) / sizeof(framing_scenario_t);
+    framing_result_t result;
+    double min_recovered = -1.0;
+    double recovered;
+    int failures = 0;
+    int opt;
+    int i;
+
+    while ((opt = getopt(argc, argv, "n:s:c:S:e:t:l:g:m:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': g_frames = atoi(optarg); break;
+            case 's': g_max_payload = atoi(optarg); break;
+            case 'c': g_rx_chunk = atoi(optarg); break;
+            case 'S': g_seed = strtoull(optarg, NULL, 0); break;
+            case 'e': custom.ber = atof(optarg); p_scenarios = &custom; break;
+            case 't': custom.truncate = atof(optarg); p_scenarios = &custom; break;
+            case 'l': custom.length = atof(optarg); p_scenarios = &custom; break;
+            case 'g': custom.garbage = atof(optarg); p_scenarios = &custom; break;
+            case 'm': min_recovered = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((g_frames <= 0) || (g_max_payload < FRAMING_MIN_PAYLOAD) ||
+        (g_max_payload > WHAD_MESSAGE_MAX_SIZE) || (g_rx_chunk <= 0) || (g_seed == 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (p_scenarios == &custom)
+    {
+        count = 1;
+    }
+
+    g_stream = (uint8_t *)malloc((size_t)g_frames * (4 + g_max_payload + FRAMING_MAX_GARBAGE));
+    g_sizes = (int *)malloc(g_frames * sizeof(int));
+    g_delivered = (bool *)malloc(g_frames * sizeof(bool));
+    if ((g_stream == NULL) || (g_sizes == NULL) || (g_delivered == NULL))
+    {
+        return 1;
+    }
+
+    printf("# %d frames, payload %d-%d bytes, rx chunk %d bytes, seed 0x%llx\n", g_frames, FRAMING_MIN_PAYLOAD,
+           g_max_payload, g_rx_chunk, (unsigned long long)g_seed);
+    printf("%-16s %10s %10s %12s %14s %10s %12s %12s\n", "scenario", "recovered", "corrupted", "discarded",
+           "ns/recovered", "lost run", "max gap", "max call ns");
+
+    for (i = 0; i < count; i++)
+    {
+        framing_run(&p_scenarios[i], &result);
+        recovered = (double)result.recovered / g_frames;
+
+        printf("%-16s %9.2f%% %10d %12llu %14.1f %10d %12llu %12llu\n", p_scenarios[i].name, 100.0 * recovered,
+               result.corrupted, (unsigned long long)result.discarded,
+               (result.recovered > 0) ? ((double)result.cpu_ns / result.recovered) : 0.0,
+               result.max_lost_run, (unsigned long long)result.max_gap, (unsigned long long)result.max_call_ns);
+
+        if ((result.violations > 0) || ((min_recovered >= 0.0) && (recovered < min_recovered)))
+        {
+            if (result.violations > 0)
+            {
+                fprintf(stderr, "%s: %d transport layer violations\n", p_scenarios[i].name, result.violations);
+            }
+            failures++;
+        }
+    }
+
+    free(g_stream);
+    free(g_sizes);
+    free(g_delivered);
+
+    return (failures > 0) ? 1 : 0;
+}
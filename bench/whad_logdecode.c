@@ -0,0 +1,405 @@
+/** \file whad_logdecode.c
+ * WHAD binary log decoder (host only).
+ *
+ * Reads the format strings section (`whad_log_fmt`, see log.h) of the firmware
+ * ELF file, then extracts every log message of a capture (see capture.h,
+ * recorded with whad-record) as whad-replay does, and prints each entry as
+ * text, along with its device timestamp and level. Dropped entries reported by
+ * the device are printed where they were noticed.
+ *
+ * Arguments are 32-bit words: integer and character conversions (`%d`, `%i`,
+ * `%u`, `%x`, `%X`, `%o`, `%c`, `%p`) are supported with their flags, width and
+ * precision, length modifiers are ignored. Strings cannot be expanded, `%s`
+ * prints the device address of the string.
+ *
+ * Usage: whad-logdecode firmware.elf capture
+ */
+
+#include <elf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "capture.h"
+
+/* Default parameters. */
+#define LOGDECODE_RX_CHUNK          (64)
+#define LOGDECODE_ARENA_SIZE        (4096)
+#define LOGDECODE_LINE_MAX_SIZE     (512)
+
+static const char *g_level_names[] = {"E", "W", "I", "D", "?", "?", "?", "?"};
+
+/* Format strings section. */
+static const char *g_formats = NULL;
+static size_t g_formats_size = 0;
+
+/* Decoded message and arena. */
+static Message g_message;
+static uint8_t g_arena_buffer[LOGDECODE_ARENA_SIZE];
+static whad_arena_t g_arena;
+
+/* Statistics. */
+static uint64_t g_frames = 0;
+static uint64_t g_messages = 0;
+static uint64_t g_entries = 0;
+static uint64_t g_errors = 0;
+static uint32_t g_dropped = 0;
+
+
+/**
+ * @brief   Find the format strings section of a firmware ELF file.
+ *
+ * @param[in]   p_elf   Pointer to the mapped ELF file
+ * @param[in]   size    ELF file size
+ * @return  0 on success, -1 if the file is not a little-endian ELF file or has no such section.
+ **/
+
+static int logdecode_find_formats(const uint8_t *p_elf, size_t size)
+{
+    const Elf32_Ehdr *p_ehdr32 = (const Elf32_Ehdr *)p_elf;
+    const Elf64_Ehdr *p_ehdr64 = (const Elf64_Ehdr *)p_elf;
+    uint64_t shoff, offset, name_offset, section_size, strtab_offset;
+    unsigned int shnum, shentsize, shstrndx;
+    unsigned int i;
+    bool is_64;
+
+    if ((size < sizeof(Elf32_Ehdr)) || (memcmp(p_elf, ELFMAG, SELFMAG) != 0) ||
+        (p_elf[EI_DATA] != ELFDATA2LSB))
+    {
+        return -1;
+    }
+
+    is_64 = (p_elf[EI_CLASS] == ELFCLASS64);
+    if (is_64 && (size < sizeof(Elf64_Ehdr)))
+    {
+        return -1;
+    }
+
+    shoff = is_64 ? p_ehdr64->e_shoff : p_ehdr32->e_shoff;
+    shnum = is_64 ? p_ehdr64->e_shnum : p_ehdr32->e_shnum;
+    shentsize = is_64 ? p_ehdr64->e_shentsize : p_ehdr32->e_shentsize;
+    shstrndx = is_64 ? p_ehdr64->e_shstrndx : p_ehdr32->e_shstrndx;
+    if ((shstrndx >= shnum) || ((shoff + (uint64_t)shnum * shentsize) > size))
+    {
+        return -1;
+    }
+
+    /* Section names table. */
+    if (is_64)
+    {
+        strtab_offset = ((const Elf64_Shdr *)&p_elf[shoff + shstrndx * shentsize])->sh_offset;
+    }
+    else
+    {
+        strtab_offset = ((const Elf32_Shdr *)&p_elf[shoff + shstrndx * shentsize])->sh_offset;
+    }
+
+    for (i=0; i<shnum; i++)
+    {
+        if (is_64)
+        {
+            const Elf64_Shdr *p_shdr = (const Elf64_Shdr *)&p_elf[shoff + i * shentsize];
+            name_offset = p_shdr->sh_name;
+            offset = p_shdr->sh_offset;
+            section_size = p_shdr->sh_size;
+        }
+        else
+        {
+            const Elf32_Shdr *p_shdr = (const Elf32_Shdr *)&p_elf[shoff + i * shentsize];
+            name_offset = p_shdr->sh_name;
+            offset = p_shdr->sh_offset;
+            section_size = p_shdr->sh_size;
+        }
+
+        if (((strtab_offset + name_offset + sizeof(WHAD_LOG_SECTION)) <= size) &&
+            (strcmp((const char *)&p_elf[strtab_offset + name_offset], WHAD_LOG_SECTION) == 0) &&
+            ((offset + section_size) <= size))
+        {
+            g_formats = (const char *)&p_elf[offset];
+            g_formats_size = section_size;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief   Expand a log entry into text.
+ *
+ * @param[in]   p_entry     Pointer to the log entry
+ * @param[out]  psz_line    Output buffer
+ * @param[in]   size        Output buffer size
+ **/
+
+static void logdecode_format(const whad_log_entry_t *p_entry, char *psz_line, size_t size)
+{
+    const char *psz_format;
+    const char *p_end;
+    char spec[32];
+    size_t length = 0;
+    size_t spec_length;
+    int arg = 0;
+    int written;
+    char conversion;
+
+    if ((p_entry->id >= g_formats_size) ||
+        (memchr(&g_formats[p_entry->id], '\0', g_formats_size - p_entry->id) == NULL))
+    {
+        length = snprintf(psz_line, size, "<unknown format 0x%04x>", p_entry->id);
+        for (arg=0; (arg < p_entry->nargs) && (length < (size - 1)); arg++)
+        {
+            length += snprintf(&psz_line[length], size - length, " 0x%08x", p_entry->args[arg]);
+        }
+        return;
+    }
+
+    psz_format = &g_formats[p_entry->id];
+    psz_line[0] = '\0';
+    while ((*psz_format != '\0') && (length < (size - 1)))
+    {
+        if ((psz_format[0] != '%') || (psz_format[1] == '%'))
+        {
+            psz_line[length++] = *psz_format;
+            psz_format += (psz_format[0] == '%') ? 2 : 1;
+            continue;
+        }
+
+        /* Conversion specification: flags, width, precision, then length modifiers dropped. */
+        p_end = psz_format + 1 + strspn(psz_format + 1, "-+ #0123456789.");
+        spec_length = p_end - psz_format;
+        p_end += strspn(p_end, "hlLqjzt");
+        conversion = *p_end;
+        if ((conversion == '\0') || (spec_length >= (sizeof(spec) - 1)))
+        {
+            break;
+        }
+        memcpy(spec, psz_format, spec_length);
+        spec[spec_length] = conversion;
+        spec[spec_length + 1] = '\0';
+        psz_format = p_end + 1;
+
+        if (arg >= p_entry->nargs)
+        {
+            written = snprintf(&psz_line[length], size - length, "<missing>");
+        }
+        else if ((conversion == 'd') || (conversion == 'i') || (conversion == 'c'))
+        {
+            written = snprintf(&psz_line[length], size - length, spec, (int32_t)p_entry->args[arg++]);
+        }
+        else if ((conversion == 'u') || (conversion == 'x') || (conversion == 'X') || (conversion == 'o'))
+        {
+            written = snprintf(&psz_line[length], size - length, spec, p_entry->args[arg++]);
+        }
+        else if ((conversion == 'p') || (conversion == 's'))
+        {
+            written = snprintf(&psz_line[length], size - length, "0x%08x", p_entry->args[arg++]);
+        }
+        else
+        {
+            written = snprintf(&psz_line[length], size - length, "<%%%c?>", conversion);
+        }
+
+        if (written < 0)
+        {
+            break;
+        }
+        length += written;
+        if (length >= size)
+        {
+            break;
+        }
+    }
+
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    psz_line[length] = '\0';
+}
+
+
+/**
+ * @brief   Print the entries of every log message held by the transport layer.
+ **/
+
+static void logdecode_drain(void)
+{
+    char line[LOGDECODE_LINE_MAX_SIZE];
+    whad_log_entry_t entry;
+    whad_result_t result;
+    uint8_t *p_frame;
+    uint8_t *p_entries;
+    uint32_t dropped;
+    int entries_size;
+    int offset;
+    int size;
+
+    for (;;)
+    {
+        result = whad_get_raw_message(&p_frame, &size);
+        if (result == WHAD_NONE)
+        {
+            return;
+        }
+        if (result != WHAD_SUCCESS)
+        {
+            g_errors++;
+            return;
+        }
+        g_frames++;
+
+        whad_arena_reset(&g_arena);
+        if (whad_decode_message_arena(p_frame, size, &g_message, &g_arena) != WHAD_SUCCESS)
+        {
+            g_errors++;
+            continue;
+        }
+
+        if (whad_generic_log_message_parse(&g_message, &dropped, &p_entries, &entries_size) != WHAD_SUCCESS)
+        {
+            continue;
+        }
+        g_messages++;
+
+        if (dropped != g_dropped)
+        {
+            printf("!! %u entries dropped\n", dropped - g_dropped);
+            g_dropped = dropped;
+        }
+
+        offset = 0;
+        while ((result = whad_log_next_entry(p_entries, entries_size, &offset, &entry)) == WHAD_SUCCESS)
+        {
+            logdecode_format(&entry, line, sizeof(line));
+            printf("[%10u.%06u] %s %s\n", entry.timestamp / 1000000, entry.timestamp % 1000000,
+                   g_level_names[entry.level & WHAD_LOG_LEVEL_MASK], line);
+            g_entries++;
+        }
+        if (result != WHAD_NONE)
+        {
+            g_errors++;
+        }
+    }
+}
+
+
+/**
+ * @brief   Print every log entry of a capture.
+ *
+ * @param[in]   p_reader    Pointer to the capture reader
+ * @return  0 on success, -1 on a malformed capture.
+ **/
+
+static int logdecode_read_capture(capture_reader_t *p_reader)
+{
+    whad_result_t result;
+    const uint8_t *p_data;
+    uint64_t time_ns;
+    int offset;
+    int chunk;
+    int room;
+    int size;
+
+    while ((result = capture_next(p_reader, &time_ns, &p_data, &size)) == WHAD_SUCCESS)
+    {
+        for (offset = 0; offset < size; offset += chunk)
+        {
+            chunk = size - offset;
+            if (chunk > LOGDECODE_RX_CHUNK)
+            {
+                chunk = LOGDECODE_RX_CHUNK;
+            }
+
+            room = WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_rxbuf_size();
+            if (chunk > room)
+            {
+                chunk = room;
+            }
+
+            if ((chunk <= 0) || (whad_transport_data_received((uint8_t *)&p_data[offset], chunk) != WHAD_SUCCESS))
+            {
+                break;
+            }
+
+            logdecode_drain();
+        }
+    }
+
+    return (result == WHAD_NONE) ? 0 : -1;
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s firmware.elf capture\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    capture_reader_t reader;
+    whad_transport_cfg_t transport;
+    struct stat st;
+    uint8_t *p_elf;
+    int fd;
+    int status;
+
+    if (argc != 3)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    fd = open(argv[1], O_RDONLY);
+    if ((fd < 0) || (fstat(fd, &st) != 0) || (st.st_size == 0))
+    {
+        fprintf(stderr, "%s: cannot open firmware file\n", argv[1]);
+        return 1;
+    }
+    p_elf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_elf == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: cannot map firmware file\n", argv[1]);
+        return 1;
+    }
+
+    if (logdecode_find_formats(p_elf, st.st_size) != 0)
+    {
+        fprintf(stderr, "%s: no %s section\n", argv[1], WHAD_LOG_SECTION);
+        munmap(p_elf, st.st_size);
+        return 1;
+    }
+
+    if (capture_open(&reader, argv[2]) != WHAD_SUCCESS)
+    {
+        fprintf(stderr, "%s: cannot map capture file\n", argv[2]);
+        munmap(p_elf, st.st_size);
+        return 1;
+    }
+
+    /* Nothing is sent back to the device. */
+    transport.max_txbuf_size = 0;
+    transport.pfn_data_send_buffer = NULL;
+    whad_init(&transport);
+    whad_arena_init(&g_arena, g_arena_buffer, sizeof(g_arena_buffer));
+
+    status = logdecode_read_capture(&reader);
+    capture_release(&reader);
+    munmap(p_elf, st.st_size);
+    if (status != 0)
+    {
+        fprintf(stderr, "%s: malformed capture\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(stderr, "%llu frames, %llu log messages, %llu entries, %u dropped, %llu errors\n",
+            (unsigned long long)g_frames, (unsigned long long)g_messages, (unsigned long long)g_entries,
+            g_dropped, (unsigned long long)g_errors);
+    return 0;
+}
@@ -0,0 +1,447 @@
+/** \file whad_loopback.c
+ * WHAD end-to-end loopback benchmark (host only).
+ *
+ * Sends BLE `RawPduReceived` notifications (generic `DebugMsg` ones carrying
+ * the PDU as text when the BLE domain is disabled) through the whole library
+ * path, from the message builder to `whad_send_message()`, the TX ring buffer, a
+ * simulated UART (see uart_sim.h) looped back to the RX ring buffer, and
+ * `whad_get_message()` that decodes them. A firmware main loop is simulated
+ * with a fixed cadence: each iteration processes received messages, queues new
+ * notifications and sends pending bytes.
+ *
+ * Time is virtual, processing time of the main loop is not accounted for:
+ * figures only depend on the link, driver and main loop parameters. The
+ * benchmark reports the sustained message rate, the link utilisation and the
+ * latency percentiles between the queuing of a notification (or its scheduled
+ * generation time, if a rate is set) and its reception by the main loop. When
+ * the library is built with `WHAD_PROFILING`, the host CPU time spent in each
+ * stage is reported as well. With `-w`, the looped back stream is recorded
+ * into a capture file (see capture.h) with its virtual receive times.
+ *
+ * Usage: whad-loopback [-b baudrate] [-t max_txbuf_size] [-p poll_period_us]
+ *                      [-i isr_latency_ns] [-c tx_chunk] [-f rx_chunk] [-o rx_timeout]
+ *                      [-n messages] [-s pdu_size] [-r rate] [-C] [-w capture]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "whad.h"
+#include "uart_sim.h"
+#include "capture.h"
+
+/* Default benchmark parameters. */
+#define LOOPBACK_DEFAULT_MESSAGES       (10000)
+#define LOOPBACK_DEFAULT_PDU_SIZE       (32)
+#define LOOPBACK_DEFAULT_TXBUF_SIZE     (64)
+#define LOOPBACK_DEFAULT_POLL_PERIOD    (100)
+
+/* Largest PDU, a NUL-terminated text in debug messages. */
+#if WHAD_ENABLE_BLE
+#define LOOPBACK_MAX_PDU_SIZE           ((int)sizeof(((ble_RawPduReceived *)0)->pdu.bytes))
+#else
+#define LOOPBACK_MAX_PDU_SIZE           (255)
+#endif
+
+/* Benchmark parameters. */
+typedef struct {
+    int messages;           /*!< Number of notifications to send */
+    int pdu_size;           /*!< PDU size in bytes */
+    int max_txbuf_size;     /*!< Transport `max_txbuf_size` */
+    uint64_t poll_ns;       /*!< Main loop period */
+    uint32_t rate;          /*!< Offered notifications per second, 0 to saturate the link */
+} loopback_cfg_t;
+
+/* Messages and PDU. */
+static Message g_message;
+static Message g_received;
+static uint8_t g_pdu[256];
+
+/* Queuing time and latency of each notification. */
+static uint64_t *g_sent_at;
+static uint64_t *g_latencies;
+
+/* Capture of the looped back stream. */
+static capture_writer_t g_capture;
+static bool g_capture_error = false;
+
+
+/**
+ * @brief   Compare two latencies, for qsort().
+ **/
+
+static int loopback_compare(const void *a, const void *b)
+{
+    uint64_t la = *(const uint64_t *)a;
+    uint64_t lb = *(const uint64_t *)b;
+
+    return (la > lb) - (la < lb);
+}
+
+
+/**
+ * @brief   Get a latency percentile, in us.
+ *
+ * @param[in]   count       Number of sorted latencies
+ * @param[in]   percentile  Percentile, between 0 and 100
+ * @return  Latency in us.
+ **/
+
+static double loopback_percentile(int count, double percentile)
+{
+    int index = (int)((percentile * (count - 1)) / 100.0 + 0.5);
+
+    return g_latencies[index] / 1000.0;
+}
+
+
+/**
+ * @brief   Build the notification carrying a given sequence number.
+ *
+ * The sequence number is sent as the PDU timestamp, or as the debug level.
+ *
+ * @param[in]   p_config    Pointer to the benchmark parameters
+ * @param[in]   sequence    Notification sequence number
+ * @return  Serialized message size in bytes, -1 on error.
+ **/
+
+static int loopback_build(loopback_cfg_t *p_config, uint32_t sequence)
+{
+    size_t size;
+
+#if WHAD_ENABLE_BLE
+    if (whad_ble_raw_pdu(&g_message, 37, -40, 0, 0x8e89bed6, g_pdu, p_config->pdu_size, 0x123456,
+                         true, sequence, 0, BLE_DIR_UNKNOWN, false, false, true) != WHAD_SUCCESS)
+    {
+        return -1;
+    }
+#else
+    if (whad_generic_debug_message(&g_message, sequence, (char *)g_pdu) != WHAD_SUCCESS)
+    {
+        return -1;
+    }
+#endif
+
+    if (!pb_get_encoded_size(&size, Message_fields, &g_message))
+    {
+        return -1;
+    }
+
+    return (int)size;
+}
+
+
+/**
+ * @brief   Get the sequence number of a received notification.
+ *
+ * @param[in]   p_message   Pointer to the received message
+ * @param[out]  p_sequence  Pointer set to the notification sequence number
+ * @return  true if the message is a notification sent by the benchmark.
+ **/
+
+static bool loopback_get_sequence(Message *p_message, uint32_t *p_sequence)
+{
+#if WHAD_ENABLE_BLE
+    if ((p_message->which_msg != Message_ble_tag) || (p_message->msg.ble.which_msg != ble_Message_raw_pdu_tag))
+    {
+        return false;
+    }
+    *p_sequence = p_message->msg.ble.msg.raw_pdu.timestamp;
+#else
+    if ((p_message->which_msg != Message_generic_tag) || (p_message->msg.generic.which_msg != generic_Message_debug_tag))
+    {
+        return false;
+    }
+    *p_sequence = p_message->msg.generic.msg.debug.level;
+#endif
+
+    return true;
+}
+
+
+#ifdef WHAD_TRACING
+
+/**
+ * @brief   Trace clock, following the simulated time.
+ *
+ * @return  Simulated time in us.
+ **/
+
+static uint32_t loopback_trace_clock(void)
+{
+    return (uint32_t)(uart_sim_get_time() / 1000);
+}
+
+#endif
+
+
+#ifdef WHAD_PROFILING
+
+/**
+ * @brief   Print the profiling statistics of each stage.
+ **/
+
+static void loopback_profile_report(void)
+{
+    whad_profile_stats_t stats;
+    int i;
+
+    printf("profile (host counter cycles):\n");
+    for (i = 0; i < WHAD_PROFILE_STAGES; i++)
+    {
+        if (whad_profile_get_stats((whad_profile_stage_t)i, &stats) == WHAD_SUCCESS)
+        {
+            printf("  %-14s n=%-8u min=%-8u avg=%-8llu max=%u\n", whad_profile_get_stage_name((whad_profile_stage_t)i),
+                   stats.count, stats.min, (unsigned long long)(stats.total / stats.count), stats.max);
+        }
+    }
+}
+
+#endif
+
+
+/**
+ * @brief   Record the bytes handed to the simulated RX interrupt.
+ **/
+
+static void loopback_capture(uint64_t time_ns, uint8_t *p_data, int size)
+{
+    if (capture_write(&g_capture, time_ns, p_data, size) != WHAD_SUCCESS)
+    {
+        g_capture_error = true;
+    }
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-b baudrate] [-t max_txbuf_size] [-p poll_period_us] [-i isr_latency_ns]\n"
+                    "       [-c tx_chunk] [-f rx_chunk] [-o rx_timeout] [-n messages] [-s pdu_size]\n"
+                    "       [-r rate] [-C] [-w capture]\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    loopback_cfg_t config;
+    uart_sim_cfg_t uart;
+    uart_sim_stats_t stats;
+    whad_transport_cfg_t transport;
+    whad_result_t result;
+    uint64_t now = 0;
+    uint64_t last_rx = 0;
+    uint64_t generated_at;
+    int frame_size;
+    int produced = 0;
+    int received = 0;
+    int errors = 0;
+    uint32_t sequence;
+    double elapsed;
+    const char *psz_capture = NULL;
+    int opt;
+    int i;
+
+    /* Parse parameters. */
+    config.messages = LOOPBACK_DEFAULT_MESSAGES;
+    config.pdu_size = LOOPBACK_DEFAULT_PDU_SIZE;
+    config.max_txbuf_size = LOOPBACK_DEFAULT_TXBUF_SIZE;
+    config.poll_ns = LOOPBACK_DEFAULT_POLL_PERIOD * 1000ULL;
+    config.rate = 0;
+    uart_sim_default_config(&uart);
+
+    while ((opt = getopt(argc, argv, "b:t:p:i:c:f:o:n:s:r:Cw:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': uart.baudrate = strtoul(optarg, NULL, 0); break;
+            case 't': config.max_txbuf_size = atoi(optarg); break;
+            case 'p': config.poll_ns = strtoull(optarg, NULL, 0) * 1000ULL; break;
+            case 'i': uart.isr_latency_ns = strtoul(optarg, NULL, 0); break;
+            case 'c': uart.tx_chunk_size = atoi(optarg); break;
+            case 'f': uart.rx_chunk_size = atoi(optarg); break;
+            case 'o': uart.rx_timeout = atoi(optarg); break;
+            case 'n': config.messages = atoi(optarg); break;
+            case 's': config.pdu_size = atoi(optarg); break;
+            case 'r': config.rate = strtoul(optarg, NULL, 0); break;
+            case 'C': uart.tx_chain = true; break;
+            case 'w': psz_capture = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((uart.baudrate == 0) || (config.max_txbuf_size <= 0) || (config.poll_ns == 0) || (config.messages <= 0) ||
+        (config.pdu_size < 0) || (config.pdu_size > LOOPBACK_MAX_PDU_SIZE))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (i=0; i<config.pdu_size; i++)
+    {
+#if WHAD_ENABLE_BLE
+        g_pdu[i] = (uint8_t)i;
+#else
+        g_pdu[i] = (uint8_t)('a' + (i % 26));
+#endif
+    }
+
+    /* Frames are only queued when they fit in the TX ring buffer. */
+    frame_size = loopback_build(&config, config.messages) + 4 + WHAD_TRACE_OVERHEAD;
+    if ((frame_size < 4) || (frame_size > (WHAD_RINGBUF_MAX_SIZE - 1)))
+    {
+        fprintf(stderr, "Frame does not fit in the TX ring buffer\n");
+        return 1;
+    }
+
+    g_sent_at = (uint64_t *)calloc(config.messages, sizeof(uint64_t));
+    g_latencies = (uint64_t *)calloc(config.messages, sizeof(uint64_t));
+    if ((g_sent_at == NULL) || (g_latencies == NULL))
+    {
+        return 1;
+    }
+
+    if (psz_capture != NULL)
+    {
+        if (capture_create(&g_capture, psz_capture) != WHAD_SUCCESS)
+        {
+            perror(psz_capture);
+            return 1;
+        }
+        uart.pfn_rx_tap = loopback_capture;
+    }
+
+    /* Plug WHAD into the simulated UART. */
+    uart_sim_init(&uart);
+    transport.max_txbuf_size = config.max_txbuf_size;
+    transport.pfn_data_send_buffer = uart_sim_send_buffer;
+#ifdef WHAD_TRACING
+    whad_trace_set_clock(loopback_trace_clock);
+#endif
+    whad_init(&transport);
+#ifdef WHAD_PROFILING
+    whad_profile_init();
+#endif
+
+    /* Main loop. */
+    for (;;)
+    {
+        uart_sim_run_until(now);
+
+        /* Process received messages. */
+        while ((result = whad_get_message(&g_received)) != WHAD_NONE)
+        {
+            if ((result != WHAD_SUCCESS) || !loopback_get_sequence(&g_received, &sequence) ||
+                (sequence >= (uint32_t)config.messages))
+            {
+                errors++;
+                if (result == WHAD_ERROR)
+                {
+                    break;
+                }
+                continue;
+            }
+
+            g_latencies[received++] = now - g_sent_at[sequence];
+            last_rx = now;
+        }
+
+        /* Queue notifications, as long as they fit in the TX ring buffer. */
+        while (produced < config.messages)
+        {
+            if (config.rate > 0)
+            {
+                generated_at = ((uint64_t)produced * 1000000000ULL) / config.rate;
+                if (generated_at > now)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                generated_at = now;
+            }
+
+            if ((WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_txbuf_size()) < frame_size)
+            {
+                break;
+            }
+
+            WHAD_PROFILE_START(start);
+            loopback_build(&config, produced);
+            WHAD_PROFILE_STOP(WHAD_PROFILE_BUILD, start);
+#ifdef WHAD_TRACING
+            whad_trace_set_capture_time((uint32_t)(generated_at / 1000));
+#endif
+            if (whad_send_message(&g_message) != WHAD_SUCCESS)
+            {
+                errors++;
+            }
+            g_sent_at[produced++] = generated_at;
+        }
+
+        /* Send pending bytes. */
+        whad_transport_send_pending();
+
+        /* Done when everything has been sent and processed. */
+        if ((produced == config.messages) && uart_sim_is_idle() &&
+            (whad_transport_get_txbuf_size() == 0) && (whad_transport_get_rxbuf_size() == 0))
+        {
+            break;
+        }
+
+        now += config.poll_ns;
+    }
+
+    if ((psz_capture != NULL) && ((capture_close(&g_capture) != WHAD_SUCCESS) || g_capture_error))
+    {
+        fprintf(stderr, "%s: write error\n", psz_capture);
+        return 1;
+    }
+
+    /* Report. */
+    uart_sim_get_stats(&stats);
+    elapsed = (last_rx > 0) ? (last_rx / 1e9) : 0.0;
+
+    printf("config:       %u bauds, %d bits/byte, max_txbuf_size %d, tx chunk %d, rx chunk %d (timeout %d), "
+           "isr latency %u ns, poll period %llu us, tx chain %s\n",
+           uart.baudrate, uart.bits_per_byte, config.max_txbuf_size, uart.tx_chunk_size, uart.rx_chunk_size,
+           uart.rx_timeout, uart.isr_latency_ns, (unsigned long long)(config.poll_ns / 1000),
+           uart.tx_chain ? "yes" : "no");
+    printf("messages:     %d sent, %d received, %d lost, %d errors, %llu rx overruns\n",
+           produced, received, produced - received, errors, (unsigned long long)stats.rx_overruns);
+    printf("frame:        %d bytes (%d-byte PDU), link limit %.1f msg/s\n",
+           frame_size, config.pdu_size, 1e9 / (double)(uart_sim_get_byte_time() * frame_size));
+
+    if (received == 0)
+    {
+        return 1;
+    }
+
+    printf("rate:         %.1f msg/s over %.3f s (offered: ", received / elapsed, elapsed);
+    if (config.rate > 0)
+        printf("%u msg/s)\n", config.rate);
+    else
+        printf("saturated)\n");
+    printf("link:         %.1f %% utilisation, %llu bytes, %llu transfers, %llu tx irqs, %llu rx irqs\n",
+           (100.0 * stats.busy_ns) / (double)last_rx, (unsigned long long)stats.tx_bytes,
+           (unsigned long long)stats.tx_transfers, (unsigned long long)stats.tx_irqs,
+           (unsigned long long)stats.rx_irqs);
+
+    qsort(g_latencies, received, sizeof(uint64_t), loopback_compare);
+    printf("latency (us): min %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+           g_latencies[0] / 1000.0, loopback_percentile(received, 50), loopback_percentile(received, 90),
+           loopback_percentile(received, 99), g_latencies[received - 1] / 1000.0);
+
+#ifdef WHAD_PROFILING
+    /* Host CPU profile of each stage. */
+    loopback_profile_report();
+#endif
+
+    free(g_sent_at);
+    free(g_latencies);
+
+    return 0;
+}
@@ -0,0 +1,255 @@
+/** \file whad_record.c
+ * WHAD link recorder (host only).
+ *
+ * Reads the raw byte stream sent by a WHAD device (serial port, pipe or file,
+ * `-` for the standard input) and appends it to a capture file (see capture.h)
+ * along with the time each chunk was received, framing and corrupted bytes
+ * included. The resulting capture can be replayed with whad-replay.
+ *
+ * Serial ports are switched to raw mode, at the given baudrate if any.
+ * Recording stops at the end of the input, after the given duration or number
+ * of bytes, or on SIGINT.
+ *
+ * Usage: whad-record [-b baudrate] [-d duration_s] [-m max_bytes] input capture
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "capture.h"
+
+/* Largest chunk read at once. */
+#define RECORD_CHUNK_SIZE       (4096)
+
+/* Polling period, so that the duration and SIGINT are honoured on an idle link. */
+#define RECORD_POLL_PERIOD_MS   (100)
+
+static volatile sig_atomic_t g_stop = 0;
+
+
+static uint64_t record_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void record_sigint(int signum)
+{
+    (void)signum;
+    g_stop = 1;
+}
+
+
+/**
+ * @brief   Convert a baudrate to a termios speed.
+ *
+ * @param[in]   baudrate    Baudrate in bits per second
+ * @return  termios speed, B0 if the baudrate is not supported.
+ **/
+
+static speed_t record_speed(uint32_t baudrate)
+{
+    switch (baudrate)
+    {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+#ifdef B1000000
+        case 1000000: return B1000000;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+        default: return B0;
+    }
+}
+
+
+/**
+ * @brief   Switch a serial port to raw mode.
+ *
+ * @param[in]   fd          Serial port file descriptor
+ * @param[in]   baudrate    Baudrate, 0 to keep the current one
+ * @return  0 on success, -1 on error.
+ **/
+
+static int record_setup_tty(int fd, uint32_t baudrate)
+{
+    struct termios tio;
+    speed_t speed;
+
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        return -1;
+    }
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    if (baudrate > 0)
+    {
+        speed = record_speed(baudrate);
+        if ((speed == B0) || (cfsetispeed(&tio, speed) != 0) || (cfsetospeed(&tio, speed) != 0))
+        {
+            return -1;
+        }
+    }
+
+    if (tcsetattr(fd, TCSANOW, &tio) != 0)
+    {
+        return -1;
+    }
+
+    tcflush(fd, TCIFLUSH);
+    return 0;
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-b baudrate] [-d duration_s] [-m max_bytes] input capture\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    capture_writer_t writer;
+    struct pollfd pfd;
+    uint8_t chunk[RECORD_CHUNK_SIZE];
+    uint32_t baudrate = 0;
+    double duration = 0.0;
+    uint64_t max_bytes = 0;
+    uint64_t start;
+    uint64_t now;
+    ssize_t count;
+    int ready;
+    int fd;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:d:m:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baudrate = strtoul(optarg, NULL, 0); break;
+            case 'd': duration = atof(optarg); break;
+            case 'm': max_bytes = strtoull(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((argc - optind) != 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    /* Open input. */
+    if (strcmp(argv[optind], "-") == 0)
+    {
+        fd = STDIN_FILENO;
+    }
+    else
+    {
+        fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    if (isatty(fd) && (record_setup_tty(fd, baudrate) != 0))
+    {
+        fprintf(stderr, "%s: cannot configure serial port\n", argv[optind]);
+        return 1;
+    }
+
+    if (capture_create(&writer, argv[optind + 1]) != WHAD_SUCCESS)
+    {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+
+    signal(SIGINT, record_sigint);
+
+    /* Record until end of input, duration, size limit or SIGINT. */
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    start = record_now();
+    while (!g_stop)
+    {
+        now = record_now();
+        if ((duration > 0.0) && ((now - start) >= (uint64_t)(duration * 1e9)))
+        {
+            break;
+        }
+
+        ready = poll(&pfd, 1, RECORD_POLL_PERIOD_MS);
+        if (ready < 0)
+        {
+            /* Interrupted by SIGINT. */
+            continue;
+        }
+        if (ready == 0)
+        {
+            continue;
+        }
+
+        count = sizeof(chunk);
+        if ((max_bytes > 0) && ((uint64_t)count > (max_bytes - writer.bytes)))
+        {
+            count = (ssize_t)(max_bytes - writer.bytes);
+        }
+
+        count = read(fd, chunk, count);
+        if (count <= 0)
+        {
+            break;
+        }
+
+        /* Timestamp chunks as soon as they are read. */
+        if (capture_write(&writer, record_now(), chunk, (int)count) != WHAD_SUCCESS)
+        {
+            perror(argv[optind + 1]);
+            return 1;
+        }
+
+        if ((max_bytes > 0) && (writer.bytes >= max_bytes))
+        {
+            break;
+        }
+    }
+
+    printf("recorded:     %llu bytes in %llu records over %.3f s\n", (unsigned long long)writer.bytes,
+           (unsigned long long)writer.records, (record_now() - start) / 1e9);
+
+    if (capture_close(&writer) != WHAD_SUCCESS)
+    {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,367 @@
+/** \file whad_replay.c
+ * WHAD capture replay and decoding benchmark (host only).
+ *
+ * Maps a capture file (see capture.h, recorded with whad-record or
+ * `whad-loopback -w`) and feeds its bytes to `whad_transport_data_received()`
+ * by chunks, as an RX interrupt handler would, then retrieves every complete
+ * frame with `whad_get_raw_message()` and decodes it with
+ * `whad_decode_message()` (or `whad_decode_message_arena()` with `-a`).
+ *
+ * The capture is replayed as fast as possible, or at its recorded pace with
+ * `-p`. The program reports the overall throughput and, for each message type,
+ * the number of messages and bytes and the decoding cost, so that decoding
+ * changes can be compared on the same realistic traffic.
+ *
+ * Usage: whad-replay [-p] [-a] [-c rx_chunk] [-r repeat] capture
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture.h"
+
+/* Default parameters. */
+#define REPLAY_DEFAULT_RX_CHUNK     (64)
+#define REPLAY_DEFAULT_REPEAT       (1)
+
+/* Message types are indexed by domain (Message tag) and domain message tag. */
+#define REPLAY_DOMAINS              (8)
+#define REPLAY_SUBTYPES             (64)
+
+/* Arena used with `-a`. */
+#define REPLAY_ARENA_SIZE           (4096)
+
+/* Per message type statistics. */
+typedef struct {
+    uint64_t count;         /*!< Messages decoded */
+    uint64_t bytes;         /*!< Encoded bytes */
+    uint64_t decode_ns;     /*!< Time spent decoding */
+    uint64_t max_ns;        /*!< Longest decoding */
+} replay_stats_t;
+
+static const char *g_domain_names[REPLAY_DOMAINS] = {
+    "unknown", "generic", "discovery", "ble", "dot15d4", "esb", "unifying", "phy"
+};
+
+/* Parameters. */
+static bool g_paced = false;
+static bool g_use_arena = false;
+static int g_rx_chunk = REPLAY_DEFAULT_RX_CHUNK;
+
+/* Statistics. */
+static replay_stats_t g_stats[REPLAY_DOMAINS][REPLAY_SUBTYPES];
+static uint64_t g_frames = 0;
+static uint64_t g_errors = 0;
+static uint64_t g_framing_ns = 0;
+
+/* Decoded message and arena. */
+static Message g_message;
+static uint8_t g_arena_buffer[REPLAY_ARENA_SIZE];
+static whad_arena_t g_arena;
+
+
+static uint64_t replay_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void replay_sleep_until(uint64_t deadline_ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = deadline_ns / 1000000000ULL;
+    ts.tv_nsec = deadline_ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+    {
+    }
+}
+
+
+/**
+ * @brief   Get the domain message tag of a decoded message.
+ *
+ * @param[in]   p_msg   Pointer to a decoded message
+ * @return  Domain message tag, 0 if unknown.
+ **/
+
+static pb_size_t replay_get_subtype(Message *p_msg)
+{
+    switch (p_msg->which_msg)
+    {
+        case Message_generic_tag: return p_msg->msg.generic.which_msg;
+        case Message_discovery_tag: return p_msg->msg.discovery.which_msg;
+#if WHAD_ENABLE_BLE
+        case Message_ble_tag: return p_msg->msg.ble.which_msg;
+#endif
+#if WHAD_ENABLE_DOT15D4
+        case Message_dot15d4_tag: return p_msg->msg.dot15d4.which_msg;
+#endif
+#if WHAD_ENABLE_ESB
+        case Message_esb_tag: return p_msg->msg.esb.which_msg;
+#endif
+#if WHAD_ENABLE_UNIFYING
+        case Message_unifying_tag: return p_msg->msg.unifying.which_msg;
+#endif
+#if WHAD_ENABLE_PHY
+        case Message_phy_tag: return p_msg->msg.phy.which_msg;
+#endif
+        default: return 0;
+    }
+}
+
+
+/**
+ * @brief   Decode every complete frame held by the transport layer.
+ **/
+
+static void replay_drain(void)
+{
+    replay_stats_t *p_stats;
+    whad_result_t result;
+    uint8_t *p_frame;
+    uint64_t start;
+    uint64_t elapsed;
+    pb_size_t domain;
+    pb_size_t subtype;
+    int size;
+
+    for (;;)
+    {
+        start = replay_now();
+        result = whad_get_raw_message(&p_frame, &size);
+        g_framing_ns += replay_now() - start;
+        if (result == WHAD_NONE)
+        {
+            return;
+        }
+        if (result != WHAD_SUCCESS)
+        {
+            g_errors++;
+            return;
+        }
+        g_frames++;
+
+        start = replay_now();
+        if (g_use_arena)
+        {
+            result = whad_decode_message_arena(p_frame, size, &g_message, &g_arena);
+        }
+        else
+        {
+            result = whad_decode_message(p_frame, size, &g_message);
+        }
+        elapsed = replay_now() - start;
+
+        if (result != WHAD_SUCCESS)
+        {
+            g_errors++;
+            continue;
+        }
+
+        domain = g_message.which_msg;
+        subtype = replay_get_subtype(&g_message);
+        if ((domain >= REPLAY_DOMAINS) || (subtype >= REPLAY_SUBTYPES))
+        {
+            domain = 0;
+            subtype = 0;
+        }
+
+        p_stats = &g_stats[domain][subtype];
+        p_stats->count++;
+        p_stats->bytes += size;
+        p_stats->decode_ns += elapsed;
+        if (elapsed > p_stats->max_ns)
+        {
+            p_stats->max_ns = elapsed;
+        }
+
+        /* Release callback fields. */
+        if (g_use_arena)
+        {
+            whad_arena_reset(&g_arena);
+        }
+        else
+        {
+            whad_free_message_resources(&g_message);
+        }
+    }
+}
+
+
+/**
+ * @brief   Replay a capture once.
+ *
+ * @param[in]   p_reader    Pointer to the capture reader
+ * @param[out]  p_bytes     Number of stream bytes replayed
+ * @param[out]  p_dropped   Number of stream bytes rejected by the transport layer
+ * @return  0 on success, -1 on a malformed capture.
+ **/
+
+static int replay_capture(capture_reader_t *p_reader, uint64_t *p_bytes, uint64_t *p_dropped)
+{
+    whad_result_t result;
+    const uint8_t *p_data;
+    uint64_t origin;
+    uint64_t time_ns;
+    int offset;
+    int chunk;
+    int room;
+    int size;
+
+    capture_rewind(p_reader);
+    origin = replay_now();
+    while ((result = capture_next(p_reader, &time_ns, &p_data, &size)) == WHAD_SUCCESS)
+    {
+        if (g_paced)
+        {
+            replay_sleep_until(origin + time_ns);
+        }
+
+        /* Feed the record by chunks, decoding complete frames in between. */
+        for (offset = 0; offset < size; offset += chunk)
+        {
+            chunk = size - offset;
+            if (chunk > g_rx_chunk)
+            {
+                chunk = g_rx_chunk;
+            }
+
+            room = WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_rxbuf_size();
+            if (chunk > room)
+            {
+                chunk = room;
+            }
+
+            if ((chunk <= 0) || (whad_transport_data_received((uint8_t *)&p_data[offset], chunk) != WHAD_SUCCESS))
+            {
+                /* Transport layer does not accept more bytes, drop the rest of the record. */
+                *p_dropped += size - offset;
+                break;
+            }
+
+            replay_drain();
+        }
+
+        *p_bytes += size;
+    }
+
+    return (result == WHAD_NONE) ? 0 : -1;
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-p] [-a] [-c rx_chunk] [-r repeat] capture\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    capture_reader_t reader;
+    whad_transport_cfg_t transport;
+    replay_stats_t *p_stats;
+    uint64_t bytes = 0;
+    uint64_t dropped = 0;
+    uint64_t messages = 0;
+    uint64_t decode_ns = 0;
+    uint64_t start;
+    double elapsed;
+    int repeat = REPLAY_DEFAULT_REPEAT;
+    int opt;
+    int i;
+    int j;
+
+    while ((opt = getopt(argc, argv, "pac:r:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p': g_paced = true; break;
+            case 'a': g_use_arena = true; break;
+            case 'c': g_rx_chunk = atoi(optarg); break;
+            case 'r': repeat = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (((argc - optind) != 1) || (g_rx_chunk <= 0) || (repeat <= 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (capture_open(&reader, argv[optind]) != WHAD_SUCCESS)
+    {
+        fprintf(stderr, "%s: cannot map capture file\n", argv[optind]);
+        return 1;
+    }
+
+    /* Nothing is sent back to the device. */
+    transport.max_txbuf_size = 0;
+    transport.pfn_data_send_buffer = NULL;
+    whad_init(&transport);
+    whad_arena_init(&g_arena, g_arena_buffer, sizeof(g_arena_buffer));
+
+    start = replay_now();
+    for (i=0; i<repeat; i++)
+    {
+        if (replay_capture(&reader, &bytes, &dropped) != 0)
+        {
+            fprintf(stderr, "%s: malformed capture\n", argv[optind]);
+            capture_release(&reader);
+            return 1;
+        }
+    }
+    elapsed = (replay_now() - start) / 1e9;
+    capture_release(&reader);
+
+    for (i=0; i<REPLAY_DOMAINS; i++)
+    {
+        for (j=0; j<REPLAY_SUBTYPES; j++)
+        {
+            messages += g_stats[i][j].count;
+            decode_ns += g_stats[i][j].decode_ns;
+        }
+    }
+
+    /* Report. */
+    printf("replay:       %s, %d pass(es), %s, rx chunk %d, %s decoding\n", argv[optind], repeat,
+           g_paced ? "recorded pace" : "as fast as possible", g_rx_chunk, g_use_arena ? "arena" : "default");
+    printf("stream:       %llu bytes, %llu dropped, %llu frames, %llu decoded, %llu errors\n",
+           (unsigned long long)bytes, (unsigned long long)dropped, (unsigned long long)g_frames,
+           (unsigned long long)messages, (unsigned long long)g_errors);
+    if ((messages == 0) || (elapsed <= 0.0))
+    {
+        return 1;
+    }
+
+    printf("throughput:   %.1f msg/s, %.2f MB/s over %.3f s (framing %.1f ns/frame, decoding %.1f ns/msg)\n",
+           messages / elapsed, bytes / elapsed / 1e6, elapsed, (double)g_framing_ns / g_frames,
+           (double)decode_ns / messages);
+    printf("  %-20s %10s %12s %10s %10s %12s\n", "type", "messages", "bytes", "ns/msg", "max ns", "msg/s");
+    for (i=0; i<REPLAY_DOMAINS; i++)
+    {
+        for (j=0; j<REPLAY_SUBTYPES; j++)
+        {
+            p_stats = &g_stats[i][j];
+            if (p_stats->count == 0)
+            {
+                continue;
+            }
+
+            printf("  %-12s tag %-4d %10llu %12llu %10.1f %10llu %12.0f\n", g_domain_names[i], j,
+                   (unsigned long long)p_stats->count, (unsigned long long)p_stats->bytes,
+                   (double)p_stats->decode_ns / p_stats->count, (unsigned long long)p_stats->max_ns,
+                   (p_stats->decode_ns > 0) ? (p_stats->count * 1e9 / p_stats->decode_ns) : 0.0);
+        }
+    }
+
+    return 0;
+}
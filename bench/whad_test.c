@@ -0,0 +1,2036 @@
+/** \file whad_test.c
+ * WHAD library tests (host only).
+ *
+ * Messages are sent with the library send functions, captured at the output
+ * of the transport layer and fed back to its input, as a device talking to
+ * itself over a loopback link would do. The following features are covered:
+ * - traced messages: frames carrying the tracing extension (see trace.h) are
+ *   decoded with their callback fields and accepted by the fast-path
+ *   decoders, the extension being added by hand when the library is not
+ *   built with WHAD_TRACING,
+ * - TX buffer: frames are queued all at once or not at all, only frames
+ *   larger than the TX buffer are streamed through it, and only when a send
+ *   callback is set,
+ * - oversize messages: received messages larger than WHAD_MESSAGE_MAX_SIZE
+ *   are discarded and answered with an error command result,
+ * - compact messages: frames sent by `whad_send_compact_message()` carry the
+ *   exact bytes NanoPb encodes from the matching `Message` builder,
+ * - fast command results: pre-encoded frames sent by
+ *   `whad_send_cmd_result_fast()` carry, for every result code, the exact
+ *   bytes `whad_send_message()` sends for `whad_generic_cmd_result()`, trace
+ *   extension aside,
+ * - notification templates: frames sent from a template, and the message
+ *   `whad_template_check()` decodes from it, carry the same message as the
+ *   equivalent builder, compared through their canonical NanoPb encoding,
+ * - fast-path decoders: commands, then every truncation and single byte
+ *   corruption of them, either decode to the same parameters as NanoPb and
+ *   the matching `_parse()` function, or are left to NanoPb (`WHAD_NONE`),
+ *   commands with reordered fields are decoded, commands preceded by another
+ *   field or overflowing a key, bool or varint are left to NanoPb,
+ * - capability index: `whad_cap_index_build()` answers like
+ *   `whad_discovery_is_domain_supported()` and
+ *   `whad_discovery_get_supported_commands()` for every domain and command,
+ * - capability cache: indexes stored and saved are loaded and looked up
+ *   unchanged, devices reporting another firmware version or other
+ *   capabilities are discovered again, and corrupted, truncated or missing
+ *   cache files leave the cache empty,
+ * - device description: a describe query is told from a device info query,
+ *   the response to it completes a capability index in one message, and a
+ *   plain response from older firmware gives `WHAD_NONE`, the index being
+ *   completed by domain info responses,
+ * - clock synchronization: exchanges with a simulated device, whose clock
+ *   drifts from the host one, give its offset and drift within the error
+ *   bound, replies delayed by queuing are left out of the estimate, and
+ *   replies to another query or to a timed out one are rejected,
+ * - binary logging: entries written with `whad_log_write()` are read back
+ *   from the log messages `whad_log_flush()` sends, in order, including
+ *   entries and batches wrapping around the end of the ring buffer, along
+ *   with the number of dropped entries, within the bandwidth budget,
+ * - PHY compatibility: `whad_phy_supported_frequencies()` copies the caller's
+ *   ranges and encodes like `whad_phy_supported_frequency_ranges()`.
+ *
+ * Usage: whad-test
+ *
+ * Exits with an error if a test fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "whad.h"
+#include "capcache.h"
+
+/* Bytes sent over the transport layer. */
+static uint8_t g_sent[2 * WHAD_MESSAGE_MAX_SIZE];
+static int g_sent_size = 0;
+
+/* Set to leave transmissions ongoing, as a busy link would do. */
+static bool g_send_hold = false;
+
+/* Arena receiving decoded callback fields. */
+static uint8_t g_arena_buf[1024];
+
+/* Canonical NanoPb encodings of the expected and tested messages. */
+static uint8_t g_expected[WHAD_MESSAGE_MAX_SIZE];
+static int g_expected_size = 0;
+static uint8_t g_encoded[WHAD_MESSAGE_MAX_SIZE];
+
+/* Fast-path decoders corpus entry. */
+static uint8_t g_corpus[WHAD_MESSAGE_MAX_SIZE + 2];
+
+/* Payloads sent by the encode paths tests, and their sizes. */
+static uint8_t g_payload[256];
+static const int g_payload_sizes[] = {0, 1, 37, 255};
+#define TEST_PAYLOAD_SIZES  ((int)(sizeof(g_payload_sizes) / sizeof(int)))
+
+/* Fast-path decoding outcome, compared with NanoPb. */
+typedef enum {
+    TEST_FAST_MATCH = 0,        /*!< Decoded, with the same parameters as NanoPb and `_parse()` */
+    TEST_FAST_FALLBACK,         /*!< Left to NanoPb */
+    TEST_FAST_MISMATCH          /*!< Decoded, but NanoPb fails or gives other parameters */
+} test_fast_result_t;
+
+/* Fast-path decoder wrapper, see `test_fast_corpus()`. */
+typedef test_fast_result_t (*test_fast_decoder_t)(uint8_t *p_message, int size);
+
+/* Number of failed checks. */
+static int g_failures = 0;
+
+#define TEST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);            \
+            g_failures++;                                                       \
+        }                                                                       \
+    } while (0)
+
+
+/**
+ * @brief   Transport send callback, records sent bytes and completes at once.
+ **/
+
+static void test_send_buffer(uint8_t *p_buffer, int size)
+{
+    if ((g_sent_size + size) <= (int)sizeof(g_sent))
+    {
+        memcpy(&g_sent[g_sent_size], p_buffer, size);
+        g_sent_size += size;
+    }
+    if (!g_send_hold)
+    {
+        whad_transport_data_sent();
+    }
+}
+
+
+/**
+ * @brief   Send every byte queued in the transport layer.
+ **/
+
+static void test_flush(void)
+{
+    while (whad_transport_send_pending() == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief   Send queued bytes and check they form a single frame.
+ *
+ * @param[in]   result      Result of the function queueing the frame
+ * @retval      true        A single frame has been sent
+ * @retval      false       Nothing sent, or not a single frame
+ **/
+
+static bool test_sent(whad_result_t result)
+{
+    if (result != WHAD_SUCCESS)
+    {
+        return false;
+    }
+    test_flush();
+
+    return ((g_sent_size >= 4) && (g_sent[0] == 0xAC) && (g_sent[1] == 0xBE) &&
+            (((g_sent[2] | (g_sent[3] << 8)) + 4) == g_sent_size));
+}
+
+
+/**
+ * @brief   Send a message and record the frame sent over the transport layer.
+ *
+ * @param[in]   p_msg       Message to send
+ * @retval      true        A single frame has been sent
+ * @retval      false       Nothing sent, or not a single frame
+ **/
+
+static bool test_send(Message *p_msg)
+{
+    g_sent_size = 0;
+    return test_sent(whad_send_message(p_msg));
+}
+
+
+/**
+ * @brief   Encode a message with NanoPb.
+ *
+ * @param[in]   p_msg       Message to encode
+ * @param[out]  p_buffer    Buffer of WHAD_MESSAGE_MAX_SIZE bytes
+ * @return      Encoded size in bytes, -1 on error.
+ **/
+
+static int test_encode(Message *p_msg, uint8_t *p_buffer)
+{
+    pb_ostream_t stream = pb_ostream_from_buffer(p_buffer, WHAD_MESSAGE_MAX_SIZE);
+
+    if (!pb_encode(&stream, Message_fields, p_msg))
+    {
+        return -1;
+    }
+
+    return (int)stream.bytes_written;
+}
+
+
+/**
+ * @brief   Set the message the next checks expect.
+ *
+ * @param[in]   result      Result of the builder
+ * @param[in]   p_msg       Message built
+ **/
+
+static void test_expect(whad_result_t result, Message *p_msg)
+{
+    TEST_CHECK(result == WHAD_SUCCESS);
+    g_expected_size = test_encode(p_msg, g_encoded);
+    TEST_CHECK(g_expected_size > 0);
+    memcpy(g_expected, g_encoded, (g_expected_size > 0) ? g_expected_size : 0);
+}
+
+
+/**
+ * @brief   Check a message matches the expected one, once re-encoded by NanoPb.
+ *
+ * @param[in]   p_msg       Message to check
+ * @retval      true        Message matches the expected one
+ * @retval      false       Message differs
+ **/
+
+static bool test_matches(Message *p_msg)
+{
+    int size = test_encode(p_msg, g_encoded);
+
+    return ((size == g_expected_size) && !memcmp(g_encoded, g_expected, size));
+}
+
+
+/**
+ * @brief   Check the recorded frame carries the expected message.
+ *
+ * @retval      true        Frame decoded and matching the expected message
+ * @retval      false       Frame cannot be decoded, or carries another message
+ **/
+
+static bool test_frame_matches(void)
+{
+    Message msg;
+
+    memset(&msg, 0, sizeof(msg));
+    if (whad_decode_message(&g_sent[4], g_sent_size - 4, &msg) != WHAD_SUCCESS)
+    {
+        return false;
+    }
+
+    return test_matches(&msg);
+}
+
+
+/**
+ * @brief   Check a template frame carries the expected message.
+ *
+ * Both the frame sent over the transport layer and the message
+ * `whad_template_check()` decodes from the template must match.
+ *
+ * @param[in]   p_template  Template the frame has been sent from
+ * @param[in]   p_payload   Payload sent
+ * @param[in]   length      Payload size in bytes
+ **/
+
+static void test_template_matches(whad_template_t *p_template, uint8_t *p_payload, int length)
+{
+    Message msg;
+
+    TEST_CHECK(test_frame_matches());
+
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_template_check(p_template, p_payload, length, &msg) == WHAD_SUCCESS);
+    TEST_CHECK(test_matches(&msg));
+}
+
+
+/**
+ * @brief   Make sure the recorded frame carries a trace extension.
+ *
+ * Frames sent by a library built with WHAD_TRACING already carry one,
+ * others get one appended, as `whad_tx_stream_close()` would do.
+ **/
+
+static void test_trace_frame(void)
+{
+    whad_trace_info_t info;
+    whad_wire_writer_t writer;
+    int size = g_sent_size - 4;
+
+    if (whad_trace_parse(&g_sent[4], size, &info) == WHAD_NONE)
+    {
+        whad_wire_writer_init(&writer, &g_sent[g_sent_size], sizeof(g_sent) - g_sent_size);
+        whad_trace_frame_start();
+        whad_trace_put_extension(&writer);
+        size += writer.offset;
+        g_sent[2] = size & 0xff;
+        g_sent[3] = (size >> 8) & 0xff;
+        g_sent_size += writer.offset;
+    }
+
+    TEST_CHECK(whad_trace_parse(&g_sent[4], size, &info) == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief   Feed the recorded bytes back to the transport layer.
+ **/
+
+static void test_loopback(void)
+{
+    TEST_CHECK(whad_transport_data_received(g_sent, g_sent_size) == WHAD_SUCCESS);
+}
+
+/**
+ * @brief   Reverse the order of the command fields of a serialized message.
+ *
+ * @param[in]   p_message   Serialized message, a command embedded in a domain message embedded in a `Message`
+ * @param[in]   size        Serialized message size in bytes
+ * @param[out]  p_reversed  Same message with command fields in reverse order
+ * @return      true on success, false if the message cannot be split into fields.
+ **/
+
+static bool test_reverse_fields(uint8_t *p_message, int size, uint8_t *p_reversed)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag;
+    uint8_t *p_data = p_message;
+    int data_size = size, offsets[16], count = 0, offset, i;
+
+    /* Locate command fields. */
+    for (i=0; i<2; i++)
+    {
+        whad_wire_reader_init(&reader, p_data, data_size);
+        if (!whad_wire_get_key(&reader, &tag, &wire_type) ||
+            !whad_wire_get_bytes(&reader, wire_type, &p_data, &data_size))
+        {
+            return false;
+        }
+    }
+
+    /* Split them. */
+    whad_wire_reader_init(&reader, p_data, data_size);
+    offsets[0] = 0;
+    while (reader.offset < reader.size)
+    {
+        if ((count == 15) || !whad_wire_get_key(&reader, &tag, &wire_type) ||
+            !whad_wire_skip_field(&reader, wire_type))
+        {
+            return false;
+        }
+        offsets[++count] = reader.offset;
+    }
+
+    /* Same headers, reversed fields. */
+    offset = (int)(p_data - p_message);
+    memcpy(p_reversed, p_message, offset);
+    for (i=count; i>0; i--)
+    {
+        memcpy(&p_reversed[offset], &p_data[offsets[i - 1]], offsets[i] - offsets[i - 1]);
+        offset += offsets[i] - offsets[i - 1];
+    }
+
+    return (offset == size);
+}
+
+
+/**
+ * @brief   Check a fast-path decoder against NanoPb on a command and its variants.
+ *
+ * The command itself, followed by an unknown field (as the tracing extension)
+ * or with its fields reordered, must be decoded. Preceded by an unknown
+ * field, it is left to NanoPb. Truncated, it must be left to NanoPb. With a
+ * corrupted byte, it must either be decoded as NanoPb does or be left to it.
+ *
+ * @param[in]   decoder     Fast-path decoder wrapper
+ * @param[in]   p_msg       Command
+ **/
+
+static void test_fast_corpus(test_fast_decoder_t decoder, Message *p_msg)
+{
+    uint8_t values[4];
+    int size, truncated = 0, mismatches = 0, i, j;
+
+    size = test_encode(p_msg, g_encoded);
+    TEST_CHECK(size > 0);
+    if (size <= 0)
+    {
+        return;
+    }
+
+    TEST_CHECK(decoder(g_encoded, size) == TEST_FAST_MATCH);
+
+    /* Unknown field after the command, then before. */
+    memcpy(g_corpus, g_encoded, size);
+    g_corpus[size] = (15 << 3) | PB_WT_VARINT;
+    g_corpus[size + 1] = 1;
+    TEST_CHECK(decoder(g_corpus, size + 2) == TEST_FAST_MATCH);
+    memcpy(&g_corpus[2], g_encoded, size);
+    g_corpus[0] = (15 << 3) | PB_WT_VARINT;
+    g_corpus[1] = 1;
+    TEST_CHECK(decoder(g_corpus, size + 2) == TEST_FAST_FALLBACK);
+
+    TEST_CHECK(test_reverse_fields(g_encoded, size, g_corpus));
+    TEST_CHECK(decoder(g_corpus, size) == TEST_FAST_MATCH);
+
+    for (i=0; i<size; i++)
+    {
+        if (decoder(g_encoded, i) != TEST_FAST_FALLBACK)
+        {
+            truncated++;
+        }
+
+        /* Cleared, set, wire type or tag altered, varint continuation toggled. */
+        values[0] = 0x00;
+        values[1] = 0xff;
+        values[2] = g_encoded[i] ^ 0x01;
+        values[3] = g_encoded[i] ^ 0x80;
+        for (j=0; j<4; j++)
+        {
+            memcpy(g_corpus, g_encoded, size);
+            g_corpus[i] = values[j];
+            if (decoder(g_corpus, size) == TEST_FAST_MISMATCH)
+            {
+                mismatches++;
+            }
+        }
+    }
+    TEST_CHECK(truncated == 0);
+    TEST_CHECK(mismatches == 0);
+}
+
+
+/**
+ * @brief   Traced messages with callback fields, decoded into an arena.
+ **/
+
+static void test_traced_arena(void)
+{
+    Message msg;
+    whad_arena_t arena;
+    char *psz_text = NULL;
+
+    printf("trace: verbose message decoded into an arena\n");
+
+    TEST_CHECK(whad_generic_verbose_message(&msg, "traced verbose message") == WHAD_SUCCESS);
+    TEST_CHECK(test_send(&msg));
+    test_trace_frame();
+    test_loopback();
+
+    whad_arena_init(&arena, g_arena_buf, sizeof(g_arena_buf));
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_get_message_arena(&msg, &arena) == WHAD_SUCCESS);
+    TEST_CHECK(whad_generic_verbose_message_parse(&msg, &psz_text) == WHAD_SUCCESS);
+    TEST_CHECK((psz_text != NULL) && !strcmp(psz_text, "traced verbose message"));
+}
+
+
+#if WHAD_ENABLE_BLE
+
+/**
+ * @brief   Traced commands decoded by a fast-path decoder.
+ **/
+
+static void test_traced_fast_path(void)
+{
+    Message msg;
+    whad_ble_pdu_params_t params;
+    uint8_t pdu[] = {0x02, 0x07, 0x03, 0x00, 0x04, 0x00, 0x0a, 0x03, 0x00};
+    uint8_t *p_message;
+    int size;
+
+    printf("trace: SendRawPDU command decoded by its fast-path decoder\n");
+
+    TEST_CHECK(whad_ble_send_raw_pdu(&msg, BLE_MASTER_TO_SLAVE, 1, 0x8e89bed6, pdu, sizeof(pdu), 0x123456,
+                                     false) == WHAD_SUCCESS);
+    TEST_CHECK(test_send(&msg));
+    test_trace_frame();
+    test_loopback();
+
+    TEST_CHECK(whad_get_raw_message(&p_message, &size) == WHAD_SUCCESS);
+    TEST_CHECK(whad_ble_send_raw_pdu_fast_parse(p_message, size, &params) == WHAD_SUCCESS);
+    TEST_CHECK(params.conn_handle == 1);
+    TEST_CHECK(params.access_address == 0x8e89bed6);
+    TEST_CHECK(params.crc == 0x123456);
+    TEST_CHECK((params.length == sizeof(pdu)) && !memcmp(params.p_pdu, pdu, sizeof(pdu)));
+
+    /* A second Message field replaces the first one, leave it to NanoPb. */
+    g_sent[g_sent_size++] = (Message_generic_tag << 3) | PB_WT_STRING;
+    g_sent[g_sent_size++] = 0;
+    TEST_CHECK(whad_ble_send_raw_pdu_fast_parse(&g_sent[4], g_sent_size - 4, &params) == WHAD_NONE);
+}
+
+#endif
+
+
+#if WHAD_ENABLE_BLE
+
+/**
+ * @brief   SendRawPDU fast-path decoding, compared with NanoPb.
+ **/
+
+static test_fast_result_t test_fast_ble_send_raw_pdu(uint8_t *p_message, int size)
+{
+    whad_ble_pdu_params_t fast, params;
+    Message msg;
+    whad_result_t result;
+
+    result = whad_ble_send_raw_pdu_fast_parse(p_message, size, &fast);
+    if (result != WHAD_SUCCESS)
+    {
+        return (result == WHAD_NONE) ? TEST_FAST_FALLBACK : TEST_FAST_MISMATCH;
+    }
+
+    if ((whad_decode_message(p_message, size, &msg) != WHAD_SUCCESS) || (msg.which_msg != Message_ble_tag) ||
+        (msg.msg.ble.which_msg != ble_Message_send_raw_pdu_tag) ||
+        (whad_ble_send_raw_pdu_parse(&msg, &params) != WHAD_SUCCESS))
+    {
+        return TEST_FAST_MISMATCH;
+    }
+
+    return ((fast.direction == params.direction) && (fast.conn_handle == params.conn_handle) &&
+            (fast.access_address == params.access_address) && (fast.crc == params.crc) &&
+            (fast.encrypt == params.encrypt) && (fast.length == params.length) &&
+            !memcmp(fast.p_pdu, params.p_pdu, fast.length)) ? TEST_FAST_MATCH : TEST_FAST_MISMATCH;
+}
+
+
+/**
+ * @brief   SendPDU fast-path decoding, compared with NanoPb.
+ **/
+
+static test_fast_result_t test_fast_ble_send_pdu(uint8_t *p_message, int size)
+{
+    whad_ble_pdu_params_t fast, params;
+    Message msg;
+    whad_result_t result;
+
+    result = whad_ble_send_pdu_fast_parse(p_message, size, &fast);
+    if (result != WHAD_SUCCESS)
+    {
+        return (result == WHAD_NONE) ? TEST_FAST_FALLBACK : TEST_FAST_MISMATCH;
+    }
+
+    if ((whad_decode_message(p_message, size, &msg) != WHAD_SUCCESS) || (msg.which_msg != Message_ble_tag) ||
+        (msg.msg.ble.which_msg != ble_Message_send_pdu_tag) ||
+        (whad_ble_send_pdu_parse(&msg, &params) != WHAD_SUCCESS))
+    {
+        return TEST_FAST_MISMATCH;
+    }
+
+    return ((fast.direction == params.direction) && (fast.conn_handle == params.conn_handle) &&
+            (fast.encrypt == params.encrypt) && (fast.length == params.length) &&
+            !memcmp(fast.p_pdu, params.p_pdu, fast.length)) ? TEST_FAST_MATCH : TEST_FAST_MISMATCH;
+}
+
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+
+/**
+ * @brief   802.15.4 SendRaw fast-path decoding, compared with NanoPb.
+ **/
+
+static test_fast_result_t test_fast_dot15d4_send_raw(uint8_t *p_message, int size)
+{
+    whad_dot15d4_send_fast_params_t fast;
+    whad_dot15d4_send_params_t params;
+    Message msg;
+    whad_result_t result;
+
+    result = whad_dot15d4_send_raw_fast_parse(p_message, size, &fast);
+    if (result != WHAD_SUCCESS)
+    {
+        return (result == WHAD_NONE) ? TEST_FAST_FALLBACK : TEST_FAST_MISMATCH;
+    }
+
+    if ((whad_decode_message(p_message, size, &msg) != WHAD_SUCCESS) || (msg.which_msg != Message_dot15d4_tag) ||
+        (msg.msg.dot15d4.which_msg != dot15d4_Message_send_raw_tag) ||
+        (whad_dot15d4_send_raw_parse(&msg, &params) != WHAD_SUCCESS))
+    {
+        return TEST_FAST_MISMATCH;
+    }
+
+    return ((fast.channel == params.channel) && (fast.fcs == params.fcs) &&
+            (fast.length == params.packet.length) &&
+            !memcmp(fast.p_pdu, params.packet.bytes, fast.length)) ? TEST_FAST_MATCH : TEST_FAST_MISMATCH;
+}
+
+#endif
+
+#if WHAD_ENABLE_ESB
+
+/**
+ * @brief   ESB Send fast-path decoding, compared with NanoPb.
+ **/
+
+static test_fast_result_t test_fast_esb_send(uint8_t *p_message, int size)
+{
+    whad_esb_send_fast_params_t fast;
+    whad_esb_send_params_t params;
+    Message msg;
+    whad_result_t result;
+
+    result = whad_esb_send_fast_parse(p_message, size, &fast);
+    if (result != WHAD_SUCCESS)
+    {
+        return (result == WHAD_NONE) ? TEST_FAST_FALLBACK : TEST_FAST_MISMATCH;
+    }
+
+    if ((whad_decode_message(p_message, size, &msg) != WHAD_SUCCESS) || (msg.which_msg != Message_esb_tag) ||
+        (msg.msg.esb.which_msg != esb_Message_send_tag) ||
+        (whad_esb_send_parse(&msg, &params) != WHAD_SUCCESS))
+    {
+        return TEST_FAST_MISMATCH;
+    }
+
+    return ((fast.channel == params.channel) && (fast.retr_count == params.retr_count) &&
+            (fast.length == params.packet.length) &&
+            !memcmp(fast.p_pdu, params.packet.bytes, fast.length)) ? TEST_FAST_MATCH : TEST_FAST_MISMATCH;
+}
+
+#endif
+
+#if WHAD_ENABLE_PHY
+
+/**
+ * @brief   PHY Send fast-path decoding, compared with NanoPb.
+ **/
+
+static test_fast_result_t test_fast_phy_send(uint8_t *p_message, int size)
+{
+    whad_phy_send_fast_params_t fast;
+    whad_phy_packet_t params;
+    Message msg;
+    whad_result_t result;
+
+    result = whad_phy_send_fast_parse(p_message, size, &fast);
+    if (result != WHAD_SUCCESS)
+    {
+        return (result == WHAD_NONE) ? TEST_FAST_FALLBACK : TEST_FAST_MISMATCH;
+    }
+
+    if ((whad_decode_message(p_message, size, &msg) != WHAD_SUCCESS) || (msg.which_msg != Message_phy_tag) ||
+        (msg.msg.phy.which_msg != phy_Message_send_tag) ||
+        (whad_phy_send_parse(&msg, &params) != WHAD_SUCCESS))
+    {
+        return TEST_FAST_MISMATCH;
+    }
+
+    return ((fast.length == params.length) &&
+            !memcmp(fast.p_payload, params.payload, fast.length)) ? TEST_FAST_MATCH : TEST_FAST_MISMATCH;
+}
+
+#endif
+
+
+/**
+ * @brief   Fast-path decoders compared with NanoPb on a corpus of commands.
+ **/
+
+static void test_fast_path(void)
+{
+    Message msg;
+    int i, length;
+#if WHAD_ENABLE_BLE
+    whad_ble_pdu_params_t params;
+
+    /* SendPDU commands NanoPb rejects: key, bool and varint overflows. */
+    uint8_t overflows[][15] = {
+        {(Message_ble_tag << 3) | PB_WT_STRING, 8, (ble_Message_send_pdu_tag << 3) | PB_WT_STRING, 6,
+         0x80, 0x80, 0x80, 0x80, 0x10, 0x00},
+        {(Message_ble_tag << 3) | PB_WT_STRING, 8, (ble_Message_send_pdu_tag << 3) | PB_WT_STRING, 6,
+         (ble_SendPDUCmd_encrypt_tag << 3) | PB_WT_VARINT, 0x80, 0x80, 0x80, 0x80, 0x10},
+        {(Message_ble_tag << 3) | PB_WT_STRING, 13, (ble_Message_send_pdu_tag << 3) | PB_WT_STRING, 11,
+         (ble_SendPDUCmd_conn_handle_tag << 3) | PB_WT_VARINT, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+         0x02}
+    };
+#endif
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        printf("fast path: commands with a %d-byte payload\n", length);
+
+        /* Zero scalars on the first commands, omitted by NanoPb. */
+#if WHAD_ENABLE_BLE
+        TEST_CHECK(whad_ble_send_raw_pdu(&msg, (i & 1) ? BLE_SLAVE_TO_MASTER : BLE_MASTER_TO_SLAVE, i,
+                                         0x8e89bed6 * (i > 0), g_payload, length, 0x123456 * i, (i > 1)) == WHAD_SUCCESS);
+        test_fast_corpus(test_fast_ble_send_raw_pdu, &msg);
+        TEST_CHECK(whad_ble_send_pdu(&msg, (i & 1) ? BLE_SLAVE_TO_MASTER : BLE_MASTER_TO_SLAVE, 0x1234 * i,
+                                     g_payload, length, (i > 1)) == WHAD_SUCCESS);
+        test_fast_corpus(test_fast_ble_send_pdu, &msg);
+#endif
+#if WHAD_ENABLE_DOT15D4
+        TEST_CHECK(whad_dot15d4_send_raw(&msg, 11 * (i > 0) + i, g_payload, length, 0xbeef * i) == WHAD_SUCCESS);
+        test_fast_corpus(test_fast_dot15d4_send_raw, &msg);
+#endif
+#if WHAD_ENABLE_ESB
+        TEST_CHECK(whad_esb_send(&msg, 8 * i, 3 * i, g_payload, length) == WHAD_SUCCESS);
+        test_fast_corpus(test_fast_esb_send, &msg);
+#endif
+#if WHAD_ENABLE_PHY
+        TEST_CHECK(whad_phy_send(&msg, g_payload, length) == WHAD_SUCCESS);
+        test_fast_corpus(test_fast_phy_send, &msg);
+#endif
+    }
+
+#if WHAD_ENABLE_BLE
+    printf("fast path: overflows left to NanoPb\n");
+    for (i=0; i<(int)(sizeof(overflows) / sizeof(overflows[0])); i++)
+    {
+        TEST_CHECK(whad_ble_send_pdu_fast_parse(overflows[i], overflows[i][1] + 2, &params) == WHAD_NONE);
+    }
+#endif
+}
+
+
+/**
+ * @brief   Check the recorded frame, sent as a compact message, carries the expected message.
+ *
+ * The message must be byte for byte the one NanoPb encodes, followed by a
+ * trace extension with WHAD_TRACING. Texts and log entries are callback
+ * fields, which `whad_decode_message()` skips: the frame is only checked to
+ * decode.
+ *
+ * @param[in]   sent        Result of `test_sent()`
+ **/
+
+static void test_compact_sent_matches(bool sent)
+{
+    Message msg;
+
+    TEST_CHECK(sent);
+    TEST_CHECK(g_sent_size == (g_expected_size + 4 + WHAD_TRACE_OVERHEAD));
+    TEST_CHECK(!memcmp(&g_sent[4], g_expected, g_expected_size));
+
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_decode_message(&g_sent[4], g_sent_size - 4, &msg) == WHAD_SUCCESS);
+}
+
+
+/* Build a message and its compact counterpart with the same parameters, then send the latter. */
+#define TEST_COMPACT(builder, ...)                                                      \
+    do {                                                                                \
+        memset(&msg, 0, sizeof(msg));                                                   \
+        test_expect(whad_##builder(&msg, ##__VA_ARGS__), &msg);                         \
+        memset(&compact, 0, sizeof(compact));                                           \
+        TEST_CHECK(whad_##builder##_compact(&compact, ##__VA_ARGS__) == WHAD_SUCCESS);  \
+        g_sent_size = 0;                                                                \
+        test_compact_sent_matches(test_sent(whad_send_compact_message(&compact)));      \
+    } while (0)
+
+
+/**
+ * @brief   Compact messages compared with their `Message` builders.
+ **/
+
+static void test_compact(void)
+{
+    Message msg;
+    whad_compact_msg_t compact;
+    whad_cmd_timing_t timing = {123456, 250, 37};
+    whad_domain_desc_t capabilities[] = {
+        {DOMAIN_BTLE, CAP_SCAN | CAP_SNIFF | CAP_INJECT, 0x3ffffff},
+        {DOMAIN_NONE, CAP_NONE, 0}
+    };
+    whad_log_entries_t entries;
+    char text[] = "compact message";
+    int i, length;
+#if WHAD_ENABLE_BLE
+    uint8_t channelmap[5] = {0xff, 0xff, 0xff, 0xff, 0x1f};
+    uint8_t bdaddr[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+#endif
+#if WHAD_ENABLE_DOT15D4
+    whad_dot15d4_recvd_packet_t dot15d4_pkt;
+#endif
+#if WHAD_ENABLE_ESB
+    whad_esb_recvd_packet_t esb_pkt;
+#endif
+
+    printf("compact: generic and discovery messages\n");
+
+    for (i=WHAD_RESULT_SUCCESS; i<=WHAD_RESULT_BUSY; i++)
+    {
+        TEST_COMPACT(generic_cmd_result, (whad_result_code_t)i);
+    }
+    TEST_COMPACT(generic_cmd_result_timed, WHAD_RESULT_SUCCESS, &timing);
+    TEST_COMPACT(generic_verbose_message, text);
+    TEST_COMPACT(generic_debug_message, 3, text);
+    TEST_COMPACT(generic_progress_message, 42);
+    TEST_COMPACT(generic_time_sync_reply, 7, 0x123456789ULL, 1000, 1250);
+
+    /* Log entries wrapping around the end of the log buffer. */
+    entries.p_first = &g_payload[200];
+    entries.first_size = 55;
+    entries.p_second = g_payload;
+    entries.second_size = 37;
+    TEST_COMPACT(generic_log_message, 5, &entries);
+
+    TEST_COMPACT(discovery_ready_resp);
+    TEST_COMPACT(discovery_domain_info_resp, DOMAIN_BTLE, capabilities);
+
+#if WHAD_ENABLE_BLE
+    printf("compact: BLE notifications\n");
+
+    TEST_COMPACT(ble_synchronized, 0x8e89bed6, 0x555555, 36, 7, channelmap);
+    TEST_COMPACT(ble_desynchronized, 0x8e89bed6);
+    TEST_COMPACT(ble_triggered, 3);
+    TEST_COMPACT(ble_hijacked, 0x8e89bed6, true);
+    TEST_COMPACT(ble_injected, 0x8e89bed6, 2, false);
+    TEST_COMPACT(ble_notify_disconnected, 1, 0x13);
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if (length > (int)sizeof(((ble_RawPduReceived *)0)->pdu.bytes))
+        {
+            continue;
+        }
+
+        /* Timestamps and CRC validity set on every other PDU, with varying scalars. */
+        TEST_COMPACT(ble_raw_pdu, 37 - i, -40 * i, 1, 0x8e89bed6, g_payload, length, 0x123456 * i, (i & 1),
+                     1000000 * i, 1250 * i, BLE_MASTER_TO_SLAVE, (i & 1), false, !(i & 1));
+
+        if (length > (int)sizeof(((ble_AdvPduReceived *)0)->adv_data.bytes))
+        {
+            continue;
+        }
+        TEST_COMPACT(ble_adv_pdu, BLE_ADV_IND, -40 * i, bdaddr, BLE_ADDR_RANDOM, g_payload, length);
+    }
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+    printf("compact: 802.15.4 notifications\n");
+
+    TEST_COMPACT(dot15d4_jammed, 123456);
+    TEST_COMPACT(dot15d4_energy_detect_sample, 123456, 200);
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if ((length > (int)sizeof(((dot15d4_PduReceived *)0)->pdu.bytes)) ||
+            (length > (int)sizeof(dot15d4_pkt.packet.bytes)))
+        {
+            continue;
+        }
+
+        /* Optional fields set on every other PDU. */
+        memset(&dot15d4_pkt, 0, sizeof(dot15d4_pkt));
+        dot15d4_pkt.channel = 11 + i;
+        dot15d4_pkt.has_rssi = !(i & 1);
+        dot15d4_pkt.rssi = -30 * i;
+        dot15d4_pkt.has_timestamp = (i & 1);
+        dot15d4_pkt.timestamp = 123456 * i;
+        dot15d4_pkt.has_fcs_validity = !(i & 1);
+        dot15d4_pkt.fcs_validity = (i > 1);
+        dot15d4_pkt.fcs = 0xbeef * i;
+        dot15d4_pkt.has_lqi = (i & 1);
+        dot15d4_pkt.lqi = 200;
+        memcpy(dot15d4_pkt.packet.bytes, g_payload, length);
+        dot15d4_pkt.packet.length = length;
+
+        TEST_COMPACT(dot15d4_pdu_received, &dot15d4_pkt);
+    }
+#endif
+
+#if WHAD_ENABLE_ESB
+    printf("compact: ESB notifications\n");
+
+    TEST_COMPACT(esb_jammed, 123456);
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if ((length > (int)sizeof(((esb_RawPduReceived *)0)->pdu.bytes)) ||
+            (length > (int)sizeof(esb_pkt.packet.bytes)))
+        {
+            continue;
+        }
+
+        /* Optional fields set on every other PDU. */
+        memset(&esb_pkt, 0, sizeof(esb_pkt));
+        esb_pkt.channel = 8 + i;
+        esb_pkt.has_rssi = (i & 1);
+        esb_pkt.rssi = -40 * i;
+        esb_pkt.has_timestamp = !(i & 1);
+        esb_pkt.timestamp = 123456 * i;
+        esb_pkt.has_crc_validity = (i & 1);
+        esb_pkt.crc_validity = (i > 1);
+        esb_pkt.has_address = !(i & 1);
+        memcpy(esb_pkt.address.address, "\xca\xfe\xba\xbe\x42", 5);
+        esb_pkt.address.size = 5;
+        memcpy(esb_pkt.packet.bytes, g_payload, length);
+        esb_pkt.packet.length = length;
+
+        TEST_COMPACT(esb_raw_pdu_received, &esb_pkt);
+    }
+#endif
+
+#if WHAD_ENABLE_UNIFYING
+    printf("compact: Unifying notifications\n");
+
+    TEST_COMPACT(unifying_jammed, 123456);
+#endif
+
+#if WHAD_ENABLE_PHY
+    printf("compact: PHY notifications\n");
+
+    TEST_COMPACT(phy_jammed, 12, 345678);
+    TEST_COMPACT(phy_sched_packet_sent, 4);
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if (length > (int)sizeof(((phy_SendCmd *)0)->packet.bytes))
+        {
+            continue;
+        }
+
+        TEST_COMPACT(phy_send, g_payload, length);
+    }
+#endif
+}
+
+
+/**
+ * @brief   Pre-encoded command results compared with their builder.
+ **/
+
+static void test_cmd_result_fast(void)
+{
+    Message msg;
+    int i, queued;
+
+    printf("generic: pre-encoded command results\n");
+
+    for (i=WHAD_RESULT_SUCCESS; i<=WHAD_RESULT_BUSY; i++)
+    {
+        memset(&msg, 0, sizeof(msg));
+        test_expect(whad_generic_cmd_result(&msg, (whad_result_code_t)i), &msg);
+
+        /* Message sent by the library... */
+        TEST_CHECK(test_send(&msg));
+        TEST_CHECK(g_sent_size == (g_expected_size + 4 + WHAD_TRACE_OVERHEAD));
+        TEST_CHECK(!memcmp(&g_sent[4], g_expected, g_expected_size));
+
+        /* ...and pre-encoded frame, which is never traced. */
+        g_sent_size = 0;
+        TEST_CHECK(test_sent(whad_send_cmd_result_fast((whad_result_code_t)i)));
+        TEST_CHECK(g_sent_size == (g_expected_size + 4));
+        TEST_CHECK(!memcmp(&g_sent[4], g_expected, g_expected_size));
+        TEST_CHECK(g_sent_size == ((i == WHAD_RESULT_SUCCESS) ? WHAD_CMD_RESULT_FRAME_MIN_SIZE :
+                                                                WHAD_CMD_RESULT_FRAME_MAX_SIZE));
+    }
+
+    /* Unknown result codes are not queued. */
+    queued = whad_transport_get_txbuf_size();
+    TEST_CHECK(whad_send_cmd_result_fast((whad_result_code_t)(WHAD_RESULT_BUSY + 1)) == WHAD_ERROR);
+    TEST_CHECK(whad_transport_get_txbuf_size() == queued);
+}
+
+
+/**
+ * @brief   Notification templates compared with their builders.
+ **/
+
+static void test_templates(void)
+{
+    whad_template_t tmpl;
+    Message msg;
+    int i, length;
+#if WHAD_ENABLE_DOT15D4
+    whad_dot15d4_recvd_packet_t dot15d4_pkt;
+#endif
+#if WHAD_ENABLE_ESB
+    whad_esb_recvd_packet_t esb_pkt;
+#endif
+#if WHAD_ENABLE_UNIFYING
+    whad_unifying_recvd_packet_t unifying_pkt;
+#endif
+#if WHAD_ENABLE_PHY
+    uint8_t syncword[4] = {0x8e, 0x89, 0xbe, 0xd6};
+#endif
+
+#if WHAD_ENABLE_BLE
+    printf("template: BLE RawPduReceived\n");
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if (length > (int)sizeof(((ble_RawPduReceived *)0)->pdu.bytes))
+        {
+            continue;
+        }
+
+        /* Timestamps and CRC validity set on every other PDU, with varying scalars. */
+        memset(&msg, 0, sizeof(msg));
+        test_expect(whad_ble_raw_pdu(&msg, 37 - i, -40 * i, 1, 0x8e89bed6, g_payload, length, 0x123456 * i,
+                                     (i & 1), 1000000 * i, 1250 * i, BLE_MASTER_TO_SLAVE, (i & 1), false,
+                                     !(i & 1)), &msg);
+        TEST_CHECK(whad_ble_raw_pdu_template(&tmpl, 1, 0x8e89bed6, BLE_MASTER_TO_SLAVE, (i & 1), false,
+                                             !(i & 1)) == WHAD_SUCCESS);
+        g_sent_size = 0;
+        TEST_CHECK(test_sent(whad_ble_raw_pdu_template_send(&tmpl, 37 - i, -40 * i, g_payload, length,
+                                                            0x123456 * i, (i & 1), 1000000 * i, 1250 * i)));
+        test_template_matches(&tmpl, g_payload, length);
+    }
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+    printf("template: 802.15.4 RawPduReceived\n");
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if ((length > (int)sizeof(((dot15d4_RawPduReceived *)0)->pdu.bytes)) ||
+            (length > (int)sizeof(dot15d4_pkt.packet.bytes)))
+        {
+            continue;
+        }
+
+        /* Optional fields set on every other PDU. */
+        memset(&dot15d4_pkt, 0, sizeof(dot15d4_pkt));
+        dot15d4_pkt.channel = 11 + i;
+        dot15d4_pkt.has_rssi = !(i & 1);
+        dot15d4_pkt.rssi = -30 * i;
+        dot15d4_pkt.has_timestamp = (i & 1);
+        dot15d4_pkt.timestamp = 123456 * i;
+        dot15d4_pkt.has_fcs_validity = !(i & 1);
+        dot15d4_pkt.fcs_validity = (i > 1);
+        dot15d4_pkt.fcs = 0xbeef * i;
+        dot15d4_pkt.has_lqi = (i & 1);
+        dot15d4_pkt.lqi = 200;
+        memcpy(dot15d4_pkt.packet.bytes, g_payload, length);
+        dot15d4_pkt.packet.length = length;
+
+        memset(&msg, 0, sizeof(msg));
+        test_expect(whad_dot15d4_raw_pdu_received(&msg, &dot15d4_pkt), &msg);
+        TEST_CHECK(whad_dot15d4_raw_pdu_template(&tmpl, &dot15d4_pkt) == WHAD_SUCCESS);
+        g_sent_size = 0;
+        TEST_CHECK(test_sent(whad_dot15d4_raw_pdu_template_send(&tmpl, &dot15d4_pkt)));
+        test_template_matches(&tmpl, dot15d4_pkt.packet.bytes, length);
+    }
+#endif
+
+#if WHAD_ENABLE_ESB
+    printf("template: ESB RawPduReceived\n");
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if ((length > (int)sizeof(((esb_RawPduReceived *)0)->pdu.bytes)) ||
+            (length > (int)sizeof(esb_pkt.packet.bytes)))
+        {
+            continue;
+        }
+
+        /* Optional fields set on every other PDU. */
+        memset(&esb_pkt, 0, sizeof(esb_pkt));
+        esb_pkt.channel = 8 + i;
+        esb_pkt.has_rssi = (i & 1);
+        esb_pkt.rssi = -40 * i;
+        esb_pkt.has_timestamp = !(i & 1);
+        esb_pkt.timestamp = 123456 * i;
+        esb_pkt.has_crc_validity = (i & 1);
+        esb_pkt.crc_validity = (i > 1);
+        esb_pkt.has_address = !(i & 1);
+        memcpy(esb_pkt.address.address, "\xca\xfe\xba\xbe\x42", 5);
+        esb_pkt.address.size = 5;
+        memcpy(esb_pkt.packet.bytes, g_payload, length);
+        esb_pkt.packet.length = length;
+
+        memset(&msg, 0, sizeof(msg));
+        test_expect(whad_esb_raw_pdu_received(&msg, &esb_pkt), &msg);
+        TEST_CHECK(whad_esb_raw_pdu_template(&tmpl, &esb_pkt) == WHAD_SUCCESS);
+        g_sent_size = 0;
+        TEST_CHECK(test_sent(whad_esb_raw_pdu_template_send(&tmpl, &esb_pkt)));
+        test_template_matches(&tmpl, esb_pkt.packet.bytes, length);
+    }
+#endif
+
+#if WHAD_ENABLE_UNIFYING
+    printf("template: Unifying RawPduReceived\n");
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if ((length > (int)sizeof(((unifying_RawPduReceived *)0)->pdu.bytes)) ||
+            (length > (int)sizeof(unifying_pkt.packet.bytes)))
+        {
+            continue;
+        }
+
+        /* Optional fields set on every other PDU. */
+        memset(&unifying_pkt, 0, sizeof(unifying_pkt));
+        unifying_pkt.channel = 5 + i;
+        unifying_pkt.has_rssi = !(i & 1);
+        unifying_pkt.rssi = -40 * i;
+        unifying_pkt.has_timestamp = (i & 1);
+        unifying_pkt.timestamp = 123456 * i;
+        unifying_pkt.has_crc_validity = !(i & 1);
+        unifying_pkt.crc_validity = (i > 1);
+        unifying_pkt.has_address = (i & 1);
+        memcpy(unifying_pkt.address.address, "\xca\xfe\xba\xbe\x42", 5);
+        unifying_pkt.address.size = 5;
+        memcpy(unifying_pkt.packet.bytes, g_payload, length);
+        unifying_pkt.packet.length = length;
+
+        memset(&msg, 0, sizeof(msg));
+        test_expect(whad_unifying_raw_pdu_received(&msg, &unifying_pkt), &msg);
+        TEST_CHECK(whad_unifying_raw_pdu_template(&tmpl, &unifying_pkt) == WHAD_SUCCESS);
+        g_sent_size = 0;
+        TEST_CHECK(test_sent(whad_unifying_raw_pdu_template_send(&tmpl, &unifying_pkt)));
+        test_template_matches(&tmpl, unifying_pkt.packet.bytes, length);
+    }
+#endif
+
+#if WHAD_ENABLE_PHY
+    printf("template: PHY PacketReceived\n");
+
+    for (i=0; i<TEST_PAYLOAD_SIZES; i++)
+    {
+        length = g_payload_sizes[i];
+        if (length > (int)sizeof(((phy_PacketReceived *)0)->packet.bytes))
+        {
+            continue;
+        }
+
+        /* No syncword on the first packet, templates always carry a timestamp. */
+        memset(&msg, 0, sizeof(msg));
+        test_expect(whad_phy_packet_received(&msg, 2402000000U + i, -40 * i, i + 1, 500 * i, g_payload, length,
+                                             syncword, (i > 0) ? 4 : 0, 250000, 1000000, PHY_LITTLE_ENDIAN,
+                                             MOD_GFSK), &msg);
+        TEST_CHECK(whad_phy_packet_received_template(&tmpl, syncword, (i > 0) ? 4 : 0, 250000, 1000000,
+                                                     PHY_LITTLE_ENDIAN, MOD_GFSK) == WHAD_SUCCESS);
+        g_sent_size = 0;
+        TEST_CHECK(test_sent(whad_phy_packet_received_template_send(&tmpl, 2402000000U + i, -40 * i, i + 1, 500 * i,
+                                                                    g_payload, length)));
+        test_template_matches(&tmpl, g_payload, length);
+    }
+#endif
+}
+
+
+/**
+ * @brief   Initialize the library, with or without a transport send callback.
+ **/
+
+static void test_init(bool send_callback)
+{
+    whad_transport_cfg_t transport;
+
+    transport.max_txbuf_size = WHAD_RINGBUF_MAX_SIZE;
+    transport.pfn_data_send_buffer = send_callback ? test_send_buffer : NULL;
+    whad_init(&transport);
+}
+
+
+/**
+ * @brief   Fill the TX buffer with verbose messages until one is rejected.
+ *
+ * @retval  Result of the rejected message
+ **/
+
+static whad_result_t test_fill_txbuf(void)
+{
+    Message msg;
+    whad_result_t result;
+    int queued;
+
+    do
+    {
+        queued = whad_transport_get_txbuf_size();
+        TEST_CHECK(whad_generic_verbose_message(&msg, "queued verbose message") == WHAD_SUCCESS);
+        result = whad_send_message(&msg);
+    } while (result == WHAD_SUCCESS);
+
+    /* Nothing of the rejected message must remain queued. */
+    TEST_CHECK(whad_transport_get_txbuf_size() == queued);
+    TEST_CHECK(queued > 0);
+
+    return result;
+}
+
+
+/**
+ * @brief   Frames queued all at once or not at all, oversize frames streamed.
+ **/
+
+static void test_txbuf(void)
+{
+    Message msg;
+    static char text[WHAD_RINGBUF_MAX_SIZE + 512];
+    int queued, size;
+
+    printf("transport: full TX buffer without send callback\n");
+
+    memset(text, 'A', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    test_init(false);
+    TEST_CHECK(test_fill_txbuf() == WHAD_RINGBUF_FULL);
+
+    /* Oversize frames cannot be streamed without a send callback. */
+    queued = whad_transport_get_txbuf_size();
+    TEST_CHECK(whad_generic_verbose_message(&msg, text) == WHAD_SUCCESS);
+    TEST_CHECK(whad_send_message(&msg) == WHAD_RINGBUF_FULL);
+    TEST_CHECK(whad_transport_get_txbuf_size() == queued);
+
+    printf("transport: full TX buffer while a transmission is ongoing\n");
+
+    /* Frames fitting in the TX buffer never wait for the ongoing transmission. */
+    test_init(true);
+    g_send_hold = true;
+    g_sent_size = 0;
+    TEST_CHECK(test_fill_txbuf() == WHAD_RINGBUF_FULL);
+    whad_transport_data_sent();
+    g_send_hold = false;
+    test_flush();
+    TEST_CHECK(whad_transport_get_txbuf_size() == 0);
+
+    printf("transport: frame larger than the TX buffer streamed through it\n");
+
+    TEST_CHECK(whad_generic_verbose_message(&msg, text) == WHAD_SUCCESS);
+    TEST_CHECK(test_send(&msg));
+    TEST_CHECK(g_sent_size > WHAD_RINGBUF_MAX_SIZE);
+    TEST_CHECK(whad_transport_get_txbuf_size() == 0);
+
+    /* The streamed frame is followed by regular frames. */
+    size = g_sent_size;
+    TEST_CHECK(whad_generic_verbose_message(&msg, "queued verbose message") == WHAD_SUCCESS);
+    TEST_CHECK(test_send(&msg));
+    TEST_CHECK(g_sent_size < size);
+}
+
+
+/* Log format strings, in the format strings section. */
+extern const char __start_whad_log_fmt[];
+static const char g_log_fmt[] __attribute__((section(WHAD_LOG_SECTION), used)) = "test entry %u %u %u";
+
+/* Log clock, in us. */
+static uint32_t g_log_clock = 0;
+
+
+/**
+ * @brief   Test log clock.
+ **/
+
+static uint32_t test_log_clock(void)
+{
+    return g_log_clock;
+}
+
+
+/**
+ * @brief   Write a test log entry, its arguments derived from its index.
+ *
+ * @param[in]   index       Entry index
+ * @retval  Result of `whad_log_write()`
+ **/
+
+static whad_result_t test_log_write(uint32_t index)
+{
+    uint32_t args[3] = {index, ~index, index * 7};
+
+    g_log_clock = 1000 * index;
+    return whad_log_write(WHAD_LOG_INFO, g_log_fmt, args, 3);
+}
+
+
+/**
+ * @brief   Flush pending log entries and check the log message carries the next ones.
+ *
+ * @param[in,out]   p_index     Index of the next expected entry, moved past the received ones
+ * @param[in]       dropped     Expected number of dropped entries
+ * @return  Number of entries received, -1 if no log message was sent.
+ **/
+
+static int test_log_flush(uint32_t *p_index, uint32_t dropped)
+{
+    Message msg;
+    whad_arena_t arena;
+    whad_log_entry_t entry;
+    uint8_t *p_entries = NULL;
+    uint32_t received_dropped = 0;
+    int size = 0, offset = 0, count = 0;
+    whad_result_t result;
+
+    g_sent_size = 0;
+    if (whad_log_flush() != WHAD_SUCCESS)
+    {
+        return -1;
+    }
+    test_flush();
+    test_loopback();
+
+    whad_arena_init(&arena, g_arena_buf, sizeof(g_arena_buf));
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_get_message_arena(&msg, &arena) == WHAD_SUCCESS);
+    TEST_CHECK(whad_generic_log_message_parse(&msg, &received_dropped, &p_entries, &size) == WHAD_SUCCESS);
+    TEST_CHECK(received_dropped == dropped);
+    TEST_CHECK(size <= WHAD_LOG_FLUSH_MAX_SIZE);
+
+    while ((result = whad_log_next_entry(p_entries, size, &offset, &entry)) == WHAD_SUCCESS)
+    {
+        TEST_CHECK(entry.id == (uint16_t)(g_log_fmt - __start_whad_log_fmt));
+        TEST_CHECK(entry.level == WHAD_LOG_INFO);
+        TEST_CHECK(entry.timestamp == (1000 * *p_index));
+        TEST_CHECK(entry.nargs == 3);
+        TEST_CHECK((entry.args[0] == *p_index) && (entry.args[1] == ~*p_index) && (entry.args[2] == (*p_index * 7)));
+        (*p_index)++;
+        count++;
+    }
+    TEST_CHECK(result == WHAD_NONE);
+
+    return count;
+}
+
+
+/**
+ * @brief   Binary log entries written, flushed and read back.
+ **/
+
+static void test_log(void)
+{
+    uint32_t written = 0, read = 0;
+    int i, batch;
+
+    printf("log: entries read back from log messages\n");
+
+    test_init(true);
+    whad_log_set_clock(test_log_clock);
+    whad_log_init();
+    whad_log_set_rate(0);
+    whad_log_set_level(WHAD_LOG_DEBUG);
+
+    TEST_CHECK(test_log_flush(&read, 0) == -1);
+    TEST_CHECK(test_log_write(written++) == WHAD_SUCCESS);
+    TEST_CHECK(test_log_flush(&read, 0) == 1);
+    TEST_CHECK(test_log_flush(&read, 0) == -1);
+
+    /* Filtered levels are not stored. */
+    whad_log_set_level(WHAD_LOG_WARNING);
+    TEST_CHECK(whad_log_write(WHAD_LOG_INFO, g_log_fmt, NULL, 0) == WHAD_NONE);
+    whad_log_set_level(WHAD_LOG_DEBUG);
+    TEST_CHECK(test_log_flush(&read, 0) == -1);
+
+    printf("log: entries wrapping around the ring buffer\n");
+
+    /* Single entries, then batches of 7 entries (35 words), crossing the end of the ring buffer several times. */
+    for (i=0; i<WHAD_LOG_RING_SIZE / 5 + 2; i++)
+    {
+        TEST_CHECK(test_log_write(written++) == WHAD_SUCCESS);
+        TEST_CHECK(test_log_flush(&read, 0) == 1);
+    }
+    for (i=0; i<(3 * WHAD_LOG_RING_SIZE) / 35; i++)
+    {
+        for (batch=0; batch<7; batch++)
+        {
+            TEST_CHECK(test_log_write(written++) == WHAD_SUCCESS);
+        }
+        TEST_CHECK(test_log_flush(&read, 0) == 7);
+    }
+    TEST_CHECK(read == written);
+
+    printf("log: dropped entries counted\n");
+
+    /* Fill the ring buffer, the entries that do not fit are dropped. */
+    for (i=0; i<WHAD_LOG_RING_SIZE / 5 + 3; i++)
+    {
+        TEST_CHECK(test_log_write(written) == ((i < WHAD_LOG_RING_SIZE / 5) ? WHAD_SUCCESS : WHAD_RINGBUF_FULL));
+        written += (i < WHAD_LOG_RING_SIZE / 5);
+    }
+    TEST_CHECK(whad_log_get_dropped() == 3);
+    while (test_log_flush(&read, 3) > 0);
+    TEST_CHECK(read == written);
+
+    /* Later drops are added to the count. */
+    for (i=0; i<WHAD_LOG_RING_SIZE / 5 + 1; i++)
+    {
+        written += (test_log_write(written) == WHAD_SUCCESS);
+    }
+    TEST_CHECK(whad_log_get_dropped() == 4);
+    while (test_log_flush(&read, 4) > 0);
+    TEST_CHECK(read == written);
+    TEST_CHECK(test_log_flush(&read, 4) == -1);
+
+    printf("log: bandwidth budget\n");
+
+    /* Budget of two full log messages (9 entries each) at 1000 bytes per second. */
+    whad_log_init();
+    whad_log_set_rate(1000);
+    written = read = 0;
+    for (i=0; i<4*9; i++)
+    {
+        TEST_CHECK(test_log_write(written++) == WHAD_SUCCESS);
+    }
+    g_log_clock = 0;
+    whad_log_set_clock(test_log_clock);
+    TEST_CHECK(test_log_flush(&read, 0) == 9);
+    TEST_CHECK(test_log_flush(&read, 0) == 9);
+    TEST_CHECK(test_log_flush(&read, 0) == -1);
+
+    /* 200-byte messages, 24 bytes left in the budget. */
+    g_log_clock += 175000;
+    TEST_CHECK(test_log_flush(&read, 0) == -1);
+    g_log_clock += 1000;
+    TEST_CHECK(test_log_flush(&read, 0) == 9);
+    g_log_clock += 200000;
+    TEST_CHECK(test_log_flush(&read, 0) == 9);
+    TEST_CHECK(read == written);
+
+    whad_log_set_rate(WHAD_LOG_DEFAULT_RATE);
+}
+
+
+/* Simulated device clock, running slower than the host one. */
+#define TEST_SYNC_HOST_START        (10000000000ULL)
+#define TEST_SYNC_DEVICE_START      (1000000ULL)
+#define TEST_SYNC_DRIFT             (40e-6)
+
+/* Device time spent between the query reception and the reply. */
+#define TEST_SYNC_PROCESSING        (30)
+
+
+/**
+ * @brief   Simulated device time at a given host time.
+ **/
+
+static uint64_t test_sync_device_time(uint64_t host_time)
+{
+    return TEST_SYNC_DEVICE_START + (uint64_t)((double)(host_time - TEST_SYNC_HOST_START) / (1.0 + TEST_SYNC_DRIFT));
+}
+
+
+/**
+ * @brief   Host time at a given simulated device time.
+ **/
+
+static uint64_t test_sync_host_time(uint64_t device_time)
+{
+    return TEST_SYNC_HOST_START + (uint64_t)((double)(device_time - TEST_SYNC_DEVICE_START) * (1.0 + TEST_SYNC_DRIFT));
+}
+
+
+/**
+ * @brief   Wait for the next clock synchronization query.
+ *
+ * @param[in,out]   p_sync      Clock synchronization state
+ * @param[in,out]   p_now       Host time, advanced until a query is due
+ * @param[out]      p_query     Query built
+ **/
+
+static void test_sync_poll(whad_clock_sync_t *p_sync, uint64_t *p_now, Message *p_query)
+{
+    while (whad_clock_sync_poll(p_sync, *p_now, p_query) == WHAD_NONE)
+    {
+        *p_now += 1000;
+    }
+}
+
+
+/**
+ * @brief   Answer a clock synchronization query as the simulated device.
+ *
+ * @param[in]   p_query     Query to answer
+ * @param[in]   up          Host to device delay
+ * @param[in]   down        Device to host delay, once the reply is queued
+ * @param[out]  p_reply     Reply built
+ * @return      Host time at which the reply is received.
+ **/
+
+static uint64_t test_sync_reply(Message *p_query, uint64_t up, uint64_t down, Message *p_reply)
+{
+    uint32_t sequence = 0;
+    uint64_t host_time = 0;
+    uint64_t rx_time;
+
+    TEST_CHECK(whad_generic_time_sync_query_parse(p_query, &sequence, &host_time) == WHAD_SUCCESS);
+    rx_time = test_sync_device_time(host_time + up);
+    TEST_CHECK(whad_generic_time_sync_reply(p_reply, sequence, host_time, rx_time,
+                                            rx_time + TEST_SYNC_PROCESSING) == WHAD_SUCCESS);
+
+    return test_sync_host_time(rx_time + TEST_SYNC_PROCESSING) + down;
+}
+
+
+/**
+ * @brief   Check device times are converted within the error bound.
+ *
+ * @param[in]   p_sync      Clock synchronization state
+ * @param[in]   host_time   Host time of the converted device time
+ * @param[in]   max_error   Largest error bound expected
+ **/
+
+static void test_sync_check(whad_clock_sync_t *p_sync, uint64_t host_time, uint64_t max_error)
+{
+    uint64_t converted = 0, error = 0;
+    uint64_t device_time = test_sync_device_time(host_time);
+    int64_t diff;
+
+    TEST_CHECK(whad_clock_sync_to_host(p_sync, device_time, &converted, &error) == WHAD_SUCCESS);
+    diff = (int64_t)(converted - host_time);
+    TEST_CHECK((diff <= (int64_t)error) && (-diff <= (int64_t)error));
+    TEST_CHECK(error <= max_error);
+
+    TEST_CHECK(whad_clock_sync_to_host32(p_sync, (uint32_t)device_time, &converted, NULL) == WHAD_SUCCESS);
+    diff = (int64_t)(converted - host_time);
+    TEST_CHECK((diff <= (int64_t)error) && (-diff <= (int64_t)error));
+}
+
+
+/**
+ * @brief   Clock synchronization against a simulated drifting device.
+ **/
+
+static void test_clock_sync(void)
+{
+    whad_clock_sync_t sync;
+    whad_clock_sync_estimate_t estimate;
+    Message query, reply;
+    uint64_t now = TEST_SYNC_HOST_START;
+    uint64_t arrival;
+    uint32_t sequence;
+    int i;
+
+    printf("clocksync: offset and drift of a drifting device\n");
+
+    whad_clock_sync_init(&sync, 0);
+    TEST_CHECK(whad_clock_sync_get_estimate(&sync, &estimate) == WHAD_NONE);
+
+    /* Symmetric delays, with some jitter. */
+    for (i=0; i<2*WHAD_CLOCK_SYNC_SAMPLES; i++)
+    {
+        test_sync_poll(&sync, &now, &query);
+        arrival = test_sync_reply(&query, 150 + (i*37) % 50, 150 + (i*53) % 50, &reply);
+        TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_SUCCESS);
+        now = arrival;
+    }
+    TEST_CHECK(whad_clock_sync_get_estimate(&sync, &estimate) == WHAD_SUCCESS);
+    TEST_CHECK(estimate.samples == WHAD_CLOCK_SYNC_SAMPLES);
+    TEST_CHECK((estimate.drift > (TEST_SYNC_DRIFT - 1e-6)) && (estimate.drift < (TEST_SYNC_DRIFT + 1e-6)));
+    test_sync_check(&sync, now, 300);
+    test_sync_check(&sync, now + 10000000, 600);
+
+    printf("clocksync: replies delayed by queuing left out\n");
+
+    /* Reply waiting 20 ms in the device TX buffer, which would skew the offset by 10 ms. */
+    test_sync_poll(&sync, &now, &query);
+    arrival = test_sync_reply(&query, 150, 150 + 20000, &reply);
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_SUCCESS);
+    now = arrival;
+    TEST_CHECK(whad_clock_sync_get_estimate(&sync, &estimate) == WHAD_SUCCESS);
+    TEST_CHECK(estimate.samples == (WHAD_CLOCK_SYNC_SAMPLES - 1));
+    test_sync_check(&sync, now, 300);
+
+    printf("clocksync: replies to another query rejected\n");
+
+    test_sync_poll(&sync, &now, &query);
+    TEST_CHECK(whad_generic_time_sync_query_parse(&query, &sequence, &arrival) == WHAD_SUCCESS);
+    arrival = test_sync_reply(&query, 150, 150, &reply);
+
+    /* Other sequence number or host time, then a message that is not a reply. */
+    reply.msg.generic.msg.time_sync_reply.sequence = sequence + 1;
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_ERROR);
+    reply.msg.generic.msg.time_sync_reply.sequence = sequence;
+    reply.msg.generic.msg.time_sync_reply.host_time--;
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_ERROR);
+    reply.msg.generic.msg.time_sync_reply.host_time++;
+    TEST_CHECK(whad_generic_progress_message(&query, 42) == WHAD_SUCCESS);
+    TEST_CHECK(whad_clock_sync_process(&sync, &query, arrival) == WHAD_NONE);
+
+    /* The query is still in flight. */
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_SUCCESS);
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_ERROR);
+    now = arrival;
+
+    printf("clocksync: lost query timed out\n");
+
+    test_sync_poll(&sync, &now, &query);
+    TEST_CHECK(whad_generic_time_sync_query_parse(&query, &sequence, &arrival) == WHAD_SUCCESS);
+    arrival = test_sync_reply(&query, 150, 150, &reply);
+
+    /* The reply is considered lost after the timeout, the next query is sent on the next period. */
+    TEST_CHECK(whad_clock_sync_poll(&sync, now + WHAD_CLOCK_SYNC_TIMEOUT_US - 1, &query) == WHAD_NONE);
+    now += WHAD_CLOCK_SYNC_TIMEOUT_US;
+    TEST_CHECK(whad_clock_sync_poll(&sync, now, &query) == WHAD_NONE);
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, now) == WHAD_ERROR);
+    test_sync_poll(&sync, &now, &query);
+
+    /* Late reply to the lost query, then reply to the new one. */
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, now + 10) == WHAD_ERROR);
+    arrival = test_sync_reply(&query, 150, 150, &reply);
+    TEST_CHECK(reply.msg.generic.msg.time_sync_reply.sequence == (sequence + 1));
+    TEST_CHECK(whad_clock_sync_process(&sync, &reply, arrival) == WHAD_SUCCESS);
+    test_sync_check(&sync, arrival, 300);
+}
+
+
+#if WHAD_ENABLE_PHY
+/**
+ * @brief   Copying and referencing supported frequencies builders encode alike.
+ **/
+
+static void test_phy_supported_frequencies(void)
+{
+    Message msg;
+    whad_phy_frequency_range_t list[2] = {{2400000000, 2500000000}, {868000000, 869000000}};
+    whad_phy_frequency_range_t copied[2];
+    whad_phy_frequency_ranges_t ranges = {list, 2};
+
+    printf("phy: supported frequencies copied or referenced\n");
+
+    memset(&msg, 0, sizeof(msg));
+    test_expect(whad_phy_supported_frequency_ranges(&msg, &ranges), &msg);
+
+    /* Copied ranges are encoded once the caller's ones are gone. */
+    memcpy(copied, list, sizeof(copied));
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_phy_supported_frequencies(&msg, copied, 2) == WHAD_SUCCESS);
+    memset(copied, 0, sizeof(copied));
+    TEST_CHECK(test_matches(&msg));
+
+    TEST_CHECK(whad_phy_supported_frequencies(&msg, list, WHAD_PHY_MAX_FREQUENCY_RANGES + 1) == WHAD_ERROR);
+    whad_phy_message_free(&msg);
+}
+#endif
+
+
+/**
+ * @brief   Received messages too large for the RX buffer are rejected.
+ **/
+
+static void test_oversize_message(void)
+{
+    Message msg;
+    uint8_t *p_message;
+    uint8_t chunk[256];
+    int remaining = WHAD_MESSAGE_MAX_SIZE + 1;
+    int size, errors = 0;
+
+    printf("transport: oversize message rejected with an error result\n");
+
+    test_init(true);
+    g_sent_size = 0;
+    chunk[0] = 0xAC;
+    chunk[1] = 0xBE;
+    chunk[2] = remaining & 0xff;
+    chunk[3] = (remaining >> 8) & 0xff;
+    TEST_CHECK(whad_transport_data_received(chunk, 4) == WHAD_SUCCESS);
+
+    /* Message bytes are dropped as they are received. */
+    memset(chunk, 0x55, sizeof(chunk));
+    while (remaining > 0)
+    {
+        size = (remaining > (int)sizeof(chunk)) ? (int)sizeof(chunk) : remaining;
+        TEST_CHECK(whad_transport_data_received(chunk, size) == WHAD_SUCCESS);
+        remaining -= size;
+        errors += (whad_get_raw_message(&p_message, &size) == WHAD_ERROR);
+    }
+    TEST_CHECK(errors == 1);
+    TEST_CHECK(whad_get_raw_message(&p_message, &size) == WHAD_NONE);
+
+    /* A single error result has been sent. */
+    test_expect(whad_generic_cmd_result(&msg, WHAD_RESULT_ERROR), &msg);
+    TEST_CHECK(test_sent(WHAD_SUCCESS));
+    TEST_CHECK(test_frame_matches());
+
+    /* Next messages are received. */
+    test_loopback();
+    TEST_CHECK(whad_get_raw_message(&p_message, &size) == WHAD_SUCCESS);
+    TEST_CHECK((size == g_expected_size) && !memcmp(p_message, g_expected, size));
+}
+
+
+/* Firmware capabilities, with commands up to the 64th one. */
+static whad_domain_desc_t g_test_capabilities[] = {
+    {DOMAIN_PHY, CAP_SNIFF | CAP_INJECT | CAP_JAM, 0x7ffffff},
+    {DOMAIN_BTLE, CAP_SCAN | CAP_SNIFF | CAP_INJECT | CAP_JAM | CAP_HIJACK, 0x3ffffff},
+    {DOMAIN_DOT15D4, CAP_SNIFF | CAP_INJECT, 0x8000000000000005ULL},
+    {DOMAIN_ESB, CAP_SNIFF | CAP_NO_RAW_DATA, 0x1},
+    {DOMAIN_ANT_FS, CAP_SIMULATE_ROLE | CAP_HOOK, 0xffffffffffffffffULL},
+    {DOMAIN_NONE, CAP_NONE, 0}
+};
+
+/* Domains checked: every known domain, then unknown ones. */
+static const uint32_t g_test_domains[] = {
+    DOMAIN_PHY, DOMAIN_BT_CLASSIC, DOMAIN_BTLE, DOMAIN_DOT15D4, DOMAIN_SIXLOWPAN, DOMAIN_ESB,
+    DOMAIN_LOGITECH_UNIFYING, DOMAIN_MOSART, DOMAIN_ANT, DOMAIN_ANT_PLUS, DOMAIN_ANT_FS,
+    0x0C000000, 0xFF000000, 0x03000001, 0x00000001
+};
+#define TEST_DOMAINS    ((int)(sizeof(g_test_domains) / sizeof(uint32_t)))
+
+
+/**
+ * @brief   Get the capabilities of a domain from a list of domain descriptions.
+ **/
+
+static uint8_t test_capabilities_get(const whad_domain_desc_t *p_capabilities, whad_domain_t domain)
+{
+    for (; p_capabilities->domain != DOMAIN_NONE; p_capabilities++)
+    {
+        if (p_capabilities->domain == domain)
+        {
+            return (uint8_t)p_capabilities->cap;
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief   Check a capability index answers like a list of domain descriptions.
+ *
+ * @param[in]   p_index         Capability index
+ * @param[in]   p_capabilities  Domain descriptions the index has been built from
+ **/
+
+static void test_cap_index_matches(const whad_cap_index_t *p_index, whad_domain_desc_t *p_capabilities)
+{
+    whad_domain_t domain;
+    uint64_t commands;
+    int i;
+    uint32_t command;
+
+    for (i=0; i<TEST_DOMAINS; i++)
+    {
+        domain = (whad_domain_t)g_test_domains[i];
+        commands = whad_discovery_get_supported_commands(domain, p_capabilities);
+
+        TEST_CHECK(whad_cap_index_is_domain_supported(p_index, domain) ==
+                   whad_discovery_is_domain_supported(p_capabilities, domain));
+        TEST_CHECK(whad_cap_index_get_supported_commands(p_index, domain) == commands);
+        TEST_CHECK(whad_cap_index_get_capabilities(p_index, domain) == test_capabilities_get(p_capabilities, domain));
+        for (command=0; command<70; command++)
+        {
+            TEST_CHECK(whad_cap_index_is_command_supported(p_index, domain, command) ==
+                       ((command < 64) && ((commands >> command) & 1)));
+        }
+    }
+}
+
+
+/**
+ * @brief   Capability index compared with the domain descriptions list.
+ **/
+
+static void test_cap_index(void)
+{
+    whad_cap_index_t index;
+    whad_domain_desc_t none[] = {{DOMAIN_NONE, CAP_NONE, 0}};
+    whad_domain_desc_t unknown[] = {
+        {DOMAIN_BTLE, CAP_SNIFF, 0x1},
+        {(whad_domain_t)0x0C000000, CAP_SNIFF, 0x1},
+        {DOMAIN_NONE, CAP_NONE, 0}
+    };
+
+    printf("discovery: capability index\n");
+
+    TEST_CHECK(whad_cap_index_build(&index, g_test_capabilities) == WHAD_SUCCESS);
+    test_cap_index_matches(&index, g_test_capabilities);
+    TEST_CHECK(whad_cap_index_build(&index, none) == WHAD_SUCCESS);
+    test_cap_index_matches(&index, none);
+
+    /* Domains the index cannot hold are rejected. */
+    TEST_CHECK(whad_cap_index_build(&index, unknown) == WHAD_ERROR);
+    TEST_CHECK(whad_cap_index_build(NULL, g_test_capabilities) == WHAD_ERROR);
+    TEST_CHECK(whad_cap_index_build(&index, NULL) == WHAD_ERROR);
+}
+
+
+/* Capability cache file, and caches saved and loaded. */
+#define TEST_CAP_CACHE_PATH     P_tmpdir "/whad-test.capcache"
+static whad_cap_cache_t g_cap_cache;
+static whad_cap_cache_t g_cap_cache_loaded;
+
+
+/**
+ * @brief   Build a device info response decoded into the arena, as received by a host.
+ *
+ * @param[out]  p_msg           Decoded device info response
+ * @param[in]   psz_devid       Device ID
+ * @param[in]   fw_version_rev  Firmware revision
+ * @param[in]   p_capabilities  Firmware capabilities
+ * @param[in]   describe        Describe the supported commands of every domain
+ **/
+
+static void test_device_info(Message *p_msg, const char *psz_devid, uint32_t fw_version_rev,
+                             whad_domain_desc_t *p_capabilities, bool describe)
+{
+    static whad_arena_t arena;
+    static uint8_t encoded[WHAD_MESSAGE_MAX_SIZE];
+    uint8_t devid[WHAD_CAP_CACHE_DEVID_SIZE];
+    Message msg;
+    int size;
+
+    memset(devid, 0, sizeof(devid));
+    strncpy((char *)devid, psz_devid, sizeof(devid) - 1);
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_discovery_device_info_resp(&msg, discovery_DeviceType_VirtualDevice, devid, 1, 115200,
+                                               "whad", "https://whad.io", 1, 2, fw_version_rev,
+                                               p_capabilities) == WHAD_SUCCESS);
+    if (describe)
+    {
+        TEST_CHECK(whad_discovery_device_info_resp_add_domains(&msg, p_capabilities) == WHAD_SUCCESS);
+    }
+    size = test_encode(&msg, encoded);
+
+    whad_arena_init(&arena, g_arena_buf, sizeof(g_arena_buf));
+    memset(p_msg, 0, sizeof(Message));
+    TEST_CHECK(whad_decode_message_arena(encoded, size, p_msg, &arena) == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief   Flip a byte of the capability cache file.
+ *
+ * @param[in]   offset      Byte offset, from the end of the file if negative
+ **/
+
+static void test_cap_cache_corrupt(long offset)
+{
+    FILE *p_file = fopen(TEST_CAP_CACHE_PATH, "r+b");
+    int value;
+
+    TEST_CHECK(p_file != NULL);
+    if (p_file == NULL)
+    {
+        return;
+    }
+
+    TEST_CHECK(fseek(p_file, offset, (offset < 0) ? SEEK_END : SEEK_SET) == 0);
+    value = fgetc(p_file);
+    TEST_CHECK(value != EOF);
+    TEST_CHECK(fseek(p_file, -1, SEEK_CUR) == 0);
+    fputc(value ^ 0x01, p_file);
+    fclose(p_file);
+}
+
+
+/**
+ * @brief   Capability cache saved, loaded and looked up.
+ **/
+
+static void test_cap_cache(void)
+{
+    whad_domain_desc_t other[] = {
+        {DOMAIN_BTLE, CAP_SCAN | CAP_SNIFF, 0x3},
+        {DOMAIN_NONE, CAP_NONE, 0}
+    };
+    whad_domain_desc_t changed[] = {
+        {DOMAIN_PHY, CAP_SNIFF | CAP_INJECT | CAP_JAM, 0x7ffffff},
+        {DOMAIN_BTLE, CAP_SCAN | CAP_SNIFF, 0x3ffffff},
+        {DOMAIN_DOT15D4, CAP_SNIFF | CAP_INJECT, 0x8000000000000005ULL},
+        {DOMAIN_ESB, CAP_SNIFF | CAP_NO_RAW_DATA, 0x1},
+        {DOMAIN_ANT_FS, CAP_SIMULATE_ROLE | CAP_HOOK, 0xffffffffffffffffULL},
+        {DOMAIN_NONE, CAP_NONE, 0}
+    };
+    whad_cap_index_t index;
+    whad_cap_index_t other_index;
+    Message msg;
+
+    printf("discovery: capability cache\n");
+
+    /* Two devices discovered, then saved. */
+    whad_cap_cache_init(&g_cap_cache);
+    TEST_CHECK(whad_cap_index_build(&index, g_test_capabilities) == WHAD_SUCCESS);
+    test_device_info(&msg, "test-device-1", 3, g_test_capabilities, false);
+    TEST_CHECK(whad_cap_cache_lookup(&g_cap_cache, &msg, &index) == WHAD_NONE);
+    TEST_CHECK(whad_cap_cache_store(&g_cap_cache, &msg, &index) == WHAD_SUCCESS);
+    TEST_CHECK(whad_cap_index_build(&other_index, other) == WHAD_SUCCESS);
+    test_device_info(&msg, "test-device-2", 3, other, false);
+    TEST_CHECK(whad_cap_cache_store(&g_cap_cache, &msg, &other_index) == WHAD_SUCCESS);
+    TEST_CHECK(g_cap_cache.modified);
+    TEST_CHECK(whad_cap_cache_save(&g_cap_cache, TEST_CAP_CACHE_PATH) == WHAD_SUCCESS);
+    TEST_CHECK(!g_cap_cache.modified);
+
+    /* Loaded indexes answer like the firmware capabilities. */
+    TEST_CHECK(whad_cap_cache_load(&g_cap_cache_loaded, TEST_CAP_CACHE_PATH) == WHAD_SUCCESS);
+    TEST_CHECK(g_cap_cache_loaded.count == 2);
+    test_device_info(&msg, "test-device-1", 3, g_test_capabilities, false);
+    memset(&index, 0, sizeof(index));
+    TEST_CHECK(whad_cap_cache_lookup(&g_cap_cache_loaded, &msg, &index) == WHAD_SUCCESS);
+    test_cap_index_matches(&index, g_test_capabilities);
+    test_device_info(&msg, "test-device-2", 3, other, false);
+    memset(&index, 0, sizeof(index));
+    TEST_CHECK(whad_cap_cache_lookup(&g_cap_cache_loaded, &msg, &index) == WHAD_SUCCESS);
+    test_cap_index_matches(&index, other);
+
+    /* Another firmware version, or other capabilities, are discovered again. */
+    test_device_info(&msg, "test-device-1", 4, g_test_capabilities, false);
+    TEST_CHECK(whad_cap_cache_lookup(&g_cap_cache_loaded, &msg, &index) == WHAD_NONE);
+    test_device_info(&msg, "test-device-1", 3, changed, false);
+    TEST_CHECK(whad_cap_cache_lookup(&g_cap_cache_loaded, &msg, &index) == WHAD_NONE);
+    test_device_info(&msg, "test-device-1", 3, other, false);
+    TEST_CHECK(whad_cap_cache_lookup(&g_cap_cache_loaded, &msg, &index) == WHAD_NONE);
+
+    /* Corrupted hash. */
+    test_cap_cache_corrupt(-1);
+    TEST_CHECK(whad_cap_cache_load(&g_cap_cache_loaded, TEST_CAP_CACHE_PATH) == WHAD_ERROR);
+    TEST_CHECK(g_cap_cache_loaded.count == 0);
+
+    /* Corrupted firmware revision of the first entry. */
+    TEST_CHECK(whad_cap_cache_save(&g_cap_cache, TEST_CAP_CACHE_PATH) == WHAD_SUCCESS);
+    test_cap_cache_corrupt(WHAD_CAP_CACHE_HEADER_SIZE + WHAD_CAP_CACHE_DEVID_SIZE + 8);
+    TEST_CHECK(whad_cap_cache_load(&g_cap_cache_loaded, TEST_CAP_CACHE_PATH) == WHAD_ERROR);
+    TEST_CHECK(g_cap_cache_loaded.count == 0);
+
+    /* Other cache version. */
+    TEST_CHECK(whad_cap_cache_save(&g_cap_cache, TEST_CAP_CACHE_PATH) == WHAD_SUCCESS);
+    test_cap_cache_corrupt(8);
+    TEST_CHECK(whad_cap_cache_load(&g_cap_cache_loaded, TEST_CAP_CACHE_PATH) == WHAD_ERROR);
+    TEST_CHECK(g_cap_cache_loaded.count == 0);
+
+    /* Truncated file. */
+    TEST_CHECK(whad_cap_cache_save(&g_cap_cache, TEST_CAP_CACHE_PATH) == WHAD_SUCCESS);
+    TEST_CHECK(truncate(TEST_CAP_CACHE_PATH, WHAD_CAP_CACHE_HEADER_SIZE + 4) == 0);
+    TEST_CHECK(whad_cap_cache_load(&g_cap_cache_loaded, TEST_CAP_CACHE_PATH) == WHAD_ERROR);
+    TEST_CHECK(g_cap_cache_loaded.count == 0);
+
+    /* Missing file. */
+    TEST_CHECK(remove(TEST_CAP_CACHE_PATH) == 0);
+    TEST_CHECK(whad_cap_cache_load(&g_cap_cache_loaded, TEST_CAP_CACHE_PATH) == WHAD_NONE);
+    TEST_CHECK(g_cap_cache_loaded.count == 0);
+}
+
+
+/**
+ * @brief   Device description, and its fallback for older firmware.
+ **/
+
+static void test_describe(void)
+{
+    whad_cap_index_t index;
+    whad_arena_t arena;
+    Message msg;
+    uint8_t encoded[WHAD_MESSAGE_MAX_SIZE];
+    int size;
+    int i;
+
+    printf("discovery: device description\n");
+
+    /* Describe queries, told from device info queries. */
+    TEST_CHECK(whad_discovery_device_describe_query(&msg, 2) == WHAD_SUCCESS);
+    size = test_encode(&msg, encoded);
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_decode_message(encoded, size, &msg) == WHAD_SUCCESS);
+    TEST_CHECK(whad_discovery_device_info_query_is_describe(&msg));
+    TEST_CHECK(whad_discovery_device_info_query(&msg, 2) == WHAD_SUCCESS);
+    size = test_encode(&msg, encoded);
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_decode_message(encoded, size, &msg) == WHAD_SUCCESS);
+    TEST_CHECK(!whad_discovery_device_info_query_is_describe(&msg));
+
+    /* Described in a single response. */
+    test_device_info(&msg, "test-device-1", 3, g_test_capabilities, true);
+    whad_cap_index_init(&index);
+    TEST_CHECK(whad_cap_index_add_device_description(&index, &msg) == WHAD_SUCCESS);
+    test_cap_index_matches(&index, g_test_capabilities);
+
+    /* Older firmware: no domains described, then one domain info response per domain. */
+    test_device_info(&msg, "test-device-1", 3, g_test_capabilities, false);
+    whad_cap_index_init(&index);
+    TEST_CHECK(whad_cap_index_add_device_description(&index, &msg) == WHAD_NONE);
+    for (i=0; g_test_capabilities[i].domain != DOMAIN_NONE; i++)
+    {
+        TEST_CHECK(whad_cap_index_get_capabilities(&index, g_test_capabilities[i].domain) ==
+                   g_test_capabilities[i].cap);
+        TEST_CHECK(whad_cap_index_get_supported_commands(&index, g_test_capabilities[i].domain) == 0);
+
+        TEST_CHECK(whad_discovery_domain_info_resp(&msg, g_test_capabilities[i].domain,
+                                                   g_test_capabilities) == WHAD_SUCCESS);
+        size = test_encode(&msg, encoded);
+        memset(&msg, 0, sizeof(msg));
+        TEST_CHECK(whad_decode_message(encoded, size, &msg) == WHAD_SUCCESS);
+        TEST_CHECK(whad_cap_index_add_domain_info(&index, &msg) == WHAD_SUCCESS);
+    }
+    test_cap_index_matches(&index, g_test_capabilities);
+
+    /* Responses not decoded into an arena cannot be indexed. */
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_discovery_device_info_resp(&msg, discovery_DeviceType_VirtualDevice, (uint8_t *)"test-device-1",
+                                               1, 115200, NULL, NULL, 1, 2, 3, g_test_capabilities) == WHAD_SUCCESS);
+    TEST_CHECK(whad_discovery_device_info_resp_add_domains(&msg, g_test_capabilities) == WHAD_SUCCESS);
+    size = test_encode(&msg, encoded);
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_decode_message(encoded, size, &msg) == WHAD_SUCCESS);
+    whad_cap_index_init(&index);
+    TEST_CHECK(whad_cap_index_add_device_description(&index, &msg) == WHAD_NONE);
+    whad_free_message_resources(&msg);
+
+    /* The same response, decoded into an arena. */
+    whad_arena_init(&arena, g_arena_buf, sizeof(g_arena_buf));
+    memset(&msg, 0, sizeof(msg));
+    TEST_CHECK(whad_decode_message_arena(encoded, size, &msg, &arena) == WHAD_SUCCESS);
+    TEST_CHECK(whad_cap_index_add_device_description(&index, &msg) == WHAD_SUCCESS);
+    test_cap_index_matches(&index, g_test_capabilities);
+}
+
+
+int main(void)
+{
+    int i;
+
+    for (i=0; i<(int)sizeof(g_payload); i++)
+    {
+        g_payload[i] = (uint8_t)(i * 7 + 1);
+    }
+
+    test_init(true);
+
+    test_traced_arena();
+#if WHAD_ENABLE_BLE
+    test_traced_fast_path();
+#endif
+    test_txbuf();
+    test_oversize_message();
+    test_clock_sync();
+    test_log();
+    test_cap_index();
+    test_cap_cache();
+    test_describe();
+#if WHAD_ENABLE_PHY
+    test_phy_supported_frequencies();
+#endif
+
+    test_init(true);
+    test_compact();
+    test_cmd_result_fast();
+    test_templates();
+    test_fast_path();
+
+    if (g_failures > 0)
+    {
+        printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
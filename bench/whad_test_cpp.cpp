@@ -0,0 +1,201 @@
+/** \file whad_test_cpp.cpp
+ * WHAD C++ wrappers tests (host only).
+ *
+ * Messages built with the C++ wrappers share the same NanoPb message (see
+ * src/cpp/message.cpp), which is only filled by pack() when a message is
+ * sent. Each test builds two messages, sends the first one, then checks the
+ * frame sent over the transport layer carries the first message intact, the
+ * second message being sent afterwards.
+ *
+ * Usage: whad-test-cpp
+ *
+ * Exits with an error if a test fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "whad.h"
+
+/* Bytes sent over the transport layer. */
+static uint8_t g_sent[2 * WHAD_MESSAGE_MAX_SIZE];
+static int g_sent_size = 0;
+
+/* Number of failed checks. */
+static int g_failures = 0;
+
+#define TEST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);            \
+            g_failures++;                                                       \
+        }                                                                       \
+    } while (0)
+
+
+/**
+ * @brief   Transport send callback, records sent bytes and completes at once.
+ **/
+
+static void test_send_buffer(uint8_t *p_buffer, int size)
+{
+    if ((g_sent_size + size) <= (int)sizeof(g_sent))
+    {
+        memcpy(&g_sent[g_sent_size], p_buffer, size);
+        g_sent_size += size;
+    }
+    whad_transport_data_sent();
+}
+
+
+/**
+ * @brief   Send a message and decode the frame sent over the transport layer.
+ *
+ * @param[in]   message     Message to send
+ * @param[out]  p_msg       Decoded message
+ * @retval      true        A single frame has been sent and decoded
+ * @retval      false       Nothing sent, or sent bytes cannot be decoded
+ **/
+
+static bool test_send(whad::NanoPbMsg &message, Message *p_msg)
+{
+    int size;
+
+    g_sent_size = 0;
+    whad::send(message);
+    while (whad_transport_send_pending() == WHAD_SUCCESS);
+
+    if ((g_sent_size < 4) || (g_sent[0] != 0xAC) || (g_sent[1] != 0xBE))
+        return false;
+
+    size = g_sent[2] | (g_sent[3] << 8);
+    if ((size + 4) != g_sent_size)
+        return false;
+
+    return (whad_decode_message(&g_sent[4], size, p_msg) == WHAD_SUCCESS);
+}
+
+
+#if WHAD_ENABLE_BLE
+
+/**
+ * @brief   Build a SetBdAddress message, then a SniffConnReq, send both in order.
+ **/
+
+static void test_ble_messages(void)
+{
+    Message msg;
+    uint8_t address[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    uint8_t target[6] = {0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6};
+
+    printf("ble: SetBdAddress then SniffConnReq\n");
+
+    whad::ble::SetBdAddress setAddress(whad::ble::BDAddress(whad::ble::AddressRandom, address));
+    whad::ble::SniffConnReq sniff(37, whad::ble::BDAddress(whad::ble::AddressPublic, target), true, false);
+
+    TEST_CHECK(test_send(setAddress, &msg));
+    TEST_CHECK(msg.which_msg == Message_ble_tag);
+    TEST_CHECK(msg.msg.ble.which_msg == ble_Message_set_bd_addr_tag);
+    TEST_CHECK(msg.msg.ble.msg.set_bd_addr.addr_type == ble_BleAddrType_RANDOM);
+    TEST_CHECK(!memcmp(msg.msg.ble.msg.set_bd_addr.bd_address, address, 6));
+
+    TEST_CHECK(test_send(sniff, &msg));
+    TEST_CHECK(msg.which_msg == Message_ble_tag);
+    TEST_CHECK(msg.msg.ble.which_msg == ble_Message_sniff_connreq_tag);
+    TEST_CHECK(msg.msg.ble.msg.sniff_connreq.channel == 37);
+    TEST_CHECK(msg.msg.ble.msg.sniff_connreq.show_advertisements);
+    TEST_CHECK(!msg.msg.ble.msg.sniff_connreq.show_empty_packets);
+    TEST_CHECK(!memcmp(msg.msg.ble.msg.sniff_connreq.bd_address, target, 6));
+
+    /* Sending a message again packs it again. */
+    TEST_CHECK(test_send(setAddress, &msg));
+    TEST_CHECK(msg.msg.ble.which_msg == ble_Message_set_bd_addr_tag);
+    TEST_CHECK(!memcmp(msg.msg.ble.msg.set_bd_addr.bd_address, address, 6));
+}
+
+#endif
+
+
+#if WHAD_ENABLE_PHY
+
+/**
+ * @brief   Build a MonitorMode message, then a SetPacketSize, send both in order.
+ **/
+
+static void test_phy_messages(void)
+{
+    Message msg;
+
+    printf("phy: MonitorMode then SetPacketSize\n");
+
+    whad::phy::MonitorMode monitor;
+    whad::phy::SetPacketSize packetSize(250);
+
+    TEST_CHECK(test_send(monitor, &msg));
+    TEST_CHECK(msg.which_msg == Message_phy_tag);
+    TEST_CHECK(msg.msg.phy.which_msg == phy_Message_monitor_tag);
+
+    TEST_CHECK(test_send(packetSize, &msg));
+    TEST_CHECK(msg.which_msg == Message_phy_tag);
+    TEST_CHECK(msg.msg.phy.which_msg == phy_Message_packet_size_tag);
+    TEST_CHECK(msg.msg.phy.msg.packet_size.packet_size == 250);
+}
+
+#endif
+
+
+/**
+ * @brief   Build a DomainInfoResp message, then a DeviceInfoQuery, send both in order.
+ **/
+
+static void test_discovery_messages(void)
+{
+    Message msg;
+    whad_domain_desc_t capabilities[] = {
+        {DOMAIN_PHY, (whad_capability_t)(CAP_SNIFF | CAP_JAM), 0x0f},
+        {DOMAIN_NONE, CAP_NONE, 0}
+    };
+
+    printf("discovery: DomainInfoResp then DeviceInfoQuery\n");
+
+    whad::discovery::DomainInfoResp domainInfo(whad::discovery::DomainPhy, capabilities);
+    whad::discovery::DeviceInfoQuery query(2);
+
+    TEST_CHECK(test_send(domainInfo, &msg));
+    TEST_CHECK(msg.which_msg == Message_discovery_tag);
+    TEST_CHECK(msg.msg.discovery.which_msg == discovery_Message_domain_resp_tag);
+    TEST_CHECK(msg.msg.discovery.msg.domain_resp.domain == DOMAIN_PHY);
+    TEST_CHECK(msg.msg.discovery.msg.domain_resp.supported_commands == 0x0f);
+
+    TEST_CHECK(test_send(query, &msg));
+    TEST_CHECK(msg.which_msg == Message_discovery_tag);
+    TEST_CHECK(msg.msg.discovery.which_msg == discovery_Message_info_query_tag);
+    TEST_CHECK(msg.msg.discovery.msg.info_query.proto_ver == 2);
+}
+
+
+int main(void)
+{
+    whad_transport_cfg_t transport;
+
+    transport.max_txbuf_size = WHAD_RINGBUF_MAX_SIZE;
+    transport.pfn_data_send_buffer = test_send_buffer;
+    whad_init(&transport);
+
+#if WHAD_ENABLE_BLE
+    test_ble_messages();
+#endif
+#if WHAD_ENABLE_PHY
+    test_phy_messages();
+#endif
+    test_discovery_messages();
+
+    if (g_failures > 0)
+    {
+        printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,636 @@
+/** \file whad_trace.c
+ * WHAD end-to-end latency analysis (host only).
+ *
+ * Reads a capture of a device built with `WHAD_TRACING` (see trace.h and
+ * capture.h, recorded with whad-record), extracts every frame as whad-replay
+ * does, and combines the trace extension of each message with its arrival
+ * time to split its latency into stages:
+ * - firmware: from the radio event to the frame being queued (device clock),
+ * - tx_ring: time spent in the TX ring buffer behind the bytes already queued,
+ *   estimated from the backlog and the link byte time,
+ * - link: transfer of the frame itself, from its size and the link byte time,
+ * - host: what remains until the host received the frame (driver, OS),
+ * - decode: `whad_decode_message()`, measured,
+ * - end_to_end: from the radio event to the decoded message.
+ *
+ * Device and host clocks are not synchronized: the offset between them is
+ * given with `-O` (in us, host minus device), or estimated by assuming that
+ * the fastest message spent no time in the host stage.
+ *
+ * The p50, p90, p99 and maximum of each stage are printed for each message
+ * type. Per-message stages may be exported as CSV with `-o`, and the summary
+ * as JSON with `-j`, for dashboards.
+ *
+ * Usage: whad-trace [-b baudrate] [-O offset_us] [-o messages.csv] [-j summary.json] capture
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture.h"
+
+/* Default parameters. */
+#define TRACE_DEFAULT_BAUDRATE      (115200)
+#define TRACE_RX_CHUNK              (64)
+
+/* Message types are indexed by domain (Message tag) and domain message tag. */
+#define TRACE_DOMAINS               (8)
+#define TRACE_SUBTYPES              (64)
+
+/* Bits per byte on the link (8N1). */
+#define TRACE_BITS_PER_BYTE         (10)
+
+/* Frame header: magic and length. */
+#define TRACE_FRAME_HEADER_SIZE     (4)
+
+/* Latency stages. */
+typedef enum {
+    TRACE_STAGE_FIRMWARE = 0,
+    TRACE_STAGE_TX_RING,
+    TRACE_STAGE_LINK,
+    TRACE_STAGE_HOST,
+    TRACE_STAGE_DECODE,
+    TRACE_STAGE_END_TO_END,
+    TRACE_STAGES
+} trace_stage_t;
+
+/* Traced message. */
+typedef struct {
+    uint32_t sequence;          /*!< Trace sequence number */
+    uint16_t domain;            /*!< Message tag */
+    uint16_t subtype;           /*!< Domain message tag */
+    int size;                   /*!< Serialized message size */
+    uint32_t backlog;           /*!< Bytes queued ahead of the frame */
+    int64_t capture_us;         /*!< Radio event, device clock unwrapped */
+    int64_t queued_us;          /*!< Frame queued, device clock unwrapped */
+    double arrival_us;          /*!< Frame received, host clock */
+    double stages[TRACE_STAGES];  /*!< Stage durations in us */
+} trace_message_t;
+
+static const char *g_domain_names[TRACE_DOMAINS] = {
+    "unknown", "generic", "discovery", "ble", "dot15d4", "esb", "unifying", "phy"
+};
+
+static const char *g_stage_names[TRACE_STAGES] = {
+    "firmware", "tx_ring", "link", "host", "decode", "end_to_end"
+};
+
+/* Traced messages. */
+static trace_message_t *g_messages = NULL;
+static size_t g_count = 0;
+static size_t g_capacity = 0;
+
+/* Stream statistics. */
+static uint64_t g_frames = 0;
+static uint64_t g_untraced = 0;
+static uint64_t g_errors = 0;
+static uint64_t g_lost = 0;
+
+/* Device clock unwrapping. */
+static bool g_clock_started = false;
+static uint32_t g_last_raw_us = 0;
+static int64_t g_last_us = 0;
+
+static Message g_message;
+
+
+static uint64_t trace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+/**
+ * @brief   Convert a 32-bit device time to a monotonic 64-bit time.
+ *
+ * Device times are assumed to be less than 2^31 us apart from the previous
+ * one converted, which holds for any capture with at least one traced message
+ * every half hour.
+ *
+ * @param[in]   raw_us  Device time, wrapping at 2^32
+ * @return  Unwrapped device time in us.
+ **/
+
+static int64_t trace_unwrap(uint32_t raw_us)
+{
+    if (!g_clock_started)
+    {
+        g_clock_started = true;
+        g_last_raw_us = raw_us;
+        g_last_us = raw_us;
+        return g_last_us;
+    }
+
+    g_last_us += (int32_t)(raw_us - g_last_raw_us);
+    g_last_raw_us = raw_us;
+    return g_last_us;
+}
+
+
+/**
+ * @brief   Get the domain message tag of a decoded message.
+ *
+ * @param[in]   p_msg   Pointer to a decoded message
+ * @return  Domain message tag, 0 if unknown.
+ **/
+
+static pb_size_t trace_get_subtype(Message *p_msg)
+{
+    switch (p_msg->which_msg)
+    {
+        case Message_generic_tag: return p_msg->msg.generic.which_msg;
+        case Message_discovery_tag: return p_msg->msg.discovery.which_msg;
+#if WHAD_ENABLE_BLE
+        case Message_ble_tag: return p_msg->msg.ble.which_msg;
+#endif
+#if WHAD_ENABLE_DOT15D4
+        case Message_dot15d4_tag: return p_msg->msg.dot15d4.which_msg;
+#endif
+#if WHAD_ENABLE_ESB
+        case Message_esb_tag: return p_msg->msg.esb.which_msg;
+#endif
+#if WHAD_ENABLE_UNIFYING
+        case Message_unifying_tag: return p_msg->msg.unifying.which_msg;
+#endif
+#if WHAD_ENABLE_PHY
+        case Message_phy_tag: return p_msg->msg.phy.which_msg;
+#endif
+        default: return 0;
+    }
+}
+
+
+/**
+ * @brief   Allocate the next traced message.
+ *
+ * @return  Pointer to a zeroed message, NULL if out of memory.
+ **/
+
+static trace_message_t *trace_add_message(void)
+{
+    trace_message_t *p_messages;
+    size_t capacity;
+
+    if (g_count == g_capacity)
+    {
+        capacity = (g_capacity == 0) ? 1024 : (g_capacity * 2);
+        p_messages = realloc(g_messages, capacity * sizeof(trace_message_t));
+        if (p_messages == NULL)
+        {
+            return NULL;
+        }
+        g_messages = p_messages;
+        g_capacity = capacity;
+    }
+
+    memset(&g_messages[g_count], 0, sizeof(trace_message_t));
+    return &g_messages[g_count++];
+}
+
+
+/**
+ * @brief   Read the trace of every complete frame held by the transport layer.
+ *
+ * @param[in]   arrival_ns  Receive time of the bytes that completed the frames
+ * @return  0 on success, -1 if out of memory.
+ **/
+
+static int trace_drain(uint64_t arrival_ns)
+{
+    static bool s_sequence_started = false;
+    static uint32_t s_next_sequence = 0;
+    trace_message_t *p_traced;
+    whad_trace_info_t info;
+    whad_result_t result;
+    uint8_t *p_frame;
+    uint64_t start;
+    uint64_t elapsed;
+    pb_size_t domain;
+    pb_size_t subtype;
+    int size;
+
+    for (;;)
+    {
+        result = whad_get_raw_message(&p_frame, &size);
+        if (result == WHAD_NONE)
+        {
+            return 0;
+        }
+        if (result != WHAD_SUCCESS)
+        {
+            g_errors++;
+            return 0;
+        }
+        g_frames++;
+
+        if (whad_trace_parse(p_frame, size, &info) != WHAD_SUCCESS)
+        {
+            g_untraced++;
+            continue;
+        }
+
+        start = trace_now();
+        result = whad_decode_message(p_frame, size, &g_message);
+        elapsed = trace_now() - start;
+        if (result != WHAD_SUCCESS)
+        {
+            g_errors++;
+            continue;
+        }
+
+        domain = g_message.which_msg;
+        subtype = trace_get_subtype(&g_message);
+        whad_free_message_resources(&g_message);
+        if ((domain >= TRACE_DOMAINS) || (subtype >= TRACE_SUBTYPES))
+        {
+            domain = 0;
+            subtype = 0;
+        }
+
+        /* Messages lost between the device and the host. */
+        if (s_sequence_started && (info.sequence != s_next_sequence))
+        {
+            g_lost += (uint32_t)(info.sequence - s_next_sequence);
+        }
+        s_sequence_started = true;
+        s_next_sequence = info.sequence + 1;
+
+        p_traced = trace_add_message();
+        if (p_traced == NULL)
+        {
+            return -1;
+        }
+        p_traced->sequence = info.sequence;
+        p_traced->domain = domain;
+        p_traced->subtype = subtype;
+        p_traced->size = size;
+        p_traced->backlog = info.backlog;
+        p_traced->queued_us = trace_unwrap(info.queued_time);
+        p_traced->capture_us = p_traced->queued_us - (int32_t)(info.queued_time - info.capture_time);
+        p_traced->arrival_us = arrival_ns / 1e3;
+        p_traced->stages[TRACE_STAGE_DECODE] = elapsed / 1e3;
+    }
+}
+
+
+/**
+ * @brief   Read every traced message of a capture.
+ *
+ * @param[in]   p_reader    Pointer to the capture reader
+ * @return  0 on success, -1 on a malformed capture or if out of memory.
+ **/
+
+static int trace_read_capture(capture_reader_t *p_reader)
+{
+    whad_result_t result;
+    const uint8_t *p_data;
+    uint64_t time_ns;
+    int offset;
+    int chunk;
+    int room;
+    int size;
+
+    while ((result = capture_next(p_reader, &time_ns, &p_data, &size)) == WHAD_SUCCESS)
+    {
+        for (offset = 0; offset < size; offset += chunk)
+        {
+            chunk = size - offset;
+            if (chunk > TRACE_RX_CHUNK)
+            {
+                chunk = TRACE_RX_CHUNK;
+            }
+
+            room = WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_rxbuf_size();
+            if (chunk > room)
+            {
+                chunk = room;
+            }
+
+            if ((chunk <= 0) || (whad_transport_data_received((uint8_t *)&p_data[offset], chunk) != WHAD_SUCCESS))
+            {
+                break;
+            }
+
+            if (trace_drain(time_ns) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return (result == WHAD_NONE) ? 0 : -1;
+}
+
+
+/**
+ * @brief   Compute the stages of every traced message.
+ *
+ * @param[in]   byte_us     Link byte time in us
+ * @param[in]   offset_us   Host minus device clock offset
+ * @param[in]   estimate    Estimate the offset from the fastest message
+ * @return  Clock offset used, in us.
+ **/
+
+static double trace_compute_stages(double byte_us, double offset_us, bool estimate)
+{
+    trace_message_t *p_traced;
+    double host_us;
+    size_t i;
+
+    for (i=0; i<g_count; i++)
+    {
+        p_traced = &g_messages[i];
+        p_traced->stages[TRACE_STAGE_FIRMWARE] = (double)(p_traced->queued_us - p_traced->capture_us);
+        p_traced->stages[TRACE_STAGE_TX_RING] = p_traced->backlog * byte_us;
+        p_traced->stages[TRACE_STAGE_LINK] = (p_traced->size + TRACE_FRAME_HEADER_SIZE) * byte_us;
+
+        /* Host stage before clock offset correction. */
+        host_us = p_traced->arrival_us - (double)p_traced->queued_us - p_traced->stages[TRACE_STAGE_TX_RING] -
+                  p_traced->stages[TRACE_STAGE_LINK];
+        p_traced->stages[TRACE_STAGE_HOST] = host_us;
+        if (estimate && ((i == 0) || (host_us < offset_us)))
+        {
+            offset_us = host_us;
+        }
+    }
+
+    for (i=0; i<g_count; i++)
+    {
+        p_traced = &g_messages[i];
+        p_traced->stages[TRACE_STAGE_HOST] -= offset_us;
+        p_traced->stages[TRACE_STAGE_END_TO_END] = p_traced->arrival_us - offset_us - (double)p_traced->capture_us +
+                                                   p_traced->stages[TRACE_STAGE_DECODE];
+    }
+
+    return offset_us;
+}
+
+
+static int trace_compare(const void *p_a, const void *p_b)
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+
+/**
+ * @brief   Get a percentile of sorted samples (nearest rank).
+ *
+ * @param[in]   p_samples   Sorted samples
+ * @param[in]   count       Number of samples, not zero
+ * @param[in]   percent     Percentile, between 0 and 100
+ * @return  Percentile value.
+ **/
+
+static double trace_percentile(double *p_samples, size_t count, int percent)
+{
+    size_t rank = (count * percent + 99) / 100;
+
+    return p_samples[(rank > 0) ? (rank - 1) : 0];
+}
+
+
+/**
+ * @brief   Print and export the latency distribution of every message type.
+ *
+ * @param[in]   p_json      Summary output, NULL if not exported
+ * @param[in]   offset_us   Clock offset used
+ * @return  0 on success, -1 if out of memory.
+ **/
+
+static int trace_summarize(FILE *p_json, double offset_us)
+{
+    double *p_samples;
+    size_t count;
+    size_t i;
+    bool first = true;
+    int domain;
+    int subtype;
+    int stage;
+
+    p_samples = malloc(g_count * sizeof(double));
+    if (p_samples == NULL)
+    {
+        return -1;
+    }
+
+    if (p_json != NULL)
+    {
+        fprintf(p_json, "{\n  \"frames\": %llu,\n  \"traced\": %llu,\n  \"untraced\": %llu,\n  \"errors\": %llu,\n"
+                "  \"lost\": %llu,\n  \"clock_offset_us\": %.1f,\n  \"types\": [",
+                (unsigned long long)g_frames, (unsigned long long)g_count, (unsigned long long)g_untraced,
+                (unsigned long long)g_errors, (unsigned long long)g_lost, offset_us);
+    }
+
+    printf("  %-20s %-10s %10s %10s %10s %10s %10s\n", "type", "stage", "messages", "p50 us", "p90 us", "p99 us", "max us");
+    for (domain=0; domain<TRACE_DOMAINS; domain++)
+    {
+        for (subtype=0; subtype<TRACE_SUBTYPES; subtype++)
+        {
+            if (p_json != NULL)
+            {
+                count = 0;
+                for (i=0; i<g_count; i++)
+                {
+                    count += ((g_messages[i].domain == domain) && (g_messages[i].subtype == subtype)) ? 1 : 0;
+                }
+                if (count > 0)
+                {
+                    fprintf(p_json, "%s\n    {\"domain\": \"%s\", \"tag\": %d, \"messages\": %llu, \"stages\": {",
+                            first ? "" : ",", g_domain_names[domain], subtype, (unsigned long long)count);
+                    first = false;
+                }
+            }
+
+            for (stage=0; stage<TRACE_STAGES; stage++)
+            {
+                count = 0;
+                for (i=0; i<g_count; i++)
+                {
+                    if ((g_messages[i].domain == domain) && (g_messages[i].subtype == subtype))
+                    {
+                        p_samples[count++] = g_messages[i].stages[stage];
+                    }
+                }
+                if (count == 0)
+                {
+                    break;
+                }
+
+                qsort(p_samples, count, sizeof(double), trace_compare);
+                printf("  %-12s tag %-4d %-10s %10llu %10.1f %10.1f %10.1f %10.1f\n", g_domain_names[domain],
+                       subtype, g_stage_names[stage], (unsigned long long)count, trace_percentile(p_samples, count, 50),
+                       trace_percentile(p_samples, count, 90), trace_percentile(p_samples, count, 99),
+                       p_samples[count - 1]);
+
+                if (p_json != NULL)
+                {
+                    fprintf(p_json, "%s\"%s\": {\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+                            (stage == 0) ? "" : ", ", g_stage_names[stage], trace_percentile(p_samples, count, 50),
+                            trace_percentile(p_samples, count, 90), trace_percentile(p_samples, count, 99),
+                            p_samples[count - 1]);
+                }
+            }
+
+            if ((p_json != NULL) && (count > 0))
+            {
+                fprintf(p_json, "}}");
+            }
+        }
+    }
+
+    if (p_json != NULL)
+    {
+        fprintf(p_json, "\n  ]\n}\n");
+    }
+
+    free(p_samples);
+    return 0;
+}
+
+
+/**
+ * @brief   Export the stages of every traced message as CSV.
+ *
+ * @param[in]   p_csv   Output file
+ **/
+
+static void trace_export_messages(FILE *p_csv)
+{
+    trace_message_t *p_traced;
+    size_t i;
+    int stage;
+
+    fprintf(p_csv, "sequence,domain,tag,size,backlog,arrival_us");
+    for (stage=0; stage<TRACE_STAGES; stage++)
+    {
+        fprintf(p_csv, ",%s_us", g_stage_names[stage]);
+    }
+    fprintf(p_csv, "\n");
+
+    for (i=0; i<g_count; i++)
+    {
+        p_traced = &g_messages[i];
+        fprintf(p_csv, "%u,%s,%u,%d,%u,%.3f", p_traced->sequence, g_domain_names[p_traced->domain],
+                p_traced->subtype, p_traced->size, p_traced->backlog, p_traced->arrival_us);
+        for (stage=0; stage<TRACE_STAGES; stage++)
+        {
+            fprintf(p_csv, ",%.3f", p_traced->stages[stage]);
+        }
+        fprintf(p_csv, "\n");
+    }
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-b baudrate] [-O offset_us] [-o messages.csv] [-j summary.json] capture\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    capture_reader_t reader;
+    whad_transport_cfg_t transport;
+    const char *psz_csv = NULL;
+    const char *psz_json = NULL;
+    FILE *p_file;
+    double offset_us = 0.0;
+    bool estimate = true;
+    long baudrate = TRACE_DEFAULT_BAUDRATE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:O:o:j:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baudrate = atol(optarg); break;
+            case 'O': offset_us = atof(optarg); estimate = false; break;
+            case 'o': psz_csv = optarg; break;
+            case 'j': psz_json = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (((argc - optind) != 1) || (baudrate <= 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (capture_open(&reader, argv[optind]) != WHAD_SUCCESS)
+    {
+        fprintf(stderr, "%s: cannot map capture file\n", argv[optind]);
+        return 1;
+    }
+
+    /* Nothing is sent back to the device. */
+    transport.max_txbuf_size = 0;
+    transport.pfn_data_send_buffer = NULL;
+    whad_init(&transport);
+
+    if (trace_read_capture(&reader) != 0)
+    {
+        fprintf(stderr, "%s: malformed capture or out of memory\n", argv[optind]);
+        capture_release(&reader);
+        return 1;
+    }
+    capture_release(&reader);
+
+    printf("trace:        %s, %ld baud, clock offset %s\n", argv[optind], baudrate,
+           estimate ? "estimated" : "given");
+    printf("stream:       %llu frames, %llu traced, %llu untraced, %llu errors, %llu lost\n",
+           (unsigned long long)g_frames, (unsigned long long)g_count, (unsigned long long)g_untraced,
+           (unsigned long long)g_errors, (unsigned long long)g_lost);
+    if (g_count == 0)
+    {
+        return 1;
+    }
+
+    offset_us = trace_compute_stages(1e6 * TRACE_BITS_PER_BYTE / baudrate, offset_us, estimate);
+    printf("clock offset: %.1f us (host minus device)\n", offset_us);
+
+    p_file = NULL;
+    if (psz_json != NULL)
+    {
+        p_file = fopen(psz_json, "w");
+        if (p_file == NULL)
+        {
+            perror(psz_json);
+            return 1;
+        }
+    }
+    if (trace_summarize(p_file, offset_us) != 0)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    if (p_file != NULL)
+    {
+        fclose(p_file);
+    }
+
+    if (psz_csv != NULL)
+    {
+        p_file = fopen(psz_csv, "w");
+        if (p_file == NULL)
+        {
+            perror(psz_csv);
+            return 1;
+        }
+        trace_export_messages(p_file);
+        fclose(p_file);
+    }
+
+    free(g_messages);
+    return 0;
+}
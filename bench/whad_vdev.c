@@ -0,0 +1,338 @@
+/** \file whad_vdev.c
+ * WHAD virtual device (host only).
+ *
+ * Runs the virtual firmware of vdev.h behind a pseudo-terminal, so that host
+ * tools connect to it as they would to a dongle's serial port, and load-tests
+ * them with synthetic traffic at a configurable rate without any hardware.
+ * The pseudo-terminal path is printed at startup and may also be exposed as a
+ * symbolic link with `-l`.
+ *
+ * The pseudo-terminal stands for the UART driver: bytes handed by
+ * `whad_transport_send_pending()` are written without blocking, and
+ * `whad_transport_data_sent()` is called once they have all been written.
+ * When the host does not read fast enough, the TX ring buffer fills up and
+ * notifications are dropped. Every second, the number of notifications
+ * generated and dropped per started domain is printed, so that the highest
+ * rate the host sustains without drops can be found.
+ *
+ * Usage: whad-vdev [-r rate] [-s payload_size] [-t max_txbuf_size] [-l link]
+ */
+
+/* posix_openpt(), ptsname() and cfmakeraw(). */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "vdev.h"
+
+/* Default transport parameters. */
+#define VDEV_DEFAULT_TXBUF_SIZE     (WHAD_TX_CHUNK_MAX_SIZE)
+
+/* Main loop period, upper bound of the notification jitter. */
+#define VDEV_POLL_PERIOD_MS         (1)
+
+/* Statistics period. */
+#define VDEV_REPORT_PERIOD_NS       (1000000000ULL)
+
+static volatile sig_atomic_t g_stop = 0;
+
+/* Pseudo-terminal master side. */
+static int g_fd = -1;
+
+/* Bytes handed by the transport layer and not yet written. */
+static uint8_t g_tx_data[WHAD_TX_CHUNK_MAX_SIZE];
+static int g_tx_size = 0;
+static int g_tx_offset = 0;
+static uint64_t g_tx_bytes = 0;
+
+
+static uint64_t vdev_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void vdev_sigint(int signum)
+{
+    (void)signum;
+    g_stop = 1;
+}
+
+
+/**
+ * @brief   Transport send callback, queuing bytes for the pseudo-terminal.
+ *
+ * @param[in]   p_buffer    Bytes to send
+ * @param[in]   size        Number of bytes to send
+ **/
+
+static void vdev_send_buffer(uint8_t *p_buffer, int size)
+{
+    memcpy(g_tx_data, p_buffer, size);
+    g_tx_size = size;
+    g_tx_offset = 0;
+}
+
+
+/**
+ * @brief   Write pending bytes to the pseudo-terminal, without blocking.
+ **/
+
+static void vdev_flush(void)
+{
+    ssize_t count;
+
+    while (g_tx_offset < g_tx_size)
+    {
+        count = write(g_fd, &g_tx_data[g_tx_offset], g_tx_size - g_tx_offset);
+        if (count <= 0)
+        {
+            /* Host is not reading (EAGAIN) or not connected (EIO). */
+            return;
+        }
+        g_tx_offset += count;
+        g_tx_bytes += count;
+    }
+
+    if (g_tx_size > 0)
+    {
+        g_tx_size = 0;
+        g_tx_offset = 0;
+        whad_transport_data_sent();
+    }
+}
+
+
+/**
+ * @brief   Read bytes sent by the host, as an RX interrupt handler would.
+ **/
+
+static void vdev_receive(void)
+{
+    uint8_t chunk[WHAD_RINGBUF_MAX_SIZE];
+    ssize_t count;
+    int room;
+
+    room = WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_rxbuf_size();
+    if (room <= 0)
+    {
+        return;
+    }
+
+    count = read(g_fd, chunk, room);
+    if (count > 0)
+    {
+        whad_transport_data_received(chunk, (int)count);
+    }
+}
+
+
+/**
+ * @brief   Create the pseudo-terminal, in raw mode.
+ *
+ * @return  Slave path, NULL on error.
+ **/
+
+static const char *vdev_open_pty(void)
+{
+    struct termios tio;
+    const char *psz_slave;
+    int slave;
+
+    g_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((g_fd < 0) || (grantpt(g_fd) != 0) || (unlockpt(g_fd) != 0))
+    {
+        return NULL;
+    }
+
+    psz_slave = ptsname(g_fd);
+    if (psz_slave == NULL)
+    {
+        return NULL;
+    }
+
+    /* Keep the slave side open, so that the master does not fail between two host sessions. */
+    slave = open(psz_slave, O_RDWR | O_NOCTTY);
+    if ((slave < 0) || (tcgetattr(slave, &tio) != 0))
+    {
+        return NULL;
+    }
+    cfmakeraw(&tio);
+    if (tcsetattr(slave, TCSANOW, &tio) != 0)
+    {
+        return NULL;
+    }
+
+    fcntl(g_fd, F_SETFL, fcntl(g_fd, F_GETFL) | O_NONBLOCK);
+    return psz_slave;
+}
+
+
+/**
+ * @brief   Print the notifications generated and dropped since the last report.
+ *
+ * @param[in]   p_stats     Current statistics
+ * @param[in]   p_last      Statistics at the last report, updated
+ * @param[in]   elapsed_ns  Time since the last report
+ * @param[in]   tx_bytes    Bytes written to the pseudo-terminal since the last report
+ **/
+
+static void vdev_report(vdev_stats_t *p_stats, vdev_stats_t *p_last, uint64_t elapsed_ns, uint64_t tx_bytes)
+{
+    double seconds = elapsed_ns / 1e9;
+    bool started = false;
+    int i;
+
+    for (i=0; i<VDEV_DOMAINS; i++)
+    {
+        if (!vdev_is_started((vdev_domain_t)i))
+        {
+            continue;
+        }
+
+        fprintf(stderr, "%s%s: %.0f msg/s, %.0f dropped/s", started ? ", " : "",
+                vdev_get_domain_name((vdev_domain_t)i),
+                (p_stats->generated[i] - p_last->generated[i]) / seconds,
+                (p_stats->dropped[i] - p_last->dropped[i]) / seconds);
+        started = true;
+    }
+
+    if (started)
+    {
+        fprintf(stderr, " (%.1f kB/s)\n", tx_bytes / seconds / 1000.0);
+    }
+
+    *p_last = *p_stats;
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-r rate] [-s payload_size] [-t max_txbuf_size] [-l link]\n", program);
+}
+
+
+int main(int argc, char **argv)
+{
+    whad_transport_cfg_t transport;
+    vdev_cfg_t config;
+    vdev_stats_t stats;
+    vdev_stats_t last;
+    struct pollfd pfd;
+    const char *psz_slave;
+    const char *psz_link = NULL;
+    uint64_t now;
+    uint64_t last_report;
+    uint64_t last_tx_bytes = 0;
+    int max_txbuf_size = VDEV_DEFAULT_TXBUF_SIZE;
+    int opt;
+    int i;
+
+    config.rate = VDEV_DEFAULT_RATE;
+    config.payload_size = VDEV_DEFAULT_PAYLOAD_SIZE;
+    while ((opt = getopt(argc, argv, "r:s:t:l:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': config.rate = strtoul(optarg, NULL, 0); break;
+            case 's': config.payload_size = atoi(optarg); break;
+            case 't': max_txbuf_size = atoi(optarg); break;
+            case 'l': psz_link = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((config.rate == 0) || (config.payload_size <= 0) || (max_txbuf_size <= 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    psz_slave = vdev_open_pty();
+    if (psz_slave == NULL)
+    {
+        perror("pseudo-terminal");
+        return 1;
+    }
+
+    if (psz_link != NULL)
+    {
+        unlink(psz_link);
+        if (symlink(psz_slave, psz_link) != 0)
+        {
+            perror(psz_link);
+            return 1;
+        }
+    }
+
+    printf("virtual device on %s, %u msg/s per started domain, %d-byte payloads\n",
+           (psz_link != NULL) ? psz_link : psz_slave, config.rate, config.payload_size);
+    fflush(stdout);
+
+    signal(SIGINT, vdev_sigint);
+    signal(SIGTERM, vdev_sigint);
+
+    /* Plug WHAD into the pseudo-terminal, with binary logging. */
+    transport.max_txbuf_size = max_txbuf_size;
+    transport.pfn_data_send_buffer = vdev_send_buffer;
+    whad_init(&transport);
+    whad_log_init();
+    now = vdev_now();
+    vdev_init(&config, now);
+    vdev_get_stats(&last);
+    last_report = now;
+
+    /* Main loop. */
+    pfd.fd = g_fd;
+    while (!g_stop)
+    {
+        pfd.events = POLLIN | ((g_tx_size > 0) ? POLLOUT : 0);
+        poll(&pfd, 1, VDEV_POLL_PERIOD_MS);
+
+        vdev_receive();
+        vdev_flush();
+        vdev_process(vdev_now());
+        vdev_flush();
+
+        now = vdev_now();
+        if ((now - last_report) >= VDEV_REPORT_PERIOD_NS)
+        {
+            vdev_get_stats(&stats);
+            vdev_report(&stats, &last, now - last_report, g_tx_bytes - last_tx_bytes);
+            last_tx_bytes = g_tx_bytes;
+            last_report = now;
+        }
+    }
+
+    /* Totals. */
+    vdev_get_stats(&stats);
+    printf("commands:     %llu received, %llu errors\n", (unsigned long long)stats.commands,
+           (unsigned long long)stats.errors);
+    for (i=0; i<VDEV_DOMAINS; i++)
+    {
+        if ((stats.generated[i] > 0) || (stats.dropped[i] > 0))
+        {
+            printf("%s: %llu generated, %llu dropped\n", vdev_get_domain_name((vdev_domain_t)i),
+                   (unsigned long long)stats.generated[i], (unsigned long long)stats.dropped[i]);
+        }
+    }
+
+    if (psz_link != NULL)
+    {
+        unlink(psz_link);
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+/** \file arena.h
+ * WHAD bump arena and arena-backed NanoPb decoding callbacks.
+ *
+ * Variable-length fields of received messages (verbose and debug texts,
+ * capabilities, frequency ranges, monitoring reports, IQ samples) are NanoPb
+ * callback fields. When a message is decoded with `whad_decode_message_arena()`
+ * their content is stored in a caller-provided arena, without any dynamic
+ * allocation and in a time bounded by the message size. Every block allocated
+ * from an arena is released at once with `whad_arena_reset()`, usually once
+ * the message has been processed.
+ */
+
+#ifndef __INC_WHAD_ARENA_H
+#define __INC_WHAD_ARENA_H
+
+#include "types.h"
+
+/* Alignment of the blocks allocated from an arena. */
+#define WHAD_ARENA_ALIGNMENT        (sizeof(void *))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bump arena
+ **/
+
+typedef struct {
+    uint8_t *p_buffer;      /*!< Arena storage */
+    int size;               /*!< Arena storage size in bytes */
+    int offset;             /*!< Number of bytes allocated */
+} whad_arena_t;
+
+/**
+ * Arena-backed callback field
+ *
+ * Allocated from the arena and referenced by the `arg` member of the callback
+ * field it is bound to. Items of a repeated field are stored contiguously.
+ **/
+
+typedef struct {
+    whad_arena_t *p_arena;              /*!< Arena storing the decoded items */
+    const pb_msgdesc_t *p_fields;       /*!< Item fields descriptor, for repeated messages */
+    uint8_t *p_items;                   /*!< Decoded items, NULL if none */
+    int item_size;                      /*!< Size of an item in bytes */
+    int count;                          /*!< Number of decoded items */
+} whad_arena_field_t;
+
+/* Arena management. */
+void whad_arena_init(whad_arena_t *p_arena, uint8_t *p_buffer, int size);
+void *whad_arena_alloc(whad_arena_t *p_arena, int size);
+void whad_arena_reset(whad_arena_t *p_arena);
+int whad_arena_get_free_size(whad_arena_t *p_arena);
+
+/* NanoPb decoding callbacks. */
+bool whad_arena_bytes_decode_cb(pb_istream_t *istream, const pb_field_t *field, void **arg);
+bool whad_arena_varint_decode_cb(pb_istream_t *istream, const pb_field_t *field, void **arg);
+bool whad_arena_message_decode_cb(pb_istream_t *istream, const pb_field_t *field, void **arg);
+
+/* Callback fields binding and access. */
+whad_result_t whad_arena_bind_bytes(pb_callback_t *p_callback, whad_arena_t *p_arena);
+whad_result_t whad_arena_bind_varints(pb_callback_t *p_callback, whad_arena_t *p_arena);
+whad_result_t whad_arena_bind_messages(pb_callback_t *p_callback, whad_arena_t *p_arena,
+                                       const pb_msgdesc_t *p_fields, int item_size);
+whad_result_t whad_arena_get_items(const pb_callback_t *p_callback, void **pp_items, int *p_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_ARENA_H */
@@ -0,0 +1,87 @@
+/** \file capcache.h
+ * WHAD capability cache (host side).
+ *
+ * Discovery takes a device info query, then one domain info query per
+ * supported domain. The capability cache keeps the result of previous
+ * discoveries (see `whad_cap_index_t`), keyed by device ID and firmware
+ * version, so that reopening a known device only takes the device info query:
+ * on a cache hit, domain info queries are skipped.
+ *
+ * When the device info response has been decoded into an arena, its domains
+ * and capabilities must also match the cached ones, a device reporting other
+ * domains with the same firmware version is discovered again.
+ *
+ * Cache file format (all integers little-endian):
+ * - header: "WHADCCH" magic (8 bytes, NUL-terminated), version (32 bits),
+ *   number of entries (32 bits),
+ * - entries: device ID (16 bytes), firmware major, minor and revision versions
+ *   (32 bits each), supported domains bitmask by domain index (32 bits), then
+ *   for each supported domain: capabilities (8 bits) and supported commands
+ *   (64 bits),
+ * - FNV-1a hash of the header and entries (32 bits).
+ *
+ * Files are replaced atomically, a cache that cannot be read is ignored.
+ *
+ * The cache relies on stdio and is only built into host libraries (ARCH_HOST),
+ * this header is not included by whad.h.
+ */
+
+#ifndef __INC_WHAD_CAPCACHE_H
+#define __INC_WHAD_CAPCACHE_H
+
+#include "types.h"
+#include "discovery.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of devices, the oldest entries are replaced when full. */
+#ifndef WHAD_CAP_CACHE_MAX_ENTRIES
+#define WHAD_CAP_CACHE_MAX_ENTRIES      (256)
+#endif
+
+/* Maximum length of a cache file path, temporary file suffix included. */
+#ifndef WHAD_CAP_CACHE_PATH_MAX
+#define WHAD_CAP_CACHE_PATH_MAX         (1024)
+#endif
+
+#define WHAD_CAP_CACHE_MAGIC            "WHADCCH"
+#define WHAD_CAP_CACHE_VERSION          (1)
+#define WHAD_CAP_CACHE_HEADER_SIZE      (16)
+#define WHAD_CAP_CACHE_DEVID_SIZE       (16)
+
+/* Cache key. */
+typedef struct {
+    uint8_t devid[WHAD_CAP_CACHE_DEVID_SIZE];   /*!< Device ID */
+    uint32_t fw_version_major;                  /*!< Firmware major version */
+    uint32_t fw_version_minor;                  /*!< Firmware minor version */
+    uint32_t fw_version_rev;                    /*!< Firmware revision */
+} whad_cap_cache_key_t;
+
+/* Cached discovery result. */
+typedef struct {
+    whad_cap_cache_key_t key;                   /*!< Device ID and firmware version */
+    whad_cap_index_t index;                     /*!< Domains, capabilities and supported commands */
+} whad_cap_cache_entry_t;
+
+/* Capability cache. */
+typedef struct {
+    whad_cap_cache_entry_t entries[WHAD_CAP_CACHE_MAX_ENTRIES];
+    int count;                                  /*!< Entries in use */
+    int next;                                   /*!< Entry replaced when the cache is full */
+    bool modified;                              /*!< Entries stored since the cache was loaded or saved */
+} whad_cap_cache_t;
+
+void whad_cap_cache_init(whad_cap_cache_t *p_cache);
+whad_result_t whad_cap_cache_load(whad_cap_cache_t *p_cache, const char *psz_path);
+whad_result_t whad_cap_cache_save(whad_cap_cache_t *p_cache, const char *psz_path);
+whad_result_t whad_cap_cache_get_key(Message *p_device_info, whad_cap_cache_key_t *p_key);
+whad_result_t whad_cap_cache_lookup(whad_cap_cache_t *p_cache, Message *p_device_info, whad_cap_index_t *p_index);
+whad_result_t whad_cap_cache_store(whad_cap_cache_t *p_cache, Message *p_device_info, const whad_cap_index_t *p_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_CAPCACHE_H */
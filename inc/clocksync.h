@@ -0,0 +1,93 @@
+/** \file clocksync.h
+ * WHAD device-to-host clock synchronization (host side).
+ *
+ * Device timestamps (BLE raw PDU timestamps, PHY timestamps, 802.15.4 energy
+ * detection samples, ESB and Unifying PDUs timestamps) are expressed in the
+ * device clock. The host periodically sends a clock synchronization query
+ * carrying its send time, the device echoes it along with its own reception
+ * and transmission times, and the host notes the reply arrival time. As with
+ * NTP, each exchange gives an offset between both clocks, with an error bound
+ * of half the round-trip delay spent outside the device.
+ *
+ * The estimator keeps the last `WHAD_CLOCK_SYNC_SAMPLES` exchanges, discards
+ * the ones delayed by queuing (e.g. a reply waiting behind notifications in the
+ * device TX ring buffer) and fits the remaining offsets against the device time
+ * to track the clock drift. Device timestamps are then converted into host time
+ * with an error bound.
+ *
+ * A single query (17 bytes at most) is in flight at any time and one is sent
+ * per period, so that synchronization does not disturb notification streaming.
+ * Times are in microseconds; host times must come from a monotonic clock.
+ */
+
+#ifndef __INC_WHAD_CLOCKSYNC_H
+#define __INC_WHAD_CLOCKSYNC_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of exchanges kept by the estimator. */
+#define WHAD_CLOCK_SYNC_SAMPLES             (16)
+
+/* Default query period, and delay after which a query is considered lost. */
+#define WHAD_CLOCK_SYNC_DEFAULT_PERIOD_US   (1000000)
+#define WHAD_CLOCK_SYNC_TIMEOUT_US          (500000)
+
+/* Exchanges delayed by more than twice the shortest delay plus this margin are discarded. */
+#define WHAD_CLOCK_SYNC_DELAY_MARGIN_US     (100)
+
+/* Shortest span of exchanges used to estimate the drift. */
+#define WHAD_CLOCK_SYNC_MIN_SPAN_US         (1000000)
+
+/* Drift bound assumed until it can be estimated (two crystals within 50 ppm). */
+#define WHAD_CLOCK_SYNC_MAX_DRIFT_PPM       (100)
+
+/* Clock synchronization exchange. */
+typedef struct {
+    uint64_t device_time;   /*!< Device time at the middle of the exchange */
+    int64_t offset;         /*!< Host time minus device time */
+    uint64_t delay;         /*!< Round-trip delay spent outside the device */
+} whad_clock_sync_sample_t;
+
+/* Clock synchronization estimate. */
+typedef struct {
+    int64_t offset;         /*!< Host time minus device time, at the reference device time */
+    double drift;           /*!< Host clock rate relative to the device clock, minus one */
+    uint64_t ref_time;      /*!< Reference device time */
+    uint64_t first_time;    /*!< Device time of the oldest exchange used */
+    uint64_t error;         /*!< Error bound within the exchanges used */
+    uint64_t error_rate;    /*!< Error bound increase per us outside the exchanges used, in ppm */
+    int samples;            /*!< Number of exchanges used */
+} whad_clock_sync_estimate_t;
+
+/* Clock synchronization state. */
+typedef struct {
+    whad_clock_sync_sample_t samples[WHAD_CLOCK_SYNC_SAMPLES];
+    int count;                          /*!< Number of exchanges stored */
+    int next;                           /*!< Index of the next exchange to store */
+    uint64_t period;                    /*!< Query period */
+    uint32_t sequence;                  /*!< Sequence number of the last query */
+    bool pending;                       /*!< A query is waiting for its reply */
+    uint64_t query_time;                /*!< Host time of the last query */
+    uint64_t next_query_time;           /*!< Host time of the next query */
+    bool valid;                         /*!< Estimate is available */
+    whad_clock_sync_estimate_t estimate;
+} whad_clock_sync_t;
+
+void whad_clock_sync_init(whad_clock_sync_t *p_sync, uint64_t period_us);
+whad_result_t whad_clock_sync_poll(whad_clock_sync_t *p_sync, uint64_t host_now, Message *p_query);
+whad_result_t whad_clock_sync_process(whad_clock_sync_t *p_sync, Message *p_reply, uint64_t host_now);
+whad_result_t whad_clock_sync_get_estimate(whad_clock_sync_t *p_sync, whad_clock_sync_estimate_t *p_estimate);
+whad_result_t whad_clock_sync_to_host(whad_clock_sync_t *p_sync, uint64_t device_time, uint64_t *p_host_time,
+                                      uint64_t *p_error);
+whad_result_t whad_clock_sync_to_host32(whad_clock_sync_t *p_sync, uint32_t device_time, uint64_t *p_host_time,
+                                        uint64_t *p_error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_CLOCKSYNC_H */
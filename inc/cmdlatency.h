@@ -0,0 +1,89 @@
+/** \file cmdlatency.h
+ * WHAD command latency breakdown (host side).
+ *
+ * A command round trip, measured by the host from the command being sent to
+ * its result being received, includes the transfer of the command, the device
+ * command handler, the time the result waits in the device TX ring buffer and
+ * the transfer of the result. Devices may send command results carrying the
+ * command timing (see `whad_generic_cmd_result_timed()`): the time the command
+ * was received, the handler duration and the number of bytes queued ahead of
+ * the result.
+ *
+ * The host notes every command it sends and every command result it receives,
+ * and the round trips are split into stages, aggregated per command type:
+ * - round_trip: from the command being sent to its result being received,
+ * - handler: from the command reception until its result was queued,
+ * - tx_queue: result waiting behind the queued bytes, from the link byte time,
+ * - link: what remains (both transfers, drivers and host scheduling),
+ * - request and response: the link stage split into the command and result
+ *   directions, only when device and host clocks are synchronized (see
+ *   clocksync.h).
+ *
+ * A single command is expected to be in flight at any time, as with every WHAD
+ * command. Times are in microseconds; host times must come from a monotonic
+ * clock.
+ */
+
+#ifndef __INC_WHAD_CMDLATENCY_H
+#define __INC_WHAD_CMDLATENCY_H
+
+#include "types.h"
+#include "clocksync.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of command types tracked. */
+#define WHAD_CMD_LATENCY_TYPES      (32)
+
+/* Command round trip stages. */
+typedef enum {
+    WHAD_CMD_STAGE_ROUND_TRIP = 0,
+    WHAD_CMD_STAGE_HANDLER,
+    WHAD_CMD_STAGE_TX_QUEUE,
+    WHAD_CMD_STAGE_LINK,
+    WHAD_CMD_STAGE_REQUEST,
+    WHAD_CMD_STAGE_RESPONSE,
+    WHAD_CMD_STAGES
+} whad_cmd_stage_t;
+
+/* Stage statistics, in us. */
+typedef struct {
+    uint32_t count;         /*!< Round trips measured */
+    uint64_t sum;           /*!< Sum of the stage durations */
+    uint64_t min;           /*!< Shortest stage duration */
+    uint64_t max;           /*!< Longest stage duration */
+} whad_cmd_stage_stats_t;
+
+/* Command type statistics. */
+typedef struct {
+    pb_size_t which_msg;        /*!< Command `Message` oneof tag (discovery or domain) */
+    pb_size_t which_submsg;     /*!< Command discovery or domain message oneof tag */
+    uint32_t results;           /*!< Command results received */
+    uint32_t untimed;           /*!< Command results without timing */
+    whad_cmd_stage_stats_t stages[WHAD_CMD_STAGES];
+} whad_cmd_latency_stats_t;
+
+/* Command latency tracker. */
+typedef struct {
+    whad_cmd_latency_stats_t types[WHAD_CMD_LATENCY_TYPES];
+    int count;                          /*!< Command types tracked */
+    uint64_t byte_time_ns;              /*!< Link byte time, 0 if unknown */
+    whad_clock_sync_t *p_sync;          /*!< Clock synchronization state, may be NULL */
+    bool pending;                       /*!< A command is waiting for its result */
+    int pending_type;                   /*!< Type index of the pending command */
+    uint64_t sent_time;                 /*!< Host time at which the pending command was sent */
+} whad_cmd_latency_t;
+
+void whad_cmd_latency_init(whad_cmd_latency_t *p_latency, uint32_t baudrate, whad_clock_sync_t *p_sync);
+whad_result_t whad_cmd_latency_sent(whad_cmd_latency_t *p_latency, Message *p_command, uint64_t host_now);
+whad_result_t whad_cmd_latency_process(whad_cmd_latency_t *p_latency, Message *p_reply, uint64_t host_now);
+int whad_cmd_latency_get_count(whad_cmd_latency_t *p_latency);
+whad_result_t whad_cmd_latency_get_stats(whad_cmd_latency_t *p_latency, int index, whad_cmd_latency_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_CMDLATENCY_H */
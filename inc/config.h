@@ -0,0 +1,134 @@
+/** \file config.h
+ * WHAD library build configuration.
+ *
+ * Every domain is enabled by default. A domain is removed from the library
+ * (C API, NanoPb messages and descriptors, see protocol.h, and compact message
+ * members) by defining its `WHAD_ENABLE_<DOMAIN>` macro to 0 at build time,
+ * e.g. `-DWHAD_ENABLE_PHY=0`. The same macros must be used when building the
+ * library and the firmware that links against it, as they change the layout
+ * of `Message`.
+ *
+ * Buffer sizes may be overridden the same way. Every statically allocated
+ * buffer of the library is sized by one of the following macros:
+ * - `WHAD_MESSAGE_MAX_SIZE`: received messages buffer (whad.c),
+ * - `WHAD_RINGBUF_MAX_SIZE`: transport RX and TX ring buffers (transport.c),
+ * - `WHAD_TX_CHUNK_MAX_SIZE`: buffer handed to the send callback (transport.c).
+ *
+ * `make memory-report` shows the resulting RAM and flash use per module and
+ * per domain.
+ *
+ * Firmware sends its messages along one of three paths, which all produce the
+ * same bytes on the link:
+ * - `Message` builders and `whad_send_message()`: every message, including
+ *   command answers and the rare large ones (PHY supported frequencies,
+ *   device info); a `Message` takes several kilobytes of RAM,
+ * - compact messages (`*_compact()` builders and
+ *   `whad_send_compact_message()`, see `whad_compact_msg_t`): default path
+ *   for notifications, a few dozen bytes per message, radio payloads being
+ *   streamed from the caller buffer (see txmsg.h),
+ * - notification templates (`*_template()` and `*_template_send()`, see
+ *   template.h): raw PDUs and PHY packets reported many times per second
+ *   during a sniffing session, whose constant fields are encoded once per
+ *   session. They are the fastest path but are not traced (see trace.h).
+ *
+ * The C library never allocates memory: builders reference caller-provided or
+ * static storage and variable-length fields are decoded into arenas (see
+ * arena.h). Defining `WHAD_NO_HEAP` (`make WHAD_NO_HEAP=1`) enforces it for
+ * firmware that forbids the heap: the C++ wrappers, which rely on
+ * `std::string` and `std::vector`, are left out of the library and the build
+ * fails if any object references an allocation function. Firmware may enforce
+ * the same policy at its final link with `-Wl,--wrap=malloc` (and `calloc`,
+ * `realloc`, `free`) without defining the wrappers.
+ */
+
+#ifndef __INC_WHAD_CONFIG_H
+#define __INC_WHAD_CONFIG_H
+
+/* Bluetooth Low Energy domain. */
+#ifndef WHAD_ENABLE_BLE
+#define WHAD_ENABLE_BLE             (1)
+#endif
+
+/* IEEE 802.15.4 domain. */
+#ifndef WHAD_ENABLE_DOT15D4
+#define WHAD_ENABLE_DOT15D4         (1)
+#endif
+
+/* Enhanced ShockBurst domain. */
+#ifndef WHAD_ENABLE_ESB
+#define WHAD_ENABLE_ESB             (1)
+#endif
+
+/* Logitech Unifying domain. */
+#ifndef WHAD_ENABLE_UNIFYING
+#define WHAD_ENABLE_UNIFYING        (1)
+#endif
+
+/* PHY domain. */
+#ifndef WHAD_ENABLE_PHY
+#define WHAD_ENABLE_PHY             (1)
+#endif
+
+/*
+ * Maximum size of a serialized message, transport header excluded. Messages
+ * are received in a buffer of this size, and larger messages are neither sent
+ * nor received: received ones are discarded and answered with an error
+ * command result. Firmwares accepting full BLE PrepareSequence commands (7061
+ * bytes) must raise it to 8192.
+ */
+#ifndef WHAD_MESSAGE_MAX_SIZE
+#define WHAD_MESSAGE_MAX_SIZE       (4096)
+#endif
+
+/*
+ * Size of the transport RX and TX ring buffers. Messages larger than these
+ * buffers are streamed through them, which busy-waits for the ongoing
+ * transmissions when sending (see whad_transport_write()).
+ */
+#ifndef WHAD_RINGBUF_MAX_SIZE
+#define WHAD_RINGBUF_MAX_SIZE       (1024)
+#endif
+
+/*
+ * Maximum number of bytes handed at once to the transport send callback, which
+ * are copied from the TX ring buffer into a dedicated buffer of this size so
+ * that the callback may send them asynchronously.
+ */
+#ifndef WHAD_TX_CHUNK_MAX_SIZE
+#define WHAD_TX_CHUNK_MAX_SIZE      (WHAD_RINGBUF_MAX_SIZE)
+#endif
+
+/*
+ * Number of frequency ranges copied by whad_phy_supported_frequencies(), which
+ * keeps its copy in static storage. whad_phy_supported_frequency_ranges()
+ * references the caller's ranges and has no such limit.
+ */
+#ifndef WHAD_PHY_MAX_FREQUENCY_RANGES
+#define WHAD_PHY_MAX_FREQUENCY_RANGES   (16)
+#endif
+
+/* The transport header stores the message size on 16 bits. */
+#if (WHAD_MESSAGE_MAX_SIZE > 65535)
+#error "WHAD_MESSAGE_MAX_SIZE cannot exceed 65535 bytes"
+#endif
+
+#if (WHAD_MESSAGE_MAX_SIZE < 1)
+#error "WHAD_MESSAGE_MAX_SIZE must be positive"
+#endif
+
+/* Ring buffers must hold a transport header or a pre-encoded command result frame. */
+#if (WHAD_RINGBUF_MAX_SIZE < 16)
+#error "WHAD_RINGBUF_MAX_SIZE must be at least 16 bytes"
+#endif
+
+/* Bytes handed to the send callback are read from the TX ring buffer. */
+#if (WHAD_TX_CHUNK_MAX_SIZE < 1) || (WHAD_TX_CHUNK_MAX_SIZE > WHAD_RINGBUF_MAX_SIZE)
+#error "WHAD_TX_CHUNK_MAX_SIZE must be between 1 and WHAD_RINGBUF_MAX_SIZE bytes"
+#endif
+
+/* NanoPb must not allocate decoded fields either. */
+#if defined(WHAD_NO_HEAP) && defined(PB_ENABLE_MALLOC)
+#error "WHAD_NO_HEAP cannot be used with PB_ENABLE_MALLOC"
+#endif
+
+#endif /* __INC_WHAD_CONFIG_H */
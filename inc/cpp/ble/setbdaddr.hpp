@@ -15,6 +15,11 @@ namespace whad::ble {
             SetBdAddress(BDAddress address);
 
             BDAddress *getAddress();
+
+        private:
+            void pack();
+
+            BDAddress m_address;
     };
 
 }
@@ -21,15 +21,17 @@ namespace whad::discovery {
     {
         public:
             DeviceInfoQuery(DiscoveryMsg &message);
-            DeviceInfoQuery(uint32_t protoVersion);
+            DeviceInfoQuery(uint32_t protoVersion, bool describeAll = false);
 
             uint32_t getVersion();
+            bool isDescribeAll();
 
         private:
             void pack();
             void unpack();
 
             uint32_t m_version;
+            bool m_describeAll;
     };
 
     /* Device information response. */
@@ -46,8 +48,24 @@ namespace whad::discovery {
                 uint32_t fwVersionMajor,
                 uint32_t fwVersionMinor,
                 uint32_t fwVersionRevision,
-                whad_domain_desc_t *capabilities
+                whad_domain_desc_t *capabilities,
+                bool describeAll = false
             );
+
+        private:
+            void pack();
+
+            Devices m_deviceType;
+            uint8_t m_deviceId[16];
+            uint32_t m_protoMinVer;
+            uint32_t m_maxSpeed;
+            std::string m_firmwareAuthor;
+            std::string m_firmwareUrl;
+            uint32_t m_fwVersionMajor;
+            uint32_t m_fwVersionMinor;
+            uint32_t m_fwVersionRevision;
+            whad_domain_desc_t *m_capabilities;
+            bool m_describeAll;
     };
 }
 
@@ -26,6 +26,28 @@ namespace whad::discovery {
 
     bool isDomainSupported(const whad_domain_desc_t *capabilities, Domains domain);
 
+    /* Capability index, answering support queries in constant time. */
+    class CapabilityIndex
+    {
+        public:
+            CapabilityIndex();
+            CapabilityIndex(const whad_domain_desc_t *capabilities);
+
+            bool addDeviceInfo(NanoPbMsg &message);
+            bool addDeviceDescription(NanoPbMsg &message);
+            bool addDomainInfo(NanoPbMsg &message);
+
+            bool isDomainSupported(Domains domain) const;
+            bool isCommandSupported(Domains domain, uint32_t command) const;
+            uint64_t getSupportedCommands(Domains domain) const;
+
+        private:
+            whad_cap_index_t m_index;
+    };
+
+    bool isDomainSupported(const CapabilityIndex &index, Domains domain);
+    bool isCommandSupported(const CapabilityIndex &index, Domains domain, uint32_t command);
+
     /* Device domain information query. */
     class DomainInfoQuery : public DiscoveryMsg
     {
@@ -49,6 +71,12 @@ namespace whad::discovery {
     {
         public:
             DomainInfoResp(Domains domain, whad_domain_desc_t *capabilities);
+
+        private:
+            void pack();
+
+            Domains m_domain;
+            whad_domain_desc_t *m_capabilities;
     };
 }
 
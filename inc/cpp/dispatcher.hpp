@@ -0,0 +1,198 @@
+#ifndef __INC_WHAD_DISPATCHER_HPP
+#define __INC_WHAD_DISPATCHER_HPP
+
+#include "message.hpp"
+#include "generic/generic.hpp"
+#include "discovery/base.hpp"
+#if WHAD_ENABLE_BLE
+#include "ble/base.hpp"
+#endif
+#if WHAD_ENABLE_DOT15D4
+#include "dot15d4/base.hpp"
+#endif
+#if WHAD_ENABLE_ESB
+#include "esb/base.hpp"
+#endif
+#if WHAD_ENABLE_UNIFYING
+#include "unifying/base.hpp"
+#endif
+#if WHAD_ENABLE_PHY
+#include "phy/base.hpp"
+#endif
+
+/* Number of handler slots per message category (highest message tag + 1, 0 if disabled). */
+#define WHAD_DISPATCH_GENERIC_SLOTS     (generic_Message_log_tag + 1)
+#define WHAD_DISPATCH_DISCOVERY_SLOTS   (discovery_Message_set_speed_tag + 1)
+#if WHAD_ENABLE_BLE
+#define WHAD_DISPATCH_BLE_SLOTS         (ble_Message_delete_seq_tag + 1)
+#else
+#define WHAD_DISPATCH_BLE_SLOTS         (0)
+#endif
+#if WHAD_ENABLE_DOT15D4
+#define WHAD_DISPATCH_DOT15D4_SLOTS     (dot15d4_Message_pdu_tag + 1)
+#else
+#define WHAD_DISPATCH_DOT15D4_SLOTS     (0)
+#endif
+#if WHAD_ENABLE_ESB
+#define WHAD_DISPATCH_ESB_SLOTS         (esb_Message_pdu_tag + 1)
+#else
+#define WHAD_DISPATCH_ESB_SLOTS         (0)
+#endif
+#if WHAD_ENABLE_UNIFYING
+#define WHAD_DISPATCH_UNIFYING_SLOTS    (unifying_Message_sniff_pairing_tag + 1)
+#else
+#define WHAD_DISPATCH_UNIFYING_SLOTS    (0)
+#endif
+#if WHAD_ENABLE_PHY
+#define WHAD_DISPATCH_PHY_SLOTS         (phy_Message_sched_pkt_sent_tag + 1)
+#else
+#define WHAD_DISPATCH_PHY_SLOTS         (0)
+#endif
+
+/* Offset of each message category in the handlers table. */
+#define WHAD_DISPATCH_GENERIC_OFFSET    (0)
+#define WHAD_DISPATCH_DISCOVERY_OFFSET  (WHAD_DISPATCH_GENERIC_OFFSET + WHAD_DISPATCH_GENERIC_SLOTS)
+#define WHAD_DISPATCH_BLE_OFFSET        (WHAD_DISPATCH_DISCOVERY_OFFSET + WHAD_DISPATCH_DISCOVERY_SLOTS)
+#define WHAD_DISPATCH_DOT15D4_OFFSET    (WHAD_DISPATCH_BLE_OFFSET + WHAD_DISPATCH_BLE_SLOTS)
+#define WHAD_DISPATCH_ESB_OFFSET        (WHAD_DISPATCH_DOT15D4_OFFSET + WHAD_DISPATCH_DOT15D4_SLOTS)
+#define WHAD_DISPATCH_UNIFYING_OFFSET   (WHAD_DISPATCH_ESB_OFFSET + WHAD_DISPATCH_ESB_SLOTS)
+#define WHAD_DISPATCH_PHY_OFFSET        (WHAD_DISPATCH_UNIFYING_OFFSET + WHAD_DISPATCH_UNIFYING_SLOTS)
+#define WHAD_DISPATCH_SLOTS             (WHAD_DISPATCH_PHY_OFFSET + WHAD_DISPATCH_PHY_SLOTS)
+
+namespace whad
+{
+    /*! Type-erased message handler, as stored in a dispatcher table. */
+    typedef void (*DispatchHandler)(NanoPbMsg &message, void *pContext);
+
+    namespace dispatch
+    {
+        /**
+         * Message category traits: base wrapper class, message type enum and
+         * location of the category in the handlers table.
+         */
+
+        template <typename B, typename E, int Offset, int Slots>
+        struct Category
+        {
+            typedef B Base;                         /*!< Category base wrapper class. */
+            typedef E Type;                         /*!< Category message type enum. */
+            static constexpr int offset = Offset;   /*!< First slot of the category. */
+            static constexpr int slots = Slots;     /*!< Number of slots of the category. */
+        };
+
+        /*
+         * Category lookup, resolved from the wrapper base class. These are only
+         * used in unevaluated contexts and are never defined.
+         */
+
+        Category<generic::GenericMsg, generic::MessageType,
+                 WHAD_DISPATCH_GENERIC_OFFSET, WHAD_DISPATCH_GENERIC_SLOTS> categoryOf(const generic::GenericMsg*);
+        Category<discovery::DiscoveryMsg, discovery::MessageType,
+                 WHAD_DISPATCH_DISCOVERY_OFFSET, WHAD_DISPATCH_DISCOVERY_SLOTS> categoryOf(const discovery::DiscoveryMsg*);
+#if WHAD_ENABLE_BLE
+        Category<ble::BleMsg, ble::MessageType,
+                 WHAD_DISPATCH_BLE_OFFSET, WHAD_DISPATCH_BLE_SLOTS> categoryOf(const ble::BleMsg*);
+#endif
+#if WHAD_ENABLE_DOT15D4
+        Category<dot15d4::Dot15d4Msg, dot15d4::MessageType,
+                 WHAD_DISPATCH_DOT15D4_OFFSET, WHAD_DISPATCH_DOT15D4_SLOTS> categoryOf(const dot15d4::Dot15d4Msg*);
+#endif
+#if WHAD_ENABLE_ESB
+        Category<esb::EsbMsg, esb::MessageType,
+                 WHAD_DISPATCH_ESB_OFFSET, WHAD_DISPATCH_ESB_SLOTS> categoryOf(const esb::EsbMsg*);
+#endif
+#if WHAD_ENABLE_UNIFYING
+        Category<unifying::UnifyingMsg, unifying::MessageType,
+                 WHAD_DISPATCH_UNIFYING_OFFSET, WHAD_DISPATCH_UNIFYING_SLOTS> categoryOf(const unifying::UnifyingMsg*);
+#endif
+#if WHAD_ENABLE_PHY
+        Category<phy::PhyMsg, phy::MessageType,
+                 WHAD_DISPATCH_PHY_OFFSET, WHAD_DISPATCH_PHY_SLOTS> categoryOf(const phy::PhyMsg*);
+#endif
+
+        /*! Traits of the category wrapper class T belongs to. */
+        template <typename T>
+        using CategoryOf = decltype(categoryOf(static_cast<const T*>(nullptr)));
+
+        /**
+         * @brief   Wrap a message into T and forward it to Handler.
+         *
+         * Both the category base wrapper and the T wrapper are built on the
+         * stack and only reference the received NanoPb message.
+         **/
+
+        template <typename T, void (*Handler)(T &message, void *pContext)>
+        void invoke(NanoPbMsg &message, void *pContext)
+        {
+            typename CategoryOf<T>::Base base(message);
+            T wrapped(base);
+
+            Handler(wrapped, pContext);
+        }
+    }
+
+    /**
+     * Table-driven message dispatcher.
+     *
+     * Handlers are stored in a flat table indexed by the message category
+     * (`Message.which_msg`) and the message type (`which_msg` of the category
+     * message), so that dispatching a message costs a single table lookup.
+     * Handlers are bound at compile time, which allows a dispatcher to be
+     * fully built as a `constexpr` object and placed in read-only memory.
+     **/
+
+    class Dispatcher
+    {
+        private:
+            DispatchHandler m_handlers[WHAD_DISPATCH_SLOTS];    /*!< Handlers table. */
+            DispatchHandler m_default;                          /*!< Handler called for unhandled messages. */
+
+        public:
+
+            /* Constructor. */
+            constexpr Dispatcher() : m_handlers{}, m_default(nullptr)
+            {
+            }
+
+            /**
+             * @brief   Register a handler for a message type.
+             *
+             * The wrapper class T determines the message category, and must be
+             * constructible from its category base class.
+             *
+             * @param[in]   type    Message type, from the category MessageType enum
+             *
+             * @retval      true    Handler registered
+             * @retval      false   Message type out of range
+             **/
+
+            template <typename T, void (*Handler)(T &message, void *pContext)>
+            constexpr bool on(typename dispatch::CategoryOf<T>::Type type)
+            {
+                typedef dispatch::CategoryOf<T> Cat;
+
+                if (((int)type <= 0) || ((int)type >= Cat::slots))
+                    return false;
+
+                m_handlers[Cat::offset + (int)type] = &dispatch::invoke<T, Handler>;
+                return true;
+            }
+
+            /**
+             * @brief   Set the handler called for messages without a registered handler.
+             *
+             * @param[in]   handler     Default handler, nullptr to ignore these messages
+             **/
+
+            constexpr void otherwise(DispatchHandler handler)
+            {
+                m_default = handler;
+            }
+
+            /* Dispatching. */
+            bool dispatch(NanoPbMsg &message, void *pContext = nullptr) const;
+            bool dispatch(Message *p_message, void *pContext = nullptr) const;
+    };
+}
+
+#endif /* __INC_WHAD_DISPATCHER_HPP */
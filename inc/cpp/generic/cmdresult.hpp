@@ -23,21 +23,32 @@ enum ResultCode {
  * The CommandResult class represents a result returned by a firmware
  * and contains a code indicating a specific status. This code is used
  * to report success, errors but also some notifications.
+ *
+ * Results may also carry the command timing, in device microseconds: the
+ * time the command was received, the handler duration and the number of
+ * bytes queued for transmission ahead of the result.
  */
 
 class CommandResult : public GenericMsg
 {
     public:
         CommandResult(ResultCode result);
+        CommandResult(ResultCode result, uint32_t rxTime, uint32_t duration, uint32_t txBacklog);
         CommandResult(NanoPbMsg message);
 
         ResultCode getResultCode();
+        bool hasTiming();
+        uint32_t getRxTime();
+        uint32_t getDuration();
+        uint32_t getTxBacklog();
 
     private:
         void pack();
         void unpack();
 
         ResultCode m_code;
+        bool m_timed;
+        whad_cmd_timing_t m_timing;
 };
 
 /**
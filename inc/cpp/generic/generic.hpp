@@ -15,7 +15,10 @@ namespace whad
             CommandResultMsg = WHAD_GENERIC_CMDRESULT,  /*!< Command result. */
             VerboseMsg = WHAD_GENERIC_VERBOSE,          /*!< Verbose message. */
             DebugMsg = WHAD_GENERIC_DEBUG,              /*!< Debug message. */
-            ProgressMsg = WHAD_GENERIC_PROGRESS         /*!< Progress message. */
+            ProgressMsg = WHAD_GENERIC_PROGRESS,        /*!< Progress message. */
+            TimeSyncQueryMsg = WHAD_GENERIC_TIME_SYNC_QUERY,    /*!< Clock synchronization query. */
+            TimeSyncReplyMsg = WHAD_GENERIC_TIME_SYNC_REPLY,    /*!< Clock synchronization reply. */
+            LogMsg = WHAD_GENERIC_LOG                   /*!< Binary log message. */
         };
 
 
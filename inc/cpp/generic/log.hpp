@@ -0,0 +1,30 @@
+#ifndef __INC_WHAD_GENERIC_LOG_HPP
+#define __INC_WHAD_GENERIC_LOG_HPP
+
+#include <vector>
+#include "../../log.h"
+#include "message.hpp"
+#include "common.hpp"
+#include "generic/generic.hpp"
+
+namespace whad::generic {
+
+    /* Binary log message, sent by the device (see log.h). */
+    class Log : public GenericMsg
+    {
+        public:
+            Log(NanoPbMsg message);
+
+            uint32_t getDropped();
+            std::vector<whad_log_entry_t> getEntries();
+
+        private:
+            void unpack();
+
+            uint32_t m_dropped;
+            std::vector<whad_log_entry_t> m_entries;
+    };
+
+}
+
+#endif /* __INC_WHAD_GENERIC_LOG_HPP */
@@ -0,0 +1,51 @@
+#ifndef __INC_WHAD_GENERIC_TIMESYNC_HPP
+#define __INC_WHAD_GENERIC_TIMESYNC_HPP
+
+#include <string>
+#include "message.hpp"
+#include "common.hpp"
+#include "generic/generic.hpp"
+
+namespace whad::generic {
+
+    /* Clock synchronization query, sent by the host. */
+    class TimeSyncQuery : public GenericMsg
+    {
+        public:
+            TimeSyncQuery(uint32_t sequence, uint64_t hostTime);
+            TimeSyncQuery(NanoPbMsg message);
+
+            uint32_t getSequence();
+            uint64_t getHostTime();
+
+        private:
+            void pack();
+            void unpack();
+
+            uint32_t m_sequence;
+            uint64_t m_hostTime;
+    };
+
+    /* Clock synchronization reply, sent by the device. */
+    class TimeSyncReply : public GenericMsg
+    {
+        public:
+            TimeSyncReply(TimeSyncQuery &query, uint64_t rxTime, uint64_t txTime);
+            TimeSyncReply(uint32_t sequence, uint64_t hostTime, uint64_t rxTime, uint64_t txTime);
+            TimeSyncReply(NanoPbMsg message);
+
+            uint32_t getSequence();
+            uint64_t getHostTime();
+            uint64_t getRxTime();
+            uint64_t getTxTime();
+
+        private:
+            void pack();
+            void unpack();
+
+            whad_time_sync_reply_params_t m_params;
+    };
+
+}
+
+#endif /* __INC_WHAD_GENERIC_TIMESYNC_HPP */
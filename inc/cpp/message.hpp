@@ -30,6 +30,12 @@ namespace whad
 
     /**
      * Whad Nanopb message wrapper class.
+     *
+     * A message built from a NanoPb message (received messages) wraps it.
+     * Default-constructed messages, built by the application to be sent, all
+     * share one static NanoPb message: their parameters are only packed into
+     * it by getRaw(), and each of them must be sent before another one is
+     * packed. Such messages must not be packed from several threads.
      **/
 
     class NanoPbMsg
@@ -46,6 +52,12 @@ namespace whad
 
             /* Accessor. */
             Message *getMessage(void);
+
+            /*
+             * Pack the message and return its NanoPb message. For default-
+             * constructed messages, it is shared and only valid until the
+             * next getRaw() call of any of them.
+             */
             Message *getRaw(void);
             MessageType getType(void);
             MessageDomain getDomain(void);
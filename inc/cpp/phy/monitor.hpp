@@ -15,6 +15,9 @@ namespace whad::phy {
         public:
             MonitorMode(PhyMsg &message);
             MonitorMode();
+
+        private:
+            void pack();
     };
 
 }
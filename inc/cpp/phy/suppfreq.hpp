@@ -19,7 +19,7 @@ namespace whad::phy {
         private:
             void pack();
 
-            const whad_phy_frequency_range_t *m_freqRanges;
+            whad_phy_frequency_ranges_t m_freqRanges;
     };
 
 }
@@ -7,29 +7,45 @@
 #include <generic/cmdresult.hpp>
 #include <generic/verbose.hpp>
 #include <generic/debug.hpp>
+#include <generic/timesync.hpp>
+#include <generic/log.hpp>
 
 /* Discovery messages. */
 #include <discovery/discovery.hpp>
 
 /* ESB */
+#if WHAD_ENABLE_ESB
 #include <esb/esb.hpp>
+#endif
 
 /* PHY messages. */
+#if WHAD_ENABLE_PHY
 #include <phy/phy.hpp>
+#endif
 
 /* BLE messages. */
+#if WHAD_ENABLE_BLE
 #include <ble/ble.hpp>
+#endif
 
 /* ZigBee messages. */
+#if WHAD_ENABLE_DOT15D4
 #include <dot15d4/dot15d4.hpp>
+#endif
 
 /* Unifying messages. */
+#if WHAD_ENABLE_UNIFYING
 #include <unifying/unifying.hpp>
+#endif
+
+/* Message dispatcher. */
+#include <dispatcher.hpp>
 
 
 namespace whad
 {
-    void send(NanoPbMsg message);
+    void send(NanoPbMsg &message);
+    void send(NanoPbMsg &&message);
 }
 
 #endif /* __INC_WHAD_HPP */
\ No newline at end of file
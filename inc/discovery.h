@@ -59,9 +59,37 @@ typedef struct {
     uint64_t supported_commands;
 } whad_domain_desc_t;
 
+/*
+ * Capability index. Domain values only use their most significant byte, which
+ * indexes the capabilities and supported commands of every domain.
+ */
+#define WHAD_DOMAIN_INDEX_SHIFT         (24)
+#define WHAD_DOMAIN_INDEX(domain)       ((uint32_t)(domain) >> WHAD_DOMAIN_INDEX_SHIFT)
+#define WHAD_CAP_INDEX_DOMAINS          (WHAD_DOMAIN_INDEX(_discovery_Domain_MAX) + 1)
+
+typedef struct {
+    uint32_t domains;                               /*!< Supported domains, one bit per domain index */
+    uint8_t capabilities[WHAD_CAP_INDEX_DOMAINS];   /*!< Capabilities flags of each domain */
+    uint64_t commands[WHAD_CAP_INDEX_DOMAINS];      /*!< Supported commands of each domain */
+} whad_cap_index_t;
+
 /* Determine if a given domain is supported. */
 bool whad_discovery_is_domain_supported(const whad_domain_desc_t *p_capabilities, whad_domain_t domain);
 
+/* Get the supported commands of a domain. */
+uint64_t whad_discovery_get_supported_commands(whad_domain_t domain, whad_domain_desc_t *p_capabilities);
+
+/* Build and query a capability index. */
+void whad_cap_index_init(whad_cap_index_t *p_index);
+whad_result_t whad_cap_index_build(whad_cap_index_t *p_index, const whad_domain_desc_t *p_capabilities);
+whad_result_t whad_cap_index_add_device_info(whad_cap_index_t *p_index, Message *p_message);
+whad_result_t whad_cap_index_add_device_description(whad_cap_index_t *p_index, Message *p_message);
+whad_result_t whad_cap_index_add_domain_info(whad_cap_index_t *p_index, Message *p_message);
+bool whad_cap_index_is_domain_supported(const whad_cap_index_t *p_index, whad_domain_t domain);
+bool whad_cap_index_is_command_supported(const whad_cap_index_t *p_index, whad_domain_t domain, uint32_t command);
+uint8_t whad_cap_index_get_capabilities(const whad_cap_index_t *p_index, whad_domain_t domain);
+uint64_t whad_cap_index_get_supported_commands(const whad_cap_index_t *p_index, whad_domain_t domain);
+
 /* Get discovery message type from NanoPb message. */
 whad_discovery_msgtype_t whad_discovery_get_message_type(Message *p_message);
 
@@ -69,11 +97,15 @@ whad_discovery_msgtype_t whad_discovery_get_message_type(Message *p_message);
 whad_result_t whad_discovery_device_info_query(Message *p_message, uint32_t proto_version);
 whad_result_t whad_discovery_device_info_query_parse(Message *p_message, uint32_t *p_proto_version);
 
+/* Create/check a device describe query (device info query describing every domain). */
+whad_result_t whad_discovery_device_describe_query(Message *p_message, uint32_t proto_version);
+bool whad_discovery_device_info_query_is_describe(Message *p_message);
+
 /* Create/parse a domain info query. */
 whad_result_t whad_discovery_domain_info_query(Message *p_message, whad_domain_t domain);
 whad_result_t whad_discovery_domain_info_query_parse(Message *p_message, whad_domain_t *p_domain);
 
-/* Create a device info response. */
+/* Create a device info response, parse its capabilities. */
 whad_result_t whad_discovery_device_info_resp(
     Message *p_message,
     discovery_DeviceType device_type,
@@ -86,6 +118,14 @@ whad_result_t whad_discovery_device_info_resp(
     uint32_t fw_version_minor,
     uint32_t fw_version_rev,
     whad_domain_desc_t *capabilities);
+whad_result_t whad_discovery_device_info_resp_capabilities_parse(Message *p_message, uint32_t **pp_capabilities,
+                                                                 int *p_count);
+
+/* Describe every domain in a device info response, parse them. */
+whad_result_t whad_discovery_device_info_resp_add_domains(Message *p_message, whad_domain_desc_t *capabilities);
+whad_result_t whad_discovery_device_info_resp_domains_parse(Message *p_message,
+                                                            discovery_DeviceDomainInfoResp **pp_domains,
+                                                            int *p_count);
 
 /* Create/parse a domain info response. */
 whad_result_t whad_discovery_domain_info_resp(Message *p_message, whad_domain_t domain, whad_domain_desc_t *p_capabilities);
@@ -102,6 +142,10 @@ whad_result_t whad_discovery_ready_resp(Message *p_message);
 whad_result_t whad_discovery_set_speed(Message *p_message, uint32_t speed);
 whad_result_t whad_discovery_set_speed_parse(Message *p_message, uint32_t *p_speed);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_discovery_ready_resp_compact(whad_compact_msg_t *p_message);
+whad_result_t whad_discovery_domain_info_resp_compact(whad_compact_msg_t *p_message, whad_domain_t domain, whad_domain_desc_t *p_capabilities);
+
 #ifdef __cplusplus
 }
 #endif
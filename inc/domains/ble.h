@@ -2,6 +2,7 @@
 #define __INC_WHAD_BLE_H
 
 #include "types.h"
+#include "template.h"
 
 #define BLE_PREPSEQ_PACKET_MAX_SIZE     255
 #define BLE_PREPSEQ_TRIGGER_MAX_SIZE    255
@@ -432,6 +433,33 @@ whad_result_t whad_ble_hijacked_parse(Message *p_message, whad_ble_hijacked_para
 whad_result_t whad_ble_injected(Message *p_message, uint32_t access_address, uint32_t attempts, bool success);
 whad_result_t whad_ble_injected_parse(Message *p_message, whad_ble_injected_params_t *p_parameters);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_ble_synchronized_compact(whad_compact_msg_t *p_message, uint32_t access_address, uint32_t crc_init,
+                                            uint32_t hop_interval, uint32_t hop_increment, uint8_t *p_channelmap);
+whad_result_t whad_ble_desynchronized_compact(whad_compact_msg_t *p_message, uint32_t access_address);
+whad_result_t whad_ble_triggered_compact(whad_compact_msg_t *p_message, uint32_t id);
+whad_result_t whad_ble_hijacked_compact(whad_compact_msg_t *p_message, uint32_t access_address, bool success);
+whad_result_t whad_ble_injected_compact(whad_compact_msg_t *p_message, uint32_t access_address, uint32_t attempts, bool success);
+whad_result_t whad_ble_notify_disconnected_compact(whad_compact_msg_t *p_message, uint32_t conn_handle, uint32_t reason);
+whad_result_t whad_ble_adv_pdu_compact(whad_compact_msg_t *p_message, whad_ble_advtype_t adv_type, int32_t rssi,
+                                       uint8_t *p_bdaddr, whad_ble_addrtype_t addr_type, uint8_t *p_adv_data,
+                                       int adv_data_length);
+whad_result_t whad_ble_raw_pdu_compact(whad_compact_msg_t *p_message, uint32_t channel, int32_t rssi,
+                                       uint32_t conn_handle, uint32_t access_address, uint8_t *p_pdu, int length,
+                                       uint32_t crc, bool crc_validity, uint32_t timestamp,
+                                       uint32_t relative_timestamp, whad_ble_direction_t direction, bool processed,
+                                       bool decrypted, bool use_timestamp);
+
+/* Notification templates (see whad_template_t). */
+whad_result_t whad_ble_raw_pdu_template(whad_template_t *p_template, uint32_t conn_handle, uint32_t access_address,
+                                        whad_ble_direction_t direction, bool processed, bool decrypted, bool use_timestamp);
+whad_result_t whad_ble_raw_pdu_template_send(whad_template_t *p_template, uint32_t channel, int32_t rssi,
+                                             uint8_t *p_pdu, int length, uint32_t crc, bool crc_validity,
+                                             uint32_t timestamp, uint32_t relative_timestamp);
+
+/* Fast-path command decoders (see whad_get_raw_message()). */
+whad_result_t whad_ble_send_raw_pdu_fast_parse(uint8_t *p_message, int size, whad_ble_pdu_params_t *p_parameters);
+whad_result_t whad_ble_send_pdu_fast_parse(uint8_t *p_message, int size, whad_ble_pdu_params_t *p_parameters);
 
 #ifdef __cplusplus
 }
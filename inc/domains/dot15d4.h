@@ -2,6 +2,7 @@
 #define __INC_WHAD_DOT15D4_H
 
 #include "types.h"
+#include "template.h"
 
 #define DOT15D4_PACKET_MAX_SIZE  (255)
 
@@ -59,6 +60,13 @@ typedef struct {
     uint32_t fcs;
 } whad_dot15d4_send_params_t;
 
+typedef struct {
+    uint32_t channel;
+    uint8_t *p_pdu;
+    int length;
+    uint32_t fcs;
+} whad_dot15d4_send_fast_params_t;
+
 typedef struct {
     uint32_t timestamp;
     uint32_t sample;
@@ -120,6 +128,17 @@ whad_result_t whad_dot15d4_raw_pdu_received_parse(Message *p_message, whad_dot15
 whad_result_t whad_dot15d4_pdu_received(Message *p_message, whad_dot15d4_recvd_packet_t *p_packet);
 whad_result_t whad_dot15d4_pdu_received_parse(Message *p_message, whad_dot15d4_recvd_packet_t *p_packet);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_dot15d4_jammed_compact(whad_compact_msg_t *p_message, uint32_t timestamp);
+whad_result_t whad_dot15d4_energy_detect_sample_compact(whad_compact_msg_t *p_message, uint32_t timestamp, uint32_t sample);
+whad_result_t whad_dot15d4_pdu_received_compact(whad_compact_msg_t *p_message, whad_dot15d4_recvd_packet_t *p_packet);
+
+/* Notification templates (see whad_template_t). */
+whad_result_t whad_dot15d4_raw_pdu_template(whad_template_t *p_template, whad_dot15d4_recvd_packet_t *p_model);
+whad_result_t whad_dot15d4_raw_pdu_template_send(whad_template_t *p_template, whad_dot15d4_recvd_packet_t *p_pdu);
+
+/* Fast-path command decoders (see whad_get_raw_message()). */
+whad_result_t whad_dot15d4_send_raw_fast_parse(uint8_t *p_message, int size, whad_dot15d4_send_fast_params_t *p_params);
 
 #ifdef __cplusplus
 }
@@ -2,6 +2,7 @@
 #define __INC_WHAD_ESB_H
 
 #include "types.h"
+#include "template.h"
 
 #define ESB_PACKET_MAX_SIZE     255
 #define ESB_ADDR_MAX_SIZE       5
@@ -81,6 +82,17 @@ typedef struct {
     whad_esb_packet_t packet;
 } whad_esb_send_params_t;
 
+/**
+ * ESB SendCmd parameters, as extracted by `whad_esb_send_fast_parse()`
+ **/
+
+typedef struct {
+    uint32_t channel;
+    uint32_t retr_count;
+    uint8_t *p_pdu;
+    int length;
+} whad_esb_send_fast_params_t;
+
 /**
  * ESB PduReceived and RawPduReceived parameters 
  **/
@@ -132,6 +144,17 @@ whad_result_t whad_esb_raw_pdu_received_parse(Message *p_message, whad_esb_recvd
 whad_result_t whad_esb_pdu_received(Message *p_message, whad_esb_recvd_packet_t *p_pdu);
 whad_result_t whad_esb_pdu_received_parse(Message *p_message, whad_esb_recvd_packet_t *p_pdu);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_esb_jammed_compact(whad_compact_msg_t *p_message, uint32_t timestamp);
+whad_result_t whad_esb_raw_pdu_received_compact(whad_compact_msg_t *p_message, whad_esb_recvd_packet_t *p_pdu);
+
+/* Notification templates (see whad_template_t). */
+whad_result_t whad_esb_raw_pdu_template(whad_template_t *p_template, whad_esb_recvd_packet_t *p_model);
+whad_result_t whad_esb_raw_pdu_template_send(whad_template_t *p_template, whad_esb_recvd_packet_t *p_pdu);
+
+/* Fast-path command decoders (see whad_get_raw_message()). */
+whad_result_t whad_esb_send_fast_parse(uint8_t *p_message, int size, whad_esb_send_fast_params_t *p_params);
+
 #ifdef __cplusplus
 }
 #endif
@@ -2,6 +2,7 @@
 #define INC_WHAD_PROTOCOL_H
 
 #include "types.h"
+#include "template.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +75,11 @@ typedef struct {
     int length;
 } whad_phy_packet_t;
 
+typedef struct {
+    uint8_t *p_payload;
+    int length;
+} whad_phy_send_fast_params_t;
+
 typedef struct {
     uint32_t ts_sec;
     uint32_t ts_usec;
@@ -96,10 +102,14 @@ typedef struct {
     bool full;
 } whad_phy_scheduled_packet_t;
 
+/* Same layout as NanoPb ranges, so that decoded ranges can be used as-is. */
+typedef phy_SupportedFrequencyRanges_FrequencyRange whad_phy_frequency_range_t;
+
+/* Frequency ranges referenced by a supported frequencies message until it is sent. */
 typedef struct {
-    uint32_t start;
-    uint32_t end;
-} whad_phy_frequency_range_t;
+    const whad_phy_frequency_range_t *p_ranges;
+    int count;
+} whad_phy_frequency_ranges_t;
 
 typedef enum {
     WHAD_PHY_UNKNOWN=0,
@@ -177,6 +187,9 @@ whad_result_t whad_phy_set_sync_word(Message *p_message, uint8_t *p_syncword, in
 whad_result_t whad_phy_set_sync_word_parse(Message *p_message, whad_phy_syncword_t *p_syncword);
 whad_result_t whad_phy_supported_frequencies(Message *p_message, whad_phy_frequency_range_t *p_ranges,
                                              int nb_ranges);
+whad_result_t whad_phy_supported_frequency_ranges(Message *p_message, whad_phy_frequency_ranges_t *p_ranges);
+whad_result_t whad_phy_supported_frequencies_parse(Message *p_message, whad_phy_frequency_range_t **pp_ranges,
+                                                   int *p_count);
 
 /* Modes */
 whad_result_t whad_phy_sniff_mode(Message *p_message, bool iq_stream);
@@ -184,6 +197,8 @@ whad_result_t whad_phy_sniff_mode_parse(Message *p_message, bool *p_iq_stream);
 whad_result_t whad_phy_jam_mode(Message *p_message, whad_phy_jam_mode_t mode);
 whad_result_t whad_phy_jam_mode_parse(Message *p_message, whad_phy_jam_mode_t *p_mode);
 whad_result_t whad_phy_monitor_mode(Message *p_message);
+whad_result_t whad_phy_monitor_report_parse(Message *p_message, uint64_t *p_timestamp, uint32_t **pp_report,
+                                            int *p_count);
 whad_result_t whad_phy_start(Message *p_message);
 whad_result_t whad_phy_stop(Message *p_message);
 
@@ -191,6 +206,7 @@ whad_result_t whad_phy_stop(Message *p_message);
 whad_result_t whad_phy_send(Message *p_message, uint8_t *p_packet, int length);
 whad_result_t whad_phy_send_parse(Message *p_message, whad_phy_packet_t *p_packet);
 whad_result_t whad_phy_send_raw_iq(Message *p_message, uint8_t *p_iq_stream, int length); /* TODO !*/
+whad_result_t whad_phy_send_raw_iq_parse(Message *p_message, int32_t **pp_iq, int *p_count);
 whad_result_t whad_phy_sched_packet(Message *p_message, uint8_t *p_packet, int length, uint32_t ts_sec,
                                     uint32_t ts_usec);
 whad_result_t whad_phy_sched_packet_parse(Message *p_message, whad_phy_sched_packet_t *p_sched_packet);
@@ -212,6 +228,21 @@ whad_result_t whad_phy_packet_scheduled_parse(Message *p_message, whad_phy_sched
 whad_result_t whad_phy_sched_packet_sent(Message *p_message, uint32_t packet_id);
 whad_result_t whad_phy_sched_packet_sent_parse(Message *p_message, uint32_t *p_packet_id);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_phy_jammed_compact(whad_compact_msg_t *p_message, uint32_t ts_sec, uint32_t ts_usec);
+whad_result_t whad_phy_sched_packet_sent_compact(whad_compact_msg_t *p_message, uint32_t packet_id);
+whad_result_t whad_phy_send_compact(whad_compact_msg_t *p_message, uint8_t *p_packet, int length);
+
+/* Notification templates (see whad_template_t). */
+whad_result_t whad_phy_packet_received_template(whad_template_t *p_template, uint8_t *syncword, int syncword_length,
+                                                uint32_t deviation, uint32_t datarate, whad_phy_endian_t endianness,
+                                                whad_phy_modulation_t modulation);
+whad_result_t whad_phy_packet_received_template_send(whad_template_t *p_template, uint32_t frequency, int32_t rssi,
+                                                     uint32_t ts_sec, uint32_t ts_usec, uint8_t *payload, int length);
+
+/* Fast-path command decoders (see whad_get_raw_message()). */
+whad_result_t whad_phy_send_fast_parse(uint8_t *p_message, int size, whad_phy_send_fast_params_t *p_packet);
+
 #ifdef __cplusplus
 }
 #endif
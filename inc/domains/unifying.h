@@ -2,6 +2,7 @@
 #define __INC_WHAD_UNIFYING_H
 
 #include "types.h"
+#include "template.h"
 
 #define UNIFYING_PACKET_MAX_SIZE     255
 #define UNIFYING_ADDR_MAX_SIZE       5
@@ -130,7 +131,12 @@ whad_result_t whad_unifying_raw_pdu_received_parse(Message *p_message, whad_unif
 whad_result_t whad_unifying_pdu_received(Message *p_message, whad_unifying_recvd_packet_t *p_pdu);
 whad_result_t whad_unifying_pdu_received_parse(Message *p_message, whad_unifying_recvd_packet_t *p_pdu);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_unifying_jammed_compact(whad_compact_msg_t *p_message, uint32_t timestamp);
 
+/* Notification templates (see whad_template_t). */
+whad_result_t whad_unifying_raw_pdu_template(whad_template_t *p_template, whad_unifying_recvd_packet_t *p_model);
+whad_result_t whad_unifying_raw_pdu_template_send(whad_template_t *p_template, whad_unifying_recvd_packet_t *p_pdu);
 
 #ifdef __cplusplus
 }
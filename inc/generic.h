@@ -7,6 +7,10 @@
 
 #include "types.h"
 
+/* Pre-encoded command result frames sizes, transport header included. */
+#define WHAD_CMD_RESULT_FRAME_MIN_SIZE  (8)     /* WHAD_RESULT_SUCCESS */
+#define WHAD_CMD_RESULT_FRAME_MAX_SIZE  (10)    /* Any other result code */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,29 +45,105 @@ typedef enum {
     WHAD_GENERIC_CMDRESULT=generic_Message_cmd_result_tag,  /*!< Command result */
     WHAD_GENERIC_VERBOSE=generic_Message_verbose_tag,       /*!< Verbose message */
     WHAD_GENERIC_DEBUG=generic_Message_debug_tag,           /*!< Debug message */
-    WHAD_GENERIC_PROGRESS=generic_Message_progress_tag      /*!< Progress message */
+    WHAD_GENERIC_PROGRESS=generic_Message_progress_tag,     /*!< Progress message */
+    WHAD_GENERIC_TIME_SYNC_QUERY=generic_Message_time_sync_query_tag,   /*!< Clock synchronization query */
+    WHAD_GENERIC_TIME_SYNC_REPLY=generic_Message_time_sync_reply_tag,   /*!< Clock synchronization reply */
+    WHAD_GENERIC_LOG=generic_Message_log_tag                /*!< Binary log entries */
 } whad_generic_msgtype_t;
 
+/**
+ * Command timing, optionally carried by a command result.
+ *
+ * Times are in microseconds of the device clock (the one used to timestamp
+ * notifications), wrapping at 2^32.
+ */
+
+typedef struct {
+    uint32_t rx_time;       /*!< Device time at which the command was received */
+    uint32_t duration;      /*!< Time spent from the command reception until its result was queued */
+    uint32_t tx_backlog;    /*!< Bytes waiting in the TX ring buffer ahead of the result */
+} whad_cmd_timing_t;
+
+/**
+ * Clock synchronization reply parameters.
+ *
+ * Host times are in the host clock unit (sent back as is by the device), device
+ * times are in microseconds of the device clock.
+ */
+
+typedef struct {
+    uint32_t sequence;      /*!< Sequence number of the query */
+    uint64_t host_time;     /*!< Host time at which the query was sent */
+    uint64_t rx_time;       /*!< Device time at which the query was received */
+    uint64_t tx_time;       /*!< Device time at which the reply was queued */
+} whad_time_sync_reply_params_t;
+
+/**
+ * Binary log entries to encode.
+ *
+ * Entries are encoded straight from the log ring buffer, they are split in
+ * two parts when they wrap around its end (the second part is then empty).
+ */
+
+typedef struct {
+    const uint8_t *p_first;     /*!< First part of the entries */
+    int first_size;             /*!< First part size in bytes */
+    const uint8_t *p_second;    /*!< Second part of the entries, may be NULL */
+    int second_size;            /*!< Second part size in bytes */
+} whad_log_entries_t;
+
 /* Get generic message type from NanoPb message. */
 whad_generic_msgtype_t whad_generic_get_message_type(Message *p_message);
 
 /* Populate a generic command result message. */
 whad_result_t whad_generic_cmd_result(Message *p_message, whad_result_code_t result);
 whad_result_t whad_generic_cmd_result_parse(Message *p_message, whad_result_code_t *p_result);
+whad_result_t whad_generic_cmd_result_timed(Message *p_message, whad_result_code_t result,
+                                            const whad_cmd_timing_t *p_timing);
+whad_result_t whad_generic_cmd_result_timing_parse(Message *p_message, whad_cmd_timing_t *p_timing);
+
+/* Send a pre-encoded command result. */
+whad_result_t whad_send_cmd_result_fast(whad_result_code_t result);
 
 /* Populate a generic verbose message. */
 whad_result_t whad_generic_verbose_message(Message *p_message, char *psz_message);
+whad_result_t whad_generic_verbose_message_parse(Message *p_message, char **ppsz_message);
 
 /* Populate a debug message. */
 whad_result_t whad_generic_debug_message(Message *p_message, uint32_t level, char *psz_message);
+whad_result_t whad_generic_debug_message_parse(Message *p_message, uint32_t *p_level, char **ppsz_message);
 
 /* Populate a progress message. */
 whad_result_t whad_generic_progress_message(Message *p_message, uint32_t value);
 whad_result_t whad_generic_progress_message_parse(Message *p_message, uint32_t *p_value);
 
+/* Populate clock synchronization messages. */
+whad_result_t whad_generic_time_sync_query(Message *p_message, uint32_t sequence, uint64_t host_time);
+whad_result_t whad_generic_time_sync_query_parse(Message *p_message, uint32_t *p_sequence, uint64_t *p_host_time);
+whad_result_t whad_generic_time_sync_reply(Message *p_message, uint32_t sequence, uint64_t host_time, uint64_t rx_time,
+                                           uint64_t tx_time);
+whad_result_t whad_generic_time_sync_reply_parse(Message *p_message, whad_time_sync_reply_params_t *p_parameters);
+
+/* Populate a binary log message. */
+whad_result_t whad_generic_log_message(Message *p_message, uint32_t dropped, whad_log_entries_t *p_entries);
+whad_result_t whad_generic_log_message_parse(Message *p_message, uint32_t *p_dropped, uint8_t **pp_entries,
+                                             int *p_size);
+
 /* Verbose message helper. */
 whad_result_t whad_verbose(char *psz_message);
 
+/* Compact messages (see whad_compact_msg_t). */
+whad_result_t whad_generic_cmd_result_compact(whad_compact_msg_t *p_message, whad_result_code_t result);
+whad_result_t whad_generic_cmd_result_timed_compact(whad_compact_msg_t *p_message, whad_result_code_t result,
+                                                    const whad_cmd_timing_t *p_timing);
+whad_result_t whad_generic_verbose_message_compact(whad_compact_msg_t *p_message, char *psz_message);
+whad_result_t whad_generic_debug_message_compact(whad_compact_msg_t *p_message, uint32_t level, char *psz_message);
+whad_result_t whad_generic_progress_message_compact(whad_compact_msg_t *p_message, uint32_t value);
+whad_result_t whad_generic_time_sync_reply_compact(whad_compact_msg_t *p_message, uint32_t sequence, uint64_t host_time,
+                                                   uint64_t rx_time, uint64_t tx_time);
+whad_result_t whad_generic_log_message_compact(whad_compact_msg_t *p_message, uint32_t dropped,
+                                               whad_log_entries_t *p_entries);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,136 @@
+/** \file log.h
+ * WHAD deferred binary logging.
+ *
+ * Verbose and debug messages carry text formatted on the device, which costs
+ * formatting time, stack and link bandwidth at every log site. Binary log
+ * sites (`WHAD_LOG()`) only store the identifier of their format string and
+ * their raw 32-bit arguments in a small lock-free ring buffer, so that they
+ * can be used from interrupt handlers and radio hot paths. The firmware main
+ * loop then calls `whad_log_flush()`, which packs as many entries as possible
+ * into a single generic log message, within a bandwidth budget.
+ *
+ * Format strings are placed in the `whad_log_fmt` section of the firmware and
+ * identified by their offset in it: they never leave the device, the host
+ * expands entries back into text from the firmware ELF file (see
+ * bench/whad_logdecode.c). Only the offsets are used, so the section may be
+ * left out of the flashed image (`(INFO)` output section).
+ *
+ * Entries are sequences of 32-bit words, in the device byte order
+ * (little-endian on every supported target):
+ * - header: format identifier (bits 0-15), number of arguments (bits 16-19),
+ *   level (bits 20-22), committed flag (bit 31),
+ * - timestamp, in us of the log clock,
+ * - arguments.
+ *
+ * Entries that do not fit in the ring buffer are dropped and counted, the
+ * total number of dropped entries is carried by every log message.
+ *
+ * Entries are reserved with 32-bit `__atomic_compare_exchange_n()` and
+ * `__atomic_fetch_add()`. Targets without exclusive load/store instructions
+ * (ARMv6-M, e.g. Cortex-M0/M0+) have no lock-free implementation of them: GCC
+ * emits calls to `__atomic_compare_exchange_4()` and `__atomic_fetch_add_4()`,
+ * which must be linked from libatomic (`-latomic`), or provided by the
+ * firmware as critical sections that disable interrupts.
+ */
+
+#ifndef __INC_WHAD_LOG_H
+#define __INC_WHAD_LOG_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Ring buffer size in 32-bit words, must be a power of two. */
+#ifndef WHAD_LOG_RING_SIZE
+#define WHAD_LOG_RING_SIZE              (256)
+#endif
+
+/* Maximum size of the entries packed into a single log message, in bytes. */
+#ifndef WHAD_LOG_FLUSH_MAX_SIZE
+#define WHAD_LOG_FLUSH_MAX_SIZE         (192)
+#endif
+
+/* Default bandwidth budget of log messages, in bytes per second (0 for no limit). */
+#ifndef WHAD_LOG_DEFAULT_RATE
+#define WHAD_LOG_DEFAULT_RATE           (2048)
+#endif
+
+/* Log sites above this level are compiled out. */
+#ifndef WHAD_LOG_MAX_LEVEL
+#define WHAD_LOG_MAX_LEVEL              WHAD_LOG_DEBUG
+#endif
+
+/* Format strings section. */
+#define WHAD_LOG_SECTION                "whad_log_fmt"
+
+/* Entry layout. */
+#define WHAD_LOG_MAX_ARGS               (8)
+#define WHAD_LOG_ENTRY_HEADER_WORDS     (2)
+#define WHAD_LOG_ID_MASK                (0x0000FFFF)
+#define WHAD_LOG_ID_UNKNOWN             (0xFFFF)
+#define WHAD_LOG_NARGS_SHIFT            (16)
+#define WHAD_LOG_NARGS_MASK             (0x0000000F)
+#define WHAD_LOG_LEVEL_SHIFT            (20)
+#define WHAD_LOG_LEVEL_MASK             (0x00000007)
+#define WHAD_LOG_COMMITTED              (0x80000000)
+
+/* Log message size besides its entries: frame header, message keys and lengths, dropped counter. */
+#define WHAD_LOG_MSG_OVERHEAD           (4 + 16)
+
+/* Log levels. */
+typedef enum {
+    WHAD_LOG_ERROR = 0,
+    WHAD_LOG_WARNING = 1,
+    WHAD_LOG_INFO = 2,
+    WHAD_LOG_DEBUG = 3
+} whad_log_level_t;
+
+/* Decoded log entry (host side). */
+typedef struct {
+    uint16_t id;                            /*!< Format string offset in the format strings section */
+    whad_log_level_t level;                 /*!< Log level */
+    uint32_t timestamp;                     /*!< Log clock time, in us */
+    int nargs;                              /*!< Number of arguments */
+    uint32_t args[WHAD_LOG_MAX_ARGS];       /*!< Arguments */
+} whad_log_entry_t;
+
+/* Log clock, in us, free-running and wrapping at 2^32. */
+typedef uint32_t (*whad_log_clock_cb_t)(void);
+
+/**
+ * Log a binary entry.
+ *
+ * Arguments are stored as 32-bit words (integers, characters or addresses,
+ * at most `WHAD_LOG_MAX_ARGS`), the format string must be a literal.
+ */
+
+#define WHAD_LOG(level, fmt, ...)                                                                   \
+    do {                                                                                            \
+        if ((level) <= WHAD_LOG_MAX_LEVEL)                                                          \
+        {                                                                                           \
+            static const char whad_log_fmt_[] __attribute__((section(WHAD_LOG_SECTION), used)) = fmt; \
+            const uint32_t whad_log_args_[] = {0, ##__VA_ARGS__};                                   \
+            whad_log_write((level), whad_log_fmt_, &whad_log_args_[1],                              \
+                           (int)(sizeof(whad_log_args_)/sizeof(uint32_t)) - 1);                     \
+        }                                                                                           \
+    } while (0)
+
+/* Device side. */
+void whad_log_init(void);
+void whad_log_set_clock(whad_log_clock_cb_t pfn_clock);
+void whad_log_set_level(whad_log_level_t level);
+void whad_log_set_rate(uint32_t bytes_per_second);
+whad_result_t whad_log_write(whad_log_level_t level, const char *psz_format, const uint32_t *p_args, int nargs);
+whad_result_t whad_log_flush(void);
+uint32_t whad_log_get_dropped(void);
+
+/* Host side. */
+whad_result_t whad_log_next_entry(const uint8_t *p_entries, int size, int *p_offset, whad_log_entry_t *p_entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_LOG_H */
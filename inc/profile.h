@@ -0,0 +1,78 @@
+/** \file profile.h
+ * WHAD profiling hooks.
+ *
+ * When the library is built with `WHAD_PROFILING` defined, the time spent in
+ * each stage of the message path (encoding, TX buffering, sending, RX
+ * buffering, framing, decoding and dispatching) is measured with a cycle
+ * counter and accumulated per stage (number of samples, min, average and max).
+ * The resulting table may be sent to the host as generic debug messages with
+ * `whad_profile_send_report()`.
+ *
+ * The default cycle counter is the DWT cycle counter on Cortex-M3/M4/M7, the
+ * TSC on x86 hosts and `clock_gettime()` (in ns) on other hosts. Another
+ * counter may be set with `whad_profile_set_counter()`.
+ *
+ * Without `WHAD_PROFILING`, the hooks compile to nothing.
+ */
+
+#ifndef __INC_WHAD_PROFILE_H
+#define __INC_WHAD_PROFILE_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Profiled stages. */
+typedef enum {
+    WHAD_PROFILE_BUILD = 0,         /*!< Message builders, wrapped by the application */
+    WHAD_PROFILE_ENCODE,            /*!< Message encoding or template sending, TX buffering included */
+    WHAD_PROFILE_TX_PUSH,           /*!< Bytes queued into the TX ring buffer */
+    WHAD_PROFILE_SEND_PENDING,      /*!< `whad_transport_send_pending()` calls handing bytes to the driver */
+    WHAD_PROFILE_RX_PUSH,           /*!< Bytes queued into the RX ring buffer */
+    WHAD_PROFILE_GET_MESSAGE,       /*!< `whad_transport_get_message()` calls returning a message */
+    WHAD_PROFILE_DECODE,            /*!< Message decoding, arena-backed fields excluded */
+    WHAD_PROFILE_DISPATCH,          /*!< C++ dispatcher, handler included */
+    WHAD_PROFILE_STAGES
+} whad_profile_stage_t;
+
+/* Per-stage statistics, in cycles of the profiling counter. */
+typedef struct {
+    uint32_t count;                 /*!< Number of samples */
+    uint32_t min;                   /*!< Shortest sample */
+    uint32_t max;                   /*!< Longest sample */
+    uint64_t total;                 /*!< Sum of samples */
+} whad_profile_stats_t;
+
+/* Profiling counter, free-running and wrapping at 2^32. */
+typedef uint32_t (*whad_profile_counter_cb_t)(void);
+
+#ifdef WHAD_PROFILING
+
+/* Profiling hooks. */
+#define WHAD_PROFILE_START(t)           uint32_t t = whad_profile_now()
+#define WHAD_PROFILE_STOP(stage, t)     whad_profile_record((stage), whad_profile_now() - (t))
+
+#else
+
+#define WHAD_PROFILE_START(t)
+#define WHAD_PROFILE_STOP(stage, t)
+
+#endif /* WHAD_PROFILING */
+
+/* Profiling API. */
+void whad_profile_init(void);
+void whad_profile_set_counter(whad_profile_counter_cb_t pfn_counter);
+void whad_profile_reset(void);
+uint32_t whad_profile_now(void);
+void whad_profile_record(whad_profile_stage_t stage, uint32_t cycles);
+whad_result_t whad_profile_get_stats(whad_profile_stage_t stage, whad_profile_stats_t *p_stats);
+const char *whad_profile_get_stage_name(whad_profile_stage_t stage);
+whad_result_t whad_profile_send_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_PROFILE_H */
@@ -0,0 +1,116 @@
+/** \file protocol.h
+ * WHAD protocol messages for the current domains selection.
+ *
+ * Generated NanoPb sources (whad/protocol) describe every domain and are not
+ * edited. This header includes them for the domains selected in config.h: the
+ * message of each disabled domain is replaced by an empty stand-in, declared
+ * under the generated header guard so that the domain header is never
+ * included.
+ *
+ * A disabled domain keeps its `Message` union member and field, but they only
+ * take one byte and no domain descriptor is linked. A message of a disabled
+ * domain is decoded with an empty payload and handled like a message of an
+ * unknown domain.
+ *
+ * The stand-in descriptors and the `Message` descriptor are bound in
+ * protocol.c, which builds whad/protocol/whad.pb.c in place of the generated
+ * source.
+ */
+
+#ifndef __INC_WHAD_PROTOCOL_H
+#define __INC_WHAD_PROTOCOL_H
+
+#include <pb.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !WHAD_ENABLE_BLE
+#define PB_BLE_WHAD_PROTOCOL_BLE_BLE_PB_H_INCLUDED
+typedef struct _ble_Message {
+    char dummy_field;
+} ble_Message;
+
+#define ble_Message_init_default                 {0}
+#define ble_Message_init_zero                    {0}
+#define ble_Message_FIELDLIST(X, a)
+#define ble_Message_CALLBACK NULL
+#define ble_Message_DEFAULT NULL
+#define ble_Message_fields &ble_Message_msg
+#define ble_Message_size                         0
+extern const pb_msgdesc_t ble_Message_msg;
+#endif
+
+#if !WHAD_ENABLE_DOT15D4
+#define PB_DOT15D4_WHAD_PROTOCOL_DOT15D4_DOT15D4_PB_H_INCLUDED
+typedef struct _dot15d4_Message {
+    char dummy_field;
+} dot15d4_Message;
+
+#define dot15d4_Message_init_default             {0}
+#define dot15d4_Message_init_zero                {0}
+#define dot15d4_Message_FIELDLIST(X, a)
+#define dot15d4_Message_CALLBACK NULL
+#define dot15d4_Message_DEFAULT NULL
+#define dot15d4_Message_fields &dot15d4_Message_msg
+#define dot15d4_Message_size                     0
+extern const pb_msgdesc_t dot15d4_Message_msg;
+#endif
+
+#if !WHAD_ENABLE_ESB
+#define PB_ESB_WHAD_PROTOCOL_ESB_ESB_PB_H_INCLUDED
+typedef struct _esb_Message {
+    char dummy_field;
+} esb_Message;
+
+#define esb_Message_init_default                 {0}
+#define esb_Message_init_zero                    {0}
+#define esb_Message_FIELDLIST(X, a)
+#define esb_Message_CALLBACK NULL
+#define esb_Message_DEFAULT NULL
+#define esb_Message_fields &esb_Message_msg
+#define esb_Message_size                         0
+extern const pb_msgdesc_t esb_Message_msg;
+#endif
+
+#if !WHAD_ENABLE_UNIFYING
+#define PB_UNIFYING_WHAD_PROTOCOL_UNIFYING_UNIFYING_PB_H_INCLUDED
+typedef struct _unifying_Message {
+    char dummy_field;
+} unifying_Message;
+
+#define unifying_Message_init_default            {0}
+#define unifying_Message_init_zero               {0}
+#define unifying_Message_FIELDLIST(X, a)
+#define unifying_Message_CALLBACK NULL
+#define unifying_Message_DEFAULT NULL
+#define unifying_Message_fields &unifying_Message_msg
+#define unifying_Message_size                    0
+extern const pb_msgdesc_t unifying_Message_msg;
+#endif
+
+#if !WHAD_ENABLE_PHY
+#define PB_PHY_WHAD_PROTOCOL_PHY_PHY_PB_H_INCLUDED
+typedef struct _phy_Message {
+    char dummy_field;
+} phy_Message;
+
+#define phy_Message_init_default                 {0}
+#define phy_Message_init_zero                    {0}
+#define phy_Message_FIELDLIST(X, a)
+#define phy_Message_CALLBACK NULL
+#define phy_Message_DEFAULT NULL
+#define phy_Message_fields &phy_Message_msg
+#define phy_Message_size                         0
+extern const pb_msgdesc_t phy_Message_msg;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "../whad/protocol/whad.pb.h"
+
+#endif /* __INC_WHAD_PROTOCOL_H */
@@ -0,0 +1,90 @@
+/** \file template.h
+ * WHAD pre-encoded notification templates.
+ *
+ * High-rate notifications (raw PDUs, PHY packets) only differ by a few
+ * scalars and their payload from one packet to another. A template holds a
+ * pre-encoded message skeleton (transport header, wrapping fields and
+ * constant fields) built once per sniffing session, with fixed-width varint
+ * slots for the changing scalars. Each packet is then sent by patching these
+ * slots and appending the payload, without any call to `pb_encode()`.
+ */
+
+#ifndef __INC_WHAD_TEMPLATE_H
+#define __INC_WHAD_TEMPLATE_H
+
+#include "types.h"
+
+#ifndef WHAD_TEMPLATE_MAX_SIZE
+#define WHAD_TEMPLATE_MAX_SIZE          (96)
+#endif
+
+/* Template frames are queued at once into the TX ring buffer. */
+#if (WHAD_TEMPLATE_MAX_SIZE >= WHAD_RINGBUF_MAX_SIZE)
+#error "WHAD_RINGBUF_MAX_SIZE must be larger than WHAD_TEMPLATE_MAX_SIZE"
+#endif
+
+/* Fixed width of varint slots, in bytes. */
+#define WHAD_TEMPLATE_LENGTH_WIDTH      (2)     /* Length prefixes, up to 16383 bytes */
+#define WHAD_TEMPLATE_BOOL_WIDTH        (1)
+#define WHAD_TEMPLATE_UINT32_WIDTH      (5)
+#define WHAD_TEMPLATE_INT32_WIDTH       (10)    /* Negative int32 are sign-extended to 64 bits */
+#define WHAD_TEMPLATE_UINT64_WIDTH      (10)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Template slots
+ *
+ * Scalar fields that may be patched for each packet.
+ */
+
+typedef enum {
+    WHAD_TEMPLATE_CHANNEL = 0,              /*!< Channel */
+    WHAD_TEMPLATE_FREQUENCY,                /*!< Frequency */
+    WHAD_TEMPLATE_RSSI,                     /*!< Received Signal Strength Indicator */
+    WHAD_TEMPLATE_TIMESTAMP,                /*!< Timestamp */
+    WHAD_TEMPLATE_RELATIVE_TIMESTAMP,       /*!< Relative timestamp */
+    WHAD_TEMPLATE_CRC,                      /*!< CRC or FCS value */
+    WHAD_TEMPLATE_CRC_VALIDITY,             /*!< CRC or FCS validity */
+    WHAD_TEMPLATE_LQI,                      /*!< Link Quality Indicator */
+    WHAD_TEMPLATE_SLOT_MAX
+} whad_template_slot_t;
+
+/**
+ * Notification template
+ **/
+
+typedef struct {
+    uint8_t skeleton[WHAD_TEMPLATE_MAX_SIZE];   /*!< Pre-encoded frame, up to the payload length prefix */
+    int size;                                   /*!< Size of the pre-encoded frame in bytes */
+    int message_len_offset;                     /*!< Offset of the `Message` field length slot */
+    int submsg_len_offset;                      /*!< Offset of the domain message field length slot */
+    int payload_len_offset;                     /*!< Offset of the payload field length slot */
+    int payload_max_size;                       /*!< Maximum payload size allowed by the protocol */
+    int16_t slot_offset[WHAD_TEMPLATE_SLOT_MAX];/*!< Offset of each slot value, -1 if not used */
+    uint8_t slot_width[WHAD_TEMPLATE_SLOT_MAX]; /*!< Width of each slot value in bytes */
+} whad_template_t;
+
+/* Template creation. */
+whad_result_t whad_template_init(whad_template_t *p_template, pb_size_t which_msg, pb_size_t which_submsg,
+                                 const pb_msgdesc_t *p_fields, const void *p_constants);
+whad_result_t whad_template_add_slot(whad_template_t *p_template, whad_template_slot_t slot, uint32_t tag, int width);
+whad_result_t whad_template_set_payload(whad_template_t *p_template, uint32_t tag, int max_size);
+
+/* Slots patching. */
+void whad_template_set_uint32(whad_template_t *p_template, whad_template_slot_t slot, uint32_t value);
+void whad_template_set_int32(whad_template_t *p_template, whad_template_slot_t slot, int32_t value);
+void whad_template_set_uint64(whad_template_t *p_template, whad_template_slot_t slot, uint64_t value);
+void whad_template_set_bool(whad_template_t *p_template, whad_template_slot_t slot, bool value);
+
+/* Template sending and validation. */
+whad_result_t whad_template_send(whad_template_t *p_template, uint8_t *p_payload, int length);
+whad_result_t whad_template_check(whad_template_t *p_template, uint8_t *p_payload, int length, Message *p_message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_TEMPLATE_H */
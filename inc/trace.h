@@ -0,0 +1,74 @@
+/** \file trace.h
+ * WHAD end-to-end latency tracing.
+ *
+ * When the library is built with `WHAD_TRACING` defined, every message sent
+ * with `whad_send_message()` or `whad_send_compact_message()` carries a
+ * trace extension: an extra field of
+ * the top-level `Message` (tag `WHAD_TRACE_FIELD_TAG`, ignored by protobuf
+ * decoders that do not know it) holding a sequence number, the capture time of
+ * the radio event, the time the frame was queued and the number of bytes
+ * waiting in the TX ring buffer ahead of it. Pre-encoded frames (templates,
+ * fast command results) are not traced.
+ *
+ * The host side reads the extension with `whad_trace_parse()` and combines it
+ * with the arrival time of the frame to split its latency into stages (see
+ * bench/whad_trace.c).
+ *
+ * Times are expressed in microseconds of the trace clock, which defaults to
+ * `clock_gettime()` on Linux hosts and must be set with
+ * `whad_trace_set_clock()` on targets.
+ */
+
+#ifndef __INC_WHAD_TRACE_H
+#define __INC_WHAD_TRACE_H
+
+#include "types.h"
+#include "wire.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Trace extension field of `Message`, and its fixed32 subfields. */
+#define WHAD_TRACE_FIELD_TAG            (1000)
+#define WHAD_TRACE_SEQUENCE_TAG         (1)
+#define WHAD_TRACE_CAPTURE_TIME_TAG     (2)
+#define WHAD_TRACE_QUEUED_TIME_TAG      (3)
+#define WHAD_TRACE_BACKLOG_TAG          (4)
+
+/* Extension size: 2-byte key, 1-byte length and four 5-byte fixed32 fields. */
+#define WHAD_TRACE_EXTENSION_SIZE       (2 + 1 + 4*5)
+
+#ifdef WHAD_TRACING
+#define WHAD_TRACE_OVERHEAD             (WHAD_TRACE_EXTENSION_SIZE)
+#else
+#define WHAD_TRACE_OVERHEAD             (0)
+#endif
+
+/* Trace extension content. */
+typedef struct {
+    uint32_t sequence;          /*!< Traced frame sequence number */
+    uint32_t capture_time;      /*!< Time of the radio event, in us */
+    uint32_t queued_time;       /*!< Time the frame was queued, in us */
+    uint32_t backlog;           /*!< Bytes in the TX ring buffer ahead of the frame */
+} whad_trace_info_t;
+
+/* Trace clock, in us, free-running and wrapping at 2^32. */
+typedef uint32_t (*whad_trace_clock_cb_t)(void);
+
+/* Device side. */
+void whad_trace_init(void);
+void whad_trace_set_clock(whad_trace_clock_cb_t pfn_clock);
+uint32_t whad_trace_now(void);
+void whad_trace_set_capture_time(uint32_t timestamp);
+void whad_trace_frame_start(void);
+void whad_trace_put_extension(whad_wire_writer_t *p_writer);
+
+/* Host side. */
+whad_result_t whad_trace_parse(const uint8_t *p_message, int size, whad_trace_info_t *p_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_TRACE_H */
@@ -3,8 +3,9 @@
 
 #include "types.h"
 #include "ringbuf.h"
+#include "profile.h"
 
-#define WHAD_TRANSPORT_MSG_MAXSIZE  1024
+#define WHAD_TRANSPORT_MSG_MAXSIZE  WHAD_MESSAGE_MAX_SIZE
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,11 +43,16 @@ typedef struct {
  */
 
 typedef struct {
-    /* WHAD message. */
-    Message msg;
+    /* State, updated from interrupt context by whad_transport_data_sent(). */
+    volatile whad_transport_state_t state;
 
-    /* State. */
-    whad_transport_state_t state;
+    /* Message being received. */
+    int rx_frame_size;      /* Size of the message being received, 0 if none */
+    int rx_frame_offset;    /* Number of bytes of this message already received */
+    int rx_discard_size;    /* Number of bytes of a discarded message still to skip */
+
+    /* Message being sent, if larger than the TX buffer. */
+    int tx_stream_size;     /* Number of bytes of this message still to stream, 0 if none */
 
     /* RX and TX buffers. */
     whad_ringbuf_t rx_buf; /* Transport RX ring buffer */
@@ -67,6 +73,9 @@ int whad_transport_send(uint8_t *p_data, int size);
 
 whad_result_t whad_transport_get_message(uint8_t *p_buffer, int *p_size);
 whad_result_t whad_transport_send_message(uint8_t *p_message, int size);
+whad_result_t whad_transport_send_header(int size);
+whad_result_t whad_transport_write(uint8_t *p_data, int size);
+whad_result_t whad_transport_send_frame(uint8_t *p_frame, int size, uint8_t *p_trailer, int trailer_size);
 
 int whad_transport_get_txbuf_size(void);
 int whad_transport_get_rxbuf_size(void);
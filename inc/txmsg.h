@@ -0,0 +1,161 @@
+/** \file txmsg.h
+ * WHAD TX-only messages.
+ *
+ * Wire-compatible variants of some generated messages carrying a radio
+ * payload. Their inline `PB_BYTES_ARRAY_T()` payload field is replaced by a
+ * reference to the caller buffer, streamed by NanoPb while encoding. This
+ * saves one copy per packet and keeps these structures small enough to be
+ * stored in a compact message (see `whad_compact_msg_t`).
+ *
+ * These messages can only be encoded, the referenced buffer must remain
+ * valid until the message is sent.
+ */
+
+#ifndef __INC_WHAD_TXMSG_H
+#define __INC_WHAD_TXMSG_H
+
+#include "../nanopb/pb_encode.h"
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Payload reference
+ **/
+
+typedef struct {
+    const uint8_t *p_bytes;     /*!< Pointer to the payload bytes */
+    pb_size_t size;             /*!< Payload size in bytes */
+} whad_payload_ref_t;
+
+#if WHAD_ENABLE_BLE
+/* BLE RawPduReceived. */
+typedef struct _whad_ble_raw_pdu_tx {
+    ble_BleDirection direction;
+    uint32_t channel;
+    bool has_rssi;
+    int32_t rssi;
+    bool has_timestamp;
+    uint64_t timestamp;
+    bool has_relative_timestamp;
+    uint64_t relative_timestamp;
+    bool has_crc_validity;
+    bool crc_validity;
+    uint32_t access_address;
+    whad_payload_ref_t pdu;
+    uint32_t crc;
+    uint32_t conn_handle;
+    bool processed;
+    bool decrypted;
+} whad_ble_raw_pdu_tx_t;
+#endif
+
+#if WHAD_ENABLE_ESB
+/* ESB RawPduReceived. */
+typedef struct _whad_esb_raw_pdu_tx {
+    uint32_t channel;
+    bool has_rssi;
+    int32_t rssi;
+    bool has_timestamp;
+    uint64_t timestamp;
+    bool has_crc_validity;
+    bool crc_validity;
+    bool has_address;
+    esb_RawPduReceived_address_t address;
+    whad_payload_ref_t pdu;
+} whad_esb_raw_pdu_tx_t;
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+/* 802.15.4 PduReceived. */
+typedef struct _whad_dot15d4_pdu_tx {
+    uint32_t channel;
+    bool has_rssi;
+    int32_t rssi;
+    bool has_timestamp;
+    uint64_t timestamp;
+    bool has_fcs_validity;
+    bool fcs_validity;
+    whad_payload_ref_t pdu;
+    bool has_lqi;
+    uint32_t lqi;
+} whad_dot15d4_pdu_tx_t;
+#endif
+
+#if WHAD_ENABLE_PHY
+/* PHY SendCmd. */
+typedef struct _whad_phy_send_tx {
+    whad_payload_ref_t packet;
+} whad_phy_send_tx_t;
+#endif
+
+/* Field definitions, matching the generated ones except for payloads. */
+#define whad_ble_raw_pdu_tx_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UENUM,    direction,         1) \
+X(a, STATIC,   SINGULAR, UINT32,   channel,           2) \
+X(a, STATIC,   OPTIONAL, INT32,    rssi,              3) \
+X(a, STATIC,   OPTIONAL, UINT64,   timestamp,         4) \
+X(a, STATIC,   OPTIONAL, UINT64,   relative_timestamp,   5) \
+X(a, STATIC,   OPTIONAL, BOOL,     crc_validity,      6) \
+X(a, STATIC,   SINGULAR, UINT32,   access_address,    7) \
+X(a, CALLBACK, SINGULAR, BYTES,    pdu,               8) \
+X(a, STATIC,   SINGULAR, UINT32,   crc,               9) \
+X(a, STATIC,   SINGULAR, UINT32,   conn_handle,      10) \
+X(a, STATIC,   SINGULAR, BOOL,     processed,        11) \
+X(a, STATIC,   SINGULAR, BOOL,     decrypted,        12)
+#define whad_ble_raw_pdu_tx_CALLBACK whad_payload_ref_field_callback
+#define whad_ble_raw_pdu_tx_DEFAULT NULL
+
+#define whad_esb_raw_pdu_tx_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   channel,           1) \
+X(a, STATIC,   OPTIONAL, INT32,    rssi,              2) \
+X(a, STATIC,   OPTIONAL, UINT64,   timestamp,         3) \
+X(a, STATIC,   OPTIONAL, BOOL,     crc_validity,      4) \
+X(a, STATIC,   OPTIONAL, BYTES,    address,           5) \
+X(a, CALLBACK, SINGULAR, BYTES,    pdu,               6)
+#define whad_esb_raw_pdu_tx_CALLBACK whad_payload_ref_field_callback
+#define whad_esb_raw_pdu_tx_DEFAULT NULL
+
+#define whad_dot15d4_pdu_tx_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   channel,           1) \
+X(a, STATIC,   OPTIONAL, INT32,    rssi,              2) \
+X(a, STATIC,   OPTIONAL, UINT64,   timestamp,         3) \
+X(a, STATIC,   OPTIONAL, BOOL,     fcs_validity,      4) \
+X(a, CALLBACK, SINGULAR, BYTES,    pdu,               5) \
+X(a, STATIC,   OPTIONAL, UINT32,   lqi,               6)
+#define whad_dot15d4_pdu_tx_CALLBACK whad_payload_ref_field_callback
+#define whad_dot15d4_pdu_tx_DEFAULT NULL
+
+#define whad_phy_send_tx_FIELDLIST(X, a) \
+X(a, CALLBACK, SINGULAR, BYTES,    packet,            1)
+#define whad_phy_send_tx_CALLBACK whad_payload_ref_field_callback
+#define whad_phy_send_tx_DEFAULT NULL
+
+/* NanoPb descriptors, only available for enabled domains. */
+#if WHAD_ENABLE_BLE
+extern const pb_msgdesc_t whad_ble_raw_pdu_tx_msg;
+#define whad_ble_raw_pdu_tx_fields &whad_ble_raw_pdu_tx_msg
+#endif
+#if WHAD_ENABLE_ESB
+extern const pb_msgdesc_t whad_esb_raw_pdu_tx_msg;
+#define whad_esb_raw_pdu_tx_fields &whad_esb_raw_pdu_tx_msg
+#endif
+#if WHAD_ENABLE_DOT15D4
+extern const pb_msgdesc_t whad_dot15d4_pdu_tx_msg;
+#define whad_dot15d4_pdu_tx_fields &whad_dot15d4_pdu_tx_msg
+#endif
+#if WHAD_ENABLE_PHY
+extern const pb_msgdesc_t whad_phy_send_tx_msg;
+#define whad_phy_send_tx_fields &whad_phy_send_tx_msg
+#endif
+
+/* Payload streaming. */
+bool whad_payload_ref_field_callback(pb_istream_t *istream, pb_ostream_t *ostream, const pb_field_iter_t *field);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_TXMSG_H */
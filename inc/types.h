@@ -3,7 +3,9 @@
 
 #include "../nanopb/pb_encode.h"
 #include "../nanopb/pb_decode.h"
-#include "../whad/protocol/whad.pb.h"
+#include "config.h"
+#include "protocol.h"
+#include "txmsg.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +19,59 @@ typedef enum {
     WHAD_RINGBUF_FULL
 } whad_result_t;
 
+/**
+ * Compact message
+ *
+ * A `Message` structure is sized for the largest message of every domain
+ * (several kilobytes), even when it only carries a 4-byte notification.
+ * A compact message only stores one small generic, discovery or domain
+ * message along with the oneof tags required to wrap it into a `Message`
+ * when serialized (see `whad_send_compact_message()`).
+ */
+
+typedef struct {
+    pb_size_t which_msg;                /*!< `Message` oneof tag (generic, discovery or domain) */
+    pb_size_t which_submsg;             /*!< Generic, discovery or domain message oneof tag */
+    const pb_msgdesc_t *p_fields;       /*!< NanoPb descriptor of the embedded message */
+    union {
+        generic_CmdResult cmd_result;
+        generic_VerboseMsg verbose;
+        generic_DebugMsg debug;
+        generic_Progress progress;
+        generic_TimeSyncReply time_sync_reply;
+        generic_LogMsg log;
+        discovery_DeviceReadyResp ready_resp;
+        discovery_DeviceDomainInfoResp domain_resp;
+#if WHAD_ENABLE_BLE
+        ble_Synchronized ble_synchronized;
+        ble_Desynchronized ble_desynchronized;
+        ble_Triggered ble_triggered;
+        ble_Hijacked ble_hijacked;
+        ble_Injected ble_injected;
+        ble_Disconnected ble_disconnected;
+        ble_AdvPduReceived ble_adv_pdu;
+        whad_ble_raw_pdu_tx_t ble_raw_pdu;
+#endif
+#if WHAD_ENABLE_ESB
+        esb_Jammed esb_jammed;
+        whad_esb_raw_pdu_tx_t esb_raw_pdu;
+#endif
+#if WHAD_ENABLE_UNIFYING
+        unifying_Jammed unifying_jammed;
+#endif
+#if WHAD_ENABLE_DOT15D4
+        dot15d4_Jammed dot15d4_jammed;
+        dot15d4_EnergyDetectionSample dot15d4_ed_sample;
+        whad_dot15d4_pdu_tx_t dot15d4_pdu;
+#endif
+#if WHAD_ENABLE_PHY
+        phy_Jammed phy_jammed;
+        phy_SchedulePacketSent phy_sched_pkt_sent;
+        whad_phy_send_tx_t phy_send;
+#endif
+    } msg;
+} whad_compact_msg_t;
+
 #ifdef __cplusplus
 }
 #endif
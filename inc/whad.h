@@ -1,19 +1,36 @@
 #ifndef __INC_WHAD_H
 #define __INC_WHAD_H
 
+#include "config.h"
 #include "ringbuf.h"
 #include "transport.h"
+#include "template.h"
+#include "wire.h"
+#include "arena.h"
+#include "profile.h"
+#include "trace.h"
+#include "clocksync.h"
+#include "log.h"
+#include "cmdlatency.h"
 #include "generic.h"
 #include "discovery.h"
+#if WHAD_ENABLE_BLE
 #include "domains/ble.h"
+#endif
+#if WHAD_ENABLE_PHY
 #include "domains/phy.h"
+#endif
+#if WHAD_ENABLE_ESB
 #include "domains/esb.h"
+#endif
+#if WHAD_ENABLE_UNIFYING
 #include "domains/unifying.h"
+#endif
+#if WHAD_ENABLE_DOT15D4
 #include "domains/dot15d4.h"
+#endif
 
 
-#define WHAD_MESSAGE_MAX_SIZE       (4096)
-
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -28,7 +45,13 @@ typedef enum {
 /* Whad initialization and message sending/receive. */
 void whad_init(whad_transport_cfg_t *p_transport_cfg);
 whad_result_t whad_get_message(Message *p_msg);
+whad_result_t whad_get_raw_message(uint8_t **pp_message, int *p_size);
+whad_result_t whad_decode_message(uint8_t *p_message, int size, Message *p_msg);
+whad_result_t whad_get_message_arena(Message *p_msg, whad_arena_t *p_arena);
+whad_result_t whad_decode_message_arena(uint8_t *p_message, int size, Message *p_msg, whad_arena_t *p_arena);
 whad_result_t whad_send_message(Message *p_msg);
+whad_result_t whad_send_compact_message(whad_compact_msg_t *p_msg);
+void whad_free_message_resources(Message *p_msg);
 
 /* Whad message decoding. */
 whad_msgtype_t whad_get_message_type(Message *p_msg);
@@ -0,0 +1,66 @@
+/** \file wire.h
+ * WHAD protobuf wire format helpers.
+ *
+ * Low-level helpers writing and reading protobuf wire format without NanoPb
+ * field descriptors, used by notification templates, trace extensions and
+ * fast-path command decoders.
+ */
+
+#ifndef __INC_WHAD_WIRE_H
+#define __INC_WHAD_WIRE_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Wire format writer
+ **/
+
+typedef struct {
+    uint8_t *p_buffer;      /*!< Output buffer, NULL to only compute the encoded size */
+    int size;               /*!< Output buffer size in bytes */
+    int offset;             /*!< Number of bytes written (or that would have been written) */
+    bool overflow;          /*!< Set when output buffer is too small */
+} whad_wire_writer_t;
+
+/**
+ * Wire format reader
+ **/
+
+typedef struct {
+    const uint8_t *p_buffer;    /*!< Input buffer */
+    int size;                   /*!< Input buffer size in bytes */
+    int offset;                 /*!< Number of bytes read */
+} whad_wire_reader_t;
+
+/* Varints. */
+int whad_wire_varint_size(uint64_t value);
+int whad_wire_write_varint(uint8_t *p_buffer, uint64_t value, int width);
+
+/* Writer. */
+void whad_wire_writer_init(whad_wire_writer_t *p_writer, uint8_t *p_buffer, int size);
+void whad_wire_put_varint(whad_wire_writer_t *p_writer, uint64_t value);
+void whad_wire_put_key(whad_wire_writer_t *p_writer, uint32_t tag, pb_wire_type_t wire_type);
+void whad_wire_put_bytes(whad_wire_writer_t *p_writer, const uint8_t *p_data, int size);
+void whad_wire_put_fixed32_field(whad_wire_writer_t *p_writer, uint32_t tag, uint32_t value);
+
+/* Reader. */
+void whad_wire_reader_init(whad_wire_reader_t *p_reader, const uint8_t *p_buffer, int size);
+bool whad_wire_get_varint(whad_wire_reader_t *p_reader, uint64_t *p_value);
+bool whad_wire_get_key(whad_wire_reader_t *p_reader, uint32_t *p_tag, pb_wire_type_t *p_wire_type);
+bool whad_wire_get_uint32(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, uint32_t *p_value);
+bool whad_wire_get_fixed32(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, uint32_t *p_value);
+bool whad_wire_get_bool(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, bool *p_value);
+bool whad_wire_get_bytes(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, uint8_t **pp_data, int *p_size);
+bool whad_wire_skip_field(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type);
+bool whad_wire_get_submessage(whad_wire_reader_t *p_reader, uint8_t *p_message, int size, pb_size_t which_msg,
+                              pb_size_t which_submsg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INC_WHAD_WIRE_H */
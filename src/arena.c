@@ -0,0 +1,362 @@
+#include "arena.h"
+
+/**
+ * @brief   Initialize an arena.
+ *
+ * @param[in,out]   p_arena     Pointer to a `whad_arena_t` structure
+ * @param[in]       p_buffer    Pointer to the arena storage, aligned on `WHAD_ARENA_ALIGNMENT`
+ * @param[in]       size        Arena storage size in bytes
+ **/
+
+void whad_arena_init(whad_arena_t *p_arena, uint8_t *p_buffer, int size)
+{
+    p_arena->p_buffer = p_buffer;
+    p_arena->size = size;
+    p_arena->offset = 0;
+}
+
+
+/**
+ * @brief   Allocate a block from an arena.
+ *
+ * @param[in,out]   p_arena     Pointer to a `whad_arena_t` structure
+ * @param[in]       size        Block size in bytes
+ * @return  Pointer to the allocated block, NULL if the arena is full.
+ **/
+
+void *whad_arena_alloc(whad_arena_t *p_arena, int size)
+{
+    int offset;
+
+    /* Sanity check. */
+    if ((p_arena == NULL) || (p_arena->p_buffer == NULL) || (size < 0))
+    {
+        return NULL;
+    }
+
+    /* Align block on WHAD_ARENA_ALIGNMENT. */
+    offset = (p_arena->offset + WHAD_ARENA_ALIGNMENT - 1) & ~(WHAD_ARENA_ALIGNMENT - 1);
+    if ((offset > p_arena->size) || (size > (p_arena->size - offset)))
+    {
+        /* Arena is full. */
+        return NULL;
+    }
+
+    p_arena->offset = offset + size;
+    return &p_arena->p_buffer[offset];
+}
+
+
+/**
+ * @brief   Release every block allocated from an arena.
+ *
+ * @param[in,out]   p_arena     Pointer to a `whad_arena_t` structure
+ **/
+
+void whad_arena_reset(whad_arena_t *p_arena)
+{
+    p_arena->offset = 0;
+}
+
+
+/**
+ * @brief   Get arena free size.
+ *
+ * @param[in]   p_arena     Pointer to a `whad_arena_t` structure
+ * @return  Number of bytes that can still be allocated, alignment not included.
+ **/
+
+int whad_arena_get_free_size(whad_arena_t *p_arena)
+{
+    return (p_arena->size - p_arena->offset);
+}
+
+
+/**
+ * @brief   Append an item to an arena-backed field.
+ *
+ * Items are grown in place while they are the last block of the arena, and
+ * moved to the top of the arena otherwise.
+ *
+ * @param[in,out]   p_field     Pointer to an arena-backed field
+ * @return  Pointer to the new item, NULL if the arena is full.
+ **/
+
+static uint8_t *whad_arena_field_append(whad_arena_field_t *p_field)
+{
+    whad_arena_t *p_arena = p_field->p_arena;
+    int items_size = p_field->count * p_field->item_size;
+    uint8_t *p_items;
+
+    if ((p_field->p_items != NULL) && (&p_field->p_items[items_size] == &p_arena->p_buffer[p_arena->offset]))
+    {
+        /* Items are the last allocated block, grow them. */
+        if (p_field->item_size > (p_arena->size - p_arena->offset))
+        {
+            return NULL;
+        }
+        p_arena->offset += p_field->item_size;
+    }
+    else
+    {
+        /* Allocate a new block and move existing items into it. */
+        p_items = (uint8_t *)whad_arena_alloc(p_arena, items_size + p_field->item_size);
+        if (p_items == NULL)
+        {
+            return NULL;
+        }
+
+        if (items_size > 0)
+        {
+            memcpy(p_items, p_field->p_items, items_size);
+        }
+        p_field->p_items = p_items;
+    }
+
+    p_field->count++;
+    return &p_field->p_items[items_size];
+}
+
+
+/**
+ * @brief   Bytes and strings decoding callback.
+ *
+ * Copies the field content into the arena, followed by a NUL byte so that
+ * text fields can be used as C strings.
+ *
+ * @param[in,out]   istream     Input stream
+ * @param[in]       field       Pointer to a field descriptor
+ * @param[in]       arg         Pointer to the arena-backed field
+ * @return true if everything went ok, false otherwise.
+ **/
+
+bool whad_arena_bytes_decode_cb(pb_istream_t *istream, const pb_field_t *field, void **arg)
+{
+    whad_arena_field_t *p_field = *(whad_arena_field_t **)arg;
+    int size = (int)istream->bytes_left;
+    uint8_t *p_bytes;
+
+    p_bytes = (uint8_t *)whad_arena_alloc(p_field->p_arena, size + 1);
+    if (p_bytes == NULL)
+    {
+        return false;
+    }
+
+    if (!pb_read(istream, p_bytes, size))
+    {
+        return false;
+    }
+    p_bytes[size] = 0;
+
+    /* Latest occurrence wins. */
+    p_field->p_items = p_bytes;
+    p_field->count = size;
+
+    return true;
+}
+
+
+/**
+ * @brief   Repeated 32-bit varints decoding callback.
+ *
+ * Handles both packed and non-packed encodings, items are stored as `uint32_t`
+ * (`int32_t` fields are stored as their two's complement).
+ *
+ * @param[in,out]   istream     Input stream
+ * @param[in]       field       Pointer to a field descriptor
+ * @param[in]       arg         Pointer to the arena-backed field
+ * @return true if everything went ok, false otherwise.
+ **/
+
+bool whad_arena_varint_decode_cb(pb_istream_t *istream, const pb_field_t *field, void **arg)
+{
+    whad_arena_field_t *p_field = *(whad_arena_field_t **)arg;
+    uint64_t value;
+    uint32_t item;
+    uint8_t *p_item;
+
+    while (istream->bytes_left > 0)
+    {
+        if (!pb_decode_varint(istream, &value))
+        {
+            return false;
+        }
+
+        p_item = whad_arena_field_append(p_field);
+        if (p_item == NULL)
+        {
+            return false;
+        }
+
+        item = (uint32_t)value;
+        memcpy(p_item, &item, sizeof(uint32_t));
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief   Repeated submessages decoding callback.
+ *
+ * @param[in,out]   istream     Input stream
+ * @param[in]       field       Pointer to a field descriptor
+ * @param[in]       arg         Pointer to the arena-backed field
+ * @return true if everything went ok, false otherwise.
+ **/
+
+bool whad_arena_message_decode_cb(pb_istream_t *istream, const pb_field_t *field, void **arg)
+{
+    whad_arena_field_t *p_field = *(whad_arena_field_t **)arg;
+    uint8_t *p_item;
+
+    p_item = whad_arena_field_append(p_field);
+    if (p_item == NULL)
+    {
+        return false;
+    }
+
+    return pb_decode(istream, p_field->p_fields, p_item);
+}
+
+
+/**
+ * @brief   Bind a callback field to an arena.
+ *
+ * @param[in,out]   p_callback  Pointer to the callback field
+ * @param[in]       p_arena     Pointer to the arena storing the decoded items
+ * @param[in]       p_decode    Decoding callback
+ * @param[in]       p_fields    Item fields descriptor, NULL if not a submessage
+ * @param[in]       item_size   Size of an item in bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid pointer or arena full.
+ **/
+
+static whad_result_t whad_arena_bind(pb_callback_t *p_callback, whad_arena_t *p_arena,
+                                     bool (*p_decode)(pb_istream_t *, const pb_field_t *, void **),
+                                     const pb_msgdesc_t *p_fields, int item_size)
+{
+    whad_arena_field_t *p_field;
+
+    /* Sanity check. */
+    if ((p_callback == NULL) || (p_arena == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    p_field = (whad_arena_field_t *)whad_arena_alloc(p_arena, sizeof(whad_arena_field_t));
+    if (p_field == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    p_field->p_arena = p_arena;
+    p_field->p_fields = p_fields;
+    p_field->p_items = NULL;
+    p_field->item_size = item_size;
+    p_field->count = 0;
+
+    p_callback->funcs.decode = p_decode;
+    p_callback->arg = p_field;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Bind a bytes or string callback field to an arena.
+ *
+ * @param[in,out]   p_callback  Pointer to the callback field
+ * @param[in]       p_arena     Pointer to the arena storing the decoded bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid pointer or arena full.
+ **/
+
+whad_result_t whad_arena_bind_bytes(pb_callback_t *p_callback, whad_arena_t *p_arena)
+{
+    return whad_arena_bind(p_callback, p_arena, whad_arena_bytes_decode_cb, NULL, sizeof(uint8_t));
+}
+
+
+/**
+ * @brief   Bind a repeated `uint32`/`int32` callback field to an arena.
+ *
+ * @param[in,out]   p_callback  Pointer to the callback field
+ * @param[in]       p_arena     Pointer to the arena storing the decoded items
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid pointer or arena full.
+ **/
+
+whad_result_t whad_arena_bind_varints(pb_callback_t *p_callback, whad_arena_t *p_arena)
+{
+    return whad_arena_bind(p_callback, p_arena, whad_arena_varint_decode_cb, NULL, sizeof(uint32_t));
+}
+
+
+/**
+ * @brief   Bind a repeated submessage callback field to an arena.
+ *
+ * @param[in,out]   p_callback  Pointer to the callback field
+ * @param[in]       p_arena     Pointer to the arena storing the decoded items
+ * @param[in]       p_fields    Submessage fields descriptor
+ * @param[in]       item_size   Submessage structure size in bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid pointer or arena full.
+ **/
+
+whad_result_t whad_arena_bind_messages(pb_callback_t *p_callback, whad_arena_t *p_arena,
+                                       const pb_msgdesc_t *p_fields, int item_size)
+{
+    /* Sanity check. */
+    if (p_fields == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    return whad_arena_bind(p_callback, p_arena, whad_arena_message_decode_cb, p_fields, item_size);
+}
+
+
+/**
+ * @brief   Retrieve the items decoded into an arena-backed callback field.
+ *
+ * @param[in]   p_callback  Pointer to the callback field
+ * @param[out]  pp_items    Pointer set to the decoded items, NULL if none
+ * @param[out]  p_count     Pointer set to the number of decoded items (bytes for a bytes field)
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid pointer.
+ * @retval  WHAD_NONE       Field has not been decoded into an arena.
+ **/
+
+whad_result_t whad_arena_get_items(const pb_callback_t *p_callback, void **pp_items, int *p_count)
+{
+    whad_arena_field_t *p_field;
+
+    /* Sanity check. */
+    if ((p_callback == NULL) || (pp_items == NULL) || (p_count == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Only fields bound by whad_arena_bind() are arena-backed. */
+    if ((p_callback->arg == NULL) ||
+        ((p_callback->funcs.decode != whad_arena_bytes_decode_cb) &&
+         (p_callback->funcs.decode != whad_arena_varint_decode_cb) &&
+         (p_callback->funcs.decode != whad_arena_message_decode_cb)))
+    {
+        return WHAD_NONE;
+    }
+
+    p_field = (whad_arena_field_t *)p_callback->arg;
+    *pp_items = p_field->p_items;
+    *p_count = p_field->count;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
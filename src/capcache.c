@@ -0,0 +1,536 @@
+#include <stdio.h>
+#include "whad.h"
+#include "capcache.h"
+
+/* Fixed part of an entry: device ID, firmware version and domains bitmask. */
+#define WHAD_CAP_CACHE_ENTRY_SIZE       (WHAD_CAP_CACHE_DEVID_SIZE + 16)
+
+/* Per-domain part of an entry: capabilities and supported commands. */
+#define WHAD_CAP_CACHE_DOMAIN_SIZE      (9)
+
+/* Valid domains bitmask, slot 0 is never used. */
+#define WHAD_CAP_CACHE_DOMAINS_MASK     ((uint32_t)(((1ULL << WHAD_CAP_INDEX_DOMAINS) - 1) & ~1ULL))
+
+#define WHAD_CAP_CACHE_FNV_OFFSET       (2166136261UL)
+#define WHAD_CAP_CACHE_FNV_PRIME        (16777619UL)
+
+
+/**
+ * @brief   Store a little-endian integer.
+ *
+ * @param[out]  p_buffer    Pointer to the destination buffer
+ * @param[in]   value       Value to store
+ * @param[in]   size        Integer size in bytes
+ **/
+
+static void whad_cap_cache_put_le(uint8_t *p_buffer, uint64_t value, int size)
+{
+    int i;
+
+    for (i=0; i<size; i++)
+    {
+        p_buffer[i] = (uint8_t)(value >> (8*i));
+    }
+}
+
+
+/**
+ * @brief   Load a little-endian integer.
+ *
+ * @param[in]   p_buffer    Pointer to the source buffer
+ * @param[in]   size        Integer size in bytes
+ * @return  Loaded value.
+ **/
+
+static uint64_t whad_cap_cache_get_le(const uint8_t *p_buffer, int size)
+{
+    uint64_t value = 0;
+    int i;
+
+    for (i=size-1; i>=0; i--)
+    {
+        value = (value << 8) | p_buffer[i];
+    }
+
+    return value;
+}
+
+
+/**
+ * @brief   Update a FNV-1a hash.
+ *
+ * @param[in]   hash        Current hash
+ * @param[in]   p_buffer    Pointer to the hashed bytes
+ * @param[in]   size        Number of bytes
+ * @return  Updated hash.
+ **/
+
+static uint32_t whad_cap_cache_hash(uint32_t hash, const uint8_t *p_buffer, int size)
+{
+    int i;
+
+    for (i=0; i<size; i++)
+    {
+        hash = (hash ^ p_buffer[i]) * WHAD_CAP_CACHE_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+
+/**
+ * @brief   Write bytes to a cache file and hash them.
+ *
+ * @param[in]       p_file      Cache file
+ * @param[in,out]   p_hash      Pointer to the current hash
+ * @param[in]       p_buffer    Pointer to the bytes to write
+ * @param[in]       size        Number of bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Write error.
+ **/
+
+static whad_result_t whad_cap_cache_write(FILE *p_file, uint32_t *p_hash, const uint8_t *p_buffer, int size)
+{
+    if (fwrite(p_buffer, size, 1, p_file) != 1)
+    {
+        return WHAD_ERROR;
+    }
+    *p_hash = whad_cap_cache_hash(*p_hash, p_buffer, size);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Read bytes from a cache file and hash them.
+ *
+ * @param[in]       p_file      Cache file
+ * @param[in,out]   p_hash      Pointer to the current hash
+ * @param[out]      p_buffer    Pointer to the destination buffer
+ * @param[in]       size        Number of bytes
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Read error or truncated file.
+ **/
+
+static whad_result_t whad_cap_cache_read(FILE *p_file, uint32_t *p_hash, uint8_t *p_buffer, int size)
+{
+    if (fread(p_buffer, size, 1, p_file) != 1)
+    {
+        return WHAD_ERROR;
+    }
+    *p_hash = whad_cap_cache_hash(*p_hash, p_buffer, size);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Find a cache entry.
+ *
+ * @param[in]   p_cache     Pointer to a capability cache
+ * @param[in]   p_key       Pointer to the entry key
+ * @return  Entry index, -1 if not found.
+ **/
+
+static int whad_cap_cache_find(whad_cap_cache_t *p_cache, const whad_cap_cache_key_t *p_key)
+{
+    whad_cap_cache_key_t *p_entry_key;
+    int i;
+
+    for (i=0; i<p_cache->count; i++)
+    {
+        p_entry_key = &p_cache->entries[i].key;
+        if ((memcmp(p_entry_key->devid, p_key->devid, WHAD_CAP_CACHE_DEVID_SIZE) == 0) &&
+            (p_entry_key->fw_version_major == p_key->fw_version_major) &&
+            (p_entry_key->fw_version_minor == p_key->fw_version_minor) &&
+            (p_entry_key->fw_version_rev == p_key->fw_version_rev))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief   Initialize an empty capability cache.
+ *
+ * @param[out]  p_cache     Pointer to a capability cache
+ **/
+
+void whad_cap_cache_init(whad_cap_cache_t *p_cache)
+{
+    /* Sanity check. */
+    if (p_cache == NULL)
+    {
+        return;
+    }
+
+    memset(p_cache, 0, sizeof(whad_cap_cache_t));
+}
+
+
+/**
+ * @brief   Load a capability cache file.
+ *
+ * The cache is emptied first, and left empty if the file is missing or
+ * invalid (bad magic or version, truncated file, hash mismatch). Entries in
+ * excess of `WHAD_CAP_CACHE_MAX_ENTRIES` are ignored.
+ *
+ * @param[out]  p_cache     Pointer to a capability cache
+ * @param[in]   psz_path    Cache file path
+ *
+ * @retval  WHAD_SUCCESS    Cache loaded.
+ * @retval  WHAD_NONE       Cache file does not exist.
+ * @retval  WHAD_ERROR      Invalid parameters or invalid cache file.
+ **/
+
+whad_result_t whad_cap_cache_load(whad_cap_cache_t *p_cache, const char *psz_path)
+{
+    uint8_t buffer[WHAD_CAP_CACHE_ENTRY_SIZE];
+    whad_cap_cache_entry_t dropped;
+    whad_cap_cache_entry_t *p_entry;
+    whad_result_t result = WHAD_ERROR;
+    uint32_t hash = WHAD_CAP_CACHE_FNV_OFFSET;
+    uint32_t count;
+    uint32_t domains;
+    uint32_t slot;
+    uint32_t i;
+    FILE *p_file;
+
+    /* Sanity check. */
+    if ((p_cache == NULL) || (psz_path == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    whad_cap_cache_init(p_cache);
+    p_file = fopen(psz_path, "rb");
+    if (p_file == NULL)
+    {
+        return WHAD_NONE;
+    }
+
+    /* Check header. */
+    if ((whad_cap_cache_read(p_file, &hash, buffer, WHAD_CAP_CACHE_HEADER_SIZE) != WHAD_SUCCESS) ||
+        (memcmp(buffer, WHAD_CAP_CACHE_MAGIC, sizeof(WHAD_CAP_CACHE_MAGIC)) != 0) ||
+        (whad_cap_cache_get_le(&buffer[8], 4) != WHAD_CAP_CACHE_VERSION))
+    {
+        goto end;
+    }
+    count = (uint32_t)whad_cap_cache_get_le(&buffer[12], 4);
+
+    for (i=0; i<count; i++)
+    {
+        /* Entries that do not fit are read to check the hash, then dropped. */
+        p_entry = (i < WHAD_CAP_CACHE_MAX_ENTRIES) ? &p_cache->entries[i] : &dropped;
+        memset(p_entry, 0, sizeof(whad_cap_cache_entry_t));
+
+        if (whad_cap_cache_read(p_file, &hash, buffer, WHAD_CAP_CACHE_ENTRY_SIZE) != WHAD_SUCCESS)
+        {
+            goto end;
+        }
+        memcpy(p_entry->key.devid, buffer, WHAD_CAP_CACHE_DEVID_SIZE);
+        p_entry->key.fw_version_major = (uint32_t)whad_cap_cache_get_le(&buffer[16], 4);
+        p_entry->key.fw_version_minor = (uint32_t)whad_cap_cache_get_le(&buffer[20], 4);
+        p_entry->key.fw_version_rev = (uint32_t)whad_cap_cache_get_le(&buffer[24], 4);
+        domains = (uint32_t)whad_cap_cache_get_le(&buffer[28], 4);
+        if ((domains & ~WHAD_CAP_CACHE_DOMAINS_MASK) != 0)
+        {
+            goto end;
+        }
+        p_entry->index.domains = domains;
+
+        for (slot=1; slot<WHAD_CAP_INDEX_DOMAINS; slot++)
+        {
+            if ((domains & (1UL << slot)) != 0)
+            {
+                if (whad_cap_cache_read(p_file, &hash, buffer, WHAD_CAP_CACHE_DOMAIN_SIZE) != WHAD_SUCCESS)
+                {
+                    goto end;
+                }
+                p_entry->index.capabilities[slot] = buffer[0];
+                p_entry->index.commands[slot] = whad_cap_cache_get_le(&buffer[1], 8);
+            }
+        }
+    }
+
+    /* Check hash. */
+    if ((fread(buffer, 4, 1, p_file) != 1) || (whad_cap_cache_get_le(buffer, 4) != hash))
+    {
+        goto end;
+    }
+
+    p_cache->count = (count < WHAD_CAP_CACHE_MAX_ENTRIES) ? (int)count : WHAD_CAP_CACHE_MAX_ENTRIES;
+    result = WHAD_SUCCESS;
+
+end:
+    fclose(p_file);
+    if (result != WHAD_SUCCESS)
+    {
+        whad_cap_cache_init(p_cache);
+    }
+    return result;
+}
+
+
+/**
+ * @brief   Save a capability cache to a file.
+ *
+ * The cache is written to a temporary file (`psz_path` followed by `.tmp`)
+ * then renamed, so that an interrupted save never leaves a truncated cache.
+ *
+ * @param[in,out]   p_cache     Pointer to a capability cache
+ * @param[in]       psz_path    Cache file path
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid parameters or file could not be written.
+ **/
+
+whad_result_t whad_cap_cache_save(whad_cap_cache_t *p_cache, const char *psz_path)
+{
+    uint8_t buffer[WHAD_CAP_CACHE_ENTRY_SIZE + WHAD_CAP_INDEX_DOMAINS*WHAD_CAP_CACHE_DOMAIN_SIZE];
+    char sz_tmp_path[WHAD_CAP_CACHE_PATH_MAX];
+    whad_cap_cache_entry_t *p_entry;
+    whad_result_t result = WHAD_ERROR;
+    uint32_t hash = WHAD_CAP_CACHE_FNV_OFFSET;
+    uint32_t slot;
+    int length;
+    int i;
+    FILE *p_file;
+
+    /* Sanity check. */
+    if ((p_cache == NULL) || (psz_path == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    length = snprintf(sz_tmp_path, sizeof(sz_tmp_path), "%s.tmp", psz_path);
+    if ((length < 0) || (length >= (int)sizeof(sz_tmp_path)))
+    {
+        return WHAD_ERROR;
+    }
+
+    p_file = fopen(sz_tmp_path, "wb");
+    if (p_file == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    memset(buffer, 0, WHAD_CAP_CACHE_HEADER_SIZE);
+    memcpy(buffer, WHAD_CAP_CACHE_MAGIC, sizeof(WHAD_CAP_CACHE_MAGIC));
+    whad_cap_cache_put_le(&buffer[8], WHAD_CAP_CACHE_VERSION, 4);
+    whad_cap_cache_put_le(&buffer[12], p_cache->count, 4);
+    if (whad_cap_cache_write(p_file, &hash, buffer, WHAD_CAP_CACHE_HEADER_SIZE) != WHAD_SUCCESS)
+    {
+        goto end;
+    }
+
+    for (i=0; i<p_cache->count; i++)
+    {
+        p_entry = &p_cache->entries[i];
+        memcpy(buffer, p_entry->key.devid, WHAD_CAP_CACHE_DEVID_SIZE);
+        whad_cap_cache_put_le(&buffer[16], p_entry->key.fw_version_major, 4);
+        whad_cap_cache_put_le(&buffer[20], p_entry->key.fw_version_minor, 4);
+        whad_cap_cache_put_le(&buffer[24], p_entry->key.fw_version_rev, 4);
+        whad_cap_cache_put_le(&buffer[28], p_entry->index.domains & WHAD_CAP_CACHE_DOMAINS_MASK, 4);
+        length = WHAD_CAP_CACHE_ENTRY_SIZE;
+
+        for (slot=1; slot<WHAD_CAP_INDEX_DOMAINS; slot++)
+        {
+            if ((p_entry->index.domains & (1UL << slot)) != 0)
+            {
+                buffer[length] = p_entry->index.capabilities[slot];
+                whad_cap_cache_put_le(&buffer[length + 1], p_entry->index.commands[slot], 8);
+                length += WHAD_CAP_CACHE_DOMAIN_SIZE;
+            }
+        }
+
+        if (whad_cap_cache_write(p_file, &hash, buffer, length) != WHAD_SUCCESS)
+        {
+            goto end;
+        }
+    }
+
+    whad_cap_cache_put_le(buffer, hash, 4);
+    if (fwrite(buffer, 4, 1, p_file) == 1)
+    {
+        result = WHAD_SUCCESS;
+    }
+
+end:
+    if (fclose(p_file) != 0)
+    {
+        result = WHAD_ERROR;
+    }
+
+    if ((result != WHAD_SUCCESS) || (rename(sz_tmp_path, psz_path) != 0))
+    {
+        remove(sz_tmp_path);
+        return WHAD_ERROR;
+    }
+    p_cache->modified = false;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Get the cache key of a device info response.
+ *
+ * @param[in]   p_device_info   Pointer to a device info response
+ * @param[out]  p_key           Pointer to the key to fill
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid parameters or wrong message type.
+ **/
+
+whad_result_t whad_cap_cache_get_key(Message *p_device_info, whad_cap_cache_key_t *p_key)
+{
+    /* Sanity check. */
+    if ((p_device_info == NULL) || (p_key == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_discovery_get_message_type(p_device_info) != WHAD_DISCOVERY_DEVICE_INFO_RESP)
+    {
+        return WHAD_ERROR;
+    }
+
+    memcpy(p_key->devid, p_device_info->msg.discovery.msg.info_resp.devid, WHAD_CAP_CACHE_DEVID_SIZE);
+    p_key->fw_version_major = p_device_info->msg.discovery.msg.info_resp.fw_version_major;
+    p_key->fw_version_minor = p_device_info->msg.discovery.msg.info_resp.fw_version_minor;
+    p_key->fw_version_rev = p_device_info->msg.discovery.msg.info_resp.fw_version_rev;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Look up the capabilities of a device.
+ *
+ * On a hit, the cached capability index is copied and domain info queries
+ * can be skipped. If the device info response has been decoded into an arena,
+ * the domains and capabilities it reports must match the cached ones.
+ *
+ * @param[in]   p_cache         Pointer to a capability cache
+ * @param[in]   p_device_info   Pointer to the device info response
+ * @param[out]  p_index         Pointer to the capability index to fill
+ *
+ * @retval  WHAD_SUCCESS    Cache hit, `p_index` filled.
+ * @retval  WHAD_NONE       Cache miss, device must be discovered.
+ * @retval  WHAD_ERROR      Invalid parameters or wrong message type.
+ **/
+
+whad_result_t whad_cap_cache_lookup(whad_cap_cache_t *p_cache, Message *p_device_info, whad_cap_index_t *p_index)
+{
+    whad_cap_cache_entry_t *p_entry;
+    whad_cap_cache_key_t key;
+    whad_cap_index_t reported;
+    uint32_t slot;
+    int i;
+
+    /* Sanity check. */
+    if ((p_cache == NULL) || (p_index == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_cap_cache_get_key(p_device_info, &key) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    i = whad_cap_cache_find(p_cache, &key);
+    if (i < 0)
+    {
+        return WHAD_NONE;
+    }
+    p_entry = &p_cache->entries[i];
+
+    /* Check reported capabilities, if decoded. */
+    whad_cap_index_init(&reported);
+    if (whad_cap_index_add_device_info(&reported, p_device_info) == WHAD_SUCCESS)
+    {
+        if (reported.domains != p_entry->index.domains)
+        {
+            return WHAD_NONE;
+        }
+
+        for (slot=1; slot<WHAD_CAP_INDEX_DOMAINS; slot++)
+        {
+            if (reported.capabilities[slot] != p_entry->index.capabilities[slot])
+            {
+                return WHAD_NONE;
+            }
+        }
+    }
+
+    *p_index = p_entry->index;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Store the capabilities of a device.
+ *
+ * The entry of the device is updated if it exists. Otherwise a new entry is
+ * added, replacing the oldest one when the cache is full.
+ *
+ * @param[in,out]   p_cache         Pointer to a capability cache
+ * @param[in]       p_device_info   Pointer to the device info response
+ * @param[in]       p_index         Pointer to the device capability index
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid parameters or wrong message type.
+ **/
+
+whad_result_t whad_cap_cache_store(whad_cap_cache_t *p_cache, Message *p_device_info, const whad_cap_index_t *p_index)
+{
+    whad_cap_cache_key_t key;
+    int i;
+
+    /* Sanity check. */
+    if ((p_cache == NULL) || (p_index == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_cap_cache_get_key(p_device_info, &key) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    i = whad_cap_cache_find(p_cache, &key);
+    if (i < 0)
+    {
+        if (p_cache->count < WHAD_CAP_CACHE_MAX_ENTRIES)
+        {
+            i = p_cache->count++;
+        }
+        else
+        {
+            i = p_cache->next;
+            p_cache->next = (p_cache->next + 1) % WHAD_CAP_CACHE_MAX_ENTRIES;
+        }
+        p_cache->entries[i].key = key;
+    }
+
+    /* Keep only valid domains, as saved. */
+    p_cache->entries[i].index = *p_index;
+    p_cache->entries[i].index.domains &= WHAD_CAP_CACHE_DOMAINS_MASK;
+    p_cache->modified = true;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
@@ -0,0 +1,377 @@
+#include "whad.h"
+
+
+/**
+ * @brief   Update the estimate from the stored exchanges.
+ *
+ * @param[in,out]   p_sync  Pointer to a clock synchronization state
+ **/
+
+static void whad_clock_sync_update(whad_clock_sync_t *p_sync)
+{
+    whad_clock_sync_sample_t *p_sample;
+    uint64_t min_delay = UINT64_MAX;
+    uint64_t max_delay = 0;
+    uint64_t threshold;
+    uint64_t ref_time = 0;
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    double x, y, x_min = 0.0;
+    double a, b, residual, max_residual = 0.0;
+    int n = 0;
+    int i;
+    int index;
+
+    for (i=0; i<p_sync->count; i++)
+    {
+        if (p_sync->samples[i].delay < min_delay)
+        {
+            min_delay = p_sync->samples[i].delay;
+        }
+    }
+    threshold = 2*min_delay + WHAD_CLOCK_SYNC_DELAY_MARGIN_US;
+
+    /* Fit the offsets of exchanges not delayed by queuing, relative to the most recent one. */
+    for (i=1; i<=p_sync->count; i++)
+    {
+        index = (p_sync->next + WHAD_CLOCK_SYNC_SAMPLES - i) % WHAD_CLOCK_SYNC_SAMPLES;
+        p_sample = &p_sync->samples[index];
+        if (p_sample->delay > threshold)
+        {
+            continue;
+        }
+
+        if (n == 0)
+        {
+            ref_time = p_sample->device_time;
+        }
+
+        x = (double)(int64_t)(p_sample->device_time - ref_time);
+        y = (double)p_sample->offset;
+        sx += x;
+        sy += y;
+        sxx += x*x;
+        sxy += x*y;
+        if (x < x_min)
+        {
+            x_min = x;
+        }
+        if (p_sample->delay > max_delay)
+        {
+            max_delay = p_sample->delay;
+        }
+        n++;
+    }
+
+    if ((n >= 2) && (-x_min >= WHAD_CLOCK_SYNC_MIN_SPAN_US))
+    {
+        b = (n*sxy - sx*sy) / (n*sxx - sx*sx);
+    }
+    else
+    {
+        /* Keep the last drift until exchanges span enough time. */
+        b = p_sync->valid ? p_sync->estimate.drift : 0.0;
+    }
+    a = (sy - b*sx) / n;
+
+    for (i=0; i<p_sync->count; i++)
+    {
+        p_sample = &p_sync->samples[i];
+        if (p_sample->delay > threshold)
+        {
+            continue;
+        }
+
+        x = (double)(int64_t)(p_sample->device_time - ref_time);
+        residual = (double)p_sample->offset - (a + b*x);
+        if (residual < 0.0)
+        {
+            residual = -residual;
+        }
+        if (residual > max_residual)
+        {
+            max_residual = residual;
+        }
+    }
+
+    p_sync->estimate.offset = (int64_t)((a >= 0.0) ? (a + 0.5) : (a - 0.5));
+    p_sync->estimate.drift = b;
+    p_sync->estimate.ref_time = ref_time;
+    p_sync->estimate.first_time = ref_time + (int64_t)x_min;
+    p_sync->estimate.error = max_delay/2 + (uint64_t)(max_residual + 1.0);
+    if ((n >= 2) && (-x_min >= WHAD_CLOCK_SYNC_MIN_SPAN_US))
+    {
+        p_sync->estimate.error_rate = (uint64_t)((2.0 * p_sync->estimate.error * 1e6) / -x_min) + 1;
+    }
+    else
+    {
+        p_sync->estimate.error_rate = WHAD_CLOCK_SYNC_MAX_DRIFT_PPM;
+    }
+    p_sync->estimate.samples = n;
+    p_sync->valid = true;
+}
+
+
+/**
+ * @brief   Initialize a clock synchronization state.
+ *
+ * @param[in,out]   p_sync      Pointer to a clock synchronization state
+ * @param[in]       period_us   Query period, 0 to use the default period
+ **/
+
+void whad_clock_sync_init(whad_clock_sync_t *p_sync, uint64_t period_us)
+{
+    /* Sanity check. */
+    if (p_sync == NULL)
+    {
+        return;
+    }
+
+    memset(p_sync, 0, sizeof(whad_clock_sync_t));
+    p_sync->period = (period_us > 0) ? period_us : WHAD_CLOCK_SYNC_DEFAULT_PERIOD_US;
+}
+
+
+/**
+ * @brief   Build the next clock synchronization query, if one is due.
+ *
+ * Called periodically by the host main loop. A query is due when no other
+ * query is in flight (or the previous one timed out) and its period elapsed.
+ * Until half of the exchanges have been stored, queries are sent more often
+ * so that a first estimate is quickly available.
+ *
+ * @param[in,out]   p_sync      Pointer to a clock synchronization state
+ * @param[in]       host_now    Current host time
+ * @param[out]      p_query     Pointer to a `Message` structure receiving the query
+ *
+ * @retval  WHAD_SUCCESS    Query built, to be sent to the device right away.
+ * @retval  WHAD_NONE       No query due.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_clock_sync_poll(whad_clock_sync_t *p_sync, uint64_t host_now, Message *p_query)
+{
+    /* Sanity check. */
+    if ((p_sync == NULL) || (p_query == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_sync->pending && ((host_now - p_sync->query_time) >= WHAD_CLOCK_SYNC_TIMEOUT_US))
+    {
+        /* Query or reply lost. */
+        p_sync->pending = false;
+    }
+
+    if (p_sync->pending || (host_now < p_sync->next_query_time))
+    {
+        return WHAD_NONE;
+    }
+
+    p_sync->sequence++;
+    if (whad_generic_time_sync_query(p_query, p_sync->sequence, host_now) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    p_sync->pending = true;
+    p_sync->query_time = host_now;
+    p_sync->next_query_time = host_now + ((p_sync->count < (WHAD_CLOCK_SYNC_SAMPLES/2)) ?
+                                          (p_sync->period / WHAD_CLOCK_SYNC_SAMPLES) : p_sync->period);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Process a message received from the device.
+ *
+ * @param[in,out]   p_sync      Pointer to a clock synchronization state
+ * @param[in]       p_reply     Pointer to the received message
+ * @param[in]       host_now    Host time at which the message was received
+ *
+ * @retval  WHAD_SUCCESS    Clock synchronization reply processed, estimate updated.
+ * @retval  WHAD_NONE       Not a clock synchronization reply.
+ * @retval  WHAD_ERROR      Invalid parameters, unexpected or inconsistent reply.
+ **/
+
+whad_result_t whad_clock_sync_process(whad_clock_sync_t *p_sync, Message *p_reply, uint64_t host_now)
+{
+    whad_time_sync_reply_params_t params;
+    whad_clock_sync_sample_t *p_sample;
+    uint64_t round_trip;
+    uint64_t processing;
+
+    /* Sanity check. */
+    if ((p_sync == NULL) || (p_reply == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_generic_time_sync_reply_parse(p_reply, &params) != WHAD_SUCCESS)
+    {
+        return WHAD_NONE;
+    }
+
+    /* Only the reply to the query in flight is used. */
+    if (!p_sync->pending || (params.sequence != p_sync->sequence) || (params.host_time != p_sync->query_time))
+    {
+        return WHAD_ERROR;
+    }
+    p_sync->pending = false;
+
+    if ((host_now < params.host_time) || (params.tx_time < params.rx_time))
+    {
+        return WHAD_ERROR;
+    }
+
+    round_trip = host_now - params.host_time;
+    processing = params.tx_time - params.rx_time;
+    if (processing > round_trip)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Store the exchange, replacing the oldest one. */
+    p_sample = &p_sync->samples[p_sync->next];
+    p_sample->device_time = params.rx_time + processing/2;
+    p_sample->offset = (((int64_t)params.host_time - (int64_t)params.rx_time) +
+                        ((int64_t)host_now - (int64_t)params.tx_time)) / 2;
+    p_sample->delay = round_trip - processing;
+    p_sync->next = (p_sync->next + 1) % WHAD_CLOCK_SYNC_SAMPLES;
+    if (p_sync->count < WHAD_CLOCK_SYNC_SAMPLES)
+    {
+        p_sync->count++;
+    }
+
+    whad_clock_sync_update(p_sync);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Get the current clock synchronization estimate.
+ *
+ * @param[in]   p_sync      Pointer to a clock synchronization state
+ * @param[out]  p_estimate  Pointer to a `whad_clock_sync_estimate_t` structure
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_NONE       No exchange completed yet.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_clock_sync_get_estimate(whad_clock_sync_t *p_sync, whad_clock_sync_estimate_t *p_estimate)
+{
+    /* Sanity check. */
+    if ((p_sync == NULL) || (p_estimate == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (!p_sync->valid)
+    {
+        return WHAD_NONE;
+    }
+
+    *p_estimate = p_sync->estimate;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Convert a device time into host time.
+ *
+ * The error bound grows with the distance between the device time and the
+ * exchanges used by the estimate, by the drift uncertainty.
+ *
+ * @param[in]   p_sync          Pointer to a clock synchronization state
+ * @param[in]   device_time     Device time in us
+ * @param[out]  p_host_time     Pointer to the corresponding host time
+ * @param[out]  p_error         Pointer to the error bound, may be NULL
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_NONE       No exchange completed yet.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_clock_sync_to_host(whad_clock_sync_t *p_sync, uint64_t device_time, uint64_t *p_host_time,
+                                      uint64_t *p_error)
+{
+    whad_clock_sync_estimate_t *p_estimate;
+    int64_t elapsed;
+    uint64_t distance = 0;
+
+    /* Sanity check. */
+    if ((p_sync == NULL) || (p_host_time == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (!p_sync->valid)
+    {
+        return WHAD_NONE;
+    }
+
+    p_estimate = &p_sync->estimate;
+    elapsed = (int64_t)(device_time - p_estimate->ref_time);
+    *p_host_time = device_time + p_estimate->offset + (int64_t)(p_estimate->drift * (double)elapsed);
+
+    if (p_error != NULL)
+    {
+        if (elapsed > 0)
+        {
+            distance = (uint64_t)elapsed;
+        }
+        else if (device_time < p_estimate->first_time)
+        {
+            distance = p_estimate->first_time - device_time;
+        }
+        *p_error = p_estimate->error + (distance * p_estimate->error_rate) / 1000000;
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Convert a 32-bit device timestamp into host time.
+ *
+ * Notifications timestamps (e.g. BLE raw PDUs) are the lower 32 bits of the
+ * device time, they are extended with the device time of the estimate
+ * (timestamps must be within 35 minutes of the last exchanges).
+ *
+ * @param[in]   p_sync          Pointer to a clock synchronization state
+ * @param[in]   device_time     Lower 32 bits of the device time in us
+ * @param[out]  p_host_time     Pointer to the corresponding host time
+ * @param[out]  p_error         Pointer to the error bound, may be NULL
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_NONE       No exchange completed yet.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_clock_sync_to_host32(whad_clock_sync_t *p_sync, uint32_t device_time, uint64_t *p_host_time,
+                                        uint64_t *p_error)
+{
+    uint64_t ref_time;
+
+    /* Sanity check. */
+    if (p_sync == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    if (!p_sync->valid)
+    {
+        return WHAD_NONE;
+    }
+
+    ref_time = p_sync->estimate.ref_time;
+    return whad_clock_sync_to_host(p_sync, ref_time + (int32_t)(device_time - (uint32_t)ref_time), p_host_time,
+                                   p_error);
+}
@@ -0,0 +1,289 @@
+#include "whad.h"
+
+
+/**
+ * @brief   Get the discovery or domain message oneof tag of a command.
+ *
+ * @param[in]   p_command   Pointer to a command message
+ * @param[out]  p_which_submsg  Pointer set to the discovery or domain message oneof tag
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Not a discovery or domain message.
+ **/
+
+static whad_result_t whad_cmd_latency_get_submsg(Message *p_command, pb_size_t *p_which_submsg)
+{
+    switch (p_command->which_msg)
+    {
+        case Message_discovery_tag:
+            *p_which_submsg = p_command->msg.discovery.which_msg;
+            break;
+
+#if WHAD_ENABLE_BLE
+        case Message_ble_tag:
+            *p_which_submsg = p_command->msg.ble.which_msg;
+            break;
+#endif
+
+#if WHAD_ENABLE_ESB
+        case Message_esb_tag:
+            *p_which_submsg = p_command->msg.esb.which_msg;
+            break;
+#endif
+
+#if WHAD_ENABLE_PHY
+        case Message_phy_tag:
+            *p_which_submsg = p_command->msg.phy.which_msg;
+            break;
+#endif
+
+#if WHAD_ENABLE_UNIFYING
+        case Message_unifying_tag:
+            *p_which_submsg = p_command->msg.unifying.which_msg;
+            break;
+#endif
+
+#if WHAD_ENABLE_DOT15D4
+        case Message_dot15d4_tag:
+            *p_which_submsg = p_command->msg.dot15d4.which_msg;
+            break;
+#endif
+
+        default:
+            /* Nope. */
+            return WHAD_ERROR;
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Add a stage duration to its statistics.
+ *
+ * @param[in,out]   p_stats     Pointer to the stage statistics
+ * @param[in]       duration    Stage duration in us, clamped to zero if negative
+ **/
+
+static void whad_cmd_latency_add(whad_cmd_stage_stats_t *p_stats, int64_t duration)
+{
+    uint64_t value = (duration > 0) ? (uint64_t)duration : 0;
+
+    if ((p_stats->count == 0) || (value < p_stats->min))
+    {
+        p_stats->min = value;
+    }
+    if (value > p_stats->max)
+    {
+        p_stats->max = value;
+    }
+    p_stats->sum += value;
+    p_stats->count++;
+}
+
+
+/**
+ * @brief   Initialize a command latency tracker.
+ *
+ * The link baudrate is used to convert the device TX queue depth into time,
+ * with 10 bits per byte (UART 8N1). Links without a meaningful baudrate (USB)
+ * use 0, the TX queue stage is then not measured.
+ *
+ * @param[in,out]   p_latency   Pointer to a command latency tracker
+ * @param[in]       baudrate    Link baudrate, 0 if unknown
+ * @param[in]       p_sync      Pointer to a clock synchronization state, may be NULL
+ **/
+
+void whad_cmd_latency_init(whad_cmd_latency_t *p_latency, uint32_t baudrate, whad_clock_sync_t *p_sync)
+{
+    /* Sanity check. */
+    if (p_latency == NULL)
+    {
+        return;
+    }
+
+    memset(p_latency, 0, sizeof(whad_cmd_latency_t));
+    p_latency->byte_time_ns = (baudrate > 0) ? (10000000000ULL / baudrate) : 0;
+    p_latency->p_sync = p_sync;
+}
+
+
+/**
+ * @brief   Note a command sent to the device.
+ *
+ * @param[in,out]   p_latency   Pointer to a command latency tracker
+ * @param[in]       p_command   Pointer to the command message
+ * @param[in]       host_now    Host time at which the command was sent
+ *
+ * @retval  WHAD_SUCCESS    Command noted.
+ * @retval  WHAD_NONE       Not a command, or no room left to track its type.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_cmd_latency_sent(whad_cmd_latency_t *p_latency, Message *p_command, uint64_t host_now)
+{
+    pb_size_t which_submsg;
+    int i;
+
+    /* Sanity check. */
+    if ((p_latency == NULL) || (p_command == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* A command without result does not hold the next one. */
+    p_latency->pending = false;
+
+    if (whad_cmd_latency_get_submsg(p_command, &which_submsg) != WHAD_SUCCESS)
+    {
+        return WHAD_NONE;
+    }
+
+    for (i=0; i<p_latency->count; i++)
+    {
+        if ((p_latency->types[i].which_msg == p_command->which_msg) &&
+            (p_latency->types[i].which_submsg == which_submsg))
+        {
+            break;
+        }
+    }
+
+    if (i == p_latency->count)
+    {
+        if (p_latency->count >= WHAD_CMD_LATENCY_TYPES)
+        {
+            return WHAD_NONE;
+        }
+        p_latency->types[i].which_msg = p_command->which_msg;
+        p_latency->types[i].which_submsg = which_submsg;
+        p_latency->count++;
+    }
+
+    p_latency->pending = true;
+    p_latency->pending_type = i;
+    p_latency->sent_time = host_now;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Process a message received from the device.
+ *
+ * Command results are matched with the command in flight and their round
+ * trip split into stages. The request and response stages rely on the clock
+ * synchronization estimate, they are clamped to zero when the estimate error
+ * exceeds them.
+ *
+ * @param[in,out]   p_latency   Pointer to a command latency tracker
+ * @param[in]       p_reply     Pointer to the received message
+ * @param[in]       host_now    Host time at which the message was received
+ *
+ * @retval  WHAD_SUCCESS    Command result processed, statistics updated.
+ * @retval  WHAD_NONE       Not a command result, or no command in flight.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_cmd_latency_process(whad_cmd_latency_t *p_latency, Message *p_reply, uint64_t host_now)
+{
+    whad_cmd_latency_stats_t *p_stats;
+    whad_cmd_timing_t timing;
+    whad_result_t result;
+    uint64_t host_rx_time;
+    int64_t round_trip;
+    int64_t queue;
+    int64_t request;
+
+    /* Sanity check. */
+    if ((p_latency == NULL) || (p_reply == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_generic_get_message_type(p_reply) != WHAD_GENERIC_CMDRESULT)
+    {
+        return WHAD_NONE;
+    }
+
+    if (!p_latency->pending)
+    {
+        return WHAD_NONE;
+    }
+    p_latency->pending = false;
+
+    p_stats = &p_latency->types[p_latency->pending_type];
+    p_stats->results++;
+    round_trip = (int64_t)(host_now - p_latency->sent_time);
+    whad_cmd_latency_add(&p_stats->stages[WHAD_CMD_STAGE_ROUND_TRIP], round_trip);
+
+    result = whad_generic_cmd_result_timing_parse(p_reply, &timing);
+    if (result != WHAD_SUCCESS)
+    {
+        p_stats->untimed++;
+        return WHAD_SUCCESS;
+    }
+
+    queue = (int64_t)((timing.tx_backlog * p_latency->byte_time_ns) / 1000);
+    whad_cmd_latency_add(&p_stats->stages[WHAD_CMD_STAGE_HANDLER], timing.duration);
+    whad_cmd_latency_add(&p_stats->stages[WHAD_CMD_STAGE_TX_QUEUE], queue);
+    whad_cmd_latency_add(&p_stats->stages[WHAD_CMD_STAGE_LINK], round_trip - timing.duration - queue);
+
+    if (whad_clock_sync_to_host32(p_latency->p_sync, timing.rx_time, &host_rx_time, NULL) == WHAD_SUCCESS)
+    {
+        request = (int64_t)(host_rx_time - p_latency->sent_time);
+        whad_cmd_latency_add(&p_stats->stages[WHAD_CMD_STAGE_REQUEST], request);
+        whad_cmd_latency_add(&p_stats->stages[WHAD_CMD_STAGE_RESPONSE],
+                             round_trip - request - timing.duration - queue);
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Get the number of command types tracked.
+ *
+ * @param[in]   p_latency   Pointer to a command latency tracker
+ *
+ * @return  Number of command types, 0 if invalid parameters
+ **/
+
+int whad_cmd_latency_get_count(whad_cmd_latency_t *p_latency)
+{
+    /* Sanity check. */
+    if (p_latency == NULL)
+    {
+        return 0;
+    }
+
+    return p_latency->count;
+}
+
+
+/**
+ * @brief   Get the statistics of a command type.
+ *
+ * @param[in]   p_latency   Pointer to a command latency tracker
+ * @param[in]   index       Command type index, below `whad_cmd_latency_get_count()`
+ * @param[out]  p_stats     Pointer to a `whad_cmd_latency_stats_t` structure
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid parameters.
+ **/
+
+whad_result_t whad_cmd_latency_get_stats(whad_cmd_latency_t *p_latency, int index, whad_cmd_latency_stats_t *p_stats)
+{
+    /* Sanity check. */
+    if ((p_latency == NULL) || (p_stats == NULL) || (index < 0) || (index >= p_latency->count))
+    {
+        return WHAD_ERROR;
+    }
+
+    *p_stats = p_latency->types[index];
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
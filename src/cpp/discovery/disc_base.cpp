@@ -19,7 +19,7 @@ whad::discovery::DiscoveryMsg::DiscoveryMsg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a discovery domain message 
  **/
 
-whad::discovery::DiscoveryMsg::DiscoveryMsg(NanoPbMsg &pMessage) : NanoPbMsg(pMessage.getRaw())
+whad::discovery::DiscoveryMsg::DiscoveryMsg(NanoPbMsg &pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
@@ -22,6 +22,8 @@ using namespace whad::discovery;
  * @param   fwVersionMinor      Minor version of the firmware running on the device
  * @param   fwVersionRevision   Minor version of the firmware running on the device
  * @param   capabilities        Specifies the device capabilities and supported commands per domain
+ * @param   describeAll         Include the supported commands of every domain, in response to a
+ *                              describe query (see DeviceInfoQuery::isDescribeAll())
  **/
 
 DeviceInfoResp::DeviceInfoResp(
@@ -34,20 +36,46 @@ DeviceInfoResp::DeviceInfoResp(
     uint32_t fwVersionMajor,
     uint32_t fwVersionMinor,
     uint32_t fwVersionRevision,
-    whad_domain_desc_t *capabilities
+    whad_domain_desc_t *capabilities,
+    bool describeAll
 ) : DiscoveryMsg()
+{
+    m_deviceType = deviceType;
+    memcpy(m_deviceId, deviceId, sizeof(m_deviceId));
+    m_protoMinVer = protoMinVer;
+    m_maxSpeed = maxSpeed;
+    m_firmwareAuthor = sFirmwareAuthor;
+    m_firmwareUrl = sFirmwareUrl;
+    m_fwVersionMajor = fwVersionMajor;
+    m_fwVersionMinor = fwVersionMinor;
+    m_fwVersionRevision = fwVersionRevision;
+    m_capabilities = capabilities;
+    m_describeAll = describeAll;
+}
+
+
+/**
+ *  @brief  Callback method to pack the message parameters into a raw message.
+ */
+
+void DeviceInfoResp::pack()
 {
     whad_discovery_device_info_resp(
-        this->getRaw(),
-        (discovery_DeviceType)deviceType,
-        deviceId,
-        protoMinVer,
-        maxSpeed,
-        (char *)sFirmwareAuthor.c_str(),
-        (char *)sFirmwareUrl.c_str(),
-        fwVersionMajor, fwVersionMinor, fwVersionRevision,
-        capabilities
+        this->getMessage(),
+        (discovery_DeviceType)m_deviceType,
+        m_deviceId,
+        m_protoMinVer,
+        m_maxSpeed,
+        (char *)m_firmwareAuthor.c_str(),
+        (char *)m_firmwareUrl.c_str(),
+        m_fwVersionMajor, m_fwVersionMinor, m_fwVersionRevision,
+        m_capabilities
     );
+
+    if (m_describeAll)
+    {
+        whad_discovery_device_info_resp_add_domains(this->getMessage(), m_capabilities);
+    }
 }
 
 /***********************
@@ -69,11 +97,14 @@ DeviceInfoQuery::DeviceInfoQuery(DiscoveryMsg &message) : DiscoveryMsg(message)
  *  @brief  Create a DeviceInfoQuery message with a specific protocol version.
  * 
  *  @param  protoVersion    Version of the WHAD protocol supported by this device
+ *  @param  describeAll     Ask for the supported commands of every domain in the
+ *                          response, discovering the device in a single round trip
  */
 
-DeviceInfoQuery::DeviceInfoQuery(uint32_t protoVersion) : DiscoveryMsg()
+DeviceInfoQuery::DeviceInfoQuery(uint32_t protoVersion, bool describeAll) : DiscoveryMsg()
 {
     m_version = protoVersion;
+    m_describeAll = describeAll;
 }
 
 
@@ -89,13 +120,33 @@ uint32_t DeviceInfoQuery::getVersion(void)
 }
 
 
+/**
+ *  @brief  Determine if the query asks for the supported commands of every domain
+ * 
+ *  @retval true    Describe query, see DeviceInfoResp
+ *  @retval false   Plain device info query
+ */
+
+bool DeviceInfoQuery::isDescribeAll(void)
+{
+    return m_describeAll;
+}
+
+
 /**
  *  @brief  Callback method to pack the message parameters into a raw message.
  */
 
 void DeviceInfoQuery::pack()
 {
-    whad_discovery_device_info_query(this->getMessage(), m_version);
+    if (m_describeAll)
+    {
+        whad_discovery_device_describe_query(this->getMessage(), m_version);
+    }
+    else
+    {
+        whad_discovery_device_info_query(this->getMessage(), m_version);
+    }
 }
 
 
@@ -109,4 +160,5 @@ void DeviceInfoQuery::unpack()
     {
         throw WhadMessageParsingError();
     }
+    m_describeAll = whad_discovery_device_info_query_is_describe(this->getMessage());
 }
\ No newline at end of file
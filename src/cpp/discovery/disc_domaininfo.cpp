@@ -12,6 +12,151 @@ bool whad::discovery::isDomainSupported(const whad_domain_desc_t *capabilities,
     return whad_discovery_is_domain_supported(capabilities, (whad_domain_t)domain);
 }
 
+
+/**
+ * @brief   Determine if a domain is supported, from a capability index.
+ * 
+ * @param   index   Capability index
+ * @param   domain  Domain
+ */
+
+bool whad::discovery::isDomainSupported(const CapabilityIndex &index, Domains domain)
+{
+    return index.isDomainSupported(domain);
+}
+
+
+/**
+ * @brief   Determine if a domain command is supported, from a capability index.
+ * 
+ * @param   index   Capability index
+ * @param   domain  Domain
+ * @param   command Domain command
+ */
+
+bool whad::discovery::isCommandSupported(const CapabilityIndex &index, Domains domain, uint32_t command)
+{
+    return index.isCommandSupported(domain, command);
+}
+
+
+/***********************
+ * Capability index
+ ***********************/
+
+/**
+ * @brief   Create an empty capability index, to be filled from device and
+ *          domain info responses.
+ */
+
+CapabilityIndex::CapabilityIndex()
+{
+    whad_cap_index_init(&m_index);
+}
+
+
+/**
+ * @brief   Create a capability index from a list of domain descriptions.
+ * 
+ * @param   capabilities    `DOMAIN_NONE`-terminated list of domain descriptions
+ */
+
+CapabilityIndex::CapabilityIndex(const whad_domain_desc_t *capabilities)
+{
+    if (whad_cap_index_build(&m_index, capabilities) != WHAD_SUCCESS)
+    {
+        whad_cap_index_init(&m_index);
+    }
+}
+
+
+/**
+ * @brief   Add the domains of a device info response.
+ * 
+ * @param   message     Device info response, decoded into an arena
+ * 
+ * @retval  true    Domains added.
+ * @retval  false   Not a device info response, or decoded without arena.
+ */
+
+bool CapabilityIndex::addDeviceInfo(NanoPbMsg &message)
+{
+    return (whad_cap_index_add_device_info(&m_index, message.getMessage()) == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief   Add the domains and supported commands of a device description.
+ * 
+ * A device description is the device info response to a describe query
+ * (see DeviceInfoQuery). If the firmware does not support describe queries,
+ * supported commands must be added from domain info responses.
+ * 
+ * @param   message     Device info response, decoded into an arena
+ * 
+ * @retval  true    Domains and supported commands added, index complete.
+ * @retval  false   Domains not described, or not a device info response.
+ */
+
+bool CapabilityIndex::addDeviceDescription(NanoPbMsg &message)
+{
+    return (whad_cap_index_add_device_description(&m_index, message.getMessage()) == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief   Add the supported commands of a domain info response.
+ * 
+ * @param   message     Domain info response
+ * 
+ * @retval  true    Supported commands added.
+ * @retval  false   Not a domain info response, or unknown domain.
+ */
+
+bool CapabilityIndex::addDomainInfo(NanoPbMsg &message)
+{
+    return (whad_cap_index_add_domain_info(&m_index, message.getMessage()) == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief   Determine if a domain is supported.
+ * 
+ * @param   domain  Domain
+ */
+
+bool CapabilityIndex::isDomainSupported(Domains domain) const
+{
+    return whad_cap_index_is_domain_supported(&m_index, (whad_domain_t)domain);
+}
+
+
+/**
+ * @brief   Determine if a domain command is supported.
+ * 
+ * @param   domain  Domain
+ * @param   command Domain command (e.g. `ble_BleCommand_SniffAdv`)
+ */
+
+bool CapabilityIndex::isCommandSupported(Domains domain, uint32_t command) const
+{
+    return whad_cap_index_is_command_supported(&m_index, (whad_domain_t)domain, command);
+}
+
+
+/**
+ * @brief   Get the supported commands of a domain.
+ * 
+ * @param   domain  Domain
+ * 
+ * @return  Supported commands bitmask, 0 if the domain is not supported
+ */
+
+uint64_t CapabilityIndex::getSupportedCommands(Domains domain) const
+{
+    return whad_cap_index_get_supported_commands(&m_index, (whad_domain_t)domain);
+}
+
 /**
  * Domain information query
  */
@@ -97,5 +242,16 @@ void DomainInfoQuery::unpack()
 
 DomainInfoResp::DomainInfoResp(Domains domain, whad_domain_desc_t *capabilities) : DiscoveryMsg()
 {
-    whad_discovery_domain_info_resp(this->getRaw(), (whad_domain_t)domain, capabilities);
+    m_domain = domain;
+    m_capabilities = capabilities;
+}
+
+
+/**
+ *  @brief  Callback method to pack the message parameters into a raw message.
+ */
+
+void DomainInfoResp::pack()
+{
+    whad_discovery_domain_info_resp(this->getMessage(), (whad_domain_t)m_domain, m_capabilities);
 }
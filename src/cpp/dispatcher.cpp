@@ -0,0 +1,118 @@
+#include <cstddef>
+#include "cpp/dispatcher.hpp"
+#include "profile.h"
+
+using namespace whad;
+
+/*
+ * The dispatcher reads the message type of any category message through the
+ * first member of the `Message.msg` union, which requires every category
+ * message to start with its `which_msg` field. Disabled domains have no
+ * handler slots, their empty stand-in messages are never read.
+ */
+
+static_assert(offsetof(generic_Message, which_msg) == 0, "unexpected generic_Message layout");
+static_assert(offsetof(discovery_Message, which_msg) == 0, "unexpected discovery_Message layout");
+#if WHAD_ENABLE_BLE
+static_assert(offsetof(ble_Message, which_msg) == 0, "unexpected ble_Message layout");
+#endif
+#if WHAD_ENABLE_DOT15D4
+static_assert(offsetof(dot15d4_Message, which_msg) == 0, "unexpected dot15d4_Message layout");
+#endif
+#if WHAD_ENABLE_ESB
+static_assert(offsetof(esb_Message, which_msg) == 0, "unexpected esb_Message layout");
+#endif
+#if WHAD_ENABLE_UNIFYING
+static_assert(offsetof(unifying_Message, which_msg) == 0, "unexpected unifying_Message layout");
+#endif
+#if WHAD_ENABLE_PHY
+static_assert(offsetof(phy_Message, which_msg) == 0, "unexpected phy_Message layout");
+#endif
+
+/* Location of each message category in the handlers table, indexed by `Message.which_msg`. */
+typedef struct {
+    uint8_t offset;
+    uint8_t slots;
+} dispatch_category_t;
+
+static const dispatch_category_t g_categories[] = {
+    {0, 0},                                                                 /* Not set */
+    {WHAD_DISPATCH_GENERIC_OFFSET, WHAD_DISPATCH_GENERIC_SLOTS},            /* Message_generic_tag */
+    {WHAD_DISPATCH_DISCOVERY_OFFSET, WHAD_DISPATCH_DISCOVERY_SLOTS},        /* Message_discovery_tag */
+    {WHAD_DISPATCH_BLE_OFFSET, WHAD_DISPATCH_BLE_SLOTS},                    /* Message_ble_tag */
+    {WHAD_DISPATCH_DOT15D4_OFFSET, WHAD_DISPATCH_DOT15D4_SLOTS},            /* Message_dot15d4_tag */
+    {WHAD_DISPATCH_ESB_OFFSET, WHAD_DISPATCH_ESB_SLOTS},                    /* Message_esb_tag */
+    {WHAD_DISPATCH_UNIFYING_OFFSET, WHAD_DISPATCH_UNIFYING_SLOTS},          /* Message_unifying_tag */
+    {WHAD_DISPATCH_PHY_OFFSET, WHAD_DISPATCH_PHY_SLOTS}                     /* Message_phy_tag */
+};
+
+static_assert(Message_phy_tag == (sizeof(g_categories)/sizeof(dispatch_category_t) - 1),
+              "dispatcher categories table does not match Message tags");
+static_assert(WHAD_DISPATCH_SLOTS <= 256, "dispatcher table offsets do not fit in 8 bits");
+
+
+/**
+ * @brief       Dispatch a message to its registered handler.
+ *
+ * @param[in]   message     Message to dispatch
+ * @param[in]   pContext    Opaque pointer forwarded to the handler
+ *
+ * @retval      true        Message processed by a registered or default handler
+ * @retval      false       No handler available for this message
+ **/
+
+bool Dispatcher::dispatch(NanoPbMsg &message, void *pContext) const
+{
+    DispatchHandler handler = nullptr;
+    Message *p_message = message.getMessage();
+    pb_size_t category, type;
+    WHAD_PROFILE_START(start);
+
+    if (p_message != NULL)
+    {
+        category = p_message->which_msg;
+        if (category < (sizeof(g_categories)/sizeof(dispatch_category_t)))
+        {
+            /* Every category message starts with its `which_msg` field. */
+            type = *(const pb_size_t *)&p_message->msg;
+            if (type < g_categories[category].slots)
+            {
+                handler = m_handlers[g_categories[category].offset + type];
+            }
+        }
+    }
+
+    /* Fall back to the default handler, if any. */
+    if (handler == nullptr)
+    {
+        handler = m_default;
+        if (handler == nullptr)
+        {
+            return false;
+        }
+    }
+
+    handler(message, pContext);
+    WHAD_PROFILE_STOP(WHAD_PROFILE_DISPATCH, start);
+
+    /* Success. */
+    return true;
+}
+
+
+/**
+ * @brief       Dispatch a NanoPb message to its registered handler.
+ *
+ * @param[in]   p_message   Pointer to the message to dispatch
+ * @param[in]   pContext    Opaque pointer forwarded to the handler
+ *
+ * @retval      true        Message processed by a registered or default handler
+ * @retval      false       No handler available for this message
+ **/
+
+bool Dispatcher::dispatch(Message *p_message, void *pContext) const
+{
+    NanoPbMsg message(p_message);
+
+    return this->dispatch(message, pContext);
+}
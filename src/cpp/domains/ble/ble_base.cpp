@@ -22,7 +22,7 @@ BleMsg::BleMsg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a ble domain message 
  **/
 
-BleMsg::BleMsg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getRaw())
+BleMsg::BleMsg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
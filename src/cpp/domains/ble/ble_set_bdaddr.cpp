@@ -10,11 +10,7 @@ using namespace whad::ble;
 
 SetBdAddress::SetBdAddress(BDAddress address) : BleMsg()
 {
-    whad_ble_set_bdaddress(
-        this->getRaw(),
-        (whad_ble_addrtype_t)address.getType(),
-        address.getAddressBuf()
-    );
+    m_address = address;
 }
 
 
@@ -41,7 +37,7 @@ BDAddress *SetBdAddress::getAddress()
     uint8_t bdAddress[6];
 
     /* Parse the underlying message to extract BD address. */
-    if (whad_ble_set_bdaddress_parse(this->getRaw(), &addrType, bdAddress) == WHAD_SUCCESS)
+    if (whad_ble_set_bdaddress_parse(this->getMessage(), &addrType, bdAddress) == WHAD_SUCCESS)
     {
         /* Parsing ok, return BD address. */
         return new BDAddress((whad::ble::AddressType)addrType, (uint8_t *)bdAddress);
@@ -49,4 +45,18 @@ BDAddress *SetBdAddress::getAddress()
 
     /* Fail. */
     return NULL;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief   Pack the BD address into the underlying message.
+ **/
+
+void SetBdAddress::pack()
+{
+    whad_ble_set_bdaddress(
+        this->getMessage(),
+        (whad_ble_addrtype_t)m_address.getType(),
+        m_address.getAddressBuf()
+    );
+}
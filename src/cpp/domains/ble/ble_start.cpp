@@ -19,7 +19,6 @@ Start::Start(BleMsg &message) : BleMsg(message)
 
 Start::Start(void) : BleMsg()
 {
-    whad_ble_start(this->getMessage());
 }
 
 
@@ -22,7 +22,7 @@ Dot15d4Msg::Dot15d4Msg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a ble domain message 
  **/
 
-Dot15d4Msg::Dot15d4Msg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getRaw())
+Dot15d4Msg::Dot15d4Msg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
@@ -22,7 +22,7 @@ EsbMsg::EsbMsg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a discovery domain message 
  **/
 
-EsbMsg::EsbMsg(NanoPbMsg &pMessage) : NanoPbMsg(pMessage.getRaw())
+EsbMsg::EsbMsg(NanoPbMsg &pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
@@ -48,7 +48,7 @@ EsbMsg::~EsbMsg()
 MessageType EsbMsg::getType(void)
 {
     MessageType msgType = (MessageType)whad_esb_get_message_type(
-        this->getRaw()
+        this->getMessage()
     );
 
     /* Return message type. */
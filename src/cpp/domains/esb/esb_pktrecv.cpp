@@ -454,7 +454,7 @@ void PacketReceived::unpack()
     whad_esb_recvd_packet_t params;
 
     res = whad_esb_pdu_received_parse(
-        this->getRaw(),
+        this->getMessage(),
         &params
     );
 
@@ -57,7 +57,7 @@ void SendPacket::unpack()
     Packet pkt;
 
     res = whad_esb_send_parse(
-        this->getRaw(),
+        this->getMessage(),
         &params
     );
 
@@ -21,7 +21,7 @@ PhyMsg::PhyMsg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a PHY domain message 
  **/
 
-PhyMsg::PhyMsg(NanoPbMsg &pMessage) : NanoPbMsg(pMessage.getRaw())
+PhyMsg::PhyMsg(NanoPbMsg &pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
@@ -15,11 +15,18 @@ MonitorMode::MonitorMode(PhyMsg &message) : PhyMsg(message)
 
 /**
  * @brief       Create a MonitorMode message.
- * 
- * @param[in]   message     Base NanoPb message to use.
  **/
 
 MonitorMode::MonitorMode() : PhyMsg()
+{
+}
+
+
+/**
+ * @brief   Create a MonitorMode message.
+ */
+
+void MonitorMode::pack()
 {
     whad_phy_monitor_mode(
         this->getMessage()
@@ -40,7 +40,7 @@ uint32_t SetPacketSize::getSize()
     uint32_t size = 0;
 
     whad_phy_set_packet_size_parse(
-        this->getRaw(),
+        this->getMessage(),
         &size
     );
 
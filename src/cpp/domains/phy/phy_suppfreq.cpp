@@ -5,12 +5,19 @@ using namespace whad::phy;
 /**
  * @brief       Create a SupportedFreqs message with the provided frequency ranges.
  * 
- * @param[in]   pFreqRanges     Pointer to an array containing the supported frequency ranges
+ * @param[in]   pFreqRanges     Pointer to an array containing the supported frequency ranges,
+ *                              terminated by a {0,0} range and valid until the message is sent
  **/
 
 SupportedFreqsResp::SupportedFreqsResp(const whad_phy_frequency_range_t *pFreqRanges) : PhyMsg()
 {
-    m_freqRanges = pFreqRanges;
+    int nRanges = 0;
+
+    /* Count ranges (last range must be {0,0}). */
+    for (nRanges=0; (pFreqRanges[nRanges].start != 0) && (pFreqRanges[nRanges].end != 0); nRanges++);
+
+    m_freqRanges.p_ranges = pFreqRanges;
+    m_freqRanges.count = nRanges;
 }
 
 
@@ -23,6 +30,8 @@ SupportedFreqsResp::SupportedFreqsResp(const whad_phy_frequency_range_t *pFreqRa
 SupportedFreqsResp::SupportedFreqsResp(PhyMsg &message) : PhyMsg(message)
 {
     /* Not yet supported. */
+    m_freqRanges.p_ranges = NULL;
+    m_freqRanges.count = 0;
 }
 
 
@@ -32,14 +41,8 @@ SupportedFreqsResp::SupportedFreqsResp(PhyMsg &message) : PhyMsg(message)
 
 void SupportedFreqsResp::pack()
 {
-    int nRanges = 0;
-
-    /* Count ranges (last range must be {0,0}). */
-    for (nRanges=0; (m_freqRanges[nRanges].start != 0) && (m_freqRanges[nRanges].end != 0); nRanges++);
-
-    whad_phy_supported_frequencies(
+    whad_phy_supported_frequency_ranges(
         this->getMessage(),
-        (whad_phy_frequency_range_t *)m_freqRanges,
-        nRanges
+        &m_freqRanges
     );   
 }
@@ -22,7 +22,7 @@ UnifyingMsg::UnifyingMsg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a ble domain message 
  **/
 
-UnifyingMsg::UnifyingMsg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getRaw())
+UnifyingMsg::UnifyingMsg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
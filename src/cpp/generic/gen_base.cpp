@@ -19,7 +19,7 @@ whad::generic::GenericMsg::GenericMsg() : NanoPbMsg()
  * @param[in]   pMessage    NanoPbMsg object containing a discovery domain message 
  **/
 
-whad::generic::GenericMsg::GenericMsg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getRaw())
+whad::generic::GenericMsg::GenericMsg(NanoPbMsg pMessage) : NanoPbMsg(pMessage.getMessage())
 {
 }
 
@@ -45,7 +45,7 @@ whad::generic::GenericMsg::~GenericMsg()
 whad::generic::MessageType whad::generic::GenericMsg::getType(void)
 {
     whad::generic::MessageType msgType = (whad::generic::MessageType)whad_generic_get_message_type(
-        this->getRaw()
+        this->getMessage()
     );
 
     /* Return message type. */
@@ -12,6 +12,26 @@ using namespace whad::generic;
 CommandResult::CommandResult(ResultCode resultCode) : GenericMsg()
 {
     m_code = resultCode;
+    m_timed = false;
+}
+
+
+/**
+ * @brief   Build a generic commmand result message with the command timing.
+ * 
+ * @param[in]   resultCode  Command result code.
+ * @param[in]   rxTime      Device time at which the command was received, in us
+ * @param[in]   duration    Command handler duration, in us
+ * @param[in]   txBacklog   Number of bytes queued for transmission ahead of the result
+ **/
+
+CommandResult::CommandResult(ResultCode resultCode, uint32_t rxTime, uint32_t duration, uint32_t txBacklog) : GenericMsg()
+{
+    m_code = resultCode;
+    m_timed = true;
+    m_timing.rx_time = rxTime;
+    m_timing.duration = duration;
+    m_timing.tx_backlog = txBacklog;
 }
 
 
@@ -25,6 +45,7 @@ CommandResult::CommandResult(NanoPbMsg message) : GenericMsg(message)
 {
     /* Default return code. */
     this->m_code = ResultError;
+    this->m_timed = false;
 
     /* Unpack NanoPb message. */
     this->unpack();
@@ -43,6 +64,55 @@ ResultCode CommandResult::getResultCode()
 }
 
 
+/**
+ * @brief   Determine if the result carries the command timing.
+ * 
+ * @retval  true    Command timing available.
+ * @retval  false   No command timing.
+ */
+
+bool CommandResult::hasTiming()
+{
+    return this->m_timed;
+}
+
+
+/**
+ * @brief   Return the device time at which the command was received.
+ * 
+ * @retval  Device time in us, 0 if no command timing
+ */
+
+uint32_t CommandResult::getRxTime()
+{
+    return this->m_timed ? this->m_timing.rx_time : 0;
+}
+
+
+/**
+ * @brief   Return the command handler duration.
+ * 
+ * @retval  Duration in us, 0 if no command timing
+ */
+
+uint32_t CommandResult::getDuration()
+{
+    return this->m_timed ? this->m_timing.duration : 0;
+}
+
+
+/**
+ * @brief   Return the number of bytes queued for transmission ahead of the result.
+ * 
+ * @retval  Number of bytes, 0 if no command timing
+ */
+
+uint32_t CommandResult::getTxBacklog()
+{
+    return this->m_timed ? this->m_timing.tx_backlog : 0;
+}
+
+
 /**
  * @brief   Pack all parameters into the corresponding NanoPb message using
  *          C helper.
@@ -50,7 +120,14 @@ ResultCode CommandResult::getResultCode()
 
 void CommandResult::pack(void)
 {
-    whad_generic_cmd_result(this->getMessage(), (whad_result_code_t)m_code);
+    if (m_timed)
+    {
+        whad_generic_cmd_result_timed(this->getMessage(), (whad_result_code_t)m_code, &m_timing);
+    }
+    else
+    {
+        whad_generic_cmd_result(this->getMessage(), (whad_result_code_t)m_code);
+    }
 }
 
 
@@ -71,6 +148,8 @@ void CommandResult::unpack()
     {
         throw whad::WhadMessageParsingError();
     }
+
+    m_timed = (whad_generic_cmd_result_timing_parse(this->getMessage(), &m_timing) == WHAD_SUCCESS);
 }
 
 
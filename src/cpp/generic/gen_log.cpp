@@ -0,0 +1,72 @@
+#include <generic/log.hpp>
+
+using namespace whad::generic;
+
+
+/**
+ * @brief   Parse a binary log message.
+ *
+ * Entries are only available if the message has been decoded into an arena
+ * (see `whad_decode_message_arena()`).
+ *
+ * @param[in]   message     Underlying NanoPb message.
+ **/
+
+Log::Log(NanoPbMsg message) : GenericMsg(message)
+{
+    this->unpack();
+}
+
+
+/**
+ * @brief   Get the total number of log entries dropped by the device.
+ *
+ * @retval  Dropped entries
+ **/
+
+uint32_t Log::getDropped()
+{
+    return m_dropped;
+}
+
+
+/**
+ * @brief   Get the log entries.
+ *
+ * @retval  Log entries, to be expanded with the firmware format strings
+ **/
+
+std::vector<whad_log_entry_t> Log::getEntries()
+{
+    return m_entries;
+}
+
+
+/**
+ * @brief   Unpack parameters from message and load them into the corresponding
+ *          properties.
+ */
+
+void Log::unpack()
+{
+    whad_log_entry_t entry;
+    whad_result_t result;
+    uint8_t *p_entries;
+    int offset = 0;
+    int size;
+
+    if (whad_generic_log_message_parse(this->getMessage(), &m_dropped, &p_entries, &size) != WHAD_SUCCESS)
+    {
+        throw whad::WhadMessageParsingError();
+    }
+
+    while ((result = whad_log_next_entry(p_entries, size, &offset, &entry)) == WHAD_SUCCESS)
+    {
+        m_entries.push_back(entry);
+    }
+
+    if (result != WHAD_NONE)
+    {
+        throw whad::WhadMessageParsingError();
+    }
+}
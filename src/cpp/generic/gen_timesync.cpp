@@ -0,0 +1,199 @@
+#include <generic/timesync.hpp>
+
+using namespace whad::generic;
+
+
+/**
+ * @brief   Build a clock synchronization query.
+ *
+ * @param[in]   sequence    Query sequence number
+ * @param[in]   hostTime    Host time at which the query is sent
+ **/
+
+TimeSyncQuery::TimeSyncQuery(uint32_t sequence, uint64_t hostTime) : GenericMsg()
+{
+    m_sequence = sequence;
+    m_hostTime = hostTime;
+}
+
+
+/**
+ * @brief   Parse a clock synchronization query.
+ *
+ * @param[in]   message     Underlying NanoPb message.
+ **/
+
+TimeSyncQuery::TimeSyncQuery(NanoPbMsg message) : GenericMsg(message)
+{
+    this->unpack();
+}
+
+
+/**
+ * @brief   Get the query sequence number.
+ *
+ * @retval  Sequence number
+ **/
+
+uint32_t TimeSyncQuery::getSequence()
+{
+    return m_sequence;
+}
+
+
+/**
+ * @brief   Get the host time at which the query was sent.
+ *
+ * @retval  Host time
+ **/
+
+uint64_t TimeSyncQuery::getHostTime()
+{
+    return m_hostTime;
+}
+
+
+/**
+ * @brief   Pack all parameters into the corresponding NanoPb message using
+ *          C helper.
+ */
+
+void TimeSyncQuery::pack()
+{
+    whad_generic_time_sync_query(this->getMessage(), m_sequence, m_hostTime);
+}
+
+
+/**
+ * @brief   Unpack parameters from message and load them into the corresponding
+ *          properties.
+ */
+
+void TimeSyncQuery::unpack()
+{
+    if (whad_generic_time_sync_query_parse(this->getMessage(), &m_sequence, &m_hostTime) != WHAD_SUCCESS)
+    {
+        throw whad::WhadMessageParsingError();
+    }
+}
+
+
+/**
+ * @brief   Build a clock synchronization reply to a query.
+ *
+ * @param[in]   query       Query to answer
+ * @param[in]   rxTime      Device time at which the query was received, in us
+ * @param[in]   txTime      Device time at which the reply is queued, in us
+ **/
+
+TimeSyncReply::TimeSyncReply(TimeSyncQuery &query, uint64_t rxTime, uint64_t txTime) : GenericMsg()
+{
+    m_params.sequence = query.getSequence();
+    m_params.host_time = query.getHostTime();
+    m_params.rx_time = rxTime;
+    m_params.tx_time = txTime;
+}
+
+
+/**
+ * @brief   Build a clock synchronization reply.
+ *
+ * @param[in]   sequence    Query sequence number
+ * @param[in]   hostTime    Host time of the query
+ * @param[in]   rxTime      Device time at which the query was received, in us
+ * @param[in]   txTime      Device time at which the reply is queued, in us
+ **/
+
+TimeSyncReply::TimeSyncReply(uint32_t sequence, uint64_t hostTime, uint64_t rxTime, uint64_t txTime) : GenericMsg()
+{
+    m_params.sequence = sequence;
+    m_params.host_time = hostTime;
+    m_params.rx_time = rxTime;
+    m_params.tx_time = txTime;
+}
+
+
+/**
+ * @brief   Parse a clock synchronization reply.
+ *
+ * @param[in]   message     Underlying NanoPb message.
+ **/
+
+TimeSyncReply::TimeSyncReply(NanoPbMsg message) : GenericMsg(message)
+{
+    this->unpack();
+}
+
+
+/**
+ * @brief   Get the query sequence number.
+ *
+ * @retval  Sequence number
+ **/
+
+uint32_t TimeSyncReply::getSequence()
+{
+    return m_params.sequence;
+}
+
+
+/**
+ * @brief   Get the host time of the query.
+ *
+ * @retval  Host time
+ **/
+
+uint64_t TimeSyncReply::getHostTime()
+{
+    return m_params.host_time;
+}
+
+
+/**
+ * @brief   Get the device time at which the query was received.
+ *
+ * @retval  Device time in us
+ **/
+
+uint64_t TimeSyncReply::getRxTime()
+{
+    return m_params.rx_time;
+}
+
+
+/**
+ * @brief   Get the device time at which the reply was queued.
+ *
+ * @retval  Device time in us
+ **/
+
+uint64_t TimeSyncReply::getTxTime()
+{
+    return m_params.tx_time;
+}
+
+
+/**
+ * @brief   Pack all parameters into the corresponding NanoPb message using
+ *          C helper.
+ */
+
+void TimeSyncReply::pack()
+{
+    whad_generic_time_sync_reply(this->getMessage(), m_params.sequence, m_params.host_time, m_params.rx_time,
+                                 m_params.tx_time);
+}
+
+
+/**
+ * @brief   Unpack parameters from message and load them into the corresponding
+ *          properties.
+ */
+
+void TimeSyncReply::unpack()
+{
+    if (whad_generic_time_sync_reply_parse(this->getMessage(), &m_params) != WHAD_SUCCESS)
+    {
+        throw whad::WhadMessageParsingError();
+    }
+}
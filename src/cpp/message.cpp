@@ -1,14 +1,28 @@
-#include <cstdlib>
 #include "cpp/message.hpp"
 #include <whad.h>
 
+/*
+ * Messages built by the application are only packed into their NanoPb
+ * message by getRaw(), right before being sent, so they all share the same
+ * static storage instead of allocating a `Message` each. Constructors must
+ * therefore only store their parameters, any write to the NanoPb message
+ * belongs to pack().
+ */
+
+static Message g_txMessage;
+
+
 /**
  * @brief   Nanopb message wrapper constructor.
+ *
+ * The underlying NanoPb message is shared by all the messages built this
+ * way: the pointer returned by getRaw() remains valid until another message
+ * is packed.
  **/
 
 whad::NanoPbMsg::NanoPbMsg(void)
 {
-    this->p_nanopbMessage = (Message*)malloc(sizeof(Message));
+    this->p_nanopbMessage = &g_txMessage;
 }
 
 
@@ -24,12 +38,6 @@ whad::NanoPbMsg::NanoPbMsg(Message *message)
 
 whad::NanoPbMsg::~NanoPbMsg(void)
 {
-    #if 0
-    if (this->p_nanopbMessage != NULL)
-    {
-        free(this->p_nanopbMessage);
-    }
-    #endif
 }
 
 
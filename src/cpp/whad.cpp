@@ -2,8 +2,22 @@
 
 using namespace whad;
 
-void send(NanoPbMsg message)
+/**
+ * @brief   Pack a message and send it.
+ *
+ * The message is taken by reference so that its own pack() method is used.
+ *
+ * @param[in]   message     Message to send
+ **/
+
+void whad::send(NanoPbMsg &message)
 { 
     /* Send WHAD message. */
     whad_send_message(message.getRaw());
+}
+
+
+void whad::send(NanoPbMsg &&message)
+{
+    whad::send(message);
 }
\ No newline at end of file
@@ -63,6 +63,33 @@ bool whad_disc_enum_capabilities_cb(pb_ostream_t *ostream, const pb_field_t *fie
     return true;
 }
 
+static bool whad_disc_enum_domains_cb(pb_ostream_t *ostream, const pb_field_t *field, void * const *arg)
+{
+    whad_domain_desc_t *capabilities = *(whad_domain_desc_t **)arg;
+    discovery_DeviceDomainInfoResp domain_info;
+
+    if (ostream != NULL && field->tag == discovery_DeviceInfoResp_domains_tag)
+    {
+        /* Same domains as the capabilities field. */
+        while ((capabilities->cap != 0) && (capabilities->domain != 0))
+        {
+            domain_info.domain = capabilities->domain;
+            domain_info.supported_commands = capabilities->supported_commands;
+
+            if (!pb_encode_tag_for_field(ostream, field))
+                return false;
+
+            if (!pb_encode_submessage(ostream, discovery_DeviceDomainInfoResp_fields, &domain_info))
+                return false;
+
+            /* Go to next capability. */
+            capabilities++;
+        }
+    }
+
+    return true;
+}
+
 uint64_t whad_discovery_get_supported_commands(whad_domain_t domain, whad_domain_desc_t *p_capabilities) {
   uint64_t supportedCommands = 0x00000000;
   int index = 0;
@@ -77,6 +104,312 @@ uint64_t whad_discovery_get_supported_commands(whad_domain_t domain, whad_domain
 }
 
 
+/*****************************
+ * Capability index
+ ****************************/
+
+/**
+ * @brief Get the capability index slot of a domain.
+ * 
+ * @param[in]       domain              Domain
+ * 
+ * @return          Domain index, 0 (never used by a domain) if the domain is unknown
+ **/
+
+static uint32_t whad_cap_index_slot(whad_domain_t domain)
+{
+    uint32_t slot = WHAD_DOMAIN_INDEX(domain);
+
+    if ((((uint32_t)domain & ((1UL << WHAD_DOMAIN_INDEX_SHIFT) - 1)) != 0) || (slot >= WHAD_CAP_INDEX_DOMAINS))
+    {
+        return 0;
+    }
+
+    return slot;
+}
+
+
+/**
+ * @brief Initialize an empty capability index.
+ * 
+ * @param[in,out]   p_index             Pointer to the capability index to initialize
+ **/
+
+void whad_cap_index_init(whad_cap_index_t *p_index)
+{
+    /* Sanity check. */
+    if (p_index == NULL)
+    {
+        return;
+    }
+
+    memset(p_index, 0, sizeof(whad_cap_index_t));
+}
+
+
+/**
+ * @brief Build a capability index from a list of domain descriptions.
+ * 
+ * The index is built once, it then answers domain and command support queries
+ * in constant time instead of scanning the list.
+ * 
+ * @param[in,out]   p_index             Pointer to the capability index to build
+ * @param[in]       p_capabilities      Pointer to a `DOMAIN_NONE`-terminated list of domain descriptions
+ * 
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid pointer or unknown domain.
+ **/
+
+whad_result_t whad_cap_index_build(whad_cap_index_t *p_index, const whad_domain_desc_t *p_capabilities)
+{
+    uint32_t slot;
+
+    /* Sanity check. */
+    if ((p_index == NULL) || (p_capabilities == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    whad_cap_index_init(p_index);
+    while (p_capabilities->domain != DOMAIN_NONE)
+    {
+        slot = whad_cap_index_slot(p_capabilities->domain);
+        if (slot == 0)
+        {
+            return WHAD_ERROR;
+        }
+
+        p_index->domains |= (1UL << slot);
+        p_index->capabilities[slot] = (uint8_t)p_capabilities->cap;
+        p_index->commands[slot] = p_capabilities->supported_commands;
+        p_capabilities++;
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Add the domains of a device info response to a capability index.
+ * 
+ * Device info responses give the supported domains and their capabilities,
+ * supported commands are then added from the domain info responses (see
+ * `whad_cap_index_add_domain_info()`). Domains unknown to this library are
+ * ignored. The message must have been decoded with `whad_decode_message_arena()`.
+ * 
+ * @param[in,out]   p_index             Pointer to the capability index
+ * @param[in]       p_message           Pointer to a device info response
+ * 
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena.
+ **/
+
+whad_result_t whad_cap_index_add_device_info(whad_cap_index_t *p_index, Message *p_message)
+{
+    whad_result_t result;
+    uint32_t *p_capabilities;
+    uint32_t slot;
+    int count;
+    int i;
+
+    /* Sanity check. */
+    if (p_index == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    result = whad_discovery_device_info_resp_capabilities_parse(p_message, &p_capabilities, &count);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+
+    for (i=0; i<count; i++)
+    {
+        slot = whad_cap_index_slot((whad_domain_t)(p_capabilities[i] & ~((1UL << WHAD_DOMAIN_INDEX_SHIFT) - 1)));
+        if (slot != 0)
+        {
+            p_index->domains |= (1UL << slot);
+            p_index->capabilities[slot] = (uint8_t)p_capabilities[i];
+        }
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Add a device description to a capability index.
+ * 
+ * A device info response sent in reply to a describe query (see
+ * `whad_discovery_device_describe_query()`) also gives the supported commands
+ * of every domain: the index is then complete and no domain info query is
+ * needed. Firmware that does not support describe queries answers with a
+ * plain device info response, supported commands must then be added from
+ * domain info responses (see `whad_cap_index_add_domain_info()`).
+ * 
+ * @param[in,out]   p_index             Pointer to the capability index
+ * @param[in]       p_message           Pointer to a device info response, decoded into an arena
+ * 
+ * @retval          WHAD_SUCCESS        Success, index complete.
+ * @retval          WHAD_ERROR          Invalid pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena, or does not
+ *                                      describe the domains.
+ **/
+
+whad_result_t whad_cap_index_add_device_description(whad_cap_index_t *p_index, Message *p_message)
+{
+    discovery_DeviceDomainInfoResp *p_domains;
+    whad_result_t result;
+    uint32_t slot;
+    int count;
+    int i;
+
+    result = whad_cap_index_add_device_info(p_index, p_message);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+
+    result = whad_discovery_device_info_resp_domains_parse(p_message, &p_domains, &count);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+
+    /* Not described, domain info queries are required. */
+    if (count == 0)
+    {
+        return WHAD_NONE;
+    }
+
+    for (i=0; i<count; i++)
+    {
+        slot = whad_cap_index_slot((whad_domain_t)p_domains[i].domain);
+        if (slot != 0)
+        {
+            p_index->commands[slot] = p_domains[i].supported_commands;
+        }
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Add the supported commands of a domain info response to a capability index.
+ * 
+ * @param[in,out]   p_index             Pointer to the capability index
+ * @param[in]       p_message           Pointer to a domain info response
+ * 
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid pointer, wrong message type or unknown domain.
+ **/
+
+whad_result_t whad_cap_index_add_domain_info(whad_cap_index_t *p_index, Message *p_message)
+{
+    whad_domain_t domain;
+    uint64_t commands;
+    uint32_t slot;
+
+    /* Sanity check. */
+    if (p_index == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_discovery_domain_info_resp_parse(p_message, &domain, &commands) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    slot = whad_cap_index_slot(domain);
+    if (slot == 0)
+    {
+        return WHAD_ERROR;
+    }
+
+    p_index->domains |= (1UL << slot);
+    p_index->commands[slot] = commands;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Determine if a domain is supported.
+ * 
+ * @param[in]       p_index             Pointer to a capability index
+ * @param[in]       domain              Domain
+ * 
+ * @retval          true                Domain supported.
+ * @retval          false               Domain not supported.
+ **/
+
+bool whad_cap_index_is_domain_supported(const whad_cap_index_t *p_index, whad_domain_t domain)
+{
+    uint32_t slot = whad_cap_index_slot(domain);
+
+    return (p_index != NULL) && (slot != 0) && ((p_index->domains & (1UL << slot)) != 0);
+}
+
+
+/**
+ * @brief Determine if a domain command is supported.
+ * 
+ * @param[in]       p_index             Pointer to a capability index
+ * @param[in]       domain              Domain
+ * @param[in]       command             Domain command (e.g. `ble_BleCommand_SniffAdv`)
+ * 
+ * @retval          true                Command supported.
+ * @retval          false               Domain or command not supported.
+ **/
+
+bool whad_cap_index_is_command_supported(const whad_cap_index_t *p_index, whad_domain_t domain, uint32_t command)
+{
+    return (command < 64) && ((whad_cap_index_get_supported_commands(p_index, domain) & (1ULL << command)) != 0);
+}
+
+
+/**
+ * @brief Get the capabilities flags of a domain.
+ * 
+ * @param[in]       p_index             Pointer to a capability index
+ * @param[in]       domain              Domain
+ * 
+ * @return          Capabilities flags (`whad_capability_t`), 0 if the domain is not supported
+ **/
+
+uint8_t whad_cap_index_get_capabilities(const whad_cap_index_t *p_index, whad_domain_t domain)
+{
+    uint32_t slot = whad_cap_index_slot(domain);
+
+    return (p_index != NULL) ? p_index->capabilities[slot] : 0;
+}
+
+
+/**
+ * @brief Get the supported commands of a domain.
+ * 
+ * @param[in]       p_index             Pointer to a capability index
+ * @param[in]       domain              Domain
+ * 
+ * @return          Supported commands bitmask, 0 if the domain is not supported
+ **/
+
+uint64_t whad_cap_index_get_supported_commands(const whad_cap_index_t *p_index, whad_domain_t domain)
+{
+    uint32_t slot = whad_cap_index_slot(domain);
+
+    return (p_index != NULL) ? p_index->commands[slot] : 0;
+}
+
+
 /**
  * @brief Initialize a discovery device info query.
  * 
@@ -99,12 +432,44 @@ whad_result_t whad_discovery_device_info_query(Message *p_message, uint32_t prot
     p_message->which_msg = Message_discovery_tag;
     p_message->msg.discovery.which_msg = discovery_Message_info_query_tag;
     p_message->msg.discovery.msg.info_query.proto_ver = proto_version;
+    p_message->msg.discovery.msg.info_query.describe_all = false;
 
     /* Success. */
     return WHAD_SUCCESS;    
 }
 
 
+/**
+ * @brief Initialize a discovery device describe query.
+ * 
+ * A describe query is a device info query asking for the supported commands
+ * of every domain in the response, so that the host discovers the device in
+ * a single round trip. Firmware that does not support it ignores the request
+ * and answers with a plain device info response.
+ * 
+ * @param[in,out]   p_message           Pointer to the message structure to initialize
+ * @param[in]       proto_version       Version of the WHAD protocol supported by the sender
+ * 
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_discovery_device_describe_query(Message *p_message, uint32_t proto_version)
+{
+    /* Build a device info query. */
+    if (whad_discovery_device_info_query(p_message, proto_version) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Ask for every domain. */
+    p_message->msg.discovery.msg.info_query.describe_all = true;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
 /**
  * @brief Parse a discovery device info query.
  * 
@@ -140,6 +505,24 @@ whad_result_t whad_discovery_device_info_query_parse(Message *p_message, uint32_
 }
 
 
+/**
+ * @brief Determine if a device info query is a describe query.
+ * 
+ * @param[in]       p_message           Pointer to the message to check
+ * 
+ * @retval          true                Describe query, the response must describe every domain
+ *                                      (see `whad_discovery_device_info_resp_add_domains()`).
+ * @retval          false               Plain device info query, or not a device info query.
+ **/
+
+bool whad_discovery_device_info_query_is_describe(Message *p_message)
+{
+    return (p_message != NULL) && (p_message->which_msg == Message_discovery_tag) &&
+           (p_message->msg.discovery.which_msg == discovery_Message_info_query_tag) &&
+           p_message->msg.discovery.msg.info_query.describe_all;
+}
+
+
 /**
  * @brief Initialize a discovery device information response message.
  * 
@@ -210,12 +593,125 @@ whad_result_t whad_discovery_device_info_resp(
     strncpy((char *)p_message->msg.discovery.msg.info_resp.devid, (char *)devid, 15);
     p_message->msg.discovery.msg.info_resp.capabilities.arg = capabilities;
     p_message->msg.discovery.msg.info_resp.capabilities.funcs.encode = whad_disc_enum_capabilities_cb;
+    p_message->msg.discovery.msg.info_resp.domains.arg = NULL;
+    p_message->msg.discovery.msg.info_resp.domains.funcs.encode = NULL;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Add the supported commands of every domain to a device information response.
+ * 
+ * Answers a describe query (see `whad_discovery_device_info_query_is_describe()`),
+ * once the response has been built with `whad_discovery_device_info_resp()`.
+ * 
+ * @param[in,out]   p_message           Pointer to a device information response
+ * @param[in]       capabilities        Firmware capabilities, the same as given to
+ *                                      `whad_discovery_device_info_resp()`
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid pointer or wrong message type.
+ **/
+
+whad_result_t whad_discovery_device_info_resp_add_domains(Message *p_message, whad_domain_desc_t *capabilities)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (capabilities == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_discovery_get_message_type(p_message) != WHAD_DISCOVERY_DEVICE_INFO_RESP)
+    {
+        return WHAD_ERROR;
+    }
+
+    p_message->msg.discovery.msg.info_resp.domains.arg = capabilities;
+    p_message->msg.discovery.msg.info_resp.domains.funcs.encode = whad_disc_enum_domains_cb;
 
     /* Success. */
     return WHAD_SUCCESS;
 }
 
 
+/**
+ * @brief Parse the capabilities of a device info response.
+ * 
+ * Capabilities are only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remain valid until the arena is reset.
+ * Each capability combines a domain and its capabilities flags, as encoded by
+ * `whad_discovery_device_info_resp()`.
+ * 
+ * @param[in]       p_message           Pointer to the message to parse
+ * @param[out]      pp_capabilities     Pointer set to the capabilities array
+ * @param[out]      p_count             Pointer set to the number of capabilities
+ * 
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena.
+ **/
+
+whad_result_t whad_discovery_device_info_resp_capabilities_parse(Message *p_message, uint32_t **pp_capabilities,
+                                                                 int *p_count)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (pp_capabilities == NULL) || (p_count == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_message->which_msg == Message_discovery_tag)
+    {
+        if (p_message->msg.discovery.which_msg == discovery_Message_info_resp_tag)
+        {
+            return whad_arena_get_items(&p_message->msg.discovery.msg.info_resp.capabilities,
+                                        (void **)pp_capabilities, p_count);
+        }
+    }
+
+    /* Nope, that's not a Discovery device info response. */
+    return WHAD_ERROR;
+}
+
+
+/**
+ * @brief Parse the supported commands of every domain of a device info response.
+ * 
+ * Domains are only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remain valid until the arena is reset.
+ * A response to a plain device info query, or from a firmware that does not
+ * support describe queries, has no domains.
+ * 
+ * @param[in]       p_message           Pointer to the message to parse
+ * @param[out]      pp_domains          Pointer set to the domains array
+ * @param[out]      p_count             Pointer set to the number of domains, 0 if not described
+ * 
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena.
+ **/
+
+whad_result_t whad_discovery_device_info_resp_domains_parse(Message *p_message,
+                                                            discovery_DeviceDomainInfoResp **pp_domains,
+                                                            int *p_count)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (pp_domains == NULL) || (p_count == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_discovery_get_message_type(p_message) != WHAD_DISCOVERY_DEVICE_INFO_RESP)
+    {
+        return WHAD_ERROR;
+    }
+
+    return whad_arena_get_items(&p_message->msg.discovery.msg.info_resp.domains, (void **)pp_domains, p_count);
+}
+
+
 /**
  * @brief Initialize a discovery device info query.
  * 
@@ -459,4 +955,62 @@ whad_result_t whad_discovery_set_speed_parse(Message *p_message, uint32_t *p_spe
 
     /* Nope, that's not a Discovery Domain info query :( */
     return WHAD_ERROR;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Initialize a compact device ready response message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_discovery_ready_resp_compact(whad_compact_msg_t *p_message)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_discovery_tag;
+    p_message->which_submsg = discovery_Message_ready_resp_tag;
+    p_message->p_fields = discovery_DeviceReadyResp_fields;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact domain information response message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       domain              Domain to report
+ * @param[in]       p_capabilities      Pointer to the device capabilities
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_discovery_domain_info_resp_compact(whad_compact_msg_t *p_message, whad_domain_t domain, whad_domain_desc_t *p_capabilities)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_discovery_tag;
+    p_message->which_submsg = discovery_Message_domain_resp_tag;
+    p_message->p_fields = discovery_DeviceDomainInfoResp_fields;
+    p_message->msg.domain_resp.domain = (discovery_Domain)domain;
+    p_message->msg.domain_resp.supported_commands = whad_discovery_get_supported_commands(domain, p_capabilities);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
@@ -1,6 +1,8 @@
 #include <whad.h>
 #include <domains/ble.h>
 
+#if WHAD_ENABLE_BLE
+
 whad_ble_msgtype_t whad_ble_get_message_type(Message *p_message)
 {
     whad_ble_msgtype_t msg_type = WHAD_BLE_UNKNOWN;
@@ -913,10 +915,70 @@ whad_result_t whad_ble_set_adv_data(Message *p_message, uint8_t *p_adv_data, int
     return WHAD_SUCCESS;   
 }
 
+
+/**
+ * @brief Parse a message setting advertising and scan response data.
+ *
+ * Data are only available if the message has been decoded with
+ * `whad_decode_message_arena()`. They are copied into the provided buffers,
+ * truncated to 31 bytes.
+ *
+ * @param[in]       p_message               Pointer to the message structure to parse
+ * @param[out]      p_adv_data              Pointer to a 31-byte advertising data buffer
+ * @param[out]      p_adv_data_length       Pointer to the advertising data length
+ * @param[out]      p_scanrsp_data          Pointer to a 31-byte scan response data buffer
+ * @param[out]      p_scanrsp_data_length   Pointer to the scan response data length
+ *
+ * @retval          WHAD_SUCCESS            Success.
+ * @retval          WHAD_ERROR              Invalid message pointer or wrong message type.
+ * @retval          WHAD_NONE               Message has not been decoded into an arena.
+ **/
+
 whad_result_t whad_ble_set_adv_data_parse(Message *p_message, uint8_t *p_adv_data, int *p_adv_data_length, 
                                     uint8_t *p_scanrsp_data, int *p_scanrsp_data_length)
 {
-    return WHAD_ERROR;
+    whad_result_t result;
+    uint8_t *p_data;
+    int length;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_adv_data == NULL) || (p_adv_data_length == NULL) ||
+        (p_scanrsp_data == NULL) || (p_scanrsp_data_length == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_ble_get_message_type(p_message) != WHAD_BLE_SET_ADV_DATA)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Extract advertising data. */
+    result = whad_arena_get_items(&p_message->msg.ble.msg.set_adv_data.scan_data, (void **)&p_data, &length);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+    *p_adv_data_length = (length > 31) ? 31 : length;
+    if (*p_adv_data_length > 0)
+    {
+        memcpy(p_adv_data, p_data, *p_adv_data_length);
+    }
+
+    /* Extract scan response data. */
+    result = whad_arena_get_items(&p_message->msg.ble.msg.set_adv_data.scanrsp_data, (void **)&p_data, &length);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+    *p_scanrsp_data_length = (length > 31) ? 31 : length;
+    if (*p_scanrsp_data_length > 0)
+    {
+        memcpy(p_scanrsp_data, p_data, *p_scanrsp_data_length);
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
 }
 
 
@@ -1120,7 +1182,8 @@ whad_result_t whad_ble_send_raw_pdu(Message *p_message, whad_ble_direction_t dir
                                     uint32_t access_address, uint8_t *p_pdu, int length, uint32_t crc, bool encrypt)
 {
     /* Sanity check. */
-    if ((p_message == NULL) || (p_pdu == NULL))
+    if ((p_message == NULL) || (p_pdu == NULL) || (length < 0) ||
+        (length > (int)sizeof(((ble_SendRawPDUCmd *)0)->pdu.bytes)))
     {
         return WHAD_ERROR;
     }
@@ -1137,6 +1200,7 @@ whad_result_t whad_ble_send_raw_pdu(Message *p_message, whad_ble_direction_t dir
     p_message->msg.ble.msg.send_raw_pdu.encrypt = encrypt;
 
     /* Copy PDU in memory. */
+    p_message->msg.ble.msg.send_raw_pdu.pdu.size = length;
     memcpy(p_message->msg.ble.msg.send_raw_pdu.pdu.bytes, p_pdu, length);
 
     /* Success. */
@@ -1196,7 +1260,8 @@ whad_result_t whad_ble_send_pdu(Message *p_message, whad_ble_direction_t directi
                                 uint8_t *p_pdu, int length, bool encrypt)
 {
     /* Sanity check. */
-    if ((p_message == NULL) || (p_pdu == NULL))
+    if ((p_message == NULL) || (p_pdu == NULL) || (length < 0) ||
+        (length > (int)sizeof(((ble_SendPDUCmd *)0)->pdu.bytes)))
     {
         return WHAD_ERROR;
     }
@@ -1209,7 +1274,8 @@ whad_result_t whad_ble_send_pdu(Message *p_message, whad_ble_direction_t directi
     p_message->msg.ble.msg.send_pdu.encrypt = encrypt;
 
     /* Copy PDU in memory. */
-    memcpy(p_message->msg.ble.msg.send_raw_pdu.pdu.bytes, p_pdu, length);
+    p_message->msg.ble.msg.send_pdu.pdu.size = length;
+    memcpy(p_message->msg.ble.msg.send_pdu.pdu.bytes, p_pdu, length);
 
     /* Success. */
     return WHAD_SUCCESS;
@@ -2363,7 +2429,7 @@ whad_result_t whad_ble_adv_pdu(Message *p_message, whad_ble_advtype_t adv_type,
     memcpy(p_message->msg.ble.msg.adv_pdu.bd_address, p_bdaddr, 6);
 
     /* Copy advertising data. */
-    if ((adv_data_length > 0) && (adv_data_length < 31))
+    if ((adv_data_length > 0) && (adv_data_length <= 31))
     {
         p_message->msg.ble.msg.adv_pdu.adv_data.size = adv_data_length;
         memcpy(p_message->msg.ble.msg.adv_pdu.adv_data.bytes, p_adv_data, adv_data_length);
@@ -2639,4 +2705,599 @@ whad_result_t whad_ble_injected_parse(Message *p_message, whad_ble_injected_para
 
     /* Success. */
     return WHAD_SUCCESS;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Initialize a compact BLE synchronization notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       access_address      Connection access address
+ * @param[in]       crc_init            Connection CRC initial value
+ * @param[in]       hop_interval        Connection hop interval
+ * @param[in]       hop_increment       Connection hop increment
+ * @param[in]       p_channelmap        Pointer to the connection channel map (5 bytes)
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or channel map pointer.
+ **/
+
+whad_result_t whad_ble_synchronized_compact(whad_compact_msg_t *p_message, uint32_t access_address, uint32_t crc_init,
+                                            uint32_t hop_interval, uint32_t hop_increment, uint8_t *p_channelmap)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_channelmap == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_synchronized_tag;
+    p_message->p_fields = ble_Synchronized_fields;
+    p_message->msg.ble_synchronized.access_address = access_address;
+    p_message->msg.ble_synchronized.hop_interval = hop_interval;
+    p_message->msg.ble_synchronized.hop_increment = hop_increment;
+    p_message->msg.ble_synchronized.crc_init = crc_init;
+    memcpy(p_message->msg.ble_synchronized.channel_map, p_channelmap, 5);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact BLE desynchronization notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       access_address      Access address of the desynchronized connection
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_ble_desynchronized_compact(whad_compact_msg_t *p_message, uint32_t access_address)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_desynchronized_tag;
+    p_message->p_fields = ble_Desynchronized_fields;
+    p_message->msg.ble_desynchronized.access_address = access_address;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact BLE sequence triggered notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       id                  Identifier of the triggered sequence
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_ble_triggered_compact(whad_compact_msg_t *p_message, uint32_t id)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_triggered_tag;
+    p_message->p_fields = ble_Triggered_fields;
+    p_message->msg.ble_triggered.id = id;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact BLE hijacking notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       access_address      Access address of the hijacked connection
+ * @param[in]       success             Hijacking status
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_ble_hijacked_compact(whad_compact_msg_t *p_message, uint32_t access_address, bool success)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_hijacked_tag;
+    p_message->p_fields = ble_Hijacked_fields;
+    p_message->msg.ble_hijacked.access_address = access_address;
+    p_message->msg.ble_hijacked.success = success;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact BLE injection notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       access_address      Access address of the target connection
+ * @param[in]       attempts            Number of injection attempts
+ * @param[in]       success             Injection status
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_ble_injected_compact(whad_compact_msg_t *p_message, uint32_t access_address, uint32_t attempts, bool success)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_injected_tag;
+    p_message->p_fields = ble_Injected_fields;
+    p_message->msg.ble_injected.access_address = access_address;
+    p_message->msg.ble_injected.injection_attempts = attempts;
+    p_message->msg.ble_injected.success = success;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact BLE disconnection notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       conn_handle         Connection handle
+ * @param[in]       reason              Disconnection reason
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_ble_notify_disconnected_compact(whad_compact_msg_t *p_message, uint32_t conn_handle, uint32_t reason)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_disconnected_tag;
+    p_message->p_fields = ble_Disconnected_fields;
+    p_message->msg.ble_disconnected.conn_handle = conn_handle;
+    p_message->msg.ble_disconnected.reason = reason;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact message reporting an advertising PDU
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       adv_type            Advertisement type
+ * @param[in]       rssi                Received Signal Strength Indicator
+ * @param[in]       p_bdaddr            Pointer to the advertiser BD address (6 bytes)
+ * @param[in]       addr_type           Advertiser address type
+ * @param[in]       p_adv_data          Pointer to the advertising data
+ * @param[in]       adv_data_length     Advertising data size in bytes
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message, address or data pointer.
+ **/
+
+whad_result_t whad_ble_adv_pdu_compact(whad_compact_msg_t *p_message, whad_ble_advtype_t adv_type, int32_t rssi,
+                                       uint8_t *p_bdaddr, whad_ble_addrtype_t addr_type, uint8_t *p_adv_data,
+                                       int adv_data_length)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_bdaddr == NULL) || (p_adv_data == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_adv_pdu_tag;
+    p_message->p_fields = ble_AdvPduReceived_fields;
+    memset(&p_message->msg.ble_adv_pdu, 0, sizeof(ble_AdvPduReceived));
+    p_message->msg.ble_adv_pdu.addr_type = (ble_BleAddrType)addr_type;
+    p_message->msg.ble_adv_pdu.rssi = rssi;
+    p_message->msg.ble_adv_pdu.adv_type = (ble_BleAdvType)adv_type;
+
+    /* Copy BD address. */
+    memcpy(p_message->msg.ble_adv_pdu.bd_address, p_bdaddr, 6);
+
+    /* Copy advertising data. */
+    if ((adv_data_length > 0) && (adv_data_length <= 31))
+    {
+        p_message->msg.ble_adv_pdu.adv_data.size = adv_data_length;
+        memcpy(p_message->msg.ble_adv_pdu.adv_data.bytes, p_adv_data, adv_data_length);
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact message reporting a BLE raw PDU
+ *
+ * Same as `whad_ble_raw_pdu()`, except that the PDU is not copied: it is
+ * streamed from `p_pdu` when the message is encoded, so this buffer must
+ * remain valid until `whad_send_compact_message()` is called.
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       channel             Channel on which the PDU has been received
+ * @param[in]       rssi                Received Signal Strength Indicator, `BLE_RSSI_NONE` if not available
+ * @param[in]       conn_handle         Connection handle
+ * @param[in]       access_address      Access address
+ * @param[in]       p_pdu               Pointer to a byte array containing the PDU
+ * @param[in]       length              Length of the PDU, in bytes
+ * @param[in]       crc                 PDU CRC
+ * @param[in]       crc_validity        Set to true if CRC is valid, false otherwise
+ * @param[in]       timestamp           Timestamp at which the PDU has been received
+ * @param[in]       relative_timestamp  Timestamp relative to the connection event
+ * @param[in]       direction           Direction of the PDU
+ * @param[in]       processed           Set to true if the PDU has been processed
+ * @param[in]       decrypted           Set to true if the PDU has been decrypted
+ * @param[in]       use_timestamp       Set to true to include timestamps
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message or PDU pointer, or PDU too large.
+ **/
+
+whad_result_t whad_ble_raw_pdu_compact(whad_compact_msg_t *p_message, uint32_t channel, int32_t rssi,
+                                       uint32_t conn_handle, uint32_t access_address, uint8_t *p_pdu, int length,
+                                       uint32_t crc, bool crc_validity, uint32_t timestamp,
+                                       uint32_t relative_timestamp, whad_ble_direction_t direction, bool processed,
+                                       bool decrypted, bool use_timestamp)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_pdu == NULL) || (length < 0) ||
+        (length > (int)sizeof(((ble_RawPduReceived *)0)->pdu.bytes)))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_ble_tag;
+    p_message->which_submsg = ble_Message_raw_pdu_tag;
+    p_message->p_fields = whad_ble_raw_pdu_tx_fields;
+    memset(&p_message->msg.ble_raw_pdu, 0, sizeof(whad_ble_raw_pdu_tx_t));
+    p_message->msg.ble_raw_pdu.channel = channel;
+    p_message->msg.ble_raw_pdu.access_address = access_address;
+    p_message->msg.ble_raw_pdu.conn_handle = conn_handle;
+    p_message->msg.ble_raw_pdu.direction = (ble_BleDirection)direction;
+
+    /* Reference PDU. */
+    p_message->msg.ble_raw_pdu.pdu.p_bytes = p_pdu;
+    p_message->msg.ble_raw_pdu.pdu.size = length;
+
+    /* Insert timestamps if set. */
+    if (use_timestamp)
+    {
+        p_message->msg.ble_raw_pdu.has_timestamp = true;
+        p_message->msg.ble_raw_pdu.timestamp = timestamp;
+        p_message->msg.ble_raw_pdu.has_relative_timestamp = true;
+        p_message->msg.ble_raw_pdu.relative_timestamp = relative_timestamp;
+    }
+
+    /* CRC */
+    p_message->msg.ble_raw_pdu.crc = crc;
+    p_message->msg.ble_raw_pdu.has_crc_validity = true;
+    p_message->msg.ble_raw_pdu.crc_validity = crc_validity;
+
+    /* RSSI */
+    if (rssi != BLE_RSSI_NONE)
+    {
+        p_message->msg.ble_raw_pdu.has_rssi = true;
+        p_message->msg.ble_raw_pdu.rssi = rssi;
+    }
+
+    /* Processed / decrypted. */
+    p_message->msg.ble_raw_pdu.processed = processed;
+    p_message->msg.ble_raw_pdu.decrypted = decrypted;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a template reporting BLE raw PDUs
+ *
+ * The connection handle, access address, direction and processing flags are
+ * encoded once, channel, RSSI, CRC, CRC validity and timestamps (if enabled)
+ * are patched for each PDU by `whad_ble_raw_pdu_template_send()`. RSSI is
+ * always included.
+ *
+ * @param[in,out]   p_template          Pointer to the template to initialize
+ * @param[in]       conn_handle         Connection handle
+ * @param[in]       access_address      Connection access address
+ * @param[in]       direction           Direction of the PDUs
+ * @param[in]       processed           Set to true if PDUs are processed by the device, false otherwise
+ * @param[in]       decrypted           Set to true if PDUs are decrypted, false otherwise
+ * @param[in]       use_timestamp       Set to true to include timestamp and relative timestamp
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template pointer.
+ **/
+
+whad_result_t whad_ble_raw_pdu_template(whad_template_t *p_template, uint32_t conn_handle, uint32_t access_address,
+                                        whad_ble_direction_t direction, bool processed, bool decrypted, bool use_timestamp)
+{
+    ble_RawPduReceived constants = ble_RawPduReceived_init_zero;
+
+    /* Constant fields. */
+    constants.conn_handle = conn_handle;
+    constants.access_address = access_address;
+    constants.direction = (ble_BleDirection)direction;
+    constants.processed = processed;
+    constants.decrypted = decrypted;
+
+    if (whad_template_init(p_template, Message_ble_tag, ble_Message_raw_pdu_tag,
+                           ble_RawPduReceived_fields, &constants) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Changing fields. */
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CHANNEL, ble_RawPduReceived_channel_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_RSSI, ble_RawPduReceived_rssi_tag, WHAD_TEMPLATE_INT32_WIDTH);
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CRC, ble_RawPduReceived_crc_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CRC_VALIDITY, ble_RawPduReceived_crc_validity_tag, WHAD_TEMPLATE_BOOL_WIDTH);
+    if (use_timestamp)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_TIMESTAMP, ble_RawPduReceived_timestamp_tag, WHAD_TEMPLATE_UINT64_WIDTH);
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_RELATIVE_TIMESTAMP, ble_RawPduReceived_relative_timestamp_tag,
+                               WHAD_TEMPLATE_UINT64_WIDTH);
+    }
+
+    /* PDU. */
+    return whad_template_set_payload(p_template, ble_RawPduReceived_pdu_tag,
+                                     sizeof(((ble_RawPduReceived *)0)->pdu.bytes));
+}
+
+
+/**
+ * @brief Send a BLE raw PDU based on a template
+ *
+ * @param[in,out]   p_template          Pointer to a template initialized by `whad_ble_raw_pdu_template()`
+ * @param[in]       channel             Channel on which the PDU has been captured
+ * @param[in]       rssi                Received Signal Strength Indicator in dBm
+ * @param[in]       p_pdu               Pointer to a byte array containing the PDU
+ * @param[in]       length              Length of the PDU, in bytes
+ * @param[in]       crc                 PDU CRC
+ * @param[in]       crc_validity        Set to true if CRC is valid, false otherwise
+ * @param[in]       timestamp           Timestamp at which the PDU has been captured
+ * @param[in]       relative_timestamp  Relative timestamp
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or PDU pointer, or PDU too large.
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer.
+ **/
+
+whad_result_t whad_ble_raw_pdu_template_send(whad_template_t *p_template, uint32_t channel, int32_t rssi,
+                                             uint8_t *p_pdu, int length, uint32_t crc, bool crc_validity,
+                                             uint32_t timestamp, uint32_t relative_timestamp)
+{
+    /* Sanity check. */
+    if (p_template == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Patch fields. */
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_CHANNEL, channel);
+    whad_template_set_int32(p_template, WHAD_TEMPLATE_RSSI, rssi);
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_CRC, crc);
+    whad_template_set_bool(p_template, WHAD_TEMPLATE_CRC_VALIDITY, crc_validity);
+    whad_template_set_uint64(p_template, WHAD_TEMPLATE_TIMESTAMP, timestamp);
+    whad_template_set_uint64(p_template, WHAD_TEMPLATE_RELATIVE_TIMESTAMP, relative_timestamp);
+
+    /* Send PDU. */
+    return whad_template_send(p_template, p_pdu, length);
+}
+
+
+/**
+ * @brief Fast-path decoding of a SendRawPDUCmd message
+ *
+ * Extracts the command parameters straight from a serialized message, as
+ * returned by `whad_get_raw_message()`, without calling NanoPb. The PDU
+ * pointer refers to the serialized message buffer.
+ *
+ * @param[in]       p_message           Pointer to a serialized message
+ * @param[in]       size                Serialized message size in bytes
+ * @param[in,out]   p_parameters        Pointer to a `whad_ble_pdu_params_t` structure
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_NONE           Not a SendRawPDUCmd message (or unusual encoding), use `whad_decode_message()`.
+ * @retval          WHAD_ERROR          Invalid pointer.
+ **/
+
+whad_result_t whad_ble_send_raw_pdu_fast_parse(uint8_t *p_message, int size, whad_ble_pdu_params_t *p_parameters)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag, direction = 0;
+    bool valid;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_parameters == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Recognize message by its leading tags. */
+    if (!whad_wire_get_submessage(&reader, p_message, size, Message_ble_tag, ble_Message_send_raw_pdu_tag))
+    {
+        return WHAD_NONE;
+    }
+
+    /* Missing fields are set to their default value. */
+    memset(p_parameters, 0, sizeof(whad_ble_pdu_params_t));
+
+    /* Extract raw PDU information. */
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type))
+        {
+            return WHAD_NONE;
+        }
+
+        switch (tag)
+        {
+            case ble_SendRawPDUCmd_direction_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &direction);
+                break;
+
+            case ble_SendRawPDUCmd_conn_handle_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_parameters->conn_handle);
+                break;
+
+            case ble_SendRawPDUCmd_access_address_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_parameters->access_address);
+                break;
+
+            case ble_SendRawPDUCmd_pdu_tag:
+                valid = whad_wire_get_bytes(&reader, wire_type, &p_parameters->p_pdu, &p_parameters->length) &&
+                        (p_parameters->length <= (int)sizeof(((ble_SendRawPDUCmd *)0)->pdu.bytes));
+                break;
+
+            case ble_SendRawPDUCmd_crc_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_parameters->crc);
+                break;
+
+            case ble_SendRawPDUCmd_encrypt_tag:
+                valid = whad_wire_get_bool(&reader, wire_type, &p_parameters->encrypt);
+                break;
+
+            default:
+                valid = whad_wire_skip_field(&reader, wire_type);
+                break;
+        }
+
+        if (!valid)
+        {
+            return WHAD_NONE;
+        }
+    }
+    p_parameters->direction = (whad_ble_direction_t)direction;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Fast-path decoding of a SendPDUCmd message
+ *
+ * Extracts the command parameters straight from a serialized message, as
+ * returned by `whad_get_raw_message()`, without calling NanoPb. The PDU
+ * pointer refers to the serialized message buffer.
+ *
+ * @param[in]       p_message           Pointer to a serialized message
+ * @param[in]       size                Serialized message size in bytes
+ * @param[in,out]   p_parameters        Pointer to a `whad_ble_pdu_params_t` structure
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_NONE           Not a SendPDUCmd message (or unusual encoding), use `whad_decode_message()`.
+ * @retval          WHAD_ERROR          Invalid pointer.
+ **/
+
+whad_result_t whad_ble_send_pdu_fast_parse(uint8_t *p_message, int size, whad_ble_pdu_params_t *p_parameters)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag, direction = 0;
+    bool valid;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_parameters == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Recognize message by its leading tags. */
+    if (!whad_wire_get_submessage(&reader, p_message, size, Message_ble_tag, ble_Message_send_pdu_tag))
+    {
+        return WHAD_NONE;
+    }
+
+    /* Missing fields are set to their default value. */
+    memset(p_parameters, 0, sizeof(whad_ble_pdu_params_t));
+
+    /* Extract information. */
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type))
+        {
+            return WHAD_NONE;
+        }
+
+        switch (tag)
+        {
+            case ble_SendPDUCmd_direction_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &direction);
+                break;
+
+            case ble_SendPDUCmd_conn_handle_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_parameters->conn_handle);
+                break;
+
+            case ble_SendPDUCmd_pdu_tag:
+                valid = whad_wire_get_bytes(&reader, wire_type, &p_parameters->p_pdu, &p_parameters->length) &&
+                        (p_parameters->length <= (int)sizeof(((ble_SendPDUCmd *)0)->pdu.bytes));
+                break;
+
+            case ble_SendPDUCmd_encrypt_tag:
+                valid = whad_wire_get_bool(&reader, wire_type, &p_parameters->encrypt);
+                break;
+
+            default:
+                valid = whad_wire_skip_field(&reader, wire_type);
+                break;
+        }
+
+        if (!valid)
+        {
+            return WHAD_NONE;
+        }
+    }
+    p_parameters->direction = (whad_ble_direction_t)direction;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+#endif /* WHAD_ENABLE_BLE */
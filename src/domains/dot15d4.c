@@ -1,6 +1,8 @@
 #include <whad.h>
 #include <domains/dot15d4.h>
 
+#if WHAD_ENABLE_DOT15D4
+
 whad_dot15d4_msgtype_t whad_dot15d4_get_message_type(Message *p_message)
 {
     whad_dot15d4_msgtype_t msg_type = WHAD_DOT15D4_UNKNOWN;
@@ -340,15 +342,16 @@ whad_result_t whad_dot15d4_send_raw(Message *p_message, uint32_t channel, uint8_
     }
 
     p_message->which_msg = Message_dot15d4_tag;
-    p_message->msg.dot15d4.which_msg = dot15d4_Message_send_tag;
+    p_message->msg.dot15d4.which_msg = dot15d4_Message_send_raw_tag;
 
-    p_message->msg.dot15d4.msg.send.channel = channel;
+    p_message->msg.dot15d4.msg.send_raw.channel = channel;
+    p_message->msg.dot15d4.msg.send_raw.fcs = fcs;
 
     if ((length >= 0) && (length <= 255))
     {
         /* Copy packet into our message structure. */
-        p_message->msg.dot15d4.msg.send.pdu.size = length;
-        memcpy(p_message->msg.dot15d4.msg.send.pdu.bytes, p_packet, length);
+        p_message->msg.dot15d4.msg.send_raw.pdu.size = length;
+        memcpy(p_message->msg.dot15d4.msg.send_raw.pdu.bytes, p_packet, length);
 
         /* Success. */
         return WHAD_SUCCESS;
@@ -1032,4 +1035,280 @@ whad_result_t whad_dot15d4_pdu_received_parse(Message *p_message, whad_dot15d4_r
 
     /* Success. */
     return WHAD_SUCCESS;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Initialize a compact 802.15.4 jammed notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       timestamp           Timestamp at which the target has been jammed
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_dot15d4_jammed_compact(whad_compact_msg_t *p_message, uint32_t timestamp)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_dot15d4_tag;
+    p_message->which_submsg = dot15d4_Message_jammed_tag;
+    p_message->p_fields = dot15d4_Jammed_fields;
+    p_message->msg.dot15d4_jammed.timestamp = timestamp;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact 802.15.4 energy detection sample notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       timestamp           Sample timestamp
+ * @param[in]       sample              Energy detection sample value
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_dot15d4_energy_detect_sample_compact(whad_compact_msg_t *p_message, uint32_t timestamp, uint32_t sample)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_dot15d4_tag;
+    p_message->which_submsg = dot15d4_Message_ed_sample_tag;
+    p_message->p_fields = dot15d4_EnergyDetectionSample_fields;
+    p_message->msg.dot15d4_ed_sample.timestamp = timestamp;
+    p_message->msg.dot15d4_ed_sample.sample = sample;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Initialize a compact message reporting a 802.15.4 PDU
+ *
+ * Same as `whad_dot15d4_pdu_received()`, except that the PDU is not copied:
+ * it is streamed from `p_packet->packet` when the message is encoded, so this
+ * structure must remain valid until `whad_send_compact_message()` is called.
+ *
+ * @param[in,out]   p_message   Pointer to a compact message structure
+ * @param[in]       p_packet    Pointer to a `whad_dot15d4_recvd_packet_t` structure
+ *
+ * @retval      WHAD_SUCCESS        Success.
+ * @retval      WHAD_ERROR          Invalid message or packet pointer, or packet too large.
+ **/
+
+whad_result_t whad_dot15d4_pdu_received_compact(whad_compact_msg_t *p_message, whad_dot15d4_recvd_packet_t *p_packet)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_packet == NULL) || (p_packet->packet.length < 0) ||
+        (p_packet->packet.length > (int)sizeof(((dot15d4_PduReceived *)0)->pdu.bytes)))
+    {
+        /* Error. */
+        return WHAD_ERROR;
+    }
+
+    /* Set message properties. */
+    p_message->which_msg = Message_dot15d4_tag;
+    p_message->which_submsg = dot15d4_Message_pdu_tag;
+    p_message->p_fields = whad_dot15d4_pdu_tx_fields;
+    memset(&p_message->msg.dot15d4_pdu, 0, sizeof(whad_dot15d4_pdu_tx_t));
+    p_message->msg.dot15d4_pdu.channel = p_packet->channel;
+    p_message->msg.dot15d4_pdu.pdu.p_bytes = p_packet->packet.bytes;
+    p_message->msg.dot15d4_pdu.pdu.size = p_packet->packet.length;
+
+    /* Set message optional properties. */
+    p_message->msg.dot15d4_pdu.has_rssi = p_packet->has_rssi;
+    p_message->msg.dot15d4_pdu.rssi = p_packet->rssi;
+    p_message->msg.dot15d4_pdu.has_timestamp = p_packet->has_timestamp;
+    p_message->msg.dot15d4_pdu.timestamp = p_packet->timestamp;
+    p_message->msg.dot15d4_pdu.has_fcs_validity = p_packet->has_fcs_validity;
+    p_message->msg.dot15d4_pdu.fcs_validity = p_packet->fcs_validity;
+    p_message->msg.dot15d4_pdu.has_lqi = p_packet->has_lqi;
+    p_message->msg.dot15d4_pdu.lqi = p_packet->lqi;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a template reporting 802.15.4 raw PDUs
+ *
+ * Optional fields are included in the template according to the `has_*`
+ * flags of the model packet. Changing fields are then patched for each
+ * PDU by `whad_dot15d4_raw_pdu_template_send()`.
+ *
+ * @param[in,out]   p_template          Pointer to the template to initialize
+ * @param[in]       p_model             Pointer to a model packet
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or model pointer.
+ **/
+
+whad_result_t whad_dot15d4_raw_pdu_template(whad_template_t *p_template, whad_dot15d4_recvd_packet_t *p_model)
+{
+    dot15d4_RawPduReceived constants = dot15d4_RawPduReceived_init_zero;
+
+    /* Sanity check. */
+    if (p_model == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_template_init(p_template, Message_dot15d4_tag, dot15d4_Message_raw_pdu_tag,
+                           dot15d4_RawPduReceived_fields, &constants) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Changing fields. */
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CHANNEL, dot15d4_RawPduReceived_channel_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CRC, dot15d4_RawPduReceived_fcs_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    if (p_model->has_rssi)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_RSSI, dot15d4_RawPduReceived_rssi_tag, WHAD_TEMPLATE_INT32_WIDTH);
+    }
+    if (p_model->has_timestamp)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_TIMESTAMP, dot15d4_RawPduReceived_timestamp_tag, WHAD_TEMPLATE_UINT64_WIDTH);
+    }
+    if (p_model->has_fcs_validity)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_CRC_VALIDITY, dot15d4_RawPduReceived_fcs_validity_tag, WHAD_TEMPLATE_BOOL_WIDTH);
+    }
+    if (p_model->has_lqi)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_LQI, dot15d4_RawPduReceived_lqi_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    }
+
+
+    /* PDU. */
+    return whad_template_set_payload(p_template, dot15d4_RawPduReceived_pdu_tag,
+                                     sizeof(((dot15d4_RawPduReceived *)0)->pdu.bytes));
+}
+
+
+/**
+ * @brief Send a 802.15.4 raw PDU based on a template
+ *
+ * @param[in,out]   p_template          Pointer to a template initialized by `whad_dot15d4_raw_pdu_template()`
+ * @param[in]       p_pdu               Pointer to the received PDU
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or PDU pointer, or PDU too large.
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer.
+ **/
+
+whad_result_t whad_dot15d4_raw_pdu_template_send(whad_template_t *p_template, whad_dot15d4_recvd_packet_t *p_pdu)
+{
+    /* Sanity check. */
+    if ((p_template == NULL) || (p_pdu == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Patch fields. */
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_CHANNEL, p_pdu->channel);
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_CRC, p_pdu->fcs);
+    whad_template_set_int32(p_template, WHAD_TEMPLATE_RSSI, p_pdu->rssi);
+    whad_template_set_uint64(p_template, WHAD_TEMPLATE_TIMESTAMP, p_pdu->timestamp);
+    whad_template_set_bool(p_template, WHAD_TEMPLATE_CRC_VALIDITY, p_pdu->fcs_validity);
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_LQI, p_pdu->lqi);
+
+
+    /* Send PDU. */
+    return whad_template_send(p_template, p_pdu->packet.bytes, p_pdu->packet.length);
+}
+
+
+/**
+ * @brief   Fast-path decoding of a SendRawCmd message
+ *
+ * Extracts the command parameters straight from a serialized message, as
+ * returned by `whad_get_raw_message()`, without calling NanoPb. The PDU
+ * pointer refers to the serialized message buffer.
+ *
+ * @param[in]       p_message   Pointer to a serialized message
+ * @param[in]       size        Serialized message size in bytes
+ * @param[in,out]   p_params    Pointer to a `whad_dot15d4_send_fast_params_t` structure
+ *
+ * @retval      WHAD_SUCCESS        Success.
+ * @retval      WHAD_NONE           Not a SendRawCmd message (or unusual encoding), use `whad_decode_message()`.
+ * @retval      WHAD_ERROR          Invalid pointer.
+ **/
+
+whad_result_t whad_dot15d4_send_raw_fast_parse(uint8_t *p_message, int size, whad_dot15d4_send_fast_params_t *p_params)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag;
+    bool valid;
+
+    /* Sanity checks. */
+    if ((p_message == NULL) || (p_params == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Recognize message by its leading tags. */
+    if (!whad_wire_get_submessage(&reader, p_message, size, Message_dot15d4_tag, dot15d4_Message_send_raw_tag))
+    {
+        return WHAD_NONE;
+    }
+
+    /* Missing fields are set to their default value. */
+    memset(p_params, 0, sizeof(whad_dot15d4_send_fast_params_t));
+
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type))
+        {
+            return WHAD_NONE;
+        }
+
+        switch (tag)
+        {
+            case dot15d4_SendRawCmd_channel_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_params->channel);
+                break;
+
+            case dot15d4_SendRawCmd_pdu_tag:
+                valid = whad_wire_get_bytes(&reader, wire_type, &p_params->p_pdu, &p_params->length) &&
+                        (p_params->length <= DOT15D4_PACKET_MAX_SIZE);
+                break;
+
+            case dot15d4_SendRawCmd_fcs_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_params->fcs);
+                break;
+
+            default:
+                valid = whad_wire_skip_field(&reader, wire_type);
+                break;
+        }
+
+        if (!valid)
+        {
+            return WHAD_NONE;
+        }
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+#endif /* WHAD_ENABLE_DOT15D4 */
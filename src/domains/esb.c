@@ -1,6 +1,8 @@
 #include <whad.h>
 #include <domains/esb.h>
 
+#if WHAD_ENABLE_ESB
+
 whad_esb_msgtype_t whad_esb_get_message_type(Message *p_message)
 {
     whad_esb_msgtype_t msg_type = WHAD_ESB_UNKNOWN;
@@ -838,4 +840,267 @@ whad_result_t whad_esb_pdu_received_parse(Message *p_message, whad_esb_recvd_pac
 
     /* Success. */
     return WHAD_SUCCESS;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Initialize a compact ESB jammed notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       timestamp           Timestamp at which the target has been jammed
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_esb_jammed_compact(whad_compact_msg_t *p_message, uint32_t timestamp)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_esb_tag;
+    p_message->which_submsg = esb_Message_jammed_tag;
+    p_message->p_fields = esb_Jammed_fields;
+    p_message->msg.esb_jammed.timestamp = timestamp;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Initialize a compact message reporting an ESB raw PDU
+ *
+ * Same as `whad_esb_raw_pdu_received()`, except that the PDU is not copied:
+ * it is streamed from `p_pdu->packet` when the message is encoded, so this
+ * structure must remain valid until `whad_send_compact_message()` is called.
+ *
+ * @param[in,out]   p_message   Pointer to a compact message structure
+ * @param[in]       p_pdu       Pointer to a `whad_esb_recvd_packet_t` structure
+ *
+ * @retval      WHAD_SUCCESS        Success.
+ * @retval      WHAD_ERROR          Invalid message or packet pointer, or wrong address size.
+ **/
+
+whad_result_t whad_esb_raw_pdu_received_compact(whad_compact_msg_t *p_message, whad_esb_recvd_packet_t *p_pdu)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_pdu == NULL))
+    {
+        /* Error. */
+        return WHAD_ERROR;
+    }
+
+    /* Set message properties. */
+    p_message->which_msg = Message_esb_tag;
+    p_message->which_submsg = esb_Message_raw_pdu_tag;
+    p_message->p_fields = whad_esb_raw_pdu_tx_fields;
+    memset(&p_message->msg.esb_raw_pdu, 0, sizeof(whad_esb_raw_pdu_tx_t));
+    p_message->msg.esb_raw_pdu.channel = p_pdu->channel;
+    p_message->msg.esb_raw_pdu.pdu.p_bytes = p_pdu->packet.bytes;
+    p_message->msg.esb_raw_pdu.pdu.size = p_pdu->packet.length;
+
+    /* Set message optional properties. */
+    p_message->msg.esb_raw_pdu.has_rssi = p_pdu->has_rssi;
+    p_message->msg.esb_raw_pdu.rssi = p_pdu->rssi;
+    p_message->msg.esb_raw_pdu.has_timestamp = p_pdu->has_timestamp;
+    p_message->msg.esb_raw_pdu.timestamp = p_pdu->timestamp;
+    p_message->msg.esb_raw_pdu.has_crc_validity = p_pdu->has_crc_validity;
+    p_message->msg.esb_raw_pdu.crc_validity = p_pdu->crc_validity;
+
+    if (p_pdu->has_address)
+    {
+        if ((p_pdu->address.size < 0) || (p_pdu->address.size > ESB_ADDR_MAX_SIZE))
+        {
+            /* Error, wrong address size. */
+            return WHAD_ERROR;
+        }
+
+        p_message->msg.esb_raw_pdu.has_address = true;
+        p_message->msg.esb_raw_pdu.address.size = p_pdu->address.size;
+        memcpy(p_message->msg.esb_raw_pdu.address.bytes, p_pdu->address.address, p_pdu->address.size);
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a template reporting ESB raw PDUs
+ *
+ * Optional fields are included in the template according to the `has_*`
+ * flags of the model packet, and its address is encoded once. Changing fields are then patched for each
+ * PDU by `whad_esb_raw_pdu_template_send()`.
+ *
+ * @param[in,out]   p_template          Pointer to the template to initialize
+ * @param[in]       p_model             Pointer to a model packet
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or model pointer.
+ **/
+
+whad_result_t whad_esb_raw_pdu_template(whad_template_t *p_template, whad_esb_recvd_packet_t *p_model)
+{
+    esb_RawPduReceived constants = esb_RawPduReceived_init_zero;
+
+    /* Sanity check. */
+    if (p_model == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Constant fields. */
+    if (p_model->has_address)
+    {
+        if (p_model->address.size > (int)sizeof(constants.address.bytes))
+        {
+            /* Error, wrong address size. */
+            return WHAD_ERROR;
+        }
+
+        constants.has_address = true;
+        constants.address.size = p_model->address.size;
+        memcpy(constants.address.bytes, p_model->address.address, p_model->address.size);
+    }
+
+    if (whad_template_init(p_template, Message_esb_tag, esb_Message_raw_pdu_tag,
+                           esb_RawPduReceived_fields, &constants) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Changing fields. */
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CHANNEL, esb_RawPduReceived_channel_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    if (p_model->has_rssi)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_RSSI, esb_RawPduReceived_rssi_tag, WHAD_TEMPLATE_INT32_WIDTH);
+    }
+    if (p_model->has_timestamp)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_TIMESTAMP, esb_RawPduReceived_timestamp_tag, WHAD_TEMPLATE_UINT64_WIDTH);
+    }
+    if (p_model->has_crc_validity)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_CRC_VALIDITY, esb_RawPduReceived_crc_validity_tag, WHAD_TEMPLATE_BOOL_WIDTH);
+    }
+
+
+    /* PDU. */
+    return whad_template_set_payload(p_template, esb_RawPduReceived_pdu_tag,
+                                     sizeof(((esb_RawPduReceived *)0)->pdu.bytes));
+}
+
+
+/**
+ * @brief Send a ESB raw PDU based on a template
+ *
+ * @param[in,out]   p_template          Pointer to a template initialized by `whad_esb_raw_pdu_template()`
+ * @param[in]       p_pdu               Pointer to the received PDU
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or PDU pointer, or PDU too large.
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer.
+ **/
+
+whad_result_t whad_esb_raw_pdu_template_send(whad_template_t *p_template, whad_esb_recvd_packet_t *p_pdu)
+{
+    /* Sanity check. */
+    if ((p_template == NULL) || (p_pdu == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Patch fields. */
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_CHANNEL, p_pdu->channel);
+    whad_template_set_int32(p_template, WHAD_TEMPLATE_RSSI, p_pdu->rssi);
+    whad_template_set_uint64(p_template, WHAD_TEMPLATE_TIMESTAMP, p_pdu->timestamp);
+    whad_template_set_bool(p_template, WHAD_TEMPLATE_CRC_VALIDITY, p_pdu->crc_validity);
+
+
+    /* Send PDU. */
+    return whad_template_send(p_template, p_pdu->packet.bytes, p_pdu->packet.length);
+}
+
+
+/**
+ * @brief Fast-path decoding of a SendCmd message
+ *
+ * Extracts the command parameters straight from a serialized message, as
+ * returned by `whad_get_raw_message()`, without calling NanoPb. The PDU
+ * pointer refers to the serialized message buffer.
+ *
+ * @param[in]       p_message   Pointer to a serialized message
+ * @param[in]       size        Serialized message size in bytes
+ * @param[in,out]   p_params    Pointer to a `whad_esb_send_fast_params_t` structure
+ *
+ * @retval      WHAD_SUCCESS        Success.
+ * @retval      WHAD_NONE           Not a SendCmd message (or unusual encoding), use `whad_decode_message()`.
+ * @retval      WHAD_ERROR          Invalid pointer.
+ **/
+
+whad_result_t whad_esb_send_fast_parse(uint8_t *p_message, int size, whad_esb_send_fast_params_t *p_params)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag;
+    bool valid;
+
+    /* Sanity checks. */
+    if ((p_message == NULL) || (p_params == NULL))
+    {
+        /* Error. */
+        return WHAD_ERROR;
+    }
+
+    /* Recognize message by its leading tags. */
+    if (!whad_wire_get_submessage(&reader, p_message, size, Message_esb_tag, esb_Message_send_tag))
+    {
+        return WHAD_NONE;
+    }
+
+    /* Missing fields are set to their default value. */
+    memset(p_params, 0, sizeof(whad_esb_send_fast_params_t));
+
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type))
+        {
+            return WHAD_NONE;
+        }
+
+        switch (tag)
+        {
+            case esb_SendCmd_channel_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_params->channel);
+                break;
+
+            case esb_SendCmd_retransmission_count_tag:
+                valid = whad_wire_get_uint32(&reader, wire_type, &p_params->retr_count);
+                break;
+
+            case esb_SendCmd_pdu_tag:
+                valid = whad_wire_get_bytes(&reader, wire_type, &p_params->p_pdu, &p_params->length) &&
+                        (p_params->length <= ESB_PACKET_MAX_SIZE);
+                break;
+
+            default:
+                valid = whad_wire_skip_field(&reader, wire_type);
+                break;
+        }
+
+        if (!valid)
+        {
+            return WHAD_NONE;
+        }
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+#endif /* WHAD_ENABLE_ESB */
@@ -1,9 +1,11 @@
 #include <whad.h>
 #include <domains/phy.h>
 
+#if WHAD_ENABLE_PHY
+
 whad_phy_msgtype_t whad_phy_get_message_type(Message *p_message)
 {
-    whad_phy_msgtype_t msg_type = WHAD_BLE_UNKNOWN;
+    whad_phy_msgtype_t msg_type = WHAD_PHY_UNKNOWN;
 
     /* Ensure it is a BLE message. */
     if (whad_get_message_domain(p_message) == DOMAIN_PHY)
@@ -16,28 +18,29 @@ whad_phy_msgtype_t whad_phy_get_message_type(Message *p_message)
     return msg_type;
 }
 
+
+/**
+ * @brief Free a PHY message's dynamically allocated resources
+ *
+ * PHY messages no longer allocate any resource, this function is only kept
+ * for compatibility and does nothing.
+ *
+ * @param[in]       p_message           Pointer to a PHY message
+ **/
+
 void whad_phy_message_free(Message *p_message)
 {
-    switch (whad_phy_get_message_type(p_message))
-    {
-        case WHAD_PHY_SUPPORTED_FREQS:
-            if (p_message->msg.phy.msg.supported_freq.frequency_ranges.arg != NULL)
-            {
-                free(p_message->msg.phy.msg.supported_freq.frequency_ranges.arg);
-            }
-            break;
-
-        default:
-            break;
-    }
+    (void)p_message;
 }
 
-bool whad_phy_frequency_range_encode_cb(pb_ostream_t *ostream, const pb_field_t *field, void * const *arg)
+static bool whad_phy_frequency_range_encode_cb(pb_ostream_t *ostream, const pb_field_t *field, void * const *arg)
 {
-  phy_SupportedFrequencyRanges_FrequencyRange *frequency_range = *(phy_SupportedFrequencyRanges_FrequencyRange **)arg;
+  const whad_phy_frequency_ranges_t *p_ranges = *(const whad_phy_frequency_ranges_t **)arg;
+  int i;
+
   if (ostream != NULL && field->tag == phy_SupportedFrequencyRanges_frequency_ranges_tag)
   {
-    while ((frequency_range->start != 0) && (frequency_range->end != 0))
+    for (i=0; i<p_ranges->count; i++)
     {
       if (!pb_encode_tag_for_field(ostream, field))
       {
@@ -46,13 +49,12 @@ bool whad_phy_frequency_range_encode_cb(pb_ostream_t *ostream, const pb_field_t
           return false;
       }
 
-      if (!pb_encode_submessage(ostream, phy_SupportedFrequencyRanges_FrequencyRange_fields, frequency_range))
+      if (!pb_encode_submessage(ostream, phy_SupportedFrequencyRanges_FrequencyRange_fields, &p_ranges->p_ranges[i]))
       {
           const char * error = PB_GET_ERROR(ostream);
           PB_UNUSED(error);
           return false;
       }
-      frequency_range++;
     }
   }
   return true;
@@ -955,6 +957,41 @@ whad_result_t whad_phy_monitor_mode(Message *p_message)
 }
 
 
+/**
+ * @brief Parse a monitoring report
+ *
+ * Report values are only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remain valid until the arena is reset.
+ *
+ * @param[in]       p_message           Pointer to the message structure to parse
+ * @param[out]      p_timestamp         Pointer to the report timestamp
+ * @param[out]      pp_report           Pointer set to the report values
+ * @param[out]      p_count             Pointer set to the number of report values
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena.
+ **/
+
+whad_result_t whad_phy_monitor_report_parse(Message *p_message, uint64_t *p_timestamp, uint32_t **pp_report,
+                                            int *p_count)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_timestamp == NULL) || (pp_report == NULL) || (p_count == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_phy_get_message_type(p_message) != WHAD_PHY_MONITOR_REPORT)
+    {
+        return WHAD_ERROR;
+    }
+
+    *p_timestamp = p_message->msg.phy.msg.monitor_report.timestamp;
+    return whad_arena_get_items(&p_message->msg.phy.msg.monitor_report.report, (void **)pp_report, p_count);
+}
+
+
 /**
  * @brief Initialize a message starting the current mode
  *
@@ -1113,53 +1150,143 @@ whad_result_t whad_phy_send_raw_iq(Message *p_message, uint8_t *p_iq_stream, int
 }
 
 
+/**
+ * @brief Parse a message sending raw IQ samples
+ *
+ * Samples are only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remain valid until the arena is reset.
+ *
+ * @param[in]       p_message           Pointer to the message structure to parse
+ * @param[out]      pp_iq               Pointer set to the IQ samples
+ * @param[out]      p_count             Pointer set to the number of IQ samples
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena.
+ **/
+
+whad_result_t whad_phy_send_raw_iq_parse(Message *p_message, int32_t **pp_iq, int *p_count)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (pp_iq == NULL) || (p_count == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (whad_phy_get_message_type(p_message) != WHAD_PHY_SEND_RAW)
+    {
+        return WHAD_ERROR;
+    }
+
+    return whad_arena_get_items(&p_message->msg.phy.msg.send_raw.iq, (void **)pp_iq, p_count);
+}
+
+
 /**
  * @brief Initialize a message specifying the supported frequency ranges for the current device
  *
+ * Ranges are copied into static storage, which holds up to
+ * `WHAD_PHY_MAX_FREQUENCY_RANGES` ranges and is shared by every message
+ * initialized with this function: the message must be sent before this
+ * function is called again. Use `whad_phy_supported_frequency_ranges()` to
+ * reference the ranges instead of copying them.
+ *
  * @param[in,out]   p_message           Pointer to the message structure to initialize
  * @param[in]       p_ranges            Pointer to a list of supported frequency ranges
  * @param[in]       nb_ranges           Number of ranges in the provided list
  *
  * @retval          WHAD_SUCCESS        Success.
- * @retval          WHAD_ERROR          Invalid message pointer or supported ranges pointer.
+ * @retval          WHAD_ERROR          Invalid message pointer or supported ranges pointer, or too many ranges.
  **/
 
 whad_result_t whad_phy_supported_frequencies(Message *p_message, whad_phy_frequency_range_t *p_ranges,
                                              int nb_ranges)
 {
+    static whad_phy_frequency_range_t ranges[WHAD_PHY_MAX_FREQUENCY_RANGES];
+    static whad_phy_frequency_ranges_t ranges_ref = {ranges, 0};
     int i;
-    phy_SupportedFrequencyRanges_FrequencyRange *p_freq_ranges = NULL;
 
     /* Sanity check. */
-    if ((p_message == NULL) || (p_ranges == NULL))
+    if ((p_message == NULL) || ((p_ranges == NULL) && (nb_ranges > 0)) || (nb_ranges < 0) ||
+        (nb_ranges > WHAD_PHY_MAX_FREQUENCY_RANGES))
     {
         return WHAD_ERROR;
     }
 
-    /* Convert WHAD freq ranges to protobuf freq ranges. */
-    p_freq_ranges = malloc(sizeof(phy_SupportedFrequencyRanges_FrequencyRange) * nb_ranges);
-    if (p_freq_ranges != NULL)
+    /* Copy ranges. */
+    for (i=0; i<nb_ranges; i++)
     {
-        for (i=0; i < nb_ranges; i++)
-        {
-            p_freq_ranges[i].start = p_ranges[i].start;
-            p_freq_ranges[i].end = p_ranges[i].end;
-        }
+        ranges[i] = p_ranges[i];
+    }
+    ranges_ref.count = nb_ranges;
+
+    return whad_phy_supported_frequency_ranges(p_message, &ranges_ref);
+}
+
+
+/**
+ * @brief Initialize a message referencing the supported frequency ranges for the current device
+ *
+ * Ranges are encoded straight from the caller's storage when the message is
+ * sent: `p_ranges` and the ranges it references must remain valid until then.
+ *
+ * @param[in,out]   p_message           Pointer to the message structure to initialize
+ * @param[in]       p_ranges            Pointer to the supported frequency ranges
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or supported ranges pointer.
+ **/
+
+whad_result_t whad_phy_supported_frequency_ranges(Message *p_message, whad_phy_frequency_ranges_t *p_ranges)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_ranges == NULL) || ((p_ranges->p_ranges == NULL) && (p_ranges->count > 0)))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate field. */
+    p_message->which_msg = Message_phy_tag;
+    p_message->msg.phy.which_msg = phy_Message_supported_freq_tag;
+    p_message->msg.phy.msg.supported_freq.frequency_ranges.arg = p_ranges;
+    p_message->msg.phy.msg.supported_freq.frequency_ranges.funcs.encode = whad_phy_frequency_range_encode_cb;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
 
-        /* Populate field. */
-        p_message->which_msg = Message_phy_tag;
-        p_message->msg.phy.which_msg = phy_Message_supported_freq_tag;
-        p_message->msg.phy.msg.supported_freq.frequency_ranges.arg = p_freq_ranges;
-        p_message->msg.phy.msg.supported_freq.frequency_ranges.funcs.encode = whad_phy_frequency_range_encode_cb;
 
-        /* Success. */
-        return WHAD_SUCCESS;
+/**
+ * @brief Parse a message specifying the supported frequency ranges of a device
+ *
+ * Ranges are only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remain valid until the arena is reset.
+ *
+ * @param[in]       p_message           Pointer to the message structure to parse
+ * @param[out]      pp_ranges           Pointer set to the supported frequency ranges
+ * @param[out]      p_count             Pointer set to the number of ranges
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer or wrong message type.
+ * @retval          WHAD_NONE           Message has not been decoded into an arena.
+ **/
+
+whad_result_t whad_phy_supported_frequencies_parse(Message *p_message, whad_phy_frequency_range_t **pp_ranges,
+                                                   int *p_count)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (pp_ranges == NULL) || (p_count == NULL))
+    {
+        return WHAD_ERROR;
     }
-    else
+
+    if (whad_phy_get_message_type(p_message) != WHAD_PHY_SUPPORTED_FREQS)
     {
-        /* Memory error. */
         return WHAD_ERROR;
     }
+
+    return whad_arena_get_items(&p_message->msg.phy.msg.supported_freq.frequency_ranges, (void **)pp_ranges,
+                                p_count);
 }
 
 
@@ -1179,7 +1306,7 @@ whad_result_t whad_phy_supported_frequencies(Message *p_message, whad_phy_freque
 whad_result_t whad_phy_sched_packet(Message *p_message, uint8_t *p_packet, int length, uint32_t ts_sec,
                                              uint32_t ts_usec)
 {
-    uint64_t timestamp = ts_sec*1000000 + ts_usec;
+    uint64_t timestamp = (uint64_t)ts_sec*1000000 + ts_usec;
 
     /* Sanity check. */
     if ((p_message == NULL) || (p_packet == NULL))
@@ -1273,7 +1400,7 @@ whad_result_t whad_phy_jammed(Message *p_message, uint32_t ts_sec, uint32_t ts_u
 
     if ((ts_sec > 0) || (ts_usec > 0))
     {
-        p_message->msg.phy.msg.jammed.timestamp = ts_sec*1000000 + ts_usec;
+        p_message->msg.phy.msg.jammed.timestamp = (uint64_t)ts_sec*1000000 + ts_usec;
     }
     else
     {
@@ -1399,7 +1526,7 @@ whad_result_t whad_phy_packet_received(Message *p_message, uint32_t frequency, i
     if ((ts_sec > 0) || (ts_usec > 0))
     {
         p_message->msg.phy.msg.packet.has_timestamp = true;
-        p_message->msg.phy.msg.packet.timestamp = ts_sec*1000000 + ts_usec;
+        p_message->msg.phy.msg.packet.timestamp = (uint64_t)ts_sec*1000000 + ts_usec;
     }
     else
     {
@@ -1461,7 +1588,7 @@ whad_result_t whad_phy_packet_received(Message *p_message, uint32_t frequency, i
     if ((ts_sec > 0) || (ts_usec > 0))
     {
         p_message->msg.phy.msg.packet.has_timestamp = true;
-        p_message->msg.phy.msg.packet.timestamp = ts_sec*1000000 + ts_usec;
+        p_message->msg.phy.msg.packet.timestamp = (uint64_t)ts_sec*1000000 + ts_usec;
     }
     else
     {
@@ -1609,3 +1736,260 @@ whad_result_t whad_phy_packet_scheduled_parse(Message *p_message, whad_phy_sched
     /* Success. */
     return WHAD_SUCCESS;
 }
+
+
+/**
+ * @brief Initialize a compact PHY jammed notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       ts_sec              Timestamp, seconds
+ * @param[in]       ts_usec             Timestamp, microseconds
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_phy_jammed_compact(whad_compact_msg_t *p_message, uint32_t ts_sec, uint32_t ts_usec)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_phy_tag;
+    p_message->which_submsg = phy_Message_jammed_tag;
+    p_message->p_fields = phy_Jammed_fields;
+    p_message->msg.phy_jammed.timestamp = (uint64_t)ts_sec*1000000 + ts_usec;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact PHY scheduled packet sent notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       packet_id           Scheduled packet identifier
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_phy_sched_packet_sent_compact(whad_compact_msg_t *p_message, uint32_t packet_id)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_phy_tag;
+    p_message->which_submsg = phy_Message_sched_pkt_sent_tag;
+    p_message->p_fields = phy_SchedulePacketSent_fields;
+    p_message->msg.phy_sched_pkt_sent.id = packet_id;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact message to send a PHY packet
+ *
+ * Same as `whad_phy_send()`, except that the packet is not copied: it is
+ * streamed from `p_packet` when the message is encoded, so this buffer must
+ * remain valid until `whad_send_compact_message()` is called.
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       p_packet            Pointer to the packet to send
+ * @param[in]       length              Packet length in bytes
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message or packet pointer, or packet too large.
+ **/
+
+whad_result_t whad_phy_send_compact(whad_compact_msg_t *p_message, uint8_t *p_packet, int length)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_packet == NULL) || (length < 0) || (length > 255))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_phy_tag;
+    p_message->which_submsg = phy_Message_send_tag;
+    p_message->p_fields = whad_phy_send_tx_fields;
+    p_message->msg.phy_send.packet.p_bytes = p_packet;
+    p_message->msg.phy_send.packet.size = length;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a template reporting PHY packets
+ *
+ * Syncword and modulation parameters are encoded once, frequency, RSSI and
+ * timestamp are patched for each packet by
+ * `whad_phy_packet_received_template_send()`. RSSI and timestamp are always
+ * included, even if the timestamp is zero.
+ *
+ * @param[in,out]   p_template          Pointer to the template to initialize
+ * @param[in]       syncword            Pointer to the packet syncword
+ * @param[in]       syncword_length     Syncword size in bytes
+ * @param[in]       deviation           Modulation deviation (in Hz)
+ * @param[in]       datarate            Modulation datarate (in bauds)
+ * @param[in]       endianness          Modulation endianness (little / big endian)
+ * @param[in]       modulation          Modulation in use
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template pointer or syncword too large.
+ **/
+
+whad_result_t whad_phy_packet_received_template(whad_template_t *p_template, uint8_t *syncword, int syncword_length,
+                                                uint32_t deviation, uint32_t datarate, whad_phy_endian_t endianness,
+                                                whad_phy_modulation_t modulation)
+{
+    phy_PacketReceived constants = phy_PacketReceived_init_zero;
+
+    /* Sanity check. */
+    if ((syncword_length < 0) || (syncword_length > (int)sizeof(constants.syncword.bytes)))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Constant fields. */
+    if ((syncword != NULL) && (syncword_length > 0))
+    {
+        constants.syncword.size = syncword_length;
+        memcpy(constants.syncword.bytes, syncword, syncword_length);
+    }
+    constants.deviation = deviation;
+    constants.datarate = datarate;
+    constants.endian = (phy_Endianness)endianness;
+    constants.modulation = (phy_Modulation)modulation;
+
+    if (whad_template_init(p_template, Message_phy_tag, phy_Message_packet_tag,
+                           phy_PacketReceived_fields, &constants) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Changing fields. */
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_FREQUENCY, phy_PacketReceived_frequency_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_RSSI, phy_PacketReceived_rssi_tag, WHAD_TEMPLATE_INT32_WIDTH);
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_TIMESTAMP, phy_PacketReceived_timestamp_tag, WHAD_TEMPLATE_UINT64_WIDTH);
+
+    /* Packet. */
+    return whad_template_set_payload(p_template, phy_PacketReceived_packet_tag,
+                                     sizeof(((phy_PacketReceived *)0)->packet.bytes));
+}
+
+
+/**
+ * @brief Send a PHY packet based on a template
+ *
+ * @param[in,out]   p_template          Pointer to a template initialized by `whad_phy_packet_received_template()`
+ * @param[in]       frequency           Frequency on which the PHY packet has been captured
+ * @param[in]       rssi                Received Signal Strength Indicator in dBm
+ * @param[in]       ts_sec              Timestamp (seconds) at which the packet has been received
+ * @param[in]       ts_usec             Timestamp (microseconds) at which the packet has been received
+ * @param[in]       payload             Pointer to the packet payload
+ * @param[in]       length              Payload size in bytes
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or payload pointer, or payload too large.
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer.
+ **/
+
+whad_result_t whad_phy_packet_received_template_send(whad_template_t *p_template, uint32_t frequency, int32_t rssi,
+                                                     uint32_t ts_sec, uint32_t ts_usec, uint8_t *payload, int length)
+{
+    /* Sanity check. */
+    if (p_template == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Patch fields. */
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_FREQUENCY, frequency);
+    whad_template_set_int32(p_template, WHAD_TEMPLATE_RSSI, rssi);
+    whad_template_set_uint64(p_template, WHAD_TEMPLATE_TIMESTAMP, (uint64_t)ts_sec*1000000 + ts_usec);
+
+    /* Send packet. */
+    return whad_template_send(p_template, payload, length);
+}
+
+
+/**
+ * @brief Fast-path decoding of a SendCmd message
+ *
+ * Extracts the packet straight from a serialized message, as returned by
+ * `whad_get_raw_message()`, without calling NanoPb. The packet pointer
+ * refers to the serialized message buffer.
+ *
+ * @param[in]       p_message           Pointer to a serialized message
+ * @param[in]       size                Serialized message size in bytes
+ * @param[in,out]   p_packet            Pointer to a `whad_phy_send_fast_params_t` structure
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_NONE           Not a SendCmd message (or unusual encoding), use `whad_decode_message()`.
+ * @retval          WHAD_ERROR          Invalid pointer.
+ **/
+
+whad_result_t whad_phy_send_fast_parse(uint8_t *p_message, int size, whad_phy_send_fast_params_t *p_packet)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag;
+    bool valid;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_packet == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Recognize message by its leading tags. */
+    if (!whad_wire_get_submessage(&reader, p_message, size, Message_phy_tag, phy_Message_send_tag))
+    {
+        return WHAD_NONE;
+    }
+
+    /* Missing fields are set to their default value. */
+    memset(p_packet, 0, sizeof(whad_phy_send_fast_params_t));
+
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type))
+        {
+            return WHAD_NONE;
+        }
+
+        if (tag == phy_SendCmd_packet_tag)
+        {
+            valid = whad_wire_get_bytes(&reader, wire_type, &p_packet->p_payload, &p_packet->length) &&
+                    (p_packet->length <= (int)sizeof(((phy_SendCmd *)0)->packet.bytes));
+        }
+        else
+        {
+            valid = whad_wire_skip_field(&reader, wire_type);
+        }
+
+        if (!valid)
+        {
+            return WHAD_NONE;
+        }
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+#endif /* WHAD_ENABLE_PHY */
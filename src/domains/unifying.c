@@ -1,6 +1,8 @@
 #include <whad.h>
 #include <domains/unifying.h>
 
+#if WHAD_ENABLE_UNIFYING
+
 whad_unifying_msgtype_t whad_unifying_get_message_type(Message *p_message)
 {
     whad_unifying_msgtype_t msg_type = WHAD_UNIFYING_UNKNOWN;
@@ -705,9 +707,9 @@ whad_result_t whad_unifying_raw_pdu_received(Message *p_message, whad_unifying_r
     }
     else
     {
-        p_message->msg.esb.msg.raw_pdu.has_address = false;
-        p_message->msg.esb.msg.raw_pdu.address.size = 0;
-        memset(p_message->msg.esb.msg.raw_pdu.address.bytes, 0, 5);
+        p_message->msg.unifying.msg.raw_pdu.has_address = false;
+        p_message->msg.unifying.msg.raw_pdu.address.size = 0;
+        memset(p_message->msg.unifying.msg.raw_pdu.address.bytes, 0, 5);
     }
 
     /* Success. */
@@ -916,4 +918,132 @@ whad_result_t whad_unifying_pdu_received_parse(Message *p_message, whad_unifying
 
     /* Success. */
     return WHAD_SUCCESS;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Initialize a compact Logitech Unifying jammed notification
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       timestamp           Timestamp at which the target has been jammed
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_unifying_jammed_compact(whad_compact_msg_t *p_message, uint32_t timestamp)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_unifying_tag;
+    p_message->which_submsg = unifying_Message_jammed_tag;
+    p_message->p_fields = unifying_Jammed_fields;
+    p_message->msg.unifying_jammed.timestamp = timestamp;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a template reporting Logitech Unifying raw PDUs
+ *
+ * The address of the model packet is encoded once, channel, RSSI, timestamp
+ * and CRC validity are patched for each PDU by
+ * `whad_unifying_raw_pdu_template_send()`, if set in the model packet.
+ *
+ * @param[in,out]   p_template          Pointer to the template to initialize
+ * @param[in]       p_model             Pointer to a model packet
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or model pointer.
+ **/
+
+whad_result_t whad_unifying_raw_pdu_template(whad_template_t *p_template, whad_unifying_recvd_packet_t *p_model)
+{
+    unifying_RawPduReceived constants = unifying_RawPduReceived_init_zero;
+
+    /* Sanity check. */
+    if (p_model == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Constant fields. */
+    if (p_model->has_address)
+    {
+        if (p_model->address.size > (int)sizeof(constants.address.bytes))
+        {
+            /* Error, wrong address size. */
+            return WHAD_ERROR;
+        }
+
+        constants.has_address = true;
+        constants.address.size = p_model->address.size;
+        memcpy(constants.address.bytes, p_model->address.address, p_model->address.size);
+    }
+
+    if (whad_template_init(p_template, Message_unifying_tag, unifying_Message_raw_pdu_tag,
+                           unifying_RawPduReceived_fields, &constants) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Changing fields. */
+    whad_template_add_slot(p_template, WHAD_TEMPLATE_CHANNEL, unifying_RawPduReceived_channel_tag, WHAD_TEMPLATE_UINT32_WIDTH);
+    if (p_model->has_rssi)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_RSSI, unifying_RawPduReceived_rssi_tag, WHAD_TEMPLATE_INT32_WIDTH);
+    }
+    if (p_model->has_timestamp)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_TIMESTAMP, unifying_RawPduReceived_timestamp_tag,
+                               WHAD_TEMPLATE_UINT64_WIDTH);
+    }
+    if (p_model->has_crc_validity)
+    {
+        whad_template_add_slot(p_template, WHAD_TEMPLATE_CRC_VALIDITY, unifying_RawPduReceived_crc_validity_tag,
+                               WHAD_TEMPLATE_BOOL_WIDTH);
+    }
+
+    /* PDU. */
+    return whad_template_set_payload(p_template, unifying_RawPduReceived_pdu_tag,
+                                     sizeof(((unifying_RawPduReceived *)0)->pdu.bytes));
+}
+
+
+/**
+ * @brief Send a Logitech Unifying raw PDU based on a template
+ *
+ * @param[in,out]   p_template          Pointer to a template initialized by `whad_unifying_raw_pdu_template()`
+ * @param[in]       p_pdu               Pointer to the received PDU
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid template or PDU pointer, or PDU too large.
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer.
+ **/
+
+whad_result_t whad_unifying_raw_pdu_template_send(whad_template_t *p_template, whad_unifying_recvd_packet_t *p_pdu)
+{
+    /* Sanity check. */
+    if ((p_template == NULL) || (p_pdu == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Patch fields. */
+    whad_template_set_uint32(p_template, WHAD_TEMPLATE_CHANNEL, p_pdu->channel);
+    whad_template_set_int32(p_template, WHAD_TEMPLATE_RSSI, p_pdu->rssi);
+    whad_template_set_uint64(p_template, WHAD_TEMPLATE_TIMESTAMP, p_pdu->timestamp);
+    whad_template_set_bool(p_template, WHAD_TEMPLATE_CRC_VALIDITY, p_pdu->crc_validity);
+
+    /* Send PDU. */
+    return whad_template_send(p_template, p_pdu->packet.bytes, p_pdu->packet.length);
+}
+
+#endif /* WHAD_ENABLE_UNIFYING */
@@ -44,6 +44,47 @@ whad_result_t whad_generic_cmd_result(Message *p_message, whad_result_code_t res
     p_message->which_msg = Message_generic_tag;
     p_message->msg.generic.which_msg = generic_Message_cmd_result_tag;
     p_message->msg.generic.msg.cmd_result.result = result;
+    p_message->msg.generic.msg.cmd_result.has_rx_time = false;
+    p_message->msg.generic.msg.cmd_result.has_duration = false;
+    p_message->msg.generic.msg.cmd_result.has_tx_backlog = false;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a generic command result message carrying the command timing
+ *
+ * Lets the host split the command round trip between the link, the device TX
+ * queue and the command handler (see cmdlatency.h).
+ *
+ * @param[in]   p_message       Pointer to a `Message` structure
+ * @param[in]   result          Result code to include in the message
+ * @param[in]   p_timing        Pointer to the command timing
+ * @retval      WHAD_SUCCESS    Success
+ * @retval      WHAD_ERROR      Wrong message or timing pointer
+ **/
+
+whad_result_t whad_generic_cmd_result_timed(Message *p_message, whad_result_code_t result,
+                                            const whad_cmd_timing_t *p_timing)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_timing == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Build a generic command result message. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->msg.generic.which_msg = generic_Message_cmd_result_tag;
+    p_message->msg.generic.msg.cmd_result.result = result;
+    p_message->msg.generic.msg.cmd_result.has_rx_time = true;
+    p_message->msg.generic.msg.cmd_result.rx_time = p_timing->rx_time;
+    p_message->msg.generic.msg.cmd_result.has_duration = true;
+    p_message->msg.generic.msg.cmd_result.duration = p_timing->duration;
+    p_message->msg.generic.msg.cmd_result.has_tx_backlog = true;
+    p_message->msg.generic.msg.cmd_result.tx_backlog = p_timing->tx_backlog;
 
     /* Success. */
     return WHAD_SUCCESS;
@@ -85,6 +126,101 @@ whad_result_t whad_generic_cmd_result_parse(Message *p_message, whad_result_code
 }
 
 
+/**
+ * @brief Parse the command timing of a generic command result message
+ *
+ * @param[in]       p_message       Pointer to a `Message` structure
+ * @param[out]      p_timing        Pointer to a `whad_cmd_timing_t` structure
+ *
+ * @retval      WHAD_SUCCESS    Success.
+ * @retval      WHAD_NONE       Command result without timing.
+ * @retval      WHAD_ERROR      Wrong message pointer or timing pointer, or wrong message type.
+ **/
+
+whad_result_t whad_generic_cmd_result_timing_parse(Message *p_message, whad_cmd_timing_t *p_timing)
+{
+    generic_CmdResult *p_cmd_result;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_timing == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_message->which_msg == Message_generic_tag)
+    {
+        if (p_message->msg.generic.which_msg == generic_Message_cmd_result_tag)
+        {
+            p_cmd_result = &p_message->msg.generic.msg.cmd_result;
+
+            /* All fields are set together by the device. */
+            if (!p_cmd_result->has_rx_time || !p_cmd_result->has_duration || !p_cmd_result->has_tx_backlog)
+            {
+                return WHAD_NONE;
+            }
+
+            p_timing->rx_time = p_cmd_result->rx_time;
+            p_timing->duration = p_cmd_result->duration;
+            p_timing->tx_backlog = p_cmd_result->tx_backlog;
+
+            /* Success. */
+            return WHAD_SUCCESS;
+        }
+    }
+
+    /* Nope. */
+    return WHAD_ERROR;
+}
+
+
+/*
+ * Pre-encoded command result frames, transport header included, indexed by
+ * result code. A successful result has no field set (proto3 default), others
+ * only carry their result code.
+ */
+
+#define WHAD_CMD_RESULT_FRAME(code)     {0xAC, 0xBE, 0x06, 0x00, 0x0A, 0x04, 0x12, 0x02, 0x08, (code)}
+
+static const uint8_t g_cmd_result_frames[][WHAD_CMD_RESULT_FRAME_MAX_SIZE] = {
+    {0xAC, 0xBE, 0x04, 0x00, 0x0A, 0x02, 0x12, 0x00},  /* WHAD_RESULT_SUCCESS */
+    WHAD_CMD_RESULT_FRAME(WHAD_RESULT_ERROR),
+    WHAD_CMD_RESULT_FRAME(WHAD_RESULT_PARAMETER_ERROR),
+    WHAD_CMD_RESULT_FRAME(WHAD_RESULT_DISCONNECTED),
+    WHAD_CMD_RESULT_FRAME(WHAD_RESULT_WRONG_MODE),
+    WHAD_CMD_RESULT_FRAME(WHAD_RESULT_UNSUPPORTED_DOMAIN),
+    WHAD_CMD_RESULT_FRAME(WHAD_RESULT_BUSY)
+};
+
+#define WHAD_CMD_RESULT_FRAMES_COUNT    (sizeof(g_cmd_result_frames)/sizeof(g_cmd_result_frames[0]))
+
+
+/**
+ * @brief Send a generic command result from a pre-encoded frame
+ *
+ * The frame is copied as-is in the transport TX buffer, without building
+ * nor encoding any `Message` structure.
+ *
+ * @param[in]   result              Result code to send
+ * @retval      WHAD_SUCCESS        Success
+ * @retval      WHAD_ERROR          Unknown result code
+ * @retval      WHAD_RINGBUF_FULL   Not enough space in TX buffer, frame not queued
+ **/
+
+whad_result_t whad_send_cmd_result_fast(whad_result_code_t result)
+{
+    /* Sanity check. */
+    if ((unsigned int)result >= WHAD_CMD_RESULT_FRAMES_COUNT)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Queue our pre-encoded frame. */
+    return whad_transport_send_frame((uint8_t *)g_cmd_result_frames[result],
+                                     (result == WHAD_RESULT_SUCCESS)?WHAD_CMD_RESULT_FRAME_MIN_SIZE:WHAD_CMD_RESULT_FRAME_MAX_SIZE,
+                                     NULL, 0);
+}
+
+
 /**
  * @brief Generic verbose message encoding callback.
  * 
@@ -143,8 +279,24 @@ whad_result_t whad_generic_verbose_message(Message *p_message, char *psz_message
     return WHAD_SUCCESS;
 }
 
+
+/**
+ * @brief Parse a generic verbose message.
+ * 
+ * The message text is only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remains valid until the arena is reset.
+ * 
+ * @param[in]       p_message     Pointer to a `Message` structure
+ * @param[out]      ppsz_message  Pointer set to the NUL-terminated message text, NULL if not available
+ * 
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer or wrong message type.
+ **/
+
 whad_result_t whad_generic_verbose_message_parse(Message *p_message, char **ppsz_message)
 {
+    int length;
+
     /* Sanity check. */
     if ((p_message == NULL) || (ppsz_message == NULL))
     {
@@ -155,9 +307,12 @@ whad_result_t whad_generic_verbose_message_parse(Message *p_message, char **ppsz
     {
         if (p_message->msg.generic.which_msg == generic_Message_verbose_tag)
         {
-            /* Save result. */
-            /* TODO: how to get a pointer to the bytes ?? */
-            *ppsz_message = NULL;
+            /* Save text from the arena, if decoded into one. */
+            if (whad_arena_get_items(&p_message->msg.generic.msg.verbose.data, (void **)ppsz_message,
+                                     &length) != WHAD_SUCCESS)
+            {
+                *ppsz_message = NULL;
+            }
 
             /* Success. */
             return WHAD_SUCCESS;
@@ -183,12 +338,12 @@ whad_result_t whad_generic_verbose_message_parse(Message *p_message, char **ppsz
 whad_result_t whad_verbose(char *psz_message)
 {
     whad_result_t result;
-    Message msg;
+    whad_compact_msg_t msg;
 
-    result = whad_generic_verbose_message(&msg, psz_message);
+    result = whad_generic_verbose_message_compact(&msg, psz_message);
     if (result == WHAD_SUCCESS)
     {
-        return whad_send_message(&msg);
+        return whad_send_compact_message(&msg);
     }
     else
     {
@@ -258,6 +413,52 @@ whad_result_t whad_generic_debug_message(Message *p_message, uint32_t level, cha
     return WHAD_SUCCESS;
 }
 
+/**
+ * @brief Parse a generic debug message.
+ * 
+ * The message text is only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remains valid until the arena is reset.
+ * 
+ * @param[in]       p_message     Pointer to a `Message` structure
+ * @param[out]      p_level       Pointer to the debug level
+ * @param[out]      ppsz_message  Pointer set to the NUL-terminated message text, NULL if not available
+ * 
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer or wrong message type.
+ **/
+
+whad_result_t whad_generic_debug_message_parse(Message *p_message, uint32_t *p_level, char **ppsz_message)
+{
+    int length;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_level == NULL) || (ppsz_message == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_message->which_msg == Message_generic_tag)
+    {
+        if (p_message->msg.generic.which_msg == generic_Message_debug_tag)
+        {
+            *p_level = p_message->msg.generic.msg.debug.level;
+
+            /* Save text from the arena, if decoded into one. */
+            if (whad_arena_get_items(&p_message->msg.generic.msg.debug.data, (void **)ppsz_message,
+                                     &length) != WHAD_SUCCESS)
+            {
+                *ppsz_message = NULL;
+            }
+
+            /* Success. */
+            return WHAD_SUCCESS;
+        }
+    }
+
+    /* Nope. */
+    return WHAD_ERROR;
+}
+
 /**
  * @brief Initialize a generic progress message.
  * 
@@ -320,4 +521,500 @@ whad_result_t whad_generic_progress_message_parse(Message *p_message, uint32_t *
 
     /* Nope. */
     return WHAD_ERROR;        
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Initialize a generic clock synchronization query.
+ *
+ * Sent by the host, the device answers with a clock synchronization reply
+ * (see `whad_generic_time_sync_reply()`).
+ *
+ * @param[in,out]   p_message     Pointer to a `Messsage` structure
+ * @param[in]       sequence      Query sequence number
+ * @param[in]       host_time     Host time at which the query is sent
+ *
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_time_sync_query(Message *p_message, uint32_t sequence, uint64_t host_time)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Specify payload type. */
+    p_message->which_msg = Message_generic_tag;
+
+    /* Fills query data. */
+    p_message->msg.generic.which_msg = generic_Message_time_sync_query_tag;
+    p_message->msg.generic.msg.time_sync_query.sequence = sequence;
+    p_message->msg.generic.msg.time_sync_query.host_time = host_time;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Parse a generic clock synchronization query.
+ *
+ * @param[in]       p_message     Pointer to a `Messsage` structure
+ * @param[out]      p_sequence    Pointer to the query sequence number
+ * @param[out]      p_host_time   Pointer to the host time at which the query was sent
+ *
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer or wrong message type.
+ **/
+
+whad_result_t whad_generic_time_sync_query_parse(Message *p_message, uint32_t *p_sequence, uint64_t *p_host_time)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_sequence == NULL) || (p_host_time == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_message->which_msg == Message_generic_tag)
+    {
+        if (p_message->msg.generic.which_msg == generic_Message_time_sync_query_tag)
+        {
+            *p_sequence = p_message->msg.generic.msg.time_sync_query.sequence;
+            *p_host_time = p_message->msg.generic.msg.time_sync_query.host_time;
+
+            /* Success. */
+            return WHAD_SUCCESS;
+        }
+    }
+
+    /* Nope. */
+    return WHAD_ERROR;
+}
+
+
+/**
+ * @brief Initialize a generic clock synchronization reply.
+ *
+ * The device echoes the sequence number and host time of the query, along with
+ * the time at which it received the query and the time at which the reply is
+ * queued, both in microseconds of the clock used to timestamp notifications.
+ * The reception time should be taken as early as possible (e.g. when the frame
+ * is extracted from the transport layer) and the transmission time right before
+ * sending the reply.
+ *
+ * @param[in,out]   p_message     Pointer to a `Messsage` structure
+ * @param[in]       sequence      Query sequence number
+ * @param[in]       host_time     Host time of the query
+ * @param[in]       rx_time       Device time at which the query was received
+ * @param[in]       tx_time       Device time at which the reply is queued
+ *
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_time_sync_reply(Message *p_message, uint32_t sequence, uint64_t host_time, uint64_t rx_time,
+                                           uint64_t tx_time)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Specify payload type. */
+    p_message->which_msg = Message_generic_tag;
+
+    /* Fills reply data. */
+    p_message->msg.generic.which_msg = generic_Message_time_sync_reply_tag;
+    p_message->msg.generic.msg.time_sync_reply.sequence = sequence;
+    p_message->msg.generic.msg.time_sync_reply.host_time = host_time;
+    p_message->msg.generic.msg.time_sync_reply.rx_time = rx_time;
+    p_message->msg.generic.msg.time_sync_reply.tx_time = tx_time;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Parse a generic clock synchronization reply.
+ *
+ * @param[in]       p_message     Pointer to a `Messsage` structure
+ * @param[out]      p_parameters  Pointer to a `whad_time_sync_reply_params_t` structure
+ *
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer or wrong message type.
+ **/
+
+whad_result_t whad_generic_time_sync_reply_parse(Message *p_message, whad_time_sync_reply_params_t *p_parameters)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_parameters == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_message->which_msg == Message_generic_tag)
+    {
+        if (p_message->msg.generic.which_msg == generic_Message_time_sync_reply_tag)
+        {
+            p_parameters->sequence = p_message->msg.generic.msg.time_sync_reply.sequence;
+            p_parameters->host_time = p_message->msg.generic.msg.time_sync_reply.host_time;
+            p_parameters->rx_time = p_message->msg.generic.msg.time_sync_reply.rx_time;
+            p_parameters->tx_time = p_message->msg.generic.msg.time_sync_reply.tx_time;
+
+            /* Success. */
+            return WHAD_SUCCESS;
+        }
+    }
+
+    /* Nope. */
+    return WHAD_ERROR;
+}
+
+
+/**
+ * @brief Generic log message encoding callback.
+ *
+ * @param[in,out]   ostream Output stream
+ * @param[in]       field   Pointer to a field descriptor.
+ * @param[in]       arg     Pointer to a custom argument storing a pointer onto a `whad_log_entries_t` structure.
+ * @return true if everything went ok, false otherwise.
+ */
+
+bool whad_log_msg_encode_cb(pb_ostream_t *ostream, const pb_field_t *field, void * const *arg)
+{
+    whad_log_entries_t *p_entries = *(whad_log_entries_t **)arg;
+
+    if (ostream != NULL && field->tag == generic_LogMsg_entries_tag)
+    {
+        if (!pb_encode_tag_for_field(ostream, field))
+            return false;
+
+        /* Both parts are written as a single bytes field. */
+        if (!pb_encode_varint(ostream, (uint64_t)(p_entries->first_size + p_entries->second_size)))
+            return false;
+
+        if (!pb_write(ostream, p_entries->p_first, p_entries->first_size))
+            return false;
+
+        if ((p_entries->second_size > 0) && !pb_write(ostream, p_entries->p_second, p_entries->second_size))
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Initialize a generic binary log message.
+ *
+ * @param[in,out]   p_message     Pointer to a `Messsage` structure
+ * @param[in]       dropped       Total number of log entries dropped by the device
+ * @param[in]       p_entries     Pointer to the log entries to include, must remain valid until the message is sent
+ *
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message or entries pointer.
+ **/
+
+whad_result_t whad_generic_log_message(Message *p_message, uint32_t dropped, whad_log_entries_t *p_entries)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_entries == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Specify payload type. */
+    p_message->which_msg = Message_generic_tag;
+
+    /* Fills log message data. */
+    p_message->msg.generic.which_msg = generic_Message_log_tag;
+    p_message->msg.generic.msg.log.dropped = dropped;
+    p_message->msg.generic.msg.log.entries.arg = p_entries;
+    p_message->msg.generic.msg.log.entries.funcs.encode = whad_log_msg_encode_cb;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Parse a generic binary log message.
+ *
+ * Entries are only available if the message has been decoded with
+ * `whad_decode_message_arena()`, and remain valid until the arena is reset.
+ * They are read with `whad_log_next_entry()`.
+ *
+ * @param[in]       p_message     Pointer to a `Messsage` structure
+ * @param[out]      p_dropped     Pointer to the total number of log entries dropped by the device
+ * @param[out]      pp_entries    Pointer set to the log entries, NULL if not available
+ * @param[out]      p_size        Pointer to the log entries size in bytes
+ *
+ * @retval          WHAD_SUCCESS  Success.
+ * @retval          WHAD_ERROR    Invalid message pointer or wrong message type.
+ **/
+
+whad_result_t whad_generic_log_message_parse(Message *p_message, uint32_t *p_dropped, uint8_t **pp_entries,
+                                             int *p_size)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_dropped == NULL) || (pp_entries == NULL) || (p_size == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (p_message->which_msg == Message_generic_tag)
+    {
+        if (p_message->msg.generic.which_msg == generic_Message_log_tag)
+        {
+            *p_dropped = p_message->msg.generic.msg.log.dropped;
+
+            /* Save entries from the arena, if decoded into one. */
+            if (whad_arena_get_items(&p_message->msg.generic.msg.log.entries, (void **)pp_entries,
+                                     p_size) != WHAD_SUCCESS)
+            {
+                *pp_entries = NULL;
+                *p_size = 0;
+            }
+
+            /* Success. */
+            return WHAD_SUCCESS;
+        }
+    }
+
+    /* Nope. */
+    return WHAD_ERROR;
+}
+
+
+/**
+ * @brief Initialize a compact generic command result message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       result              Result code to include in the message
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_cmd_result_compact(whad_compact_msg_t *p_message, whad_result_code_t result)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_cmd_result_tag;
+    p_message->p_fields = generic_CmdResult_fields;
+    p_message->msg.cmd_result.result = (generic_ResultCode)result;
+    p_message->msg.cmd_result.has_rx_time = false;
+    p_message->msg.cmd_result.has_duration = false;
+    p_message->msg.cmd_result.has_tx_backlog = false;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact generic command result message carrying the command timing
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       result              Result code to include in the message
+ * @param[in]       p_timing            Pointer to the command timing
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message or timing pointer.
+ **/
+
+whad_result_t whad_generic_cmd_result_timed_compact(whad_compact_msg_t *p_message, whad_result_code_t result,
+                                                    const whad_cmd_timing_t *p_timing)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_timing == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_cmd_result_tag;
+    p_message->p_fields = generic_CmdResult_fields;
+    p_message->msg.cmd_result.result = (generic_ResultCode)result;
+    p_message->msg.cmd_result.has_rx_time = true;
+    p_message->msg.cmd_result.rx_time = p_timing->rx_time;
+    p_message->msg.cmd_result.has_duration = true;
+    p_message->msg.cmd_result.duration = p_timing->duration;
+    p_message->msg.cmd_result.has_tx_backlog = true;
+    p_message->msg.cmd_result.tx_backlog = p_timing->tx_backlog;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact generic verbose message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       psz_message         Pointer to the message string to include in this verbose message
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_verbose_message_compact(whad_compact_msg_t *p_message, char *psz_message)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_verbose_tag;
+    p_message->p_fields = generic_VerboseMsg_fields;
+    p_message->msg.verbose.data.arg = psz_message;
+    p_message->msg.verbose.data.funcs.encode = whad_verbose_msg_encode_cb;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact generic debug message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       level               Debug level
+ * @param[in]       psz_message         Pointer to a text string corresponding to the debug message to send
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_debug_message_compact(whad_compact_msg_t *p_message, uint32_t level, char *psz_message)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_debug_tag;
+    p_message->p_fields = generic_DebugMsg_fields;
+    p_message->msg.debug.level = level;
+    p_message->msg.debug.data.arg = psz_message;
+    p_message->msg.debug.data.funcs.encode = whad_debug_msg_encode_cb;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact generic progress message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       value               Progress value
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_progress_message_compact(whad_compact_msg_t *p_message, uint32_t value)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_progress_tag;
+    p_message->p_fields = generic_Progress_fields;
+    p_message->msg.progress.value = value;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact generic clock synchronization reply
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       sequence            Query sequence number
+ * @param[in]       host_time           Host time of the query
+ * @param[in]       rx_time             Device time at which the query was received
+ * @param[in]       tx_time             Device time at which the reply is queued
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message pointer.
+ **/
+
+whad_result_t whad_generic_time_sync_reply_compact(whad_compact_msg_t *p_message, uint32_t sequence, uint64_t host_time,
+                                                   uint64_t rx_time, uint64_t tx_time)
+{
+    /* Sanity check. */
+    if (p_message == NULL)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_time_sync_reply_tag;
+    p_message->p_fields = generic_TimeSyncReply_fields;
+    p_message->msg.time_sync_reply.sequence = sequence;
+    p_message->msg.time_sync_reply.host_time = host_time;
+    p_message->msg.time_sync_reply.rx_time = rx_time;
+    p_message->msg.time_sync_reply.tx_time = tx_time;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief Initialize a compact generic binary log message
+ *
+ * @param[in,out]   p_message           Pointer to a compact message structure
+ * @param[in]       dropped             Total number of log entries dropped by the device
+ * @param[in]       p_entries           Pointer to the log entries to include, must remain valid until the message is sent
+ *
+ * @retval          WHAD_SUCCESS        Success.
+ * @retval          WHAD_ERROR          Invalid message or entries pointer.
+ **/
+
+whad_result_t whad_generic_log_message_compact(whad_compact_msg_t *p_message, uint32_t dropped,
+                                               whad_log_entries_t *p_entries)
+{
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_entries == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Populate message fields. */
+    p_message->which_msg = Message_generic_tag;
+    p_message->which_submsg = generic_Message_log_tag;
+    p_message->p_fields = generic_LogMsg_fields;
+    p_message->msg.log.dropped = dropped;
+    p_message->msg.log.entries.arg = p_entries;
+    p_message->msg.log.entries.funcs.encode = whad_log_msg_encode_cb;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
@@ -0,0 +1,453 @@
+#include "whad.h"
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#if (WHAD_LOG_RING_SIZE & (WHAD_LOG_RING_SIZE - 1)) != 0
+#error WHAD_LOG_RING_SIZE must be a power of two
+#endif
+
+#define WHAD_LOG_RING_MASK      (WHAD_LOG_RING_SIZE - 1)
+
+/* Rate limiting budget cap, two full log messages (in bytes x 10^6). */
+#define WHAD_LOG_RATE_BURST     ((uint64_t)(2 * (WHAD_LOG_FLUSH_MAX_SIZE + WHAD_LOG_MSG_OVERHEAD)) * 1000000ULL)
+
+/* Start of the format strings section, provided by the linker when a log site exists. */
+extern const char __start_whad_log_fmt[] __attribute__((weak));
+
+/*
+ * Log ring buffer: producers reserve words by moving `head` forward, then
+ * write their entry and set its header last. The consumer (`whad_log_flush()`)
+ * sends committed entries, clears their words and moves `tail` forward.
+ */
+static uint32_t g_log_ring[WHAD_LOG_RING_SIZE];
+static uint32_t g_log_head = 0;
+static uint32_t g_log_tail = 0;
+static uint32_t g_log_dropped = 0;
+static uint32_t g_log_reported_dropped = 0;
+static whad_log_level_t g_log_level = WHAD_LOG_MAX_LEVEL;
+
+/* Log clock and rate limiting (tokens in bytes x 10^6). */
+static whad_log_clock_cb_t gpfn_log_clock = NULL;
+static uint32_t g_log_rate = WHAD_LOG_DEFAULT_RATE;
+static uint64_t g_log_tokens = 0;
+static uint32_t g_log_last_refill = 0;
+
+
+/**
+ * @brief   Default log clock.
+ *
+ * @return  Monotonic time in us on Linux hosts, 0 otherwise.
+ **/
+
+static uint32_t whad_log_default_clock(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL));
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief   Read the log clock.
+ *
+ * @return  Time in us, 0 if no clock is available.
+ **/
+
+static uint32_t whad_log_now(void)
+{
+    if (gpfn_log_clock == NULL)
+    {
+        return 0;
+    }
+
+    return gpfn_log_clock();
+}
+
+
+/**
+ * @brief   Refill the rate limiting budget and check it allows a message.
+ *
+ * @param[in]   size    Message size in bytes
+ * @return  true if the message may be sent, false otherwise.
+ **/
+
+static bool whad_log_rate_allows(int size)
+{
+    uint32_t now;
+    uint32_t elapsed;
+
+    /* No rate limiting without a clock. */
+    if ((g_log_rate == 0) || (gpfn_log_clock == NULL))
+    {
+        return true;
+    }
+
+    now = gpfn_log_clock();
+    elapsed = now - g_log_last_refill;
+    g_log_last_refill = now;
+    if (elapsed > 10000000)
+    {
+        elapsed = 10000000;
+    }
+
+    g_log_tokens += (uint64_t)elapsed * g_log_rate;
+    if (g_log_tokens > WHAD_LOG_RATE_BURST)
+    {
+        g_log_tokens = WHAD_LOG_RATE_BURST;
+    }
+
+    return (g_log_tokens >= ((uint64_t)size * 1000000ULL));
+}
+
+
+/**
+ * @brief   Take a sent message from the rate limiting budget.
+ *
+ * @param[in]   size    Message size in bytes, allowed by `whad_log_rate_allows()`
+ **/
+
+static void whad_log_rate_consume(int size)
+{
+    if ((g_log_rate != 0) && (gpfn_log_clock != NULL))
+    {
+        g_log_tokens -= (uint64_t)size * 1000000ULL;
+    }
+}
+
+
+/**
+ * @brief   Initialize binary logging.
+ *
+ * Empties the ring buffer, resets the dropped entries counter and selects the
+ * default log clock, unless a clock has already been set. Binary logging is
+ * opt-in: firmwares using it call this function after `whad_init()`, others
+ * do not link the log ring buffer.
+ **/
+
+void whad_log_init(void)
+{
+    if (gpfn_log_clock == NULL)
+    {
+        gpfn_log_clock = whad_log_default_clock;
+    }
+
+    memset(g_log_ring, 0, sizeof(g_log_ring));
+    __atomic_store_n(&g_log_head, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_log_tail, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_log_dropped, 0, __ATOMIC_RELAXED);
+    g_log_reported_dropped = 0;
+    g_log_tokens = WHAD_LOG_RATE_BURST;
+    g_log_last_refill = whad_log_now();
+}
+
+
+/**
+ * @brief   Set the log clock.
+ *
+ * @param[in]   pfn_clock   Clock returning a time in us, free-running and wrapping at 2^32
+ **/
+
+void whad_log_set_clock(whad_log_clock_cb_t pfn_clock)
+{
+    gpfn_log_clock = pfn_clock;
+    g_log_last_refill = whad_log_now();
+}
+
+
+/**
+ * @brief   Set the highest level of the entries to store.
+ *
+ * @param[in]   level   Log level, entries of higher levels are ignored
+ **/
+
+void whad_log_set_level(whad_log_level_t level)
+{
+    g_log_level = level;
+}
+
+
+/**
+ * @brief   Set the bandwidth budget of log messages.
+ *
+ * @param[in]   bytes_per_second    Average link bandwidth allowed, 0 for no limit
+ **/
+
+void whad_log_set_rate(uint32_t bytes_per_second)
+{
+    g_log_rate = bytes_per_second;
+}
+
+
+/**
+ * @brief   Store a binary log entry.
+ *
+ * Called by `WHAD_LOG()`. Safe to call from interrupt handlers and from
+ * several contexts at once, never blocks.
+ *
+ * @param[in]   level       Log level
+ * @param[in]   psz_format  Format string, located in the format strings section
+ * @param[in]   p_args      Pointer to the arguments
+ * @param[in]   nargs       Number of arguments, extra arguments beyond `WHAD_LOG_MAX_ARGS` are ignored
+ *
+ * @retval  WHAD_SUCCESS        Entry stored.
+ * @retval  WHAD_NONE           Level filtered out.
+ * @retval  WHAD_RINGBUF_FULL   Not enough room in the ring buffer, entry dropped.
+ **/
+
+whad_result_t whad_log_write(whad_log_level_t level, const char *psz_format, const uint32_t *p_args, int nargs)
+{
+    uintptr_t offset;
+    uint32_t header;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t words;
+    int i;
+
+    if (level > g_log_level)
+    {
+        return WHAD_NONE;
+    }
+
+    if (nargs > WHAD_LOG_MAX_ARGS)
+    {
+        nargs = WHAD_LOG_MAX_ARGS;
+    }
+    words = WHAD_LOG_ENTRY_HEADER_WORDS + nargs;
+
+    /* Reserve the entry words. */
+    head = __atomic_load_n(&g_log_head, __ATOMIC_RELAXED);
+    do
+    {
+        tail = __atomic_load_n(&g_log_tail, __ATOMIC_ACQUIRE);
+        if ((head - tail + words) > WHAD_LOG_RING_SIZE)
+        {
+            __atomic_fetch_add(&g_log_dropped, 1, __ATOMIC_RELAXED);
+            return WHAD_RINGBUF_FULL;
+        }
+    } while (!__atomic_compare_exchange_n(&g_log_head, &head, head + words, true, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+
+    offset = (uintptr_t)psz_format - (uintptr_t)__start_whad_log_fmt;
+    if ((__start_whad_log_fmt == NULL) || ((uintptr_t)psz_format < (uintptr_t)__start_whad_log_fmt) ||
+        (offset >= WHAD_LOG_ID_UNKNOWN))
+    {
+        offset = WHAD_LOG_ID_UNKNOWN;
+    }
+
+    g_log_ring[(head + 1) & WHAD_LOG_RING_MASK] = whad_log_now();
+    for (i=0; i<nargs; i++)
+    {
+        g_log_ring[(head + WHAD_LOG_ENTRY_HEADER_WORDS + i) & WHAD_LOG_RING_MASK] = p_args[i];
+    }
+
+    /* Commit the entry. */
+    header = (uint32_t)offset | ((uint32_t)nargs << WHAD_LOG_NARGS_SHIFT) |
+             (((uint32_t)level & WHAD_LOG_LEVEL_MASK) << WHAD_LOG_LEVEL_SHIFT) | WHAD_LOG_COMMITTED;
+    __atomic_store_n(&g_log_ring[head & WHAD_LOG_RING_MASK], header, __ATOMIC_RELEASE);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Send pending log entries.
+ *
+ * Called from the firmware main loop (a single context). Packs the committed
+ * entries, in order and up to `WHAD_LOG_FLUSH_MAX_SIZE` bytes, into a single
+ * log message sent straight from the ring buffer. Nothing is sent when the
+ * bandwidth budget is exhausted, or when the TX ring buffer cannot take the
+ * message without waiting.
+ *
+ * @retval  WHAD_SUCCESS        Log message sent.
+ * @retval  WHAD_NONE           Nothing to send, or bandwidth budget exhausted.
+ * @retval  WHAD_RINGBUF_FULL   Not enough room in the TX ring buffer, retry later.
+ * @retval  WHAD_ERROR          Message could not be sent.
+ **/
+
+whad_result_t whad_log_flush(void)
+{
+    whad_compact_msg_t msg;
+    whad_log_entries_t entries;
+    whad_result_t result;
+    uint32_t header;
+    uint32_t dropped;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t words = 0;
+    uint32_t entry_words;
+    uint32_t start;
+    uint32_t i;
+    int size;
+
+    tail = g_log_tail;
+    head = __atomic_load_n(&g_log_head, __ATOMIC_ACQUIRE);
+    dropped = __atomic_load_n(&g_log_dropped, __ATOMIC_RELAXED);
+
+    /* Committed entries, stopping at the first one still being written. */
+    while ((tail + words) != head)
+    {
+        header = __atomic_load_n(&g_log_ring[(tail + words) & WHAD_LOG_RING_MASK], __ATOMIC_ACQUIRE);
+        if ((header & WHAD_LOG_COMMITTED) == 0)
+        {
+            break;
+        }
+
+        entry_words = WHAD_LOG_ENTRY_HEADER_WORDS + ((header >> WHAD_LOG_NARGS_SHIFT) & WHAD_LOG_NARGS_MASK);
+        if (((words + entry_words) * sizeof(uint32_t)) > WHAD_LOG_FLUSH_MAX_SIZE)
+        {
+            break;
+        }
+        words += entry_words;
+    }
+
+    if ((words == 0) && (dropped == g_log_reported_dropped))
+    {
+        return WHAD_NONE;
+    }
+
+    size = words * sizeof(uint32_t);
+    if (!whad_log_rate_allows(size + WHAD_LOG_MSG_OVERHEAD))
+    {
+        return WHAD_NONE;
+    }
+
+    if ((WHAD_RINGBUF_MAX_SIZE - 1 - whad_transport_get_txbuf_size()) <
+        (size + WHAD_LOG_MSG_OVERHEAD + WHAD_TRACE_OVERHEAD))
+    {
+        return WHAD_RINGBUF_FULL;
+    }
+
+    /* Entries may wrap around the end of the ring buffer. */
+    start = tail & WHAD_LOG_RING_MASK;
+    entries.p_first = (const uint8_t *)&g_log_ring[start];
+    entries.p_second = (const uint8_t *)&g_log_ring[0];
+    if ((start + words) > WHAD_LOG_RING_SIZE)
+    {
+        entries.first_size = (WHAD_LOG_RING_SIZE - start) * sizeof(uint32_t);
+        entries.second_size = size - entries.first_size;
+    }
+    else
+    {
+        entries.first_size = size;
+        entries.second_size = 0;
+    }
+
+    whad_generic_log_message_compact(&msg, dropped, &entries);
+    result = whad_send_compact_message(&msg);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+
+    g_log_reported_dropped = dropped;
+    whad_log_rate_consume(size + WHAD_LOG_MSG_OVERHEAD);
+
+    /*
+     * Clear every sent word before handing them back to producers: a header
+     * reserved but not written yet may land on a former argument or timestamp,
+     * which must not look committed.
+     */
+    for (i=0; i<words; i++)
+    {
+        g_log_ring[(tail + i) & WHAD_LOG_RING_MASK] = 0;
+    }
+    __atomic_store_n(&g_log_tail, tail + words, __ATOMIC_RELEASE);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Get the number of log entries dropped since initialization.
+ *
+ * @return  Number of dropped entries.
+ **/
+
+uint32_t whad_log_get_dropped(void)
+{
+    return __atomic_load_n(&g_log_dropped, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * @brief   Read a little-endian log word.
+ *
+ * @param[in]   p_data  Pointer to the word
+ * @return  Word value.
+ **/
+
+static uint32_t whad_log_read_word(const uint8_t *p_data)
+{
+    return (uint32_t)p_data[0] | ((uint32_t)p_data[1] << 8) | ((uint32_t)p_data[2] << 16) |
+           ((uint32_t)p_data[3] << 24);
+}
+
+
+/**
+ * @brief   Read the next entry of a log message.
+ *
+ * @param[in]       p_entries   Pointer to the log entries (see `whad_generic_log_message_parse()`)
+ * @param[in]       size        Log entries size in bytes
+ * @param[in,out]   p_offset    Pointer to the offset of the entry to read, moved to the next entry
+ * @param[out]      p_entry     Pointer to a `whad_log_entry_t` structure
+ *
+ * @retval  WHAD_SUCCESS    Entry read.
+ * @retval  WHAD_NONE       No more entries.
+ * @retval  WHAD_ERROR      Invalid parameters or truncated entry.
+ **/
+
+whad_result_t whad_log_next_entry(const uint8_t *p_entries, int size, int *p_offset, whad_log_entry_t *p_entry)
+{
+    const uint8_t *p_words;
+    uint32_t header;
+    int count;
+    int nargs;
+    int i;
+
+    /* Sanity check. */
+    if ((p_offset == NULL) || (p_entry == NULL) || ((p_entries == NULL) && (size > 0)))
+    {
+        return WHAD_ERROR;
+    }
+
+    if (*p_offset >= size)
+    {
+        return WHAD_NONE;
+    }
+
+    p_words = &p_entries[*p_offset];
+    count = (size - *p_offset) / sizeof(uint32_t);
+    if (count < WHAD_LOG_ENTRY_HEADER_WORDS)
+    {
+        return WHAD_ERROR;
+    }
+
+    header = whad_log_read_word(p_words);
+    nargs = (header >> WHAD_LOG_NARGS_SHIFT) & WHAD_LOG_NARGS_MASK;
+    if ((nargs > WHAD_LOG_MAX_ARGS) || (count < (WHAD_LOG_ENTRY_HEADER_WORDS + nargs)))
+    {
+        return WHAD_ERROR;
+    }
+
+    p_entry->id = (uint16_t)(header & WHAD_LOG_ID_MASK);
+    p_entry->level = (whad_log_level_t)((header >> WHAD_LOG_LEVEL_SHIFT) & WHAD_LOG_LEVEL_MASK);
+    p_entry->timestamp = whad_log_read_word(&p_words[sizeof(uint32_t)]);
+    p_entry->nargs = nargs;
+    for (i=0; i<nargs; i++)
+    {
+        p_entry->args[i] = whad_log_read_word(&p_words[(WHAD_LOG_ENTRY_HEADER_WORDS + i) * sizeof(uint32_t)]);
+    }
+    *p_offset += (WHAD_LOG_ENTRY_HEADER_WORDS + nargs) * sizeof(uint32_t);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
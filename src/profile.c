@@ -0,0 +1,296 @@
+#include "whad.h"
+
+#if defined(__linux__) && !defined(__x86_64__) && !defined(__i386__)
+#include <time.h>
+#endif
+
+/* Debug level of profiling report messages. */
+#define WHAD_PROFILE_DEBUG_LEVEL    (0)
+
+/* Cortex-M debug registers. */
+#define WHAD_DEMCR                  (*(volatile uint32_t *)0xE000EDFC)
+#define WHAD_DEMCR_TRCENA           (1 << 24)
+#define WHAD_DWT_CTRL               (*(volatile uint32_t *)0xE0001000)
+#define WHAD_DWT_CTRL_CYCCNTENA     (1 << 0)
+#define WHAD_DWT_CYCCNT             (*(volatile uint32_t *)0xE0001004)
+
+static whad_profile_stats_t g_profile_stats[WHAD_PROFILE_STAGES];
+static whad_profile_counter_cb_t gpfn_profile_counter = NULL;
+
+static const char *g_profile_stage_names[WHAD_PROFILE_STAGES] = {
+    "build",
+    "encode",
+    "tx_push",
+    "send_pending",
+    "rx_push",
+    "get_message",
+    "decode",
+    "dispatch"
+};
+
+
+/**
+ * @brief   Default profiling counter.
+ *
+ * @return  DWT cycle counter on Cortex-M, TSC on x86 hosts, time in ns on
+ *          other Linux hosts, 0 if no counter is available.
+ **/
+
+static uint32_t whad_profile_default_counter(void)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+    return WHAD_DWT_CYCCNT;
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__builtin_ia32_rdtsc();
+#elif defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief   Append a string to a report line.
+ *
+ * @param[in]   p_line      Pointer to the end of the report line
+ * @param[in]   psz_text    String to append
+ * @return  Pointer to the new end of the report line.
+ **/
+
+static char *whad_profile_append(char *p_line, const char *psz_text)
+{
+    while (*psz_text != '\0')
+    {
+        *p_line++ = *psz_text++;
+    }
+    *p_line = '\0';
+
+    return p_line;
+}
+
+
+/**
+ * @brief   Append a decimal number to a report line.
+ *
+ * @param[in]   p_line      Pointer to the end of the report line
+ * @param[in]   value       Number to append
+ * @return  Pointer to the new end of the report line.
+ **/
+
+static char *whad_profile_append_number(char *p_line, uint32_t value)
+{
+    char digits[10];
+    int count = 0;
+
+    do
+    {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0)
+    {
+        *p_line++ = digits[--count];
+    }
+    *p_line = '\0';
+
+    return p_line;
+}
+
+
+/**
+ * @brief   Initialize profiling.
+ *
+ * Enables the DWT cycle counter on Cortex-M, selects the default profiling
+ * counter and resets statistics.
+ **/
+
+void whad_profile_init(void)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+    WHAD_DEMCR |= WHAD_DEMCR_TRCENA;
+    WHAD_DWT_CYCCNT = 0;
+    WHAD_DWT_CTRL |= WHAD_DWT_CTRL_CYCCNTENA;
+#endif
+
+    gpfn_profile_counter = whad_profile_default_counter;
+    whad_profile_reset();
+}
+
+
+/**
+ * @brief   Set the profiling counter.
+ *
+ * @param[in]   pfn_counter     Counter, free-running and wrapping at 2^32
+ **/
+
+void whad_profile_set_counter(whad_profile_counter_cb_t pfn_counter)
+{
+    gpfn_profile_counter = pfn_counter;
+}
+
+
+/**
+ * @brief   Reset profiling statistics.
+ **/
+
+void whad_profile_reset(void)
+{
+    int i;
+
+    for (i = 0; i < WHAD_PROFILE_STAGES; i++)
+    {
+        g_profile_stats[i].count = 0;
+        g_profile_stats[i].min = UINT32_MAX;
+        g_profile_stats[i].max = 0;
+        g_profile_stats[i].total = 0;
+    }
+}
+
+
+/**
+ * @brief   Read the profiling counter.
+ *
+ * @return  Counter value, 0 if profiling has not been initialized.
+ **/
+
+uint32_t whad_profile_now(void)
+{
+    if (gpfn_profile_counter == NULL)
+    {
+        return 0;
+    }
+
+    return gpfn_profile_counter();
+}
+
+
+/**
+ * @brief   Record a sample for a stage.
+ *
+ * @param[in]   stage   Profiled stage
+ * @param[in]   cycles  Duration of the stage, in profiling counter cycles
+ **/
+
+void whad_profile_record(whad_profile_stage_t stage, uint32_t cycles)
+{
+    whad_profile_stats_t *p_stats;
+
+    /* Sanity check. */
+    if ((unsigned int)stage >= WHAD_PROFILE_STAGES)
+    {
+        return;
+    }
+
+    p_stats = &g_profile_stats[stage];
+    p_stats->count++;
+    p_stats->total += cycles;
+    if (cycles < p_stats->min)
+    {
+        p_stats->min = cycles;
+    }
+    if (cycles > p_stats->max)
+    {
+        p_stats->max = cycles;
+    }
+}
+
+
+/**
+ * @brief   Get the statistics of a stage.
+ *
+ * @param[in]   stage       Profiled stage
+ * @param[out]  p_stats     Pointer to a `whad_profile_stats_t` structure
+ *
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Invalid stage or pointer.
+ * @retval  WHAD_NONE       No sample recorded for this stage.
+ **/
+
+whad_result_t whad_profile_get_stats(whad_profile_stage_t stage, whad_profile_stats_t *p_stats)
+{
+    /* Sanity check. */
+    if (((unsigned int)stage >= WHAD_PROFILE_STAGES) || (p_stats == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    *p_stats = g_profile_stats[stage];
+    if (p_stats->count == 0)
+    {
+        return WHAD_NONE;
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Get the name of a stage.
+ *
+ * @param[in]   stage   Profiled stage
+ * @return  Stage name, NULL if stage is invalid.
+ **/
+
+const char *whad_profile_get_stage_name(whad_profile_stage_t stage)
+{
+    if ((unsigned int)stage >= WHAD_PROFILE_STAGES)
+    {
+        return NULL;
+    }
+
+    return g_profile_stage_names[stage];
+}
+
+
+/**
+ * @brief   Send profiling statistics to the host.
+ *
+ * Sends a generic debug message for each stage having samples, formatted as
+ * "<stage>: n=<count> min=<min> avg=<avg> max=<max>" (in profiling counter
+ * cycles).
+ *
+ * @retval  WHAD_SUCCESS    Report queued for transmission.
+ * @retval  WHAD_ERROR      Report could not be queued.
+ **/
+
+whad_result_t whad_profile_send_report(void)
+{
+    whad_compact_msg_t message;
+    whad_profile_stats_t stats;
+    char line[96];
+    char *p_line;
+    int i;
+
+    for (i = 0; i < WHAD_PROFILE_STAGES; i++)
+    {
+        if (whad_profile_get_stats((whad_profile_stage_t)i, &stats) != WHAD_SUCCESS)
+        {
+            continue;
+        }
+
+        p_line = whad_profile_append(line, g_profile_stage_names[i]);
+        p_line = whad_profile_append(p_line, ": n=");
+        p_line = whad_profile_append_number(p_line, stats.count);
+        p_line = whad_profile_append(p_line, " min=");
+        p_line = whad_profile_append_number(p_line, stats.min);
+        p_line = whad_profile_append(p_line, " avg=");
+        p_line = whad_profile_append_number(p_line, (uint32_t)(stats.total / stats.count));
+        p_line = whad_profile_append(p_line, " max=");
+        whad_profile_append_number(p_line, stats.max);
+
+        whad_generic_debug_message_compact(&message, WHAD_PROFILE_DEBUG_LEVEL, line);
+        if (whad_send_compact_message(&message) != WHAD_SUCCESS)
+        {
+            return WHAD_ERROR;
+        }
+    }
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
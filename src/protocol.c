@@ -0,0 +1,21 @@
+#include "protocol.h"
+
+/* Empty descriptors of the disabled domains stand-ins (see protocol.h). */
+#if !WHAD_ENABLE_BLE
+PB_BIND(ble_Message, ble_Message, AUTO)
+#endif
+#if !WHAD_ENABLE_DOT15D4
+PB_BIND(dot15d4_Message, dot15d4_Message, AUTO)
+#endif
+#if !WHAD_ENABLE_ESB
+PB_BIND(esb_Message, esb_Message, AUTO)
+#endif
+#if !WHAD_ENABLE_UNIFYING
+PB_BIND(unifying_Message, unifying_Message, AUTO)
+#endif
+#if !WHAD_ENABLE_PHY
+PB_BIND(phy_Message, phy_Message, AUTO)
+#endif
+
+/* `Message` descriptor, bound against the stand-ins. */
+#include "../whad/protocol/whad.pb.c"
@@ -47,8 +47,8 @@ whad_result_t whad_ringbuf_push(whad_ringbuf_t *p_ringbuf, uint8_t data)
 {
     int new_head;
 
-    /* Do we have enough space ? */
-    if (whad_ringbuf_get_free_size(p_ringbuf) >= 1)
+    /* Do we have enough space ? Keep one byte free, a full ring buffer would look empty. */
+    if (whad_ringbuf_get_free_size(p_ringbuf) > 1)
     {
         /* Update head and save data. */
         new_head = (p_ringbuf->head + 1)%WHAD_RINGBUF_MAX_SIZE;
@@ -63,6 +63,54 @@ whad_result_t whad_ringbuf_push(whad_ringbuf_t *p_ringbuf, uint8_t data)
 }
 
 
+/**
+ * @brief   Push a buffer into a ring buffer.
+ *
+ * The whole buffer is pushed, or nothing if the ring buffer cannot hold it.
+ *
+ * @param   p_ringbuf   Pointer to a `whad_ringbuf_t` structure.
+ * @param   p_data      Pointer to the data to save into the ring buffer.
+ * @param   size        Number of bytes to save into the ring buffer.
+ * @return  WHAD_SUCCESS on success, WHAD_RINGBUF_FULL if buffer has not enough free space.
+ */
+
+whad_result_t whad_ringbuf_push_buffer(whad_ringbuf_t *p_ringbuf, uint8_t *p_data, int size)
+{
+    int fh=0, sh=0;
+
+    /* Keep one byte free, a full ring buffer would look empty. */
+    if (size > (whad_ringbuf_get_free_size(p_ringbuf) - 1))
+        return WHAD_RINGBUF_FULL;
+
+    /* Determine first and second halves. */
+    if ((p_ringbuf->head + size) > WHAD_RINGBUF_MAX_SIZE)
+    {
+        fh = (WHAD_RINGBUF_MAX_SIZE - p_ringbuf->head);
+        sh = size - fh;
+    }
+    else
+    {
+        fh = size;
+    }
+
+    /* Copy data. */
+    if (fh > 0)
+    {
+        memcpy(&p_ringbuf->data[p_ringbuf->head], p_data, fh);
+    }
+    if (sh > 0)
+    {
+        memcpy(&p_ringbuf->data[0], &p_data[fh], sh);
+    }
+
+    /* Update head. */
+    p_ringbuf->head = (p_ringbuf->head + size) % WHAD_RINGBUF_MAX_SIZE;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
 /**
  * @brief   Retrieve data from a ring buffer.
  * @param   p_ringbuf   Pointer to a `whad_ringbuf_t` structure.
@@ -0,0 +1,429 @@
+#include "whad.h"
+
+/**
+ * Template reader state, used to decode a template and its payload as a
+ * single stream.
+ */
+
+typedef struct {
+    whad_template_t *p_template;
+    uint8_t *p_payload;
+    int length;
+    int offset;
+} whad_template_reader_t;
+
+
+/**
+ * @brief   Append a field key and a value slot to a template.
+ *
+ * @param[in,out]   p_template  Pointer to a template
+ * @param[in]       tag         Field tag
+ * @param[in]       wire_type   Field wire type
+ * @param[in]       width       Width of the value slot in bytes
+ * @return          Offset of the value slot, -1 if template is too small.
+ */
+
+static int whad_template_append_slot(whad_template_t *p_template, uint32_t tag, pb_wire_type_t wire_type, int width)
+{
+    int offset;
+
+    /* Key (10 bytes max) and value must fit in our skeleton. */
+    if ((p_template->size + 10 + width) > WHAD_TEMPLATE_MAX_SIZE)
+    {
+        return -1;
+    }
+
+    /* Write key. */
+    p_template->size += whad_wire_write_varint(&p_template->skeleton[p_template->size],
+                                               (tag << 3) | wire_type, 0);
+
+    /* Reserve slot (zero value). */
+    offset = p_template->size;
+    p_template->size += whad_wire_write_varint(&p_template->skeleton[offset], 0, width);
+
+    return offset;
+}
+
+
+/**
+ * @brief   Template stream reader callback (NanoPb input stream).
+ *
+ * @param[in,out]   stream  Input stream
+ * @param[out]      buf     Output buffer
+ * @param[in]       count   Number of bytes to read
+ * @return true if everything went ok, false otherwise.
+ */
+
+static bool whad_template_read_cb(pb_istream_t *stream, pb_byte_t *buf, size_t count)
+{
+    whad_template_reader_t *p_reader = (whad_template_reader_t *)stream->state;
+    int size = p_reader->p_template->size;
+    size_t i;
+
+    for (i=0; i<count; i++)
+    {
+        if (p_reader->offset < size)
+        {
+            buf[i] = p_reader->p_template->skeleton[p_reader->offset];
+        }
+        else if (p_reader->offset < (size + p_reader->length))
+        {
+            buf[i] = p_reader->p_payload[p_reader->offset - size];
+        }
+        else
+        {
+            return false;
+        }
+        p_reader->offset++;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief   Patch frame and fields lengths for a given payload size.
+ *
+ * @param[in,out]   p_template  Pointer to a template
+ * @param[in]       length      Payload size in bytes
+ */
+
+static void whad_template_patch_lengths(whad_template_t *p_template, int length)
+{
+    int total = p_template->size + length;
+
+    /* Transport header. */
+    p_template->skeleton[2] = ((total - 4) & 0xff);
+    p_template->skeleton[3] = ((total - 4) >> 8) & 0xff;
+
+    /* Wrapping fields and payload lengths. */
+    whad_wire_write_varint(&p_template->skeleton[p_template->message_len_offset],
+                           total - (p_template->message_len_offset + WHAD_TEMPLATE_LENGTH_WIDTH),
+                           WHAD_TEMPLATE_LENGTH_WIDTH);
+    whad_wire_write_varint(&p_template->skeleton[p_template->submsg_len_offset],
+                           total - (p_template->submsg_len_offset + WHAD_TEMPLATE_LENGTH_WIDTH),
+                           WHAD_TEMPLATE_LENGTH_WIDTH);
+    whad_wire_write_varint(&p_template->skeleton[p_template->payload_len_offset],
+                           length, WHAD_TEMPLATE_LENGTH_WIDTH);
+}
+
+
+/**
+ * @brief   Initialize a notification template.
+ *
+ * Encodes the transport header, the `Message` and domain message wrapping
+ * fields (with fixed-width length slots) and the constant fields of the
+ * notification. Scalar slots and the payload field must then be added with
+ * `whad_template_add_slot()` and `whad_template_set_payload()`.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       which_msg       `Message` oneof tag (domain)
+ * @param[in]       which_submsg    Domain message oneof tag
+ * @param[in]       p_fields        NanoPb descriptor of the notification
+ * @param[in]       p_constants     Pointer to a notification structure holding the constant fields,
+ *                                  changing fields must be left to their default value.
+ *
+ * @retval          WHAD_SUCCESS    Success.
+ * @retval          WHAD_ERROR      Invalid pointer or constant fields too large.
+ */
+
+whad_result_t whad_template_init(whad_template_t *p_template, pb_size_t which_msg, pb_size_t which_submsg,
+                                 const pb_msgdesc_t *p_fields, const void *p_constants)
+{
+    pb_ostream_t stream;
+    int i;
+
+    /* Sanity check. */
+    if ((p_template == NULL) || (p_fields == NULL) || (p_constants == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* No slot defined. */
+    for (i=0; i<WHAD_TEMPLATE_SLOT_MAX; i++)
+    {
+        p_template->slot_offset[i] = -1;
+        p_template->slot_width[i] = 0;
+    }
+    p_template->payload_len_offset = -1;
+    p_template->payload_max_size = 0;
+
+    /* Transport header, length is patched when sending. */
+    p_template->skeleton[0] = 0xAC;
+    p_template->skeleton[1] = 0xBE;
+    p_template->skeleton[2] = 0;
+    p_template->skeleton[3] = 0;
+    p_template->size = 4;
+
+    /* Wrapping fields. */
+    p_template->message_len_offset = whad_template_append_slot(p_template, which_msg, PB_WT_STRING,
+                                                               WHAD_TEMPLATE_LENGTH_WIDTH);
+    p_template->submsg_len_offset = whad_template_append_slot(p_template, which_submsg, PB_WT_STRING,
+                                                              WHAD_TEMPLATE_LENGTH_WIDTH);
+
+    /* Constant fields. */
+    stream = pb_ostream_from_buffer(&p_template->skeleton[p_template->size],
+                                    WHAD_TEMPLATE_MAX_SIZE - p_template->size);
+    if (!pb_encode(&stream, p_fields, p_constants))
+    {
+        return WHAD_ERROR;
+    }
+    p_template->size += stream.bytes_written;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Add a scalar slot to a template.
+ *
+ * The corresponding field must not be part of the constant fields.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       slot            Slot to add
+ * @param[in]       tag             Field tag
+ * @param[in]       width           Slot width in bytes (see `WHAD_TEMPLATE_*_WIDTH`)
+ *
+ * @retval          WHAD_SUCCESS    Success.
+ * @retval          WHAD_ERROR      Invalid parameter, payload already set or template too small.
+ */
+
+whad_result_t whad_template_add_slot(whad_template_t *p_template, whad_template_slot_t slot, uint32_t tag, int width)
+{
+    int offset;
+
+    /* Sanity check. */
+    if ((p_template == NULL) || (slot >= WHAD_TEMPLATE_SLOT_MAX) || (width <= 0) || (width > 10))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Payload must be the last field. */
+    if (p_template->payload_len_offset >= 0)
+    {
+        return WHAD_ERROR;
+    }
+
+    offset = whad_template_append_slot(p_template, tag, PB_WT_VARINT, width);
+    if (offset < 0)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Save slot. */
+    p_template->slot_offset[slot] = offset;
+    p_template->slot_width[slot] = width;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Set the payload field of a template.
+ *
+ * This terminates the template, no more slot can be added.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       tag             Payload field tag
+ * @param[in]       max_size        Maximum payload size allowed by the protocol
+ *
+ * @retval          WHAD_SUCCESS    Success.
+ * @retval          WHAD_ERROR      Invalid parameter or template too small.
+ */
+
+whad_result_t whad_template_set_payload(whad_template_t *p_template, uint32_t tag, int max_size)
+{
+    /* Sanity check. */
+    if ((p_template == NULL) || (max_size <= 0) || (p_template->payload_len_offset >= 0))
+    {
+        return WHAD_ERROR;
+    }
+
+    p_template->payload_len_offset = whad_template_append_slot(p_template, tag, PB_WT_STRING,
+                                                               WHAD_TEMPLATE_LENGTH_WIDTH);
+    if (p_template->payload_len_offset < 0)
+    {
+        return WHAD_ERROR;
+    }
+    p_template->payload_max_size = max_size;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Patch an unsigned 32-bit slot.
+ *
+ * Slots that are not part of the template are ignored.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       slot            Slot to patch
+ * @param[in]       value           Slot value
+ */
+
+void whad_template_set_uint32(whad_template_t *p_template, whad_template_slot_t slot, uint32_t value)
+{
+    if (p_template->slot_offset[slot] >= 0)
+    {
+        whad_wire_write_varint(&p_template->skeleton[p_template->slot_offset[slot]],
+                               value, p_template->slot_width[slot]);
+    }
+}
+
+
+/**
+ * @brief   Patch a signed 32-bit slot.
+ *
+ * Negative values are sign-extended to 64 bits as required by protobuf, the
+ * slot must be `WHAD_TEMPLATE_INT32_WIDTH` bytes wide.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       slot            Slot to patch
+ * @param[in]       value           Slot value
+ */
+
+void whad_template_set_int32(whad_template_t *p_template, whad_template_slot_t slot, int32_t value)
+{
+    if (p_template->slot_offset[slot] >= 0)
+    {
+        whad_wire_write_varint(&p_template->skeleton[p_template->slot_offset[slot]],
+                               (uint64_t)(int64_t)value, p_template->slot_width[slot]);
+    }
+}
+
+
+/**
+ * @brief   Patch an unsigned 64-bit slot.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       slot            Slot to patch
+ * @param[in]       value           Slot value
+ */
+
+void whad_template_set_uint64(whad_template_t *p_template, whad_template_slot_t slot, uint64_t value)
+{
+    if (p_template->slot_offset[slot] >= 0)
+    {
+        whad_wire_write_varint(&p_template->skeleton[p_template->slot_offset[slot]],
+                               value, p_template->slot_width[slot]);
+    }
+}
+
+
+/**
+ * @brief   Patch a boolean slot.
+ *
+ * @param[in,out]   p_template      Pointer to a template
+ * @param[in]       slot            Slot to patch
+ * @param[in]       value           Slot value
+ */
+
+void whad_template_set_bool(whad_template_t *p_template, whad_template_slot_t slot, bool value)
+{
+    if (p_template->slot_offset[slot] >= 0)
+    {
+        whad_wire_write_varint(&p_template->skeleton[p_template->slot_offset[slot]],
+                               value ? 1 : 0, p_template->slot_width[slot]);
+    }
+}
+
+
+/**
+ * @brief   Send a notification based on a template.
+ *
+ * Lengths are patched for the given payload, then the template and the
+ * payload are queued for transmission.
+ *
+ * @param[in,out]   p_template          Pointer to a template
+ * @param[in]       p_payload           Pointer to the payload
+ * @param[in]       length              Payload size in bytes
+ *
+ * @retval          WHAD_SUCCESS        Notification queued for transmission.
+ * @retval          WHAD_ERROR          Invalid parameter or incomplete template.
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer.
+ */
+
+whad_result_t whad_template_send(whad_template_t *p_template, uint8_t *p_payload, int length)
+{
+    whad_result_t result;
+    WHAD_PROFILE_START(start);
+
+    /* Sanity check. */
+    if ((p_template == NULL) || (p_payload == NULL) || (p_template->payload_len_offset < 0))
+    {
+        return WHAD_ERROR;
+    }
+
+    if ((length < 0) || (length > p_template->payload_max_size))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Patch lengths and queue our frame. */
+    whad_template_patch_lengths(p_template, length);
+    result = whad_transport_send_frame(p_template->skeleton, p_template->size, p_payload, length);
+    WHAD_PROFILE_STOP(WHAD_PROFILE_ENCODE, start);
+
+    return result;
+}
+
+
+/**
+ * @brief   Decode a template-based notification with NanoPb.
+ *
+ * This function is intended for validation purpose: it decodes the exact
+ * bytes `whad_template_send()` would queue with the generic NanoPb decoder,
+ * allowing to compare the result with the equivalent `Message` builder.
+ *
+ * @param[in,out]   p_template          Pointer to a template
+ * @param[in]       p_payload           Pointer to the payload
+ * @param[in]       length              Payload size in bytes
+ * @param[out]      p_message           Pointer to a `Message` structure to decode into
+ *
+ * @retval          WHAD_SUCCESS        Notification successfully decoded.
+ * @retval          WHAD_ERROR          Invalid parameter or decoding error.
+ */
+
+whad_result_t whad_template_check(whad_template_t *p_template, uint8_t *p_payload, int length, Message *p_message)
+{
+    whad_template_reader_t reader;
+    pb_istream_t stream;
+
+    /* Sanity check. */
+    if ((p_template == NULL) || (p_payload == NULL) || (p_message == NULL) || (p_template->payload_len_offset < 0))
+    {
+        return WHAD_ERROR;
+    }
+
+    if ((length < 0) || (length > p_template->payload_max_size))
+    {
+        return WHAD_ERROR;
+    }
+
+    whad_template_patch_lengths(p_template, length);
+
+    /* Decode frame content (skip transport header). */
+    reader.p_template = p_template;
+    reader.p_payload = p_payload;
+    reader.length = length;
+    reader.offset = 4;
+
+    stream.callback = whad_template_read_cb;
+    stream.state = &reader;
+    stream.bytes_left = (p_template->skeleton[2] | (p_template->skeleton[3] << 8));
+#ifndef PB_NO_ERRMSG
+    stream.errmsg = NULL;
+#endif
+
+    if (pb_decode(&stream, Message_fields, p_message) && (stream.bytes_left == 0))
+    {
+        /* Success. */
+        return WHAD_SUCCESS;
+    }
+
+    /* Decoding error. */
+    return WHAD_ERROR;
+}
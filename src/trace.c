@@ -0,0 +1,222 @@
+#include "whad.h"
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+static whad_trace_clock_cb_t gpfn_trace_clock = NULL;
+static uint32_t g_trace_sequence = 0;
+static uint32_t g_trace_capture_time = 0;
+static bool g_trace_capture_time_set = false;
+
+/* Frame being queued. */
+static whad_trace_info_t g_trace_frame;
+
+
+/**
+ * @brief   Default trace clock.
+ *
+ * @return  Monotonic time in us on Linux hosts, 0 otherwise.
+ **/
+
+static uint32_t whad_trace_default_clock(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL));
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief   Initialize tracing.
+ *
+ * Selects the default trace clock, unless a clock has already been set, and
+ * resets the sequence number. Called by `whad_init()` when tracing is enabled.
+ **/
+
+void whad_trace_init(void)
+{
+    if (gpfn_trace_clock == NULL)
+    {
+        gpfn_trace_clock = whad_trace_default_clock;
+    }
+    g_trace_sequence = 0;
+    g_trace_capture_time_set = false;
+}
+
+
+/**
+ * @brief   Set the trace clock.
+ *
+ * @param[in]   pfn_clock   Clock returning a time in us, free-running and wrapping at 2^32
+ **/
+
+void whad_trace_set_clock(whad_trace_clock_cb_t pfn_clock)
+{
+    gpfn_trace_clock = pfn_clock;
+}
+
+
+/**
+ * @brief   Read the trace clock.
+ *
+ * @return  Time in us, 0 if tracing has not been initialized.
+ **/
+
+uint32_t whad_trace_now(void)
+{
+    if (gpfn_trace_clock == NULL)
+    {
+        return 0;
+    }
+
+    return gpfn_trace_clock();
+}
+
+
+/**
+ * @brief   Set the capture time of the next traced frame.
+ *
+ * Called by the firmware with the time of the radio event (e.g. the RX
+ * timestamp of a packet) before sending its notification. Frames sent without
+ * a capture time use their queuing time.
+ *
+ * @param[in]   timestamp   Radio event time, in us of the trace clock
+ **/
+
+void whad_trace_set_capture_time(uint32_t timestamp)
+{
+    g_trace_capture_time = timestamp;
+    g_trace_capture_time_set = true;
+}
+
+
+/**
+ * @brief   Start tracing a frame about to be queued.
+ *
+ * Records the queuing time and the TX ring buffer backlog, must be called
+ * before the frame header is queued.
+ **/
+
+void whad_trace_frame_start(void)
+{
+    g_trace_frame.sequence = g_trace_sequence;
+    g_trace_frame.queued_time = whad_trace_now();
+    g_trace_frame.capture_time = g_trace_capture_time_set ? g_trace_capture_time : g_trace_frame.queued_time;
+    g_trace_frame.backlog = (uint32_t)whad_transport_get_txbuf_size();
+    g_trace_capture_time_set = false;
+}
+
+
+/**
+ * @brief   Write the trace extension of the frame being queued.
+ *
+ * Writes exactly `WHAD_TRACE_EXTENSION_SIZE` bytes and moves to the next
+ * sequence number.
+ *
+ * @param[in,out]   p_writer    Pointer to a writer
+ **/
+
+void whad_trace_put_extension(whad_wire_writer_t *p_writer)
+{
+    whad_wire_put_key(p_writer, WHAD_TRACE_FIELD_TAG, PB_WT_STRING);
+    whad_wire_put_varint(p_writer, WHAD_TRACE_EXTENSION_SIZE - 3);
+    whad_wire_put_fixed32_field(p_writer, WHAD_TRACE_SEQUENCE_TAG, g_trace_frame.sequence);
+    whad_wire_put_fixed32_field(p_writer, WHAD_TRACE_CAPTURE_TIME_TAG, g_trace_frame.capture_time);
+    whad_wire_put_fixed32_field(p_writer, WHAD_TRACE_QUEUED_TIME_TAG, g_trace_frame.queued_time);
+    whad_wire_put_fixed32_field(p_writer, WHAD_TRACE_BACKLOG_TAG, g_trace_frame.backlog);
+
+    g_trace_sequence++;
+}
+
+
+/**
+ * @brief   Read the trace extension of a received message.
+ *
+ * Scans the top-level fields of a serialized `Message` for the trace
+ * extension, without decoding the message itself.
+ *
+ * @param[in]   p_message   Pointer to the serialized message
+ * @param[in]   size        Serialized message size in bytes
+ * @param[out]  p_info      Pointer to a `whad_trace_info_t` structure
+ *
+ * @retval  WHAD_SUCCESS    Trace extension found.
+ * @retval  WHAD_NONE       Message is not traced.
+ * @retval  WHAD_ERROR      Invalid parameters or malformed message.
+ **/
+
+whad_result_t whad_trace_parse(const uint8_t *p_message, int size, whad_trace_info_t *p_info)
+{
+    whad_wire_reader_t reader, extension;
+    pb_wire_type_t wire_type;
+    uint8_t *p_extension;
+    int extension_size;
+    uint32_t tag;
+    uint32_t *p_value;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_info == NULL) || (size < 0))
+    {
+        return WHAD_ERROR;
+    }
+
+    whad_wire_reader_init(&reader, p_message, size);
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type))
+        {
+            return WHAD_ERROR;
+        }
+
+        if (tag != WHAD_TRACE_FIELD_TAG)
+        {
+            if (!whad_wire_skip_field(&reader, wire_type))
+            {
+                return WHAD_ERROR;
+            }
+            continue;
+        }
+
+        if (!whad_wire_get_bytes(&reader, wire_type, &p_extension, &extension_size))
+        {
+            return WHAD_ERROR;
+        }
+
+        /* Read trace subfields, ignoring unknown ones. */
+        memset(p_info, 0, sizeof(whad_trace_info_t));
+        whad_wire_reader_init(&extension, p_extension, extension_size);
+        while (extension.offset < extension.size)
+        {
+            if (!whad_wire_get_key(&extension, &tag, &wire_type))
+            {
+                return WHAD_ERROR;
+            }
+
+            switch (tag)
+            {
+                case WHAD_TRACE_SEQUENCE_TAG: p_value = &p_info->sequence; break;
+                case WHAD_TRACE_CAPTURE_TIME_TAG: p_value = &p_info->capture_time; break;
+                case WHAD_TRACE_QUEUED_TIME_TAG: p_value = &p_info->queued_time; break;
+                case WHAD_TRACE_BACKLOG_TAG: p_value = &p_info->backlog; break;
+                default: p_value = NULL; break;
+            }
+
+            if ((p_value != NULL) ? !whad_wire_get_fixed32(&extension, wire_type, p_value) :
+                                    !whad_wire_skip_field(&extension, wire_type))
+            {
+                return WHAD_ERROR;
+            }
+        }
+
+        /* Success. */
+        return WHAD_SUCCESS;
+    }
+
+    /* Not traced. */
+    return WHAD_NONE;
+}
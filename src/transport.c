@@ -1,7 +1,7 @@
 #include "transport.h"
 
 static whad_transport_t gw_transport;
-static uint8_t tx_buf[WHAD_RINGBUF_MAX_SIZE];
+static uint8_t tx_buf[WHAD_TX_CHUNK_MAX_SIZE];
 
 
 /**
@@ -12,9 +12,6 @@ static uint8_t tx_buf[WHAD_RINGBUF_MAX_SIZE];
 
 void whad_transport_init(whad_transport_cfg_t *p_transport_cfg)
 {
-    /* Initialiaze protobuf message. */
-    memset(&gw_transport.msg, 0, sizeof(Message));
-
     /* Initialize RX and TX ring buffers. */
     whad_ringbuf_init(&gw_transport.rx_buf);
     whad_ringbuf_init(&gw_transport.tx_buf);
@@ -25,6 +22,14 @@ void whad_transport_init(whad_transport_cfg_t *p_transport_cfg)
 
     /* Set state to idle. */
     gw_transport.state = WHAD_TRANSPORT_IDLE;
+
+    /* No message being received. */
+    gw_transport.rx_frame_size = 0;
+    gw_transport.rx_frame_offset = 0;
+    gw_transport.rx_discard_size = 0;
+
+    /* No message being streamed. */
+    gw_transport.tx_stream_size = 0;
 }
 
 
@@ -43,16 +48,20 @@ void whad_transport_init(whad_transport_cfg_t *p_transport_cfg)
 whad_result_t whad_transport_data_received(uint8_t *p_data, int size)
 {
     int i;
+    WHAD_PROFILE_START(start);
 
     /* Enqueue data in RX buffer. */
     for (i=0; i<size; i++)
     {
         if (whad_ringbuf_push(&gw_transport.rx_buf, p_data[i]) == WHAD_RINGBUF_FULL)
         {
+            WHAD_PROFILE_STOP(WHAD_PROFILE_RX_PUSH, start);
             return WHAD_RINGBUF_FULL;
         }
     }
 
+    WHAD_PROFILE_STOP(WHAD_PROFILE_RX_PUSH, start);
+
     /* Success. */
     return WHAD_SUCCESS;
 }
@@ -88,8 +97,14 @@ whad_result_t whad_transport_send_pending(void)
                 /* Cap buf_size to max_txbuf_size. */
                 buf_size = gw_transport.config.max_txbuf_size;
             }
+            if (buf_size > WHAD_TX_CHUNK_MAX_SIZE)
+            {
+                /* Cap buf_size to our send buffer size. */
+                buf_size = WHAD_TX_CHUNK_MAX_SIZE;
+            }
 
             /* Read buffer from TX queue. */
+            WHAD_PROFILE_START(start);
             if (whad_ringbuf_copy(&gw_transport.tx_buf, tx_buf, buf_size) == WHAD_SUCCESS)
             {
                 /* Send it through UART. */
@@ -98,6 +113,7 @@ whad_result_t whad_transport_send_pending(void)
 
                 /* Skip sent bytes. */
                 whad_ringbuf_skip(&gw_transport.tx_buf, buf_size);
+                WHAD_PROFILE_STOP(WHAD_PROFILE_SEND_PENDING, start);
             }
             else
                 return WHAD_ERROR;
@@ -114,20 +130,41 @@ whad_result_t whad_transport_send_pending(void)
  * @brief Retrieve a WHAD message from RX queue, if any
  * 
  * This function must be called regularly to handle incoming WHAD
- * messages.
+ * messages. Messages larger than the RX ring buffer are reassembled in
+ * the destination buffer as their bytes are received, so the same buffer
+ * must be provided until a message is returned. Messages larger than the
+ * destination buffer are discarded.
  * 
  * @param   p_buffer  Pointer to a buffer large enough to receive data
- * @param   p_size    Pointer to an integer specifying the size of the destination buffer
- * @returns WHAD_SUCCESS on success, WHAD_ERROR otherwise.
+ * @param   p_size    Pointer to an integer specifying the size of the destination buffer,
+ *                    set to the received message size (0 if none)
+ * @retval  WHAD_SUCCESS    Success.
+ * @retval  WHAD_ERROR      Message too large for the destination buffer, `p_size` is set to
+ *                          its size and the message is discarded.
  */
 
 whad_result_t whad_transport_get_message(uint8_t *p_buffer, int *p_size)
 {
     uint8_t header[4];
     uint16_t size;
+    int chunk;
+    WHAD_PROFILE_START(start);
 
-    /* Check if we have a complete message. */
-    if (whad_ringbuf_get_size(&gw_transport.rx_buf) >= 4)
+    /* Drop remaining bytes of a discarded message, if any. */
+    if (gw_transport.rx_discard_size > 0)
+    {
+        chunk = whad_ringbuf_get_size(&gw_transport.rx_buf);
+        if (chunk > gw_transport.rx_discard_size)
+        {
+            chunk = gw_transport.rx_discard_size;
+        }
+        whad_ringbuf_skip(&gw_transport.rx_buf, chunk);
+        gw_transport.rx_discard_size -= chunk;
+    }
+
+    /* Look for a message header, if no message is being received. */
+    while ((gw_transport.rx_discard_size == 0) && (gw_transport.rx_frame_size == 0) &&
+           (whad_ringbuf_get_size(&gw_transport.rx_buf) >= 4))
     {
         /* Parse header. */
         if (whad_ringbuf_copy(&gw_transport.rx_buf, header, 4) == WHAD_ERROR)
@@ -139,33 +176,27 @@ whad_result_t whad_transport_get_message(uint8_t *p_buffer, int *p_size)
         /* Check magic */
         if ((header[0] == 0xAC) && (header[1] == 0xBE))
         {
-            /* Best case scenario, deduce size and build message. */
+            /* Best case scenario, deduce size and start receiving message. */
             size = header[2] | (header[3] << 8);
+            whad_ringbuf_skip(&gw_transport.rx_buf, 4);
 
             /* Ensure our destination buffer is large enough. */
-            if (*p_size >= size)
-            {
-                /* Do we have a complete message ? */
-                if (whad_ringbuf_get_size(&gw_transport.rx_buf) >= (size + 4))
-                {
-                    /* We have enough, extract message (skip header). */
-                    whad_ringbuf_skip(&gw_transport.rx_buf, 4);
-                    whad_ringbuf_copy(&gw_transport.rx_buf, p_buffer, size);
-                    whad_ringbuf_skip(&gw_transport.rx_buf, size);
-
-                    /* Return message size. */
-                    *p_size = size;
-
-                    /* Success. */
-                    return WHAD_SUCCESS;
-                }
-            }
-            else
+            if (*p_size < size)
             {
-                /* Provide the expected buffer size. */
+                /* Discard this message and provide the expected buffer size. */
+                gw_transport.rx_discard_size = size;
                 *p_size = size;
                 return WHAD_ERROR;
             }
+
+            gw_transport.rx_frame_size = size;
+            gw_transport.rx_frame_offset = 0;
+
+            /* Empty messages carry nothing to process. */
+            if (size == 0)
+            {
+                break;
+            }
         }
         else if (header[1] == 0xAC) {
             whad_ringbuf_skip(&gw_transport.rx_buf, 1);
@@ -176,44 +207,236 @@ whad_result_t whad_transport_get_message(uint8_t *p_buffer, int *p_size)
         }
     }
 
+    /* Move received bytes of the current message into the destination buffer. */
+    if (gw_transport.rx_frame_size > 0)
+    {
+        chunk = whad_ringbuf_get_size(&gw_transport.rx_buf);
+        if (chunk > (gw_transport.rx_frame_size - gw_transport.rx_frame_offset))
+        {
+            chunk = gw_transport.rx_frame_size - gw_transport.rx_frame_offset;
+        }
+        whad_ringbuf_copy(&gw_transport.rx_buf, &p_buffer[gw_transport.rx_frame_offset], chunk);
+        whad_ringbuf_skip(&gw_transport.rx_buf, chunk);
+        gw_transport.rx_frame_offset += chunk;
+
+        /* Do we have a complete message ? */
+        if (gw_transport.rx_frame_offset == gw_transport.rx_frame_size)
+        {
+            /* Return message size. */
+            *p_size = gw_transport.rx_frame_size;
+            gw_transport.rx_frame_size = 0;
+            WHAD_PROFILE_STOP(WHAD_PROFILE_GET_MESSAGE, start);
+
+            /* Success. */
+            return WHAD_SUCCESS;
+        }
+    }
+
     /* Nothing to process. */
     *p_size = 0;
     return WHAD_SUCCESS;
 }
 
-whad_result_t whad_transport_send_message(uint8_t *p_message, int size)
+
+/**
+ * @brief   Write bytes into the TX buffer.
+ *
+ * Bytes are queued all at once, or not at all if the TX buffer cannot hold
+ * them. Bytes of a message larger than the TX buffer (see
+ * `whad_transport_send_header()`) are the only exception: they are streamed
+ * through it, pending bytes being sent and this function busy-waiting for the
+ * ongoing transmission to end whenever it is full. Messages are encoded
+ * straight into the TX buffer, so the stream cannot be suspended and resumed
+ * on a later call.
+ *
+ * Streaming therefore requires `whad_transport_data_sent()` to be called from
+ * an interrupt handler or from the send callback itself: if it is only
+ * called from the main loop, this function never returns. Such firmwares must
+ * keep their messages smaller than WHAD_RINGBUF_MAX_SIZE (minus the 4-byte
+ * header), or send them from a context that can be preempted by the end of
+ * transmission.
+ *
+ * @param   p_data      Pointer to the bytes to send
+ * @param   size        Number of bytes to send
+ * @retval  WHAD_SUCCESS        All bytes have been queued.
+ * @retval  WHAD_RINGBUF_FULL   Not enough space in TX buffer, bytes not queued.
+ */
+
+whad_result_t whad_transport_write(uint8_t *p_data, int size)
 {
-    uint8_t header[4];
-    int nb_bytes_sent;
+    int chunk;
+    WHAD_PROFILE_START(start);
 
-    if (size == 0)
+    /* Queue bytes at once if they fit. */
+    if (whad_ringbuf_push_buffer(&gw_transport.tx_buf, p_data, size) == WHAD_SUCCESS)
+    {
+        if (gw_transport.tx_stream_size > 0)
+        {
+            gw_transport.tx_stream_size -= size;
+        }
+        WHAD_PROFILE_STOP(WHAD_PROFILE_TX_PUSH, start);
         return WHAD_SUCCESS;
+    }
+
+    /* Only the message being streamed may wait for free space. */
+    if (size > gw_transport.tx_stream_size)
+    {
+        WHAD_PROFILE_STOP(WHAD_PROFILE_TX_PUSH, start);
+        return WHAD_RINGBUF_FULL;
+    }
+    gw_transport.tx_stream_size -= size;
+
+    while (size > 0)
+    {
+        /* Queue as many bytes as our TX buffer can hold (keeping one byte free). */
+        chunk = whad_ringbuf_get_free_size(&gw_transport.tx_buf) - 1;
+        if (chunk > size)
+        {
+            chunk = size;
+        }
+
+        if (chunk > 0)
+        {
+            whad_ringbuf_push_buffer(&gw_transport.tx_buf, p_data, chunk);
+            p_data += chunk;
+            size -= chunk;
+        }
+        else
+        {
+            /* Send pending bytes (fails while a transmission is ongoing). */
+            whad_transport_send_pending();
+        }
+    }
+
+    WHAD_PROFILE_STOP(WHAD_PROFILE_TX_PUSH, start);
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief   Queue a transport header announcing a message of a given size.
+ *
+ * The message itself must then be queued with `whad_transport_write()`. The
+ * header is only queued if the TX buffer has room for the whole message, so
+ * that its bytes can then be queued without waiting. Messages larger than
+ * the TX buffer can never fit, they are streamed through it if a send
+ * callback is set (see `whad_transport_write()`).
+ *
+ * @param   size    Size of the serialized message in bytes
+ * @retval  WHAD_SUCCESS        Header queued.
+ * @retval  WHAD_ERROR          Message size exceeds WHAD_MESSAGE_MAX_SIZE.
+ * @retval  WHAD_RINGBUF_FULL   Not enough space in TX buffer, header not queued.
+ */
+
+whad_result_t whad_transport_send_header(int size)
+{
+    uint8_t header[4];
+
+    if ((size < 0) || (size > WHAD_MESSAGE_MAX_SIZE))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Make sure the whole frame fits, unless it can only be streamed. */
+    if ((4 + size) > (whad_ringbuf_get_free_size(&gw_transport.tx_buf) - 1))
+    {
+        if (((4 + size) < WHAD_RINGBUF_MAX_SIZE) || (gw_transport.config.pfn_data_send_buffer == NULL))
+        {
+            return WHAD_RINGBUF_FULL;
+        }
+        gw_transport.tx_stream_size = 4 + size;
+    }
 
     /* Write header. */
     header[0] = '\xAC';
     header[1] = '\xBE';
     header[2] = (size & 0xff);
     header[3] = (size >> 8) & 0xff;
-    
+
+    return whad_transport_write(header, 4);
+}
+
+
+/**
+ * @brief   Queue a serialized message for transmission.
+ *
+ * The message is queued with its header at once, or not at all if the TX
+ * buffer cannot hold them. Messages larger than the TX buffer are streamed
+ * through it, and this function busy-waits until they are entirely queued,
+ * see `whad_transport_write()`.
+ *
+ * @param   p_message   Pointer to the serialized message
+ * @param   size        Size of the serialized message in bytes
+ * @retval  WHAD_SUCCESS        Message queued.
+ * @retval  WHAD_ERROR          Message too large.
+ * @retval  WHAD_RINGBUF_FULL   Not enough space in TX buffer, message not queued.
+ */
+
+whad_result_t whad_transport_send_message(uint8_t *p_message, int size)
+{
+    whad_result_t result;
+
+    if (size == 0)
+        return WHAD_SUCCESS;
+
     /* Send header, then message payload. */
-    nb_bytes_sent = whad_transport_send(header, 4);
-    if (nb_bytes_sent < 4)
+    result = whad_transport_send_header(size);
+    if (result != WHAD_SUCCESS)
     {
-        /* Could not send the whole header. */
-        return WHAD_ERROR;
+        return result;
     }
 
-    nb_bytes_sent = whad_transport_send(p_message, size);
-    if (nb_bytes_sent < size)
+    return whad_transport_write(p_message, size);
+}
+
+/**
+ * @brief   Queue a pre-encoded frame for transmission.
+ *
+ * The frame (transport header included) and the optional trailing bytes
+ * are queued at once, or not at all if the TX buffer cannot hold them, so
+ * that a partially queued frame never corrupts the stream.
+ *
+ * Unlike messages sent with `whad_transport_send_message()`, frames are never
+ * streamed: this function never waits for a transmission to end, and frames
+ * that do not fit in the free space of the TX buffer are rejected, whatever
+ * their size. Only messages larger than the TX buffer wait for the ongoing
+ * transmissions, see `whad_transport_write()`.
+ *
+ * @param   p_frame         Pointer to the pre-encoded frame
+ * @param   size            Size of the pre-encoded frame in bytes
+ * @param   p_trailer       Pointer to bytes to append to the frame, may be NULL
+ * @param   trailer_size    Number of bytes to append to the frame
+ * @retval  WHAD_SUCCESS        Frame successfully queued.
+ * @retval  WHAD_RINGBUF_FULL   Not enough space in TX buffer, frame not queued.
+ */
+
+whad_result_t whad_transport_send_frame(uint8_t *p_frame, int size, uint8_t *p_trailer, int trailer_size)
+{
+    /* Make sure both parts fit in our TX buffer. */
+    if ((p_trailer == NULL) || (trailer_size <= 0))
     {
-        /* Could not send the whole buffer. */
-        return WHAD_ERROR;
+        trailer_size = 0;
+    }
+
+    if ((size + trailer_size) > (whad_ringbuf_get_free_size(&gw_transport.tx_buf) - 1))
+    {
+        return WHAD_RINGBUF_FULL;
+    }
+
+    /* Queue frame, then trailing bytes. */
+    whad_ringbuf_push_buffer(&gw_transport.tx_buf, p_frame, size);
+    if (trailer_size > 0)
+    {
+        whad_ringbuf_push_buffer(&gw_transport.tx_buf, p_trailer, trailer_size);
     }
 
     /* Success. */
     return WHAD_SUCCESS;
 }
 
+
 /**
  * @brief   WHAD transport data sent callback.
  * 
@@ -257,8 +480,9 @@ int whad_transport_send(uint8_t *p_data, int size)
     /* Enqueue as much data as possible. */
     while (i<size)
     {
-        if (whad_ringbuf_push(&gw_transport.tx_buf, p_data[i++]) == WHAD_ERROR)
+        if (whad_ringbuf_push(&gw_transport.tx_buf, p_data[i]) != WHAD_SUCCESS)
             break;
+        i++;
     }
 
     /* Return the number of bytes added to the send queue. */
@@ -0,0 +1,48 @@
+#include "whad.h"
+
+#if WHAD_ENABLE_BLE
+PB_BIND(whad_ble_raw_pdu_tx, whad_ble_raw_pdu_tx_t, 2)
+#endif
+#if WHAD_ENABLE_ESB
+PB_BIND(whad_esb_raw_pdu_tx, whad_esb_raw_pdu_tx_t, 2)
+#endif
+#if WHAD_ENABLE_DOT15D4
+PB_BIND(whad_dot15d4_pdu_tx, whad_dot15d4_pdu_tx_t, 2)
+#endif
+#if WHAD_ENABLE_PHY
+PB_BIND(whad_phy_send_tx, whad_phy_send_tx_t, 2)
+#endif
+
+
+/**
+ * @brief   NanoPb field callback streaming a referenced payload.
+ *
+ * Writes the `whad_payload_ref_t` field pointed by `field` as a bytes field,
+ * straight from the referenced buffer. Empty payloads are omitted, as NanoPb
+ * does for proto3 bytes fields.
+ *
+ * @param[in]       istream     Input stream, set when decoding (not supported)
+ * @param[in,out]   ostream     Output stream, set when encoding
+ * @param[in]       field       Field iterator
+ * @return          true on success, false on error or when decoding.
+ */
+
+bool whad_payload_ref_field_callback(pb_istream_t *istream, pb_ostream_t *ostream, const pb_field_iter_t *field)
+{
+    const whad_payload_ref_t *p_payload = (const whad_payload_ref_t *)field->pData;
+
+    /* TX-only messages cannot be decoded. */
+    if (ostream == NULL)
+    {
+        return false;
+    }
+
+    /* Nothing to encode. */
+    if (p_payload->size == 0)
+    {
+        return true;
+    }
+
+    return pb_encode_tag_for_field(ostream, field) &&
+           pb_encode_string(ostream, p_payload->p_bytes, p_payload->size);
+}
@@ -1,7 +1,6 @@
 #include "whad.h"
 
 static uint8_t g_rx_message_buf[WHAD_MESSAGE_MAX_SIZE];
-static uint8_t g_tx_message_buf[WHAD_MESSAGE_MAX_SIZE];
 
 /***
  * WHAD driver
@@ -11,102 +10,265 @@ void whad_init(whad_transport_cfg_t *p_transport_cfg)
 {
     /* Initialize transport. */
     whad_transport_init(p_transport_cfg);
+
+#ifdef WHAD_TRACING
+    /* Restart trace sequence numbers, keeping any trace clock already set. */
+    whad_trace_init();
+#endif
 }
 
 /**
  * @brief   Free a WHAD message's dynamically allocated resources.
+ *
+ * Builders only reference caller-provided or static storage and decoded
+ * variable-length fields live in arenas, so no message owns heap memory:
+ * kept for compatibility, this is a no-op.
  * 
  * @param[in]   p_msg   Pointer to a WHAD message
  */
 
 void whad_free_message_resources(Message *p_msg)
 {
-    switch (whad_get_message_type(p_msg))
+    (void)p_msg;
+}
+
+
+/**
+ * @brief NanoPb output stream callback writing into the transport TX buffer.
+ */
+
+static bool whad_tx_stream_write(pb_ostream_t *stream, const pb_byte_t *buf, size_t count)
+{
+    return (whad_transport_write((uint8_t *)buf, (int)count) == WHAD_SUCCESS);
+}
+
+
+/**
+ * @brief Start streaming a serialized message of a given size to the transport layer
+ *
+ * @param[in,out]   p_stream            Pointer to the output stream to initialize
+ * @param[in]       size                Serialized message size in bytes
+ * @retval          WHAD_ERROR          Message is empty or too large
+ * @retval          WHAD_RINGBUF_FULL   Not enough space in TX buffer, nothing queued
+ * @retval          WHAD_SUCCESS        Transport header queued, message must be encoded into `p_stream`
+ */
+
+static whad_result_t whad_tx_stream_open(pb_ostream_t *p_stream, size_t size)
+{
+    pb_ostream_t stream = {&whad_tx_stream_write, NULL, size, 0};
+    whad_result_t result;
+
+    if ((size == 0) || ((size + WHAD_TRACE_OVERHEAD) > WHAD_MESSAGE_MAX_SIZE))
     {
-        case WHAD_MSGTYPE_DOMAIN:
-            switch (whad_get_message_domain(p_msg))
-            {
-                case DOMAIN_PHY:
-                    whad_phy_message_free(p_msg);
-                    break;
+        return WHAD_ERROR;
+    }
 
-                default:
-                    break;
-            }
-            break;
+#ifdef WHAD_TRACING
+    whad_trace_frame_start();
+#endif
 
-        default:
+    /* The header also accounts for the trace extension, if any. */
+    result = whad_transport_send_header((int)size + WHAD_TRACE_OVERHEAD);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+
+    *p_stream = stream;
+
+    /* Success. */
+    return WHAD_SUCCESS;
+}
+
+
+/**
+ * @brief End streaming a serialized message to the transport layer
+ *
+ * If the message could not be fully encoded, it is padded with zeros up to
+ * the size announced in its header to keep the host in sync with our frames
+ * (the host then discards it as an invalid message).
+ *
+ * @param[in]   p_stream     Pointer to the output stream
+ * @param[in]   encoded      Message encoding result
+ * @retval      WHAD_ERROR   Message could not be fully encoded
+ * @retval      WHAD_SUCCESS Message has successfully been queued for transmission
+ */
+
+static whad_result_t whad_tx_stream_close(pb_ostream_t *p_stream, bool encoded)
+{
+    uint8_t zero = 0;
+#ifdef WHAD_TRACING
+    uint8_t extension[WHAD_TRACE_EXTENSION_SIZE];
+    whad_wire_writer_t writer;
+#endif
+
+    if (encoded && (p_stream->bytes_written == p_stream->max_size))
+    {
+#ifdef WHAD_TRACING
+        /* Append trace extension. */
+        whad_wire_writer_init(&writer, extension, sizeof(extension));
+        whad_trace_put_extension(&writer);
+        return whad_transport_write(extension, writer.offset);
+#else
+        /* Success. */
+        return WHAD_SUCCESS;
+#endif
+    }
+
+    /* Pad our truncated message (and its trace extension). */
+    while (p_stream->bytes_written < (p_stream->max_size + WHAD_TRACE_OVERHEAD))
+    {
+        if (whad_transport_write(&zero, 1) != WHAD_SUCCESS)
+        {
             break;
+        }
+        p_stream->bytes_written++;
     }
+
+    return WHAD_ERROR;
 }
 
 
 /**
  * @brief Send a WHAD message over the communication layer
+ *
+ * The message is serialized straight into the transport TX buffer, once
+ * enough space is available for the whole message. Messages larger than this
+ * buffer are streamed through it, busy-waiting for the ongoing transmissions,
+ * see `whad_transport_write()`.
  * 
- * @param[in]   p_msg        Pointer to a NanoPb message structure
- * @retval      WHAD_ERROR   An error occurred while sending message
- * @retval      WHAD_SUCCESS Message has successfully been queued for transmission
+ * @param[in]   p_msg               Pointer to a NanoPb message structure
+ * @retval      WHAD_ERROR          An error occurred while sending message
+ * @retval      WHAD_RINGBUF_FULL   Not enough space in TX buffer, message not queued
+ * @retval      WHAD_SUCCESS        Message has successfully been queued for transmission
  */
 
 whad_result_t whad_send_message(Message *p_msg)
 {
-    /* Serialize our message. */
-    pb_ostream_t stream = pb_ostream_from_buffer(g_tx_message_buf, 1024);
-    if (pb_encode(&stream, Message_fields, p_msg))
+    pb_ostream_t stream;
+    size_t size;
+    bool encoded;
+    whad_result_t result;
+    WHAD_PROFILE_START(start);
+
+    /* Compute our serialized message size. */
+    if (!pb_get_encoded_size(&size, Message_fields, p_msg))
     {
-        if (stream.bytes_written >0)
-        {
-            /* Free any dynamically allocated resources.*/
-            whad_free_message_resources(p_msg);
+        return WHAD_ERROR;
+    }
 
-            /* Send our serialized message to transport. */
-            return whad_transport_send_message(g_tx_message_buf, stream.bytes_written);
-        }
-        else
-        {
-            return WHAD_ERROR;
-        }
+    /* Serialize our message into the transport layer. */
+    result = whad_tx_stream_open(&stream, size);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
     }
-    else
+    encoded = pb_encode(&stream, Message_fields, p_msg);
+    WHAD_PROFILE_STOP(WHAD_PROFILE_ENCODE, start);
+
+    return whad_tx_stream_close(&stream, encoded);
+}
+
+
+/**
+ * @brief Send a compact WHAD message over the communication layer
+ *
+ * The embedded message is wrapped into its generic, discovery or domain
+ * message and into a `Message` on the fly, producing the exact same bytes
+ * as `whad_send_message()` would without requiring a full `Message`
+ * structure.
+ *
+ * @param[in]   p_msg               Pointer to a compact message structure
+ * @retval      WHAD_ERROR          An error occurred while sending message
+ * @retval      WHAD_RINGBUF_FULL   Not enough space in TX buffer, message not queued
+ * @retval      WHAD_SUCCESS        Message has successfully been queued for transmission
+ */
+
+whad_result_t whad_send_compact_message(whad_compact_msg_t *p_msg)
+{
+    pb_ostream_t sizing = PB_OSTREAM_SIZING;
+    pb_ostream_t stream;
+    size_t submsg_size;
+    bool encoded;
+    whad_result_t result;
+    WHAD_PROFILE_START(start);
+
+    /* Sanity check. */
+    if ((p_msg == NULL) || (p_msg->p_fields == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Compute the size of the wrapping generic/discovery/domain message. */
+    if (!pb_encode_tag(&sizing, PB_WT_STRING, p_msg->which_submsg) ||
+        !pb_encode_submessage(&sizing, p_msg->p_fields, &p_msg->msg))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Then the size of the whole message. */
+    submsg_size = sizing.bytes_written;
+    if (!pb_encode_tag(&sizing, PB_WT_STRING, p_msg->which_msg) ||
+        !pb_encode_varint(&sizing, submsg_size))
+    {
         return WHAD_ERROR;
+    }
+
+    /* Serialize our message into the transport layer, including both wrapping fields. */
+    result = whad_tx_stream_open(&stream, sizing.bytes_written);
+    if (result != WHAD_SUCCESS)
+    {
+        return result;
+    }
+    encoded = pb_encode_tag(&stream, PB_WT_STRING, p_msg->which_msg) &&
+              pb_encode_varint(&stream, submsg_size) &&
+              pb_encode_tag(&stream, PB_WT_STRING, p_msg->which_submsg) &&
+              pb_encode_submessage(&stream, p_msg->p_fields, &p_msg->msg);
+    WHAD_PROFILE_STOP(WHAD_PROFILE_ENCODE, start);
+
+    return whad_tx_stream_close(&stream, encoded);
 }
 
 
 /**
- * @brief Retrieve a received WHAD message from the communication layer
- * 
- * @param[in]   p_msg        Pointer to a NanoPb message structure
- * @retval      WHAD_ERROR   An error occurred while getting the message
+ * @brief Retrieve a received serialized WHAD message from the communication layer
+ *
+ * The message is left serialized in the RX message buffer, allowing fast-path
+ * decoders (`whad_*_fast_parse()`) to be tried before `whad_decode_message()`.
+ * It remains valid until the next call to `whad_get_raw_message()` or
+ * `whad_get_message()`.
+ *
+ * Messages larger than WHAD_MESSAGE_MAX_SIZE are discarded, and a command
+ * result reporting an error is sent in place of their response, so that the
+ * host does not wait for it.
+ *
+ * @param[out]  pp_message   Pointer set to the serialized message
+ * @param[out]  p_size       Pointer to the serialized message size in bytes
+ * @retval      WHAD_ERROR   An error occurred while getting the message, or message too large
  * @retval      WHAD_SUCCESS Message has successfully been retrieved
  * @retval      WHAD_NONE    No received message to be retrieved
  */
 
-whad_result_t whad_get_message(Message *p_msg)
+whad_result_t whad_get_raw_message(uint8_t **pp_message, int *p_size)
 {
     whad_result_t result;
     int message_size = WHAD_MESSAGE_MAX_SIZE;
 
+    /* Sanity check. */
+    if ((pp_message == NULL) || (p_size == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
     result = whad_transport_get_message(g_rx_message_buf, &message_size);
     if (result == WHAD_SUCCESS)
     {
         /* Do we have a message to parse ? */
         if (message_size > 0)
         {
-            /* Parse message. */
-            pb_istream_t stream = pb_istream_from_buffer(g_rx_message_buf, message_size);
-
-            /* Now we are ready to decode the message. */
-            if (pb_decode(&stream, Message_fields, p_msg))
-            {
-                /* Success, we got a message. */
-                return WHAD_SUCCESS;
-            }
-            else
-            {
-                /* Fail. */
-                return WHAD_ERROR;
-            }
+            *pp_message = g_rx_message_buf;
+            *p_size = message_size;
+            return WHAD_SUCCESS;
         }
         else
         {
@@ -116,12 +278,306 @@ whad_result_t whad_get_message(Message *p_msg)
     }
     else
     {
+        /* Reject messages too large for our RX message buffer. */
+        if (message_size > WHAD_MESSAGE_MAX_SIZE)
+        {
+            whad_send_cmd_result_fast(WHAD_RESULT_ERROR);
+        }
+
         /* Failure. */
         return WHAD_ERROR;
     }
 }
 
 
+/**
+ * @brief Decode a serialized WHAD message
+ *
+ * @param[in]   p_message    Pointer to a serialized message
+ * @param[in]   size         Serialized message size in bytes
+ * @param[in]   p_msg        Pointer to a NanoPb message structure
+ * @retval      WHAD_ERROR   Message cannot be decoded
+ * @retval      WHAD_SUCCESS Message has successfully been decoded
+ */
+
+whad_result_t whad_decode_message(uint8_t *p_message, int size, Message *p_msg)
+{
+    bool decoded;
+    WHAD_PROFILE_START(start);
+
+    /* Parse message. */
+    pb_istream_t stream = pb_istream_from_buffer(p_message, size);
+
+    /* Now we are ready to decode the message. */
+    decoded = pb_decode(&stream, Message_fields, p_msg);
+    WHAD_PROFILE_STOP(WHAD_PROFILE_DECODE, start);
+
+    if (decoded)
+    {
+        /* Success, we got a message. */
+        return WHAD_SUCCESS;
+    }
+    else
+    {
+        /* Fail. */
+        return WHAD_ERROR;
+    }
+}
+
+
+/**
+ * @brief Bind the callback fields of a decoded message to an arena
+ *
+ * @param[in,out]   p_msg           Pointer to a decoded NanoPb message structure
+ * @param[in]       p_arena         Pointer to the arena storing callback fields content
+ * @param[out]      p_which_submsg  Pointer set to the generic, discovery or domain message oneof tag
+ * @param[out]      pp_fields       Pointer set to the fields descriptor of the embedded message
+ * @param[out]      pp_submsg       Pointer set to the embedded message structure
+ * @retval          WHAD_SUCCESS    Callback fields bound to the arena
+ * @retval          WHAD_NONE       Message has no callback field
+ * @retval          WHAD_ERROR      Arena is full
+ */
+
+static whad_result_t whad_bind_message_arena(Message *p_msg, whad_arena_t *p_arena, pb_size_t *p_which_submsg,
+                                             const pb_msgdesc_t **pp_fields, void **pp_submsg)
+{
+    whad_result_t result = WHAD_NONE;
+
+    switch (p_msg->which_msg)
+    {
+        case Message_generic_tag:
+            *p_which_submsg = p_msg->msg.generic.which_msg;
+            switch (p_msg->msg.generic.which_msg)
+            {
+                case generic_Message_verbose_tag:
+                    *pp_fields = generic_VerboseMsg_fields;
+                    *pp_submsg = &p_msg->msg.generic.msg.verbose;
+                    result = whad_arena_bind_bytes(&p_msg->msg.generic.msg.verbose.data, p_arena);
+                    break;
+
+                case generic_Message_debug_tag:
+                    *pp_fields = generic_DebugMsg_fields;
+                    *pp_submsg = &p_msg->msg.generic.msg.debug;
+                    result = whad_arena_bind_bytes(&p_msg->msg.generic.msg.debug.data, p_arena);
+                    break;
+
+                case generic_Message_log_tag:
+                    *pp_fields = generic_LogMsg_fields;
+                    *pp_submsg = &p_msg->msg.generic.msg.log;
+                    result = whad_arena_bind_bytes(&p_msg->msg.generic.msg.log.entries, p_arena);
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+
+        case Message_discovery_tag:
+            *p_which_submsg = p_msg->msg.discovery.which_msg;
+            if (p_msg->msg.discovery.which_msg == discovery_Message_info_resp_tag)
+            {
+                *pp_fields = discovery_DeviceInfoResp_fields;
+                *pp_submsg = &p_msg->msg.discovery.msg.info_resp;
+                result = whad_arena_bind_varints(&p_msg->msg.discovery.msg.info_resp.capabilities, p_arena);
+                if (result == WHAD_SUCCESS)
+                {
+                    result = whad_arena_bind_messages(&p_msg->msg.discovery.msg.info_resp.domains, p_arena,
+                                                      discovery_DeviceDomainInfoResp_fields,
+                                                      sizeof(discovery_DeviceDomainInfoResp));
+                }
+            }
+            break;
+
+#if WHAD_ENABLE_BLE
+        case Message_ble_tag:
+            *p_which_submsg = p_msg->msg.ble.which_msg;
+            if (p_msg->msg.ble.which_msg == ble_Message_set_adv_data_tag)
+            {
+                *pp_fields = ble_SetAdvDataCmd_fields;
+                *pp_submsg = &p_msg->msg.ble.msg.set_adv_data;
+                result = whad_arena_bind_bytes(&p_msg->msg.ble.msg.set_adv_data.scan_data, p_arena);
+                if (result == WHAD_SUCCESS)
+                {
+                    result = whad_arena_bind_bytes(&p_msg->msg.ble.msg.set_adv_data.scanrsp_data, p_arena);
+                }
+            }
+            break;
+#endif
+
+#if WHAD_ENABLE_PHY
+        case Message_phy_tag:
+            *p_which_submsg = p_msg->msg.phy.which_msg;
+            switch (p_msg->msg.phy.which_msg)
+            {
+                case phy_Message_send_raw_tag:
+                    *pp_fields = phy_SendRawCmd_fields;
+                    *pp_submsg = &p_msg->msg.phy.msg.send_raw;
+                    result = whad_arena_bind_varints(&p_msg->msg.phy.msg.send_raw.iq, p_arena);
+                    break;
+
+                case phy_Message_raw_packet_tag:
+                    *pp_fields = phy_RawPacketReceived_fields;
+                    *pp_submsg = &p_msg->msg.phy.msg.raw_packet;
+                    result = whad_arena_bind_varints(&p_msg->msg.phy.msg.raw_packet.iq, p_arena);
+                    break;
+
+                case phy_Message_monitor_report_tag:
+                    *pp_fields = phy_MonitoringReport_fields;
+                    *pp_submsg = &p_msg->msg.phy.msg.monitor_report;
+                    result = whad_arena_bind_varints(&p_msg->msg.phy.msg.monitor_report.report, p_arena);
+                    break;
+
+                case phy_Message_supported_freq_tag:
+                    *pp_fields = phy_SupportedFrequencyRanges_fields;
+                    *pp_submsg = &p_msg->msg.phy.msg.supported_freq;
+                    result = whad_arena_bind_messages(&p_msg->msg.phy.msg.supported_freq.frequency_ranges, p_arena,
+                                                      phy_SupportedFrequencyRanges_FrequencyRange_fields,
+                                                      sizeof(phy_SupportedFrequencyRanges_FrequencyRange));
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+
+/**
+ * @brief Decode a serialized WHAD message, storing its callback fields into an arena
+ *
+ * Variable-length callback fields (texts, capabilities, IQ samples, frequency
+ * ranges, reports) are skipped by `whad_decode_message()`. This function
+ * stores them into the provided arena, where the message `*_parse()`
+ * functions can access them. They remain valid until the arena is reset,
+ * usually right after the message has been processed.
+ *
+ * NanoPb clears oneof submessages before decoding them, so the embedded
+ * message of a message carrying callback fields is decoded a second time
+ * once its callbacks have been bound to the arena.
+ *
+ * @param[in]   p_message    Pointer to the serialized message
+ * @param[in]   size         Serialized message size in bytes
+ * @param[in]   p_msg        Pointer to a NanoPb message structure
+ * @param[in]   p_arena      Pointer to the arena storing callback fields content
+ * @retval      WHAD_ERROR   Message cannot be decoded or arena is too small
+ * @retval      WHAD_SUCCESS Message has successfully been decoded
+ */
+
+whad_result_t whad_decode_message_arena(uint8_t *p_message, int size, Message *p_msg, whad_arena_t *p_arena)
+{
+    whad_wire_reader_t reader;
+    pb_istream_t stream;
+    pb_size_t which_submsg = 0;
+    const pb_msgdesc_t *p_fields = NULL;
+    void *p_submsg = NULL;
+    whad_result_t result;
+
+    /* Sanity check. */
+    if ((p_message == NULL) || (p_msg == NULL) || (p_arena == NULL))
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Decode message, callback fields are skipped. */
+    if (whad_decode_message(p_message, size, p_msg) != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Bind callback fields to the arena, if any. */
+    result = whad_bind_message_arena(p_msg, p_arena, &which_submsg, &p_fields, &p_submsg);
+    if (result == WHAD_NONE)
+    {
+        /* Success, no callback field. */
+        return WHAD_SUCCESS;
+    }
+    else if (result != WHAD_SUCCESS)
+    {
+        return WHAD_ERROR;
+    }
+
+    /* Decode embedded message again, callback fields included. */
+    if (!whad_wire_get_submessage(&reader, p_message, size, p_msg->which_msg, which_submsg))
+    {
+        return WHAD_ERROR;
+    }
+
+    stream = pb_istream_from_buffer(reader.p_buffer, reader.size);
+    if (pb_decode(&stream, p_fields, p_submsg))
+    {
+        /* Success. */
+        return WHAD_SUCCESS;
+    }
+    else
+    {
+        /* Fail. */
+        return WHAD_ERROR;
+    }
+}
+
+
+/**
+ * @brief Retrieve a received WHAD message from the communication layer
+ * 
+ * @param[in]   p_msg        Pointer to a NanoPb message structure
+ * @retval      WHAD_ERROR   An error occurred while getting the message
+ * @retval      WHAD_SUCCESS Message has successfully been retrieved
+ * @retval      WHAD_NONE    No received message to be retrieved
+ */
+
+whad_result_t whad_get_message(Message *p_msg)
+{
+    whad_result_t result;
+    uint8_t *p_message;
+    int message_size;
+
+    result = whad_get_raw_message(&p_message, &message_size);
+    if (result == WHAD_SUCCESS)
+    {
+        /* Decode message. */
+        return whad_decode_message(p_message, message_size, p_msg);
+    }
+
+    /* No message or failure. */
+    return result;
+}
+
+
+/**
+ * @brief Retrieve a received WHAD message, storing its callback fields into an arena
+ * 
+ * @param[in]   p_msg        Pointer to a NanoPb message structure
+ * @param[in]   p_arena      Pointer to the arena storing callback fields content
+ * @retval      WHAD_ERROR   An error occurred while getting the message
+ * @retval      WHAD_SUCCESS Message has successfully been retrieved
+ * @retval      WHAD_NONE    No received message to be retrieved
+ */
+
+whad_result_t whad_get_message_arena(Message *p_msg, whad_arena_t *p_arena)
+{
+    whad_result_t result;
+    uint8_t *p_message;
+    int message_size;
+
+    result = whad_get_raw_message(&p_message, &message_size);
+    if (result == WHAD_SUCCESS)
+    {
+        /* Decode message. */
+        return whad_decode_message_arena(p_message, message_size, p_msg, p_arena);
+    }
+
+    /* No message or failure. */
+    return result;
+}
+
+
 /**
  * @brief Retrieve the message type of a given message
  * 
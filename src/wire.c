@@ -0,0 +1,451 @@
+#include "whad.h"
+
+/**
+ * @brief   Compute the size of a varint.
+ *
+ * @param[in]   value   Value to encode
+ * @return      Size of the shortest varint encoding of `value`, in bytes.
+ */
+
+int whad_wire_varint_size(uint64_t value)
+{
+    int size = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+
+/**
+ * @brief   Write a varint into a buffer.
+ *
+ * Values shorter than the requested width are padded with continuation bytes,
+ * which is valid protobuf and accepted by every decoder.
+ *
+ * @param[in,out]   p_buffer    Pointer to the output buffer
+ * @param[in]       value       Value to encode
+ * @param[in]       width       Number of bytes to write, 0 to use the shortest encoding
+ * @return          Number of bytes written.
+ */
+
+int whad_wire_write_varint(uint8_t *p_buffer, uint64_t value, int width)
+{
+    int i = 0;
+
+    if (width == 0)
+    {
+        /* Shortest encoding. */
+        while (value >= 0x80)
+        {
+            p_buffer[i++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        p_buffer[i++] = (uint8_t)value;
+    }
+    else
+    {
+        /* Fixed-width encoding. */
+        for (i=0; i<(width - 1); i++)
+        {
+            p_buffer[i] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        p_buffer[i++] = (uint8_t)(value & 0x7F);
+    }
+
+    return i;
+}
+
+
+/**
+ * @brief   Initialize a wire format writer.
+ *
+ * @param[in,out]   p_writer    Pointer to a writer
+ * @param[in]       p_buffer    Pointer to the output buffer, NULL to only compute sizes
+ * @param[in]       size        Output buffer size in bytes
+ */
+
+void whad_wire_writer_init(whad_wire_writer_t *p_writer, uint8_t *p_buffer, int size)
+{
+    p_writer->p_buffer = p_buffer;
+    p_writer->size = size;
+    p_writer->offset = 0;
+    p_writer->overflow = false;
+}
+
+
+/**
+ * @brief   Write a varint.
+ *
+ * @param[in,out]   p_writer    Pointer to a writer
+ * @param[in]       value       Value to write
+ */
+
+void whad_wire_put_varint(whad_wire_writer_t *p_writer, uint64_t value)
+{
+    if (p_writer->p_buffer == NULL)
+    {
+        p_writer->offset += whad_wire_varint_size(value);
+    }
+    else if ((p_writer->offset + whad_wire_varint_size(value)) <= p_writer->size)
+    {
+        p_writer->offset += whad_wire_write_varint(&p_writer->p_buffer[p_writer->offset], value, 0);
+    }
+    else
+    {
+        p_writer->overflow = true;
+    }
+}
+
+
+/**
+ * @brief   Write a field key.
+ *
+ * @param[in,out]   p_writer    Pointer to a writer
+ * @param[in]       tag         Field tag
+ * @param[in]       wire_type   Field wire type
+ */
+
+void whad_wire_put_key(whad_wire_writer_t *p_writer, uint32_t tag, pb_wire_type_t wire_type)
+{
+    whad_wire_put_varint(p_writer, ((uint64_t)tag << 3) | wire_type);
+}
+
+
+/**
+ * @brief   Write raw bytes.
+ *
+ * @param[in,out]   p_writer    Pointer to a writer
+ * @param[in]       p_data      Pointer to the bytes to write
+ * @param[in]       size        Number of bytes to write
+ */
+
+void whad_wire_put_bytes(whad_wire_writer_t *p_writer, const uint8_t *p_data, int size)
+{
+    if (p_writer->p_buffer == NULL)
+    {
+        p_writer->offset += size;
+    }
+    else if ((p_writer->offset + size) <= p_writer->size)
+    {
+        memcpy(&p_writer->p_buffer[p_writer->offset], p_data, size);
+        p_writer->offset += size;
+    }
+    else
+    {
+        p_writer->overflow = true;
+    }
+}
+
+
+/**
+ * @brief   Write a fixed32 field.
+ *
+ * Unlike varint fields, fixed32 fields always take 5 bytes (tags up to 15).
+ *
+ * @param[in,out]   p_writer    Pointer to a writer
+ * @param[in]       tag         Field tag
+ * @param[in]       value       Field value
+ */
+
+void whad_wire_put_fixed32_field(whad_wire_writer_t *p_writer, uint32_t tag, uint32_t value)
+{
+    uint8_t bytes[4];
+
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+
+    whad_wire_put_key(p_writer, tag, PB_WT_32BIT);
+    whad_wire_put_bytes(p_writer, bytes, 4);
+}
+
+
+/**
+ * @brief   Initialize a wire format reader.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[in]       p_buffer    Pointer to the input buffer
+ * @param[in]       size        Input buffer size in bytes
+ */
+
+void whad_wire_reader_init(whad_wire_reader_t *p_reader, const uint8_t *p_buffer, int size)
+{
+    p_reader->p_buffer = p_buffer;
+    p_reader->size = size;
+    p_reader->offset = 0;
+}
+
+
+/**
+ * @brief   Read a varint.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[out]      p_value     Pointer to the decoded value
+ * @return          true on success, false if the varint is truncated or does not fit in 64 bits.
+ */
+
+bool whad_wire_get_varint(whad_wire_reader_t *p_reader, uint64_t *p_value)
+{
+    uint64_t value = 0;
+    int shift = 0;
+    uint8_t byte;
+
+    do
+    {
+        if ((p_reader->offset >= p_reader->size) || (shift >= 70))
+        {
+            return false;
+        }
+
+        byte = p_reader->p_buffer[p_reader->offset++];
+
+        /* The 10th byte only carries bit 63, NanoPb rejects anything else. */
+        if ((shift == 63) && (byte > 1))
+        {
+            return false;
+        }
+
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    *p_value = value;
+    return true;
+}
+
+
+/**
+ * @brief   Read a field key.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[out]      p_tag       Pointer to the field tag
+ * @param[out]      p_wire_type Pointer to the field wire type
+ * @return          true on success, false on error, invalid tag or key larger than 32 bits (as NanoPb).
+ */
+
+bool whad_wire_get_key(whad_wire_reader_t *p_reader, uint32_t *p_tag, pb_wire_type_t *p_wire_type)
+{
+    uint64_t key;
+
+    /* Tag 0 is invalid. */
+    if (!whad_wire_get_varint(p_reader, &key) || ((key >> 3) == 0) || (key > UINT32_MAX))
+    {
+        return false;
+    }
+
+    *p_tag = (uint32_t)(key >> 3);
+    *p_wire_type = (pb_wire_type_t)(key & 0x07);
+    return true;
+}
+
+
+/**
+ * @brief   Read an uint32 (or enum) field value.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[in]       wire_type   Field wire type, as read from its key
+ * @param[out]      p_value     Pointer to the decoded value
+ * @return          true on success, false on wrong wire type or out of range value.
+ */
+
+bool whad_wire_get_uint32(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, uint32_t *p_value)
+{
+    uint64_t value;
+
+    if ((wire_type != PB_WT_VARINT) || !whad_wire_get_varint(p_reader, &value) || (value > UINT32_MAX))
+    {
+        return false;
+    }
+
+    *p_value = (uint32_t)value;
+    return true;
+}
+
+
+/**
+ * @brief   Read a fixed32 field value.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[in]       wire_type   Field wire type, as read from its key
+ * @param[out]      p_value     Pointer to the decoded value
+ * @return          true on success, false on wrong wire type or truncated value.
+ */
+
+bool whad_wire_get_fixed32(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, uint32_t *p_value)
+{
+    const uint8_t *p_bytes;
+
+    if ((wire_type != PB_WT_32BIT) || ((p_reader->offset + 4) > p_reader->size))
+    {
+        return false;
+    }
+
+    p_bytes = &p_reader->p_buffer[p_reader->offset];
+    *p_value = (uint32_t)p_bytes[0] | ((uint32_t)p_bytes[1] << 8) | ((uint32_t)p_bytes[2] << 16) |
+               ((uint32_t)p_bytes[3] << 24);
+    p_reader->offset += 4;
+
+    return true;
+}
+
+
+/**
+ * @brief   Read a bool field value.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[in]       wire_type   Field wire type, as read from its key
+ * @param[out]      p_value     Pointer to the decoded value
+ * @return          true on success, false on wrong wire type or value larger than 32 bits (as NanoPb).
+ */
+
+bool whad_wire_get_bool(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, bool *p_value)
+{
+    uint64_t value;
+
+    if ((wire_type != PB_WT_VARINT) || !whad_wire_get_varint(p_reader, &value) || (value > UINT32_MAX))
+    {
+        return false;
+    }
+
+    *p_value = (value != 0);
+    return true;
+}
+
+
+/**
+ * @brief   Read a bytes (or embedded message) field value.
+ *
+ * No copy is made, `pp_data` points into the reader input buffer.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[in]       wire_type   Field wire type, as read from its key
+ * @param[out]      pp_data     Pointer set to the first byte of the field value
+ * @param[out]      p_size      Pointer to the field value size in bytes
+ * @return          true on success, false on wrong wire type or truncated value.
+ */
+
+bool whad_wire_get_bytes(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type, uint8_t **pp_data, int *p_size)
+{
+    uint64_t size;
+
+    if ((wire_type != PB_WT_STRING) || !whad_wire_get_varint(p_reader, &size) ||
+        (size > (uint64_t)(p_reader->size - p_reader->offset)))
+    {
+        return false;
+    }
+
+    *pp_data = (uint8_t *)&p_reader->p_buffer[p_reader->offset];
+    *p_size = (int)size;
+    p_reader->offset += (int)size;
+    return true;
+}
+
+
+/**
+ * @brief   Skip a field value.
+ *
+ * @param[in,out]   p_reader    Pointer to a reader
+ * @param[in]       wire_type   Field wire type, as read from its key
+ * @return          true on success, false on unsupported wire type or truncated value.
+ */
+
+bool whad_wire_skip_field(whad_wire_reader_t *p_reader, pb_wire_type_t wire_type)
+{
+    uint64_t value;
+    uint8_t *p_data;
+    int size;
+
+    switch (wire_type)
+    {
+        case PB_WT_VARINT:
+            return whad_wire_get_varint(p_reader, &value);
+
+        case PB_WT_64BIT:
+            size = 8;
+            break;
+
+        case PB_WT_32BIT:
+            size = 4;
+            break;
+
+        case PB_WT_STRING:
+            return whad_wire_get_bytes(p_reader, wire_type, &p_data, &size);
+
+        default:
+            return false;
+    }
+
+    if ((p_reader->offset + size) > p_reader->size)
+    {
+        return false;
+    }
+
+    p_reader->offset += size;
+    return true;
+}
+
+
+/**
+ * @brief   Open the embedded message of a serialized `Message`.
+ *
+ * Succeeds only if the `Message` is made of a single generic/discovery/domain
+ * message field matching `which_msg`, itself made of a single field matching
+ * `which_submsg`. The reader is then set up over this embedded message.
+ * Unknown fields following the message field, such as the tracing extension
+ * (see trace.h), are skipped as NanoPb does. Any other layout, even if valid,
+ * is left to NanoPb.
+ *
+ * @param[in,out]   p_reader        Pointer to a reader
+ * @param[in]       p_message       Pointer to a serialized `Message` (without transport header)
+ * @param[in]       size            Serialized message size in bytes
+ * @param[in]       which_msg       Expected `Message` oneof tag
+ * @param[in]       which_submsg    Expected generic, discovery or domain message oneof tag
+ * @return          true if the message matches, false otherwise.
+ */
+
+bool whad_wire_get_submessage(whad_wire_reader_t *p_reader, uint8_t *p_message, int size, pb_size_t which_msg,
+                              pb_size_t which_submsg)
+{
+    whad_wire_reader_t reader;
+    pb_wire_type_t wire_type;
+    uint32_t tag;
+    uint8_t *p_data;
+    int data_size;
+
+    /* Wrapping Message field. */
+    whad_wire_reader_init(&reader, p_message, size);
+    if (!whad_wire_get_key(&reader, &tag, &wire_type) || (tag != which_msg) ||
+        !whad_wire_get_bytes(&reader, wire_type, &p_data, &data_size))
+    {
+        return false;
+    }
+
+    /* Skip trailing unknown fields, another Message field would replace this one. */
+    while (reader.offset < reader.size)
+    {
+        if (!whad_wire_get_key(&reader, &tag, &wire_type) ||
+            ((tag >= Message_generic_tag) && (tag <= Message_phy_tag)) ||
+            !whad_wire_skip_field(&reader, wire_type))
+        {
+            return false;
+        }
+    }
+
+    /* Wrapping generic/discovery/domain message field. */
+    whad_wire_reader_init(&reader, p_data, data_size);
+    if (!whad_wire_get_key(&reader, &tag, &wire_type) || (tag != which_submsg) ||
+        !whad_wire_get_bytes(&reader, wire_type, &p_data, &data_size) || (reader.offset != reader.size))
+    {
+        return false;
+    }
+
+    whad_wire_reader_init(p_reader, p_data, data_size);
+    return true;
+}
@@ -67,6 +67,8 @@ typedef struct _discovery_DeviceDomainInfoResp {
 
 typedef struct _discovery_DeviceInfoQuery { 
     uint32_t proto_ver;
+    /* Ask for the supported commands of every domain in the response. */
+    bool describe_all;
 } discovery_DeviceInfoQuery;
 
 typedef PB_BYTES_ARRAY_T(64) discovery_DeviceInfoResp_fw_author_t;
@@ -87,6 +89,8 @@ typedef struct _discovery_DeviceInfoResp {
     uint32_t fw_version_minor;
     uint32_t fw_version_rev;
     pb_callback_t capabilities;
+    /* Supported commands of every domain, if describe_all was set. */
+    pb_callback_t domains;
 } discovery_DeviceInfoResp;
 
 typedef struct _discovery_SetTransportSpeed { 
@@ -129,17 +133,17 @@ extern "C" {
 #define discovery_DeviceResetQuery_init_default  {0}
 #define discovery_DeviceReadyResp_init_default   {0}
 #define discovery_SetTransportSpeed_init_default {0}
-#define discovery_DeviceInfoResp_init_default    {0, {0}, 0, 0, {0, {0}}, {0, {0}}, 0, 0, 0, {{NULL}, NULL}}
+#define discovery_DeviceInfoResp_init_default    {0, {0}, 0, 0, {0, {0}}, {0, {0}}, 0, 0, 0, {{NULL}, NULL}, {{NULL}, NULL}}
 #define discovery_DeviceDomainInfoResp_init_default {0, 0}
-#define discovery_DeviceInfoQuery_init_default   {0}
+#define discovery_DeviceInfoQuery_init_default   {0, 0}
 #define discovery_DeviceDomainInfoQuery_init_default {0}
 #define discovery_Message_init_default           {0, {discovery_DeviceResetQuery_init_default}}
 #define discovery_DeviceResetQuery_init_zero     {0}
 #define discovery_DeviceReadyResp_init_zero      {0}
 #define discovery_SetTransportSpeed_init_zero    {0}
-#define discovery_DeviceInfoResp_init_zero       {0, {0}, 0, 0, {0, {0}}, {0, {0}}, 0, 0, 0, {{NULL}, NULL}}
+#define discovery_DeviceInfoResp_init_zero       {0, {0}, 0, 0, {0, {0}}, {0, {0}}, 0, 0, 0, {{NULL}, NULL}, {{NULL}, NULL}}
 #define discovery_DeviceDomainInfoResp_init_zero {0, 0}
-#define discovery_DeviceInfoQuery_init_zero      {0}
+#define discovery_DeviceInfoQuery_init_zero      {0, 0}
 #define discovery_DeviceDomainInfoQuery_init_zero {0}
 #define discovery_Message_init_zero              {0, {discovery_DeviceResetQuery_init_zero}}
 
@@ -148,6 +152,7 @@ extern "C" {
 #define discovery_DeviceDomainInfoResp_domain_tag 1
 #define discovery_DeviceDomainInfoResp_supported_commands_tag 2
 #define discovery_DeviceInfoQuery_proto_ver_tag  1
+#define discovery_DeviceInfoQuery_describe_all_tag 2
 #define discovery_DeviceInfoResp_type_tag        1
 #define discovery_DeviceInfoResp_devid_tag       2
 #define discovery_DeviceInfoResp_proto_min_ver_tag 3
@@ -158,6 +163,7 @@ extern "C" {
 #define discovery_DeviceInfoResp_fw_version_minor_tag 8
 #define discovery_DeviceInfoResp_fw_version_rev_tag 9
 #define discovery_DeviceInfoResp_capabilities_tag 10
+#define discovery_DeviceInfoResp_domains_tag     11
 #define discovery_SetTransportSpeed_speed_tag    1
 #define discovery_Message_reset_query_tag        1
 #define discovery_Message_ready_resp_tag         2
@@ -193,9 +199,11 @@ X(a, STATIC,   SINGULAR, BYTES,    fw_url,            6) \
 X(a, STATIC,   SINGULAR, UINT32,   fw_version_major,   7) \
 X(a, STATIC,   SINGULAR, UINT32,   fw_version_minor,   8) \
 X(a, STATIC,   SINGULAR, UINT32,   fw_version_rev,    9) \
-X(a, CALLBACK, REPEATED, UINT32,   capabilities,     10)
+X(a, CALLBACK, REPEATED, UINT32,   capabilities,     10) \
+X(a, CALLBACK, REPEATED, MESSAGE,  domains,          11)
 #define discovery_DeviceInfoResp_CALLBACK pb_default_field_callback
 #define discovery_DeviceInfoResp_DEFAULT NULL
+#define discovery_DeviceInfoResp_domains_MSGTYPE discovery_DeviceDomainInfoResp
 
 #define discovery_DeviceDomainInfoResp_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT32,   domain,            1) \
@@ -204,7 +212,8 @@ X(a, STATIC,   SINGULAR, UINT64,   supported_commands,   2)
 #define discovery_DeviceDomainInfoResp_DEFAULT NULL
 
 #define discovery_DeviceInfoQuery_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, UINT32,   proto_ver,         1)
+X(a, STATIC,   SINGULAR, UINT32,   proto_ver,         1) \
+X(a, STATIC,   SINGULAR, BOOL,     describe_all,      2)
 #define discovery_DeviceInfoQuery_CALLBACK NULL
 #define discovery_DeviceInfoQuery_DEFAULT NULL
 
@@ -255,7 +264,7 @@ extern const pb_msgdesc_t discovery_Message_msg;
 /* discovery_Message_size depends on runtime parameters */
 #define discovery_DeviceDomainInfoQuery_size     6
 #define discovery_DeviceDomainInfoResp_size      17
-#define discovery_DeviceInfoQuery_size           6
+#define discovery_DeviceInfoQuery_size           8
 #define discovery_DeviceReadyResp_size           0
 #define discovery_DeviceResetQuery_size          0
 #define discovery_SetTransportSpeed_size         6
@@ -18,6 +18,15 @@ PB_BIND(generic_DebugMsg, generic_DebugMsg, AUTO)
 PB_BIND(generic_VerboseMsg, generic_VerboseMsg, AUTO)
 
 
+PB_BIND(generic_TimeSyncQuery, generic_TimeSyncQuery, AUTO)
+
+
+PB_BIND(generic_TimeSyncReply, generic_TimeSyncReply, AUTO)
+
+
+PB_BIND(generic_LogMsg, generic_LogMsg, AUTO)
+
+
 PB_BIND(generic_Message, generic_Message, AUTO)
 
 
@@ -27,6 +27,15 @@ typedef struct _generic_VerboseMsg {
 
 typedef struct _generic_CmdResult { 
     generic_ResultCode result;
+    /* Device time the command was received at, in microseconds. */
+    bool has_rx_time;
+    uint32_t rx_time;
+    /* Time from the command reception until its result was queued, in microseconds. */
+    bool has_duration;
+    uint32_t duration;
+    /* Bytes waiting in the TX ring buffer ahead of the result. */
+    bool has_tx_backlog;
+    uint32_t tx_backlog;
 } generic_CmdResult;
 
 typedef struct _generic_DebugMsg { 
@@ -34,10 +43,36 @@ typedef struct _generic_DebugMsg {
     pb_callback_t data;
 } generic_DebugMsg;
 
+/* Binary log entries, see inc/log.h. */
+typedef struct _generic_LogMsg { 
+    /* Total number of entries dropped by the device. */
+    uint32_t dropped;
+    /* Packed log entries. */
+    pb_callback_t entries;
+} generic_LogMsg;
+
 typedef struct _generic_Progress { 
     uint32_t value;
 } generic_Progress;
 
+/* Clock synchronization query, sent by the host. */
+typedef struct _generic_TimeSyncQuery { 
+    uint32_t sequence;
+    /* Host time the query was sent at, in microseconds. */
+    uint64_t host_time;
+} generic_TimeSyncQuery;
+
+/* Clock synchronization reply, sent by the device. */
+typedef struct _generic_TimeSyncReply { 
+    uint32_t sequence;
+    /* Host time copied from the query. */
+    uint64_t host_time;
+    /* Device time the query was received at, in microseconds. */
+    uint64_t rx_time;
+    /* Device time the reply was queued at, in microseconds. */
+    uint64_t tx_time;
+} generic_TimeSyncReply;
+
 typedef struct _generic_Message { 
     pb_size_t which_msg;
     union {
@@ -46,6 +81,9 @@ typedef struct _generic_Message {
         generic_Progress progress;
         generic_DebugMsg debug;
         generic_VerboseMsg verbose;
+        generic_TimeSyncQuery time_sync_query;
+        generic_TimeSyncReply time_sync_reply;
+        generic_LogMsg log;
     } msg;
 } generic_Message;
 
@@ -61,32 +99,55 @@ extern "C" {
 #endif
 
 /* Initializer values for message structs */
-#define generic_CmdResult_init_default           {_generic_ResultCode_MIN}
+#define generic_CmdResult_init_default           {_generic_ResultCode_MIN, false, 0, false, 0, false, 0}
 #define generic_Progress_init_default            {0}
 #define generic_DebugMsg_init_default            {0, {{NULL}, NULL}}
 #define generic_VerboseMsg_init_default          {{{NULL}, NULL}}
+#define generic_TimeSyncQuery_init_default       {0, 0}
+#define generic_TimeSyncReply_init_default       {0, 0, 0, 0}
+#define generic_LogMsg_init_default              {0, {{NULL}, NULL}}
 #define generic_Message_init_default             {0, {_generic_ResultCode_MIN}}
-#define generic_CmdResult_init_zero              {_generic_ResultCode_MIN}
+#define generic_CmdResult_init_zero              {_generic_ResultCode_MIN, false, 0, false, 0, false, 0}
 #define generic_Progress_init_zero               {0}
 #define generic_DebugMsg_init_zero               {0, {{NULL}, NULL}}
 #define generic_VerboseMsg_init_zero             {{{NULL}, NULL}}
+#define generic_TimeSyncQuery_init_zero          {0, 0}
+#define generic_TimeSyncReply_init_zero          {0, 0, 0, 0}
+#define generic_LogMsg_init_zero                 {0, {{NULL}, NULL}}
 #define generic_Message_init_zero                {0, {_generic_ResultCode_MIN}}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define generic_VerboseMsg_data_tag              1
 #define generic_CmdResult_result_tag             1
+#define generic_CmdResult_rx_time_tag            2
+#define generic_CmdResult_duration_tag           3
+#define generic_CmdResult_tx_backlog_tag         4
 #define generic_DebugMsg_level_tag               1
 #define generic_DebugMsg_data_tag                2
+#define generic_LogMsg_dropped_tag               1
+#define generic_LogMsg_entries_tag               2
 #define generic_Progress_value_tag               1
+#define generic_TimeSyncQuery_sequence_tag       1
+#define generic_TimeSyncQuery_host_time_tag      2
+#define generic_TimeSyncReply_sequence_tag       1
+#define generic_TimeSyncReply_host_time_tag      2
+#define generic_TimeSyncReply_rx_time_tag        3
+#define generic_TimeSyncReply_tx_time_tag        4
 #define generic_Message_result_tag               1
 #define generic_Message_cmd_result_tag           2
 #define generic_Message_progress_tag             3
 #define generic_Message_debug_tag                4
 #define generic_Message_verbose_tag              5
+#define generic_Message_time_sync_query_tag      6
+#define generic_Message_time_sync_reply_tag      7
+#define generic_Message_log_tag                  8
 
 /* Struct field encoding specification for nanopb */
 #define generic_CmdResult_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, UENUM,    result,            1)
+X(a, STATIC,   SINGULAR, UENUM,    result,            1) \
+X(a, STATIC,   OPTIONAL, UINT32,   rx_time,           2) \
+X(a, STATIC,   OPTIONAL, UINT32,   duration,          3) \
+X(a, STATIC,   OPTIONAL, UINT32,   tx_backlog,        4)
 #define generic_CmdResult_CALLBACK NULL
 #define generic_CmdResult_DEFAULT NULL
 
@@ -106,23 +167,52 @@ X(a, CALLBACK, SINGULAR, BYTES,    data,              1)
 #define generic_VerboseMsg_CALLBACK pb_default_field_callback
 #define generic_VerboseMsg_DEFAULT NULL
 
+#define generic_TimeSyncQuery_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   sequence,          1) \
+X(a, STATIC,   SINGULAR, UINT64,   host_time,         2)
+#define generic_TimeSyncQuery_CALLBACK NULL
+#define generic_TimeSyncQuery_DEFAULT NULL
+
+#define generic_TimeSyncReply_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   sequence,          1) \
+X(a, STATIC,   SINGULAR, UINT64,   host_time,         2) \
+X(a, STATIC,   SINGULAR, UINT64,   rx_time,           3) \
+X(a, STATIC,   SINGULAR, UINT64,   tx_time,           4)
+#define generic_TimeSyncReply_CALLBACK NULL
+#define generic_TimeSyncReply_DEFAULT NULL
+
+#define generic_LogMsg_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   dropped,           1) \
+X(a, CALLBACK, SINGULAR, BYTES,    entries,           2)
+#define generic_LogMsg_CALLBACK pb_default_field_callback
+#define generic_LogMsg_DEFAULT NULL
+
 #define generic_Message_FIELDLIST(X, a) \
 X(a, STATIC,   ONEOF,    UENUM,    (msg,result,msg.result),   1) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (msg,cmd_result,msg.cmd_result),   2) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (msg,progress,msg.progress),   3) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (msg,debug,msg.debug),   4) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (msg,verbose,msg.verbose),   5)
+X(a, STATIC,   ONEOF,    MESSAGE,  (msg,verbose,msg.verbose),   5) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (msg,time_sync_query,msg.time_sync_query),   6) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (msg,time_sync_reply,msg.time_sync_reply),   7) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (msg,log,msg.log),   8)
 #define generic_Message_CALLBACK NULL
 #define generic_Message_DEFAULT NULL
 #define generic_Message_msg_cmd_result_MSGTYPE generic_CmdResult
 #define generic_Message_msg_progress_MSGTYPE generic_Progress
 #define generic_Message_msg_debug_MSGTYPE generic_DebugMsg
 #define generic_Message_msg_verbose_MSGTYPE generic_VerboseMsg
+#define generic_Message_msg_time_sync_query_MSGTYPE generic_TimeSyncQuery
+#define generic_Message_msg_time_sync_reply_MSGTYPE generic_TimeSyncReply
+#define generic_Message_msg_log_MSGTYPE generic_LogMsg
 
 extern const pb_msgdesc_t generic_CmdResult_msg;
 extern const pb_msgdesc_t generic_Progress_msg;
 extern const pb_msgdesc_t generic_DebugMsg_msg;
 extern const pb_msgdesc_t generic_VerboseMsg_msg;
+extern const pb_msgdesc_t generic_TimeSyncQuery_msg;
+extern const pb_msgdesc_t generic_TimeSyncReply_msg;
+extern const pb_msgdesc_t generic_LogMsg_msg;
 extern const pb_msgdesc_t generic_Message_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
@@ -130,14 +220,20 @@ extern const pb_msgdesc_t generic_Message_msg;
 #define generic_Progress_fields &generic_Progress_msg
 #define generic_DebugMsg_fields &generic_DebugMsg_msg
 #define generic_VerboseMsg_fields &generic_VerboseMsg_msg
+#define generic_TimeSyncQuery_fields &generic_TimeSyncQuery_msg
+#define generic_TimeSyncReply_fields &generic_TimeSyncReply_msg
+#define generic_LogMsg_fields &generic_LogMsg_msg
 #define generic_Message_fields &generic_Message_msg
 
 /* Maximum encoded size of messages (where known) */
 /* generic_DebugMsg_size depends on runtime parameters */
 /* generic_VerboseMsg_size depends on runtime parameters */
+/* generic_LogMsg_size depends on runtime parameters */
 /* generic_Message_size depends on runtime parameters */
-#define generic_CmdResult_size                   2
+#define generic_CmdResult_size                   20
 #define generic_Progress_size                    6
+#define generic_TimeSyncQuery_size               17
+#define generic_TimeSyncReply_size               39
 
 #ifdef __cplusplus
 } /* extern "C" */